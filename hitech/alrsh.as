@@ -5,16 +5,32 @@
 	psect	text
 
 alrsh:
-	ld	a,b		;check for zero shift
-	or	a
-	ret	z
-	cp	33
-	jr	c,1f		;limit shift to 32 bits
-	ld	b,32
+	ld	a,b
+	cp	32		;limit shift to 32 bits
+	jr	c,1f
+	ld	b,31		;3 bytes of sign, then 7 bits
 1:
+	ld	a,b
+	cp	8		;whole bytes first
+	jr	c,2f
+	ld	e,d
+	ld	d,l
+	ld	l,h
+	ld	a,h
+	rla
+	sbc	a,a
+	ld	h,a		;fill with the sign
+	ld	a,b
+	sub	8
+	ld	b,a
+	jr	1b
+2:
+	or	a		;check for zero shift
+	ret	z
+3:
 	sra	h
 	rr	l
 	rr	d
 	rr	e
-	djnz	1b
+	djnz	3b
 	ret
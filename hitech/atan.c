@@ -3,38 +3,38 @@
 #define	PI	3.14159265358979
 #define	TWO_PI	6.28318530717958
 #define	HALF_PI	1.570796326794895
+#define	SIXTH_PI	0.523598775598299
+#define	TAN_PI_12	0.2679491924
+#define	SQRT3	1.7320508076
 
 double
 atan(f)
 double	f;
 {
-	static /* const */ double	coeff_a[] =
+	/* minimax fit to atan(x)/x as a polynomial in x*x, for x
+	 * between 0 and tan(pi/12) */
+	static /* const */ double	coeff[] =
 	{
-		33.058618473989548,
-		58.655751569001961,
-		32.390974856200445,
-		5.8531952112628600,
-		0.19523741936234277,
-		-.0024346033004411264
-	};
-	static /* const */ double	coeff_b[] =
-	{
-		33.058618473992416,
-		69.675291059524653,
-		49.004348218216250,
-		12.975578862709239,
-		1.0
+		 9.9999997977e-01,
+		-3.3332423451e-01,
+		 1.9935727215e-01,
+		-1.2813336301e-01,
 	};
 	int	recip;
+	char	sixth;
 	extern double	eval_poly(), fabs();
-	double		val, val_squared;
+	double		val;
 
 	if((val = fabs(f)) == 0.0)
 		return 0.0;
 	if(recip = (val > 1.0))
 		val = 1.0/val;
-	val_squared = val * val;
-	val *= eval_poly(val_squared, coeff_a, 5)/eval_poly(val_squared, coeff_b, 4);
+	/* atan(x) is pi/6 + atan((x*sqrt(3) - 1)/(x + sqrt(3))) */
+	if(sixth = (val > TAN_PI_12))
+		val = (val * SQRT3 - 1.0)/(val + SQRT3);
+	val *= eval_poly(val * val, coeff, 3);
+	if(sixth)
+		val += SIXTH_PI;
 	if(recip)
 		val = HALF_PI - val;
 	return f < 0.0 ? -val : val;
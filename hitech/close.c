@@ -52,6 +52,11 @@ int close(uchar fd)
     if (fd >= MAXFILE)
         return -1;
     fc = &_fcb[fd];
+    if (fc->host)   /* The host file already has its exact size */
+    {
+        fc->use = 0;
+        return _zxclose(fc);
+    }
     luid = getuid();
     setuid(fc->uid);
     if (fc->use == U_WRITE || fc->use == U_RDWR
@@ -1,16 +1,23 @@
 #include	<math.h>
 
-#define	PI	3.14159265358979
-#define	TWO_PI	6.28318530717958
-#define	HALF_PI	1.570796326794895
+extern int	_trigred();
+extern double	_sinr(), _cosr();
 
 double
 cos(f)
 double	f;
 {
+	double	r;
+
 	/* cos is pi/2 out of phase with sin, so ... */
 
-	if(f > PI)
-		return sin(f - (PI+HALF_PI));
-	return sin(f + HALF_PI);
+	switch(_trigred(f, &r)) {
+	case 0:
+		return _cosr(r);
+	case 1:
+		return -_sinr(r);
+	case 2:
+		return -_cosr(r);
+	}
+	return _sinr(r);
 }
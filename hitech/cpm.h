@@ -42,6 +42,7 @@ extern struct	fcb
     uchar	use;		/* 42: use flag */
     uchar	uid;		/* 43: user id belonging to this file */
     long	fsize;		/* 44: file length in bytes */
+    uchar	host;		/* 48: zxcc host file handle + 1, or 0 */
 }  _fcb[MAXFILE];
 
 extern short	   bdos(int, ...);
@@ -52,6 +53,7 @@ extern char *      fcbname(short i);
 extern short	   getuid(void);
 extern short	   setuid(short);
 extern uchar	   setfcb(struct fcb *, char *);
+extern uchar	   _msect(ushort);
 extern char	*  (*_passwd)(struct fcb *);
 extern short	   bios(short fn, ...);
 #define bios3 bios
@@ -68,6 +70,34 @@ extern short	   bios(short fn, ...);
 #define U_RSX   8               /* PIPEMGR RSX */
 #define U_ERR   9               /* PIPEMGR stderr channel */
 
+/*   zxcc's host file calls, used instead of FCBs when the start-up
+     code finds them (_zxhost is then set).  See zxhost.h in zxcc. */
+
+#define ZXHPROBE 0xD0		/* returns ZXHMAGIC */
+#define ZXHOPEN	 0xD1
+#define ZXHCLOSE 0xD2
+#define ZXHREAD	 0xD3
+#define ZXHWRITE 0xD4
+#define ZXHSIZE	 0xD5
+#define ZXHMAGIC 0x5A58
+
+#define ZXHCREAT 0x10		/* open mode: create or truncate */
+
+struct zxhpb
+{
+    uchar	handle;
+    uchar	mode;		/* 0 read, 1 write, 2 both, + ZXHCREAT */
+    char *	addr;		/* file name, or data */
+    ushort	count;		/* bytes to move, and moved */
+    long	pos;		/* file position, or size */
+};
+
+extern char	_zxhost;
+extern int	_zxopen(struct fcb *, char *, uchar);
+extern int	_zxio(struct fcb *, uchar, char *, ushort);
+extern int	_zxclose(struct fcb *);
+extern long	_zxsize(struct fcb *);
+
 /*	special character values */
 
 #define	CPMETX	032		/* ctrl-Z, CP/M end of file for text */
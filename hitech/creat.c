@@ -15,6 +15,11 @@ int creat(char *name)
     {
         if (unlink(name) == -1 && errno > 16)
             return -1;
+        if (_zxhost && !_zxopen(fc, name, U_WRITE - 1 + ZXHCREAT))
+        {
+            fc->use = U_WRITE;
+            return fc - _fcb;
+        }
         setuid(fc->uid);
         if ((bdos(CPMMAKE, fc) & 0xFF) == 0xFF)
         {
@@ -1,16 +1,39 @@
 #include	<stdlib.h>
 #include	"huff.h"
 
+/*
+ *	Codes are looked up 8 bits at a time in htab, built from the tree
+ *	once it has been read. An entry for a code of 8 bits or less holds
+ *	its character and length; one for the first 8 bits of a longer
+ *	code holds the node they lead to, and the rest of the code is
+ *	followed down the tree a bit at a time. Bits come out of the file
+ *	least significant first and are kept in bitbuf, a byte or so
+ *	ahead of the decoder.
+ */
+
+#define	TBITS	8
+#define	TSIZE	(1<<TBITS)
+
+typedef struct {
+	uchar		t_len;		/* code length, if a leaf */
+	uchar		t_c;		/* its character */
+	node *		t_node;		/* else where TBITS bits lead */
+}	tent;
+
 char	cl[ALFSIZ];
 short	alfused;
 static	short	clidx;
-static	short	g_bit;
-static	short	g_char;
+static	unsigned	bitbuf;		/* bits not yet used, next in bit 0 */
+static	uchar	nbits;		/* how many there are */
+static	uchar	nfake;		/* how many of those are past EOF */
+static	tent	htab[TSIZE];
 node *	root;
 
 void   bld_tree(void);
 node * get_tree(void);
+void   bld_tab(node *, uchar, unsigned);
 void   align(void);
+void   fill(void);
 int    get_bit(void);
 int    gethch(void);
 extern void error(char *fmt, ...);
@@ -23,6 +46,7 @@ void bld_tree(void) {
 	align();
 	clidx = 0;
 	root = get_tree();
+	bld_tab(root, 0, 0);
 }
 
 node * get_tree(void) {
@@ -38,24 +62,81 @@ node * get_tree(void) {
 	return tp;
 }
 
+/*
+ *	Fill in the table entries for every TBITS bit pattern that starts
+ *	with the len bits of code, which lead from the root to tp
+ */
+void bld_tab(register node * tp, uchar len, unsigned code) {
+	register tent *	ep;
+
+	if(tp->n_left && len < TBITS) {
+		bld_tab(tp->n_left, len+1, code | (1 << len));
+		bld_tab(tp->n_right, len+1, code);
+		return;
+	}
+	for(ep = &htab[code] ; ep < &htab[TSIZE] ; ep += 1 << len)
+		if(tp->n_left)
+			ep->t_node = tp;
+		else {
+			ep->t_len = len;
+			ep->t_c = tp->n_c;
+		}
+}
+
 void align(void) {
-	g_char = 0;
-	g_bit = CHAR_BIT;
+	bitbuf = 0;
+	nbits = 0;
+	nfake = 0;
+}
+
+/*
+ *	Make sure there are at least TBITS bits in bitbuf. Reading past
+ *	the end of the file is only an error if those bits get used.
+ */
+void fill(void) {
+	int	c;
+
+	while(nbits < TBITS) {
+		if((c = getchar()) == EOF) {
+			c = 0;
+			nfake += CHAR_BIT;
+		}
+		bitbuf |= (unsigned)c << nbits;
+		nbits += CHAR_BIT;
+	}
 }
 
 int get_bit(void) {
-	if(g_bit == CHAR_BIT)
-		if((g_char = getchar()) == EOF)
-			error("Read error or EOF on huf file");
-		else
-			g_bit = 0;
-	return g_char & (1 << g_bit++);
+	int	b;
+
+	if(nbits == 0)
+		fill();
+	if(nbits == nfake)
+		error("Read error or EOF on huf file");
+	b = bitbuf & 1;
+	bitbuf >>= 1;
+	nbits--;
+	return b;
 }
 
 int gethch(void) {
 	register node *	tp;
+	register tent *	ep;
 
-	tp = root;
+	if(nbits < TBITS)
+		fill();
+	ep = &htab[bitbuf & (TSIZE-1)];
+	if(!(tp = ep->t_node)) {
+		if(nbits - ep->t_len < nfake)
+			error("Read error or EOF on huf file");
+		bitbuf >>= ep->t_len;
+		nbits -= ep->t_len;
+		return ep->t_c;
+	}
+	if(nbits - TBITS < nfake)
+		error("Read error or EOF on huf file");
+	bitbuf >>= TBITS;
+	nbits -= TBITS;
 	while(tp->n_left)
 		tp = get_bit() ? tp->n_left : tp->n_right;
 	return tp->n_c & 0xFF;
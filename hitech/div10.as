@@ -0,0 +1,69 @@
+;	int _div10(unsigned long *lp)
+
+;	Divides *lp by 10 in place and returns the remainder, for _pnum().
+;	Shift and subtract a bit at a time, taking only 16 steps when the
+;	top half of the number is zero.
+
+	psect	text
+	global	__div10
+
+__div10:
+	pop	bc		;return address
+	pop	hl		;lp
+	push	hl
+	push	bc
+	push	hl		;keep lp for the quotient
+	ld	e,(hl)
+	inc	hl
+	ld	d,(hl)
+	inc	hl
+	ld	c,(hl)
+	inc	hl
+	ld	b,(hl)
+	ex	de,hl		;the number is in bchl
+	xor	a		;remainder so far
+	ld	d,a
+	ld	a,b
+	or	c
+	ld	a,d
+	jr	z,3f
+	ld	d,32
+1:
+	add	hl,hl		;shift a bit of the number into a
+	rl	c
+	rl	b
+	rla
+	cp	10
+	jr	c,2f
+	sub	10		;and a quotient bit into the bottom
+	inc	l
+2:
+	dec	d
+	jr	nz,1b
+	jr	5f
+
+3:
+	ld	d,16
+4:
+	add	hl,hl
+	rla
+	cp	10
+	jr	c,6f
+	sub	10
+	inc	l
+6:
+	dec	d
+	jr	nz,4b
+5:
+	ex	de,hl
+	pop	hl
+	ld	(hl),e
+	inc	hl
+	ld	(hl),d
+	inc	hl
+	ld	(hl),c
+	inc	hl
+	ld	(hl),b
+	ld	l,a		;return the remainder
+	ld	h,0
+	ret
@@ -9,16 +9,49 @@
 
 extern int	atoi(char *);
 extern int	_pnum();
+extern int	_putn();
 
 static uchar	ival;
 static char *	x;
 static FILE *	ffile;
 
+/* Output is gathered in obuf and handed to _putn() in blocks */
+
+#define	OBSIZ	64
+
+static char	obuf[OBSIZ];
+static char *	op;
+
+static
+pflush()
+{
+	_putn(obuf, op - obuf, ffile);
+	op = obuf;
+}
+
 static
 pputc(c)
 char	c;
 {
-	putc(c, ffile);
+	if(op == &obuf[OBSIZ])
+		pflush();
+	*op++ = c;
+}
+
+static
+pputs(s, n)
+char *		s;
+unsigned	n;
+{
+	if(n > &obuf[OBSIZ] - op) {
+		pflush();
+		if(n > OBSIZ) {
+			_putn(s, n, ffile);
+			return;
+		}
+	}
+	memcpy(op, s, n);
+	op += n;
 }
 
 static char *
@@ -43,10 +76,14 @@ int *		a;
 	unsigned	len;
 
 	ffile = file;
+	op = obuf;
 	while(c = *f++)
-		if(c != '%')
-			pputc(c);
-		else {
+		if(c != '%') {
+			x = f - 1;
+			while(*f && *f != '%')
+				f++;
+			pputs(x, f - x);
+		} else {
 			base = 10;
 			width = 0;
 			sign = 0;
@@ -81,6 +118,7 @@ int *		a;
 			switch(c = *f++) {
 
 			case 0:
+				pflush();
 				return;
 			case 'o':
 			case 'O':
@@ -112,8 +150,7 @@ dostring:
 				if(!left)
 					while(width--)
 						pputc(' ');
-				while(i--)
-					pputc(*x++);
+				pputs(x, i);
 				if(left)
 					while(width--)
 						pputc(' ');
@@ -139,4 +176,5 @@ dostring:
 			while(left-- > width)
 				pputc(' ');
 		}
+	pflush();
 }
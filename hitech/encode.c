@@ -218,20 +218,31 @@ void put_bit(int i) {
 }
 
 /*
- *
+ *	The code bits are stored least significant first, the same order
+ *	they go out in, so a code is put a byte at a time: shifted up past
+ *	the bits already in p_char, with the top of it left over for the
+ *	next output byte.
  */
 void puthch(uchar c) {
-	h_char	tch;
-	short	i;
-
-	tch = clist[c].c_bits;
-	for(i = 0 ; i < tch.h_nbits ; i++) {
-		if(TST(tch.h_cbits, i))
-			p_char |= 1 << p_bit;
-		if(++p_bit == CHAR_BIT) {
+	register h_char *	tp;
+	register uchar *	bp;
+	uchar			n;
+	unsigned		w;
+
+	tp = &clist[c].c_bits;
+	bp = tp->h_cbits;
+	for(n = tp->h_nbits ; n >= CHAR_BIT ; n -= CHAR_BIT) {
+		w = (unsigned)*bp++ << p_bit;
+		putchar(p_char | (uchar)w);
+		p_char = w >> CHAR_BIT;
+	}
+	if(n) {
+		w = (unsigned)(*bp & ((1 << n) - 1)) << p_bit;
+		p_char |= w;
+		if((p_bit += n) >= CHAR_BIT) {
 			putchar(p_char);
-			p_char = 0;
-			p_bit = 0;
+			p_char = w >> CHAR_BIT;
+			p_bit -= CHAR_BIT;
 		}
 	}
 }
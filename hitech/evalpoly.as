@@ -0,0 +1,52 @@
+;	double eval_poly(x, d, n)
+;	double	x;
+;	double *d;
+;	int	n;
+
+;	Returns d[0] + d[1]*x + ... + d[n]*x^n, worked out by Horner's
+;	rule from d[n] down, calling the floating point routines directly.
+
+	psect	text
+	global	_eval_poly, flmul, fladd, csv, cret
+
+_eval_poly:
+	call	csv
+	ld	l,(ix+12)	;n
+	ld	h,(ix+13)
+	add	hl,hl
+	add	hl,hl
+	ld	e,(ix+10)	;d
+	ld	d,(ix+11)
+	add	hl,de
+	push	hl
+	pop	iy		;iy points to d[n]
+	ld	e,(iy+0)
+	ld	d,(iy+1)
+	ld	l,(iy+2)
+	ld	h,(iy+3)
+1:
+	ld	a,(ix+12)	;done all the terms?
+	or	(ix+13)
+	jp	z,cret
+	ld	c,(ix+12)
+	ld	b,(ix+13)
+	dec	bc
+	ld	(ix+12),c
+	ld	(ix+13),b
+	ld	c,(ix+8)	;multiply by x
+	ld	b,(ix+9)
+	push	bc
+	ld	c,(ix+6)
+	ld	b,(ix+7)
+	push	bc
+	call	flmul
+	ld	bc,-4		;and add the next coefficient down
+	add	iy,bc
+	ld	c,(iy+2)
+	ld	b,(iy+3)
+	push	bc
+	ld	c,(iy+0)
+	ld	b,(iy+1)
+	push	bc
+	call	fladd
+	jr	1b
@@ -1,39 +1,38 @@
 #include	<math.h>
 
+#define	LN2_HI	45426.0		/* ln(2) to 16 bits, times 2^16 */
+#define	LN2_LO	1.4286068203e-6
+
 extern double	eval_poly();
 double
 exp(x)
 double x;
 {
-	int	exp;
-	char	sign;
+	double	t;
+	int	n;
 
+	/* minimax fit to e^x on [-ln(2)/2, ln(2)/2] */
 	/* const */ static double coeff[] =
 	{
-		1.0000000000e+00,
-		6.9314718056e-01,
-		2.4022650695e-01,
-		5.5504108945e-02,
-		9.6181261779e-03,
-		1.3333710529e-03,
-		1.5399104432e-04,
-		1.5327675257e-05,
-		1.2485143336e-06,
-		1.3908092221e-07,
+		1.0000000006e+00,
+		1.0000000363e+00,
+		4.9999992080e-01,
+		1.6666420170e-01,
+		4.1668225567e-02,
+		8.3748157982e-03,
+		1.3836846130e-03,
 	};
 
-	if(x == 0.0)
-		return 1.0;
-	sign = x < 0.0;
-	if(sign)
-		x = -x;
-	x *= 1.4426950409;		/* convert to log2 */
-	exp = (int)floor(x);
-	x -= (double)exp;
-	x = ldexp(eval_poly(x, coeff, sizeof coeff/sizeof coeff[0] - 1), exp);
-	if(sign)
-		return 1.0/x;
-	return x;
+	/* x = n*ln(2) + r, with r no bigger than ln(2)/2 either way */
+	t = x * 1.4426950409;
+	n = (int)t;			/* ftol rounds to nearest */
+	/* two statements, or the compiler adds the two parts of n*ln(2)
+	 * together first and loses the low bits */
+	if(n) {
+		x -= ldexp(n * LN2_HI, -16);
+		x -= n * LN2_LO;
+	}
+	return ldexp(eval_poly(x, coeff, sizeof coeff/sizeof coeff[0] - 1), n);
 }
 
 double
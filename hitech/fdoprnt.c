@@ -11,12 +11,46 @@ static char *	x;
 static FILE *	ffile;
 extern int	atoi(char *);
 extern int	strlen(char *);
+extern void *	memcpy(void *, void *, unsigned);
+extern int	_putn();
+
+/* Output is gathered in obuf and handed to _putn() in blocks */
+
+#define	OBSIZ	64
+
+static char	obuf[OBSIZ];
+static char *	op;
+
+static
+pflush()
+{
+	_putn(obuf, op - obuf, ffile);
+	op = obuf;
+}
 
 static
 pputc(c)
 int	c;
 {
-	putc(c, ffile);
+	if(op == &obuf[OBSIZ])
+		pflush();
+	*op++ = c;
+}
+
+static
+pputs(s, n)
+char *		s;
+unsigned	n;
+{
+	if(n > &obuf[OBSIZ] - op) {
+		pflush();
+		if(n > OBSIZ) {
+			_putn(s, n, ffile);
+			return;
+		}
+	}
+	memcpy(op, s, n);
+	op += n;
 }
 
 static char *
@@ -42,10 +76,14 @@ int *		a;
 	extern	short _pnum(), _fnum();
 
 	ffile = file;
+	op = obuf;
 	while(c = *f++)
-		if(c != '%')
-			pputc(c);
-		else {
+		if(c != '%') {
+			x = f - 1;
+			while(*f && *f != '%')
+				f++;
+			pputs(x, f - x);
+		} else {
 			base = 10;
 			width = 0;
 			sign = 0;
@@ -81,6 +119,7 @@ int *		a;
 			switch(c = *f++) {
 
 			case 0:
+				pflush();
 				return;
 			case 'o':
 			case 'O':
@@ -114,8 +153,7 @@ dostring:
 				if(!left)
 					while(width--)
 						pputc(' ');
-				while(i--)
-					pputc(*x++);
+				pputs(x, i);
 				if(left)
 					while(width--)
 						pputc(' ');
@@ -164,4 +202,5 @@ dostring:
 			while(left-- > width)
 				pputc(' ');
 		}
+	pflush();
 }
@@ -47,6 +47,7 @@ struct fcb *getfcb()
         {
             fp->use = U_READ;
             fp->rwp = 0;
+            fp->host = 0;
             return fp;
         }
     return (struct fcb *)0;
@@ -191,6 +191,18 @@ negif:	;called with high word in HL, low word in HL'
 ;	selected
 
 divide:
+	ld	a,d			;a divisor of 16 bits or less
+	or	e			;can be done a byte at a time
+	jr	nz,ldivide
+	exx
+	ld	a,d
+	or	e
+	exx
+	jp	nz,sdivide
+
+;	the divisor is more than 16 bits, or zero
+
+ldivide:
 	ld	bc,0			;initialize quotient
 	ld	a,e			;check for zero divisor
 	or	d
@@ -268,3 +280,75 @@ divide:
 	dec	a			;decrement loop count
 	jr	nz,3b
 	ret				;finished
+;	Divide by a 16 bit divisor. The dividend goes on the stack, and is
+;	divided a byte at a time, most significant first, into a 16 bit
+;	remainder, each byte being replaced by that byte of the quotient.
+;	Leading zero bytes, which leave the quotient and remainder at zero,
+;	are skipped.
+
+sdivide:
+	push	hl			;high word of dividend
+	exx
+	push	hl			;low word
+	push	de			;divisor
+	exx
+	pop	de			;divisor in de
+	exx
+	ld	hl,3
+	add	hl,sp			;hl' points to the top byte
+	exx
+	ld	hl,0			;remainder
+	ld	c,4			;byte count
+1:
+	exx
+	ld	a,(hl)
+	exx
+	or	a
+	jr	nz,2f
+	exx
+	dec	hl
+	exx
+	dec	c
+	jr	nz,1b
+	jr	7f			;dividend is zero
+2:
+	exx
+	ld	a,(hl)			;next byte of dividend
+	exx
+	ld	b,8
+
+;	each step shifts a bit of the dividend out of a into the remainder,
+;	and the complement of a quotient bit into a from the carry
+
+3:
+	rla
+	adc	hl,hl
+	jr	c,5f			;17 bits: divisor must go
+	sbc	hl,de
+	jr	nc,4f
+	add	hl,de			;didn't go - restore, setting carry
+4:
+	djnz	3b
+	rla
+	cpl
+	exx
+	ld	(hl),a			;byte of quotient
+	dec	hl
+	exx
+	dec	c
+	jr	nz,2b
+7:
+	push	hl			;remainder
+	exx
+	pop	hl
+	pop	bc			;low word of quotient
+	exx
+	pop	bc			;high word
+	ld	hl,0			;high word of remainder
+	ret
+5:
+	ccf
+	sbc	hl,de			;always goes, and leaves under 16 bits
+	scf
+	ccf
+	jr	4b
@@ -5,16 +5,31 @@
 	psect	text
 
 llrsh:
-	ld	a,b		;check for zero shift
-	or	a
-	ret	z
-	cp	33
-	jr	c,1f		;limit shift to 32 bits
-	ld	b,32
+	ld	a,b
+	cp	32		;limit shift to 32 bits
+	jr	nc,4f
 1:
+	cp	8		;whole bytes first
+	jr	c,2f
+	ld	e,d
+	ld	d,l
+	ld	l,h
+	ld	h,0
+	sub	8
+	jr	1b
+2:
+	or	a		;check for zero shift
+	ret	z
+	ld	b,a
+3:
 	srl	h
 	rr	l
 	rr	d
 	rr	e
-	djnz	1b
+	djnz	3b
+	ret
+4:
+	ld	hl,0
+	ld	d,h
+	ld	e,l
 	ret
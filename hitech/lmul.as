@@ -3,6 +3,11 @@
 ;	Called with 1st arg in HLDE, 2nd arg on stack. Returns with
 ;	result in HLDE, other argument removed from stack
 
+;	The low word of the product is the low word of low*low; its high
+;	word is the high word of low*low plus the low words of the two
+;	cross products, which need no multiplying when a high word is 0
+;	or -1.
+
 	global	almul, llmul
 
 	psect	text
@@ -16,42 +21,89 @@ llmul:
 	exx
 	pop	bc		;hi word of multiplier
 	push	hl		;restore return address
-	ld	hl,0		;initialize product
-	exx			;get lo words back
-	ld	hl,0
-	ld	a,c
-	ld	c,b
-	call	mult8b
-	ld	a,c
-	call	mult8b
-	exx
-	ld	a,c
-	exx
-	call	mult8b
-	exx
 	ld	a,b
+	or	c
+	or	d
+	or	e
+	jr	nz,1f
+	exx			;both hi words zero: just low * low
+	call	mult16
+	ex	de,hl
+	ret
+1:
+	push	bc
 	exx
-	call	mult8b
-	push	hl		;low word
+	push	de
+	push	bc
 	exx
+	pop	bc		;low word of multiplier
+	call	xmul		;hi * low
+	pop	bc		;low word of multiplicand
+	pop	de		;hi word of multiplier
+	push	hl
+	call	xmul		;low * hi
 	pop	de
+	add	hl,de
+	push	hl		;sum of the cross products
+	exx			;low words
+	call	mult16
+	ex	(sp),hl		;low word of the product on the stack
+	add	hl,de		;add the cross products to the hi word
+	pop	de
+	ret
+
+;	Low word of DE * BC in HL
+
+xmul:
+	ld	a,d
+	or	e
+	jr	z,1f		;times 0
+	ld	a,d
+	and	e
+	inc	a
+	jr	nz,mult16
+	ld	h,a		;times -1
+	ld	l,a
+	sbc	hl,bc		;carry is clear after the and
+	ret
+1:
+	ld	h,a
+	ld	l,a
 	ret
 
-mult8b:	ld	b,8
+;	Multiply DE by BC, returning the product in DEHL. Works down the
+;	bits of whichever has a zero hi byte, if either does, so that a
+;	small multiplier takes 8 steps rather than 16.
+
+mult16:
+	ld	hl,0
+	ld	a,d
+	or	a
+	jr	z,1f
+	ld	a,b
+	or	a
+	ld	a,16
+	jr	nz,3f
+	ld	h,d		;swap them over
+	ld	l,e
+	ld	d,b
+	ld	e,c
+	ld	b,h
+	ld	c,l
+	ld	hl,0
+1:
+	ld	d,e		;skip the zero hi byte
+	ld	e,h
+	ld	a,8
 3:
-	srl	a
-	jp	nc,1f
-	add	hl,de
-	exx
-	adc	hl,de
-	exx
-1:	ex	de,hl
 	add	hl,hl
-	ex	de,hl
-	exx
-	ex	de,hl
-	adc	hl,hl
-	ex	de,hl
-	exx
-	djnz	3b
+	rl	e
+	rl	d
+	jr	nc,4f
+	add	hl,bc
+	jr	nc,4f
+	inc	de
+4:
+	dec	a
+	jr	nz,3b
 	ret
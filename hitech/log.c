@@ -1,33 +1,44 @@
 #include	<math.h>
 
+#define	SQRT_HALF	0.70710678119
+#define	LN2_HI		45426.0		/* ln(2) to 16 bits, times 2^16 */
+#define	LN2_LO		1.4286068203e-6
+
 extern double	eval_poly();
 double
 log(x)
 double	x;
 {
 	int	exp;
+	double	s;
 
+	/* minimax fit to log((1+s)/(1-s))/s as a polynomial in s*s,
+	 * for s between +-(sqrt(2)-1)/(sqrt(2)+1) */
 	static /* const */ double coeff[] =
 	{
-		 0.0000000000,	/* a0 */
-		 0.9999964239,	/* a1 */
-		-0.4998741238,	/* a2 */
-		 0.3317990258,	/* a3 */
-		-0.2407338084,	/* a4 */
-		 0.1676540711,	/* a5 */
-		-0.0953293897,	/* a6 */
-		 0.0360884937,	/* a7 */
-		-0.0064535442,	/* a8 */
+		 1.9999999986,
+		 0.66666815951,
+		 0.39974794925,
+		 0.29925650681,
 	};
 
 	/* zero or -ve arguments are not defined */
 
 	if(x <= 0.0)
 		return 0.0;
-	x = frexp(x, &exp) * 2.0 - 1.0;
-	exp--;
-	x = eval_poly(x, coeff, sizeof coeff/sizeof coeff[0] - 1);
-	return x + 0.69314718055995 * exp;
+	x = frexp(x, &exp);
+	if(x < SQRT_HALF) {
+		x = ldexp(x, 1);
+		exp--;
+	}
+	/* x is now within sqrt(2) either way of 1 */
+	s = (x - 1.0) / (x + 1.0);
+	x = s * eval_poly(s * s, coeff, sizeof coeff/sizeof coeff[0] - 1);
+	if(exp) {
+		x += exp * LN2_LO;
+		x += ldexp(exp * LN2_HI, -16);
+	}
+	return x;
 }
 
 double
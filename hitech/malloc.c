@@ -1,172 +1,262 @@
-#ifdef debug
-#define ASSERT(p) if(!(p))botch("p");else
-botch(s)
-char *s;
-{
-	printf("assertion botched: %s\n",s);
-	abort();
-}
-#else
-#define ASSERT(p)
-#endif
-
 /*	C storage allocator for Z80 and other 8 bit machines
- *	circular first-fit strategy
- *	works with noncontiguous, but monotonically linked, arena
- *	each block is preceded by a ptr to the (pointer of) 
- *	the next following block and a busy flag
- *	bit in flag is 1 for busy, 0 for idle
- *	gaps in arena are merely noted as busy blocks
- *	last block of arena (pointed to by alloct) is empty and
- *	has a pointer to first
- *	idle blocks are coalesced during space search
+ *	segregated free lists with boundary tags
+ *
+ *	each block is preceded by a word holding its size (a multiple
+ *	of 4, header included) and two flags: BUSY if the block is in
+ *	use, PBUSY if the block before it is. A free block also has its
+ *	size in its last word, so that free() can find the start of a
+ *	free block just before the one it is given, and coalesce both
+ *	neighbours at once without any search.
+ *
+ *	free blocks are kept on doubly linked lists, one for each small
+ *	size (8 to 36 bytes) and one for each power of 2 above that.
+ *	malloc() takes a block from the list for its size if it can.
+ *	Otherwise it carves one off the front of dv, a free block kept on
+ *	no list for the purpose, or else takes the first block big enough
+ *	on the lists of bigger ones; what is left over becomes dv if it is
+ *	bigger than the old one. Blocks freed next to dv join it.
  *
-*/
-#define	BLOCK	(85*sizeof(struct store))	/* 255 bytes */
-#define BUSY 1
-#define NULL 0
-#define	testbusy(p)	((p).flag & BUSY)
-#define	sbusy(p)	(p).flag |= BUSY
-#define	cbusy(p)	(p).flag &= ~BUSY
+ *	the arena grows with sbrk(). Each piece ends in a busy block of
+ *	size 0, so coalescing stops there; a piece that carries on where
+ *	the last one stopped starts at that marker instead.
+ */
+#include <stdlib.h>
+
+#define	BUSY	1
+#define	PBUSY	2
+#define	FLAGS	(BUSY|PBUSY)
+#define	HDR	sizeof(unsigned short)
+#define	MINBLK	8			/* room for size, links and tag */
+#define	NSMALL	8			/* lists for 8, 12, ... 36 bytes */
+#define	NLISTS	(NSMALL+8)		/* and 40-63, 64-127, ... 4K- */
+#define	BLOCK	256			/* sbrk() in pieces this big */
 
 struct store
 {
-	struct store *	ptr;
-	char		flag;
+	unsigned short	size;
+	struct store *	next;		/* free blocks only */
+	struct store *	prev;
 };
 
-static struct store	allocs[2];	/*initial arena*/
-static struct store *	allocp;		/*search ptr*/
-static struct store *	alloct;		/*arena top*/
-static struct store	allocx;		/* for realloc */
-char *			sbrk();
+#define	SIZE(p)		((p)->size & ~FLAGS)
+#define	NEXT(p)		((struct store *)((char *)(p) + SIZE(p)))
+#define	TAG(p)		(((unsigned short *)NEXT(p))[-1])
+#define	SETFREE(p, n)	((p)->size = (n) | PBUSY, TAG(p) = (n))
+#define	LISTOF(n)	((n) <= (NSMALL+1)*4 ? ((unsigned char)(n) >> 2) - 2 : listof(n))
+
+/*	each list is circular, with a head in heads[], so that a block can
+ *	be taken off it without knowing which one it is on. Only the links
+ *	of a head are used, so the heads overlap: the size word of each is
+ *	the prev link of the one before. used[] is set when a block is put
+ *	on a list and cleared when malloc() finds it empty again; the entry
+ *	past the end stops malloc()'s search for a list with something on it
+ */
+static struct store *	heads[2*NLISTS+1];
+static char		used[NLISTS+1] = { 0, 0, 0, 0, 0, 0, 0, 0,
+					   0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static struct store *	dv;		/* being carved up; on no list */
+static char *		top;		/* end of the last piece of arena */
+extern char *		sbrk();
+extern void		bmove(void *, void *, unsigned);
+
+#define	HEAD(l)		((struct store *)&heads[2*(l)])
 
-char *
-malloc(nw)
-unsigned nw;
+static unsigned char
+listof(unsigned short size)
 {
-	register struct store *p, *q;
-	static unsigned temp;	/*coroutines assume no auto*/
-
-	if(allocs[0].ptr==(struct store *)0) {	/*first time*/
-		alloct = allocs[0].ptr = &allocs[1];
-		allocp = allocs[1].ptr = &allocs[0];
-		sbusy(allocs[0]);
-		sbusy(allocs[1]);
+	unsigned char	l, hi;
+
+	if(!(hi = ((unsigned char *)&size)[1]))	/* size >> 8, without a loop */
+		return size < 64 ? NSMALL : size < 128 ? NSMALL+1 : NSMALL+2;
+	for(l = NSMALL+3 ; hi >>= 1 ; )
+		if(++l == NLISTS-1)
+			break;
+	return l;
+}
+
+#define	unlist(p)	((p)->prev->next = (p)->next, (p)->next->prev = (p)->prev)
+
+/*	put a free block on its list. The block before it is always busy,
+ *	or the two would have been coalesced
+ */
+static void
+enlist(register struct store *p, unsigned short size)
+{
+	register struct store *	h;
+	unsigned char		l;
+
+	SETFREE(p, size);
+	used[l = LISTOF(size)] = 1;
+	h = HEAD(l);
+	p->next = h->next;
+	p->prev = h;
+	h->next->prev = p;
+	h->next = p;
+}
+
+/*	add size bytes (at least) to the arena
+ */
+static int
+grow(unsigned short size)
+{
+	register struct store *	p;
+	char *			cp;
+	unsigned short		n;
+
+	if(!top)
+		for(n = 0 ; n < NLISTS ; n++)
+			HEAD(n)->next = HEAD(n)->prev = HEAD(n);
+	n = (size + 2*HDR + BLOCK-1) & ~(BLOCK-1);
+	if(n < size || (int)(cp = sbrk(n)) == -1) {
+		n = (size + 2*HDR + 3) & ~3;	/* just what is needed */
+		if(n < size || (int)(cp = sbrk(n)) == -1)
+			return 0;
 	}
-	nw = ((nw - 1 + sizeof(struct store)*2)/sizeof(struct store)) * sizeof(struct store);
-	ASSERT(allocp>=allocs && allocp<=alloct);
-	ASSERT(allock());
-	for(p=allocp; ; ) {
-		for(temp=0; ; ) {
-			if(!testbusy(*p)) {
-				while(!testbusy(*(q=p->ptr))) {
-					ASSERT(q>p&&q<alloct);
-					p->ptr = q->ptr;
-				}
-				if(q>=(struct store *)((char *)p+nw) && (struct store *)((char *)p+nw)>=p)
-					goto found;
-			}
-			q = p;
-			p = p->ptr;
-			if(p>q)
-				ASSERT(p<=alloct);
-			else if(q!=alloct || p!=allocs) {
-				ASSERT(q==alloct&&p==allocs);
-				return(NULL);
-			} else if(++temp>1)
-				break;
-		}
-		temp = ((nw+sizeof(struct store)-1+BLOCK)/BLOCK)*BLOCK;
-		q = (struct store *)sbrk(0);
-		if((struct store *)((char *)q+temp) < q) {
-			return(NULL);
+	if(cp == top) {		/* carry on from the old end marker */
+		p = (struct store *)(cp - HDR);
+		p->size = n | BUSY | (p->size & PBUSY);
+	} else {		/* skip a word to keep sizes in fours */
+		p = (struct store *)(cp + HDR);
+		p->size = (n - 2*HDR) | BUSY | PBUSY;
+	}
+	top = cp + n;
+	((struct store *)(top - HDR))->size = BUSY;
+	free((char *)p + HDR);
+	return 1;
+}
+
+void *
+malloc(size_t nbytes)
+{
+	register struct store *	p, * h;
+	unsigned short		size, rest;
+	char *			u;
+
+	size = (nbytes + HDR + 3) & ~3;
+	if(size < nbytes)
+		return NULL;
+	if(size < MINBLK)
+		size = MINBLK;
+	for(;;) {
+		u = &used[LISTOF(size)];
+		h = HEAD(u - used);
+		if(*u && (p = h->next) != h && SIZE(p) >= size)
+			goto found;
+		if((p = dv) && SIZE(p) >= size) {
+			dv = NULL;
+			goto split;
 		}
-		q = (struct store *)sbrk(temp);
-		if((int)q == -1) {
-			return(NULL);
+		for( ; ; u++) {
+			while(!*u)
+				u++;
+			if(u == &used[NLISTS])
+				break;
+			h = HEAD(u - used);
+			for(p = h->next ; p != h && SIZE(p) < size ; p = p->next)
+				continue;
+			if(p != h)
+				goto found;
+			if(h->next == h)
+				*u = 0;
 		}
-		ASSERT(q>alloct);
-		alloct->ptr = q;
-		if(q!=alloct+1)
-			sbusy(*alloct);
-		else
-			cbusy(*alloct);
-		alloct = q->ptr = (struct store *)((char *)q+temp-sizeof(struct store));;
-		alloct->ptr = allocs;
-		sbusy(*alloct);
-		cbusy(*q);
+		if(!grow(size))
+			return NULL;
 	}
 found:
-	allocp = (struct store *)((char *)p + nw);
-	ASSERT(allocp<=alloct);
-	if(q>allocp) {
-		allocx = *allocp;
-		allocp->ptr = p->ptr;
-		allocp->flag = 0;
+	unlist(p);
+split:
+	if((rest = SIZE(p) - size) >= MINBLK) {
+		p->size = size | BUSY | PBUSY;
+		h = NEXT(p);
+		if(dv && SIZE(dv) >= rest)
+			enlist(h, rest);
+		else {
+			if(dv)
+				enlist(dv, SIZE(dv));
+			SETFREE(h, rest);
+			dv = h;
+		}
+	} else {
+		p->size |= BUSY;
+		NEXT(p)->size |= PBUSY;
 	}
-	p->ptr = allocp;
-	sbusy(*p);
-	return((char *)(p+1));
+	return (char *)p + HDR;
 }
 
-/*	freeing strategy tuned for LIFO allocation
-*/
-free(ap)
-char *ap;
+void
+free(void *ap)
 {
-	register struct store *p;
-
-	p = ((struct store *)ap)-1;
-	ASSERT(p>allocs[1].ptr&&p<=alloct);
-	ASSERT(allock());
-	allocp = p;
-	ASSERT(testbusy(*p));
-	cbusy(*p);
-	ASSERT(p->ptr > allocp && p->ptr <= alloct);
-}
+	register struct store *	p, * q;
+	unsigned short		size;
+	char			todv;
 
-char *
-realloc(p, nbytes)
-char *		p;
-unsigned short	nbytes;
-{
-	register struct store *	xp, * q;
-	unsigned short		ons;
-	unsigned short		ns;
-
-	xp = (struct store *)p;
-	ns = (nbytes + sizeof(struct store) - 1)/sizeof(struct store);
-	ons = xp[-1].ptr - xp;
-	if(testbusy(xp[-1]))
-		free((char *)xp);
-	if(!(q = (struct store *)malloc(nbytes)) || q == xp)
-		return (char *)q;
-	ns = q[-1].ptr - q;
-	if(ons > ns)
-		ons = ns;
-	bmove((char *)xp, (char *)q, ons * sizeof(struct store));
-	if(q < xp && q+ns > xp)
-		q[q+ns-xp] = allocx;
-	return (char *)q;
+	if(!ap)
+		return;
+	p = (struct store *)((char *)ap - HDR);
+	size = SIZE(p);
+	q = NEXT(p);
+	todv = 0;
+	if(q->size & BUSY)
+		q->size &= ~PBUSY;
+	else {
+		if(q == dv)
+			todv = 1;
+		else
+			unlist(q);
+		size += SIZE(q);
+	}
+	if(!(p->size & PBUSY)) {
+		p = (struct store *)((char *)p - ((unsigned short *)p)[-1]);
+		if(p == dv)
+			todv = 1;
+		else
+			unlist(p);
+		size += SIZE(p);
+	}
+	if(todv) {
+		SETFREE(p, size);
+		dv = p;
+	} else
+		enlist(p, size);
 }
 
-
-#ifdef	debug
-showall()
+void *
+realloc(void *ap, size_t nbytes)
 {
-	struct store *p, *q;
-	int i, used = 0, free = 0;
-
-	for(p = &allocs[0] ; p && p!= alloct ; p = q) {
-		q = p->ptr;
-		printf("%4.4x %5d %s\n", p, i = (unsigned)q - (unsigned)p,
-			testbusy(*p) ? "BUSY" : "FREE");
-		if(testbusy(*p))
-			used += i;
+	register struct store *	p, * q;
+	unsigned short		size;
+	char *			np;
+
+	if(!ap)
+		return malloc(nbytes);
+	p = (struct store *)((char *)ap - HDR);
+	size = (nbytes + HDR + 3) & ~3;
+	if(size < nbytes)
+		return NULL;
+	if(size < MINBLK)
+		size = MINBLK;
+	q = NEXT(p);
+	if(SIZE(p) < size && !(q->size & BUSY)
+	   && SIZE(p) + SIZE(q) >= size) {	/* grow into the next block */
+		if(q == dv)
+			dv = NULL;
 		else
-			free += i;
+			unlist(q);
+		p->size += SIZE(q);
+		NEXT(p)->size |= PBUSY;
+	}
+	if(SIZE(p) >= size) {
+		if(SIZE(p) - size >= MINBLK) {	/* give back the end */
+			q = (struct store *)((char *)p + size);
+			q->size = (SIZE(p) - size) | BUSY | PBUSY;
+			p->size = size | (p->size & FLAGS);
+			free((char *)q + HDR);
+		}
+		return ap;
 	}
-	printf("%d used, %d free, %4.4x end\n", used, free, alloct);
+	if(!(np = malloc(nbytes)))
+		return NULL;
+	bmove(ap, np, SIZE(p) - HDR);
+	free(ap);
+	return np;
 }
-#endif
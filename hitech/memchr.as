@@ -0,0 +1,26 @@
+;	void *memchr(void *ptr, int c, size_t count)
+
+;	Returns a pointer to the first c in the count bytes at ptr, or NULL
+
+	psect	text
+	global	_memchr
+
+_memchr:
+	pop	af		;return address
+	pop	hl		;ptr
+	pop	de		;c
+	pop	bc		;count
+	push	bc		;stack is as it was
+	push	de
+	push	hl
+	push	af
+	ld	a,b
+	or	c
+	jr	z,1f
+	ld	a,e
+	cpir
+	dec	hl		;cpir has gone one past it
+	ret	z
+1:
+	ld	hl,0
+	ret
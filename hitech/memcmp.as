@@ -0,0 +1,38 @@
+;	int memcmp(void *s1, void *s2, size_t count)
+
+;	Returns -1, 0 or 1 as the first differing byte of s1 is below,
+;	equal to or above that of s2, comparing them as unsigned chars
+
+	psect	text
+	global	_memcmp
+
+_memcmp:
+	pop	af		;return address
+	pop	de		;s1
+	pop	hl		;s2
+	pop	bc		;count
+	push	bc		;stack is as it was
+	push	hl
+	push	de
+	push	af
+	ld	a,b
+	or	c
+	jr	z,2f
+1:
+	ld	a,(de)
+	inc	de
+	cpi			;compare with (hl++), count down bc
+	jr	nz,3f
+	jp	pe,1b		;more to do
+2:
+	ld	hl,0
+	ret
+
+3:
+	dec	hl		;cpi leaves the carry alone, so compare again
+	cp	(hl)
+	ld	hl,1
+	ret	nc
+	dec	hl
+	dec	hl
+	ret
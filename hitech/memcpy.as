@@ -0,0 +1,23 @@
+;	void *memcpy(void *to, void *from, size_t count)
+
+	psect	text
+	global	_memcpy
+
+_memcpy:
+	pop	af		;return address
+	pop	de		;to
+	pop	hl		;from
+	pop	bc		;count
+	push	bc		;stack is as it was
+	push	hl
+	push	de
+	push	af
+	ld	a,b
+	or	c
+	jr	z,1f
+	push	de
+	ldir
+	pop	de
+1:
+	ex	de,hl		;return to
+	ret
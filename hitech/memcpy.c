@@ -1,7 +0,0 @@
-memcpy(d, s, n)
-register char *	d, * s;
-register int	n;
-{
-	while(n--)
-		*d++ = *s++;
-}
@@ -0,0 +1,41 @@
+;	void *memmove(void *to, void *from, size_t count)
+
+;	As memcpy(), but the areas may overlap: when to is above from
+;	the copy is done from the top down
+
+	psect	text
+	global	_memmove
+
+_memmove:
+	pop	af		;return address
+	pop	de		;to
+	pop	hl		;from
+	pop	bc		;count
+	push	bc		;stack is as it was
+	push	hl
+	push	de
+	push	af
+	ld	a,b
+	or	c
+	jr	z,2f
+	push	de
+	push	hl
+	or	a
+	sbc	hl,de		;carry if from < to
+	pop	hl
+	jr	c,1f
+	ldir
+	pop	de
+	jr	2f
+1:
+	dec	bc		;point at the last byte of each
+	add	hl,bc
+	ex	de,hl
+	add	hl,bc
+	ex	de,hl
+	inc	bc
+	lddr
+	pop	de
+2:
+	ex	de,hl		;return to
+	ret
@@ -0,0 +1,32 @@
+;	void *memset(void *ptr, int fill, size_t count)
+
+;	Stores the fill byte once, then lets LDIR copy it along
+
+	psect	text
+	global	_memset
+
+_memset:
+	pop	af		;return address
+	pop	hl		;ptr
+	pop	de		;fill
+	pop	bc		;count
+	push	bc		;stack is as it was
+	push	de
+	push	hl
+	push	af
+	ld	a,b
+	or	c
+	ret	z
+	push	hl
+	ld	(hl),e
+	dec	bc
+	ld	a,b
+	or	c
+	jr	z,1f
+	ld	d,h
+	ld	e,l
+	inc	de
+	ldir
+1:
+	pop	hl		;return ptr
+	ret
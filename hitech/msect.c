@@ -0,0 +1,23 @@
+#include    "cpm.h"
+
+/* Multi-sector transfers for read() and write(). Once the multi-sector
+ * count has been set (BDOS 44), CP/M 3 and MP/M move up to 128 sectors
+ * with each random read or write; CP/M 2 only ever moves one. */
+
+static uchar    maxsec;     /* 0 until the BDOS version is known */
+
+/* Set the multi-sector count for as many whole sectors of nbytes as can
+ * go at once, and return it. If that is more than 1, the caller puts the
+ * count back to 1 after the transfer. */
+uchar _msect(ushort nbytes)
+{
+    ushort  n;
+
+    if (!maxsec)
+        maxsec = (bdos(CPMVERS)&0xFF) >= 0x30 ? 128 : 1;
+    if ((n = nbytes/SECSIZE) > maxsec)
+        n = maxsec;
+    if (n > 1)
+        bdos(CPMSMSC, n);
+    return n;
+}
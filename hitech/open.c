@@ -11,6 +11,8 @@ long _fsize(uchar fd)
     if (fd >= MAXFILE)
         return -1;
     fc = &_fcb[fd];
+    if (fc->host)
+        return _zxsize(fc);
     luid = getuid();
     setuid(fc->uid);
     bdos(CPMCFS, fc);
@@ -46,6 +48,11 @@ int open(char *name, int mode)
         return -1;
     if (!setfcb(fc, name))
    {
+        if (_zxhost && !_zxopen(fc, name, mode - 1))
+        {
+            fc->use = mode;
+            return fc - _fcb;
+        }
         if (mode == U_READ && (bdos(CPMVERS)&0x7F) >= 0x30)
             fc->name[5] |= 0x80;    /* read-only mode */
         luid = getuid();
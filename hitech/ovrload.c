@@ -1,21 +1,53 @@
 #include <overlay.h>
 #include <string.h>
 #include <unixio.h>
+#include <xmem.h>
 
 extern unsigned _ovrsize;
 extern char *_ovrstart;
 extern intptr_t _ovrbgn(intptr_t args);
 extern char ovrfilename[15]={0};
 
+/* Overlays read from disc are also kept in expanded memory, when there
+ * is room for them at the top of it, and copied back from there when
+ * they are called again. */
+#define NCACHE	4
+static struct {
+	char name[9];		/* As given to ovrload() */
+	char file[15];		/* The file it was read from */
+	unsigned size;
+} cache[NCACHE];
+static int nextslot;
+
+/* Where in expanded memory slot i is, or -1 if it won't fit */
+static long slotoff(int i)
+{
+	unsigned pages = (_ovrsize - 1) / XMPAGE + 1;
+
+	if (xmpages() < NCACHE * pages)
+		return -1;
+	return (long)(xmpages() - (i + 1) * pages) * XMPAGE;
+}
+
 /* Overlay loader for Hi-Tech C */
 intptr_t ovrload(char *name,intptr_t args)
 {
-	int fd, size;
+	int fd, size, i;
     char ovrname[9];
 	char filename[15], *p, *index();
 
     strncpy(ovrname,name,8);
     ovrname[8]=0;
+	for (i = 0; i < NCACHE; i++)
+		if (cache[i].name[0] && !strcmp(cache[i].name, ovrname)) {
+			if (strcmp(cache[i].file, ovrfilename)) {
+				ovrfilename[0] = 0;
+				if (xmget(_ovrstart, slotoff(i), cache[i].size) < 0)
+					goto error;
+				strcpy(ovrfilename, cache[i].file);
+			}
+			return _ovrbgn(args);
+		}
 	strcpy(filename,ovrname);	/* Copy the filename */
 	strcat(filename,".ovr");	/* add the extent */
 	if ((fd = open(filename, 0)) < 0)
@@ -28,14 +60,25 @@ intptr_t ovrload(char *name,intptr_t args)
         }
 	}
     if(!strcmp(filename,ovrfilename) && _ovrbgn) {
+        close(fd);
         return _ovrbgn(args);
     }
+	ovrfilename[0] = 0;		/* Until it has been read */
 	size = read(fd,_ovrstart,_ovrsize);
 	close(fd);
 	if (size < 0 || !_ovrbgn) {
 		goto error;			/* read error */
     }
     strcpy(ovrfilename,filename);
+	if (slotoff(nextslot) >= 0) {
+		cache[nextslot].name[0] = 0;
+		if (!xmput(slotoff(nextslot), _ovrstart, size)) {
+			strcpy(cache[nextslot].name, ovrname);
+			strcpy(cache[nextslot].file, filename);
+			cache[nextslot].size = size;
+			nextslot = (nextslot + 1) % NCACHE;
+		}
+	}
 	return _ovrbgn(args);		/* ok, execute the overlay */
 
 error:
@@ -4,6 +4,8 @@
 #define	NDIG	30		/* max number of digits to be printed */
 #define	putch(x)	(*pputch)(x)
 
+extern int	_div10(unsigned long *);
+
 _pnum(i, f, w, s, base, pputch)
 unsigned long	i;
 unsigned char	base;
@@ -25,10 +27,18 @@ char	f, w;
 	if(f == 0 && i == 0)
 		f++;
 
+	/* decimal by a divide made for it, octal and hex by shifting */
 	cp = &buf[NDIG];
 	while(i || f > 0) {
-		*--cp = "0123456789ABCDEF"[i%base];
-		i /= base;
+		if(base == 10)
+			*--cp = _div10(&i) + '0';
+		else if(base == 16) {
+			*--cp = "0123456789ABCDEF"[(unsigned char)i & 15];
+			i >>= 4;
+		} else {
+			*--cp = ((unsigned char)i & 7) + '0';
+			i >>= 3;
+		}
 		f--;
 	}
 	fw = f = (&buf[NDIG] - cp) + s;
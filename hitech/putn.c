@@ -0,0 +1,60 @@
+/*
+ *	_putn - write n characters to a stream, for _doprnt()
+ *
+ *	Does what n calls of putc() would, but copies each run that fits
+ *	straight into the buffer, hands an unbuffered stream a run in
+ *	one write(), and puts sprintf()'s output directly in its string.
+ *	Anything else (a newline in text mode, a full buffer, a stream not
+ *	yet written to) goes through putc() as before.
+ */
+
+#include	<stdio.h>
+#include	<string.h>
+
+extern int	write(int, void *, int);
+
+_putn(s, n, f)
+register char *	s;
+unsigned	n;
+register FILE *	f;
+{
+	unsigned	k;
+	char *		p;
+
+	if(f->_flag & _IOSTRG) {
+		memcpy(f->_ptr, s, n);
+		f->_ptr += n;
+		return;
+	}
+	while(n) {
+		if(!(f->_flag & _IODIRN)) {
+			putc(*s++, f);
+			n--;
+			continue;
+		}
+		if(f->_base == (char *)NULL)
+			k = f->_flag & _IONBF ? n : 0;
+		else if(f->_flag & _IONBF || f->_cnt <= 0)
+			k = 0;
+		else
+			k = n < f->_cnt ? n : f->_cnt;
+		if(k && !(f->_flag & _IOBINARY) && (p = memchr(s, '\n', k)))
+			k = p - s;
+		if(k == 0) {
+			putc(*s++, f);
+			n--;
+			continue;
+		}
+		if(f->_base == (char *)NULL) {
+			if(write(fileno(f), s, k) != k)
+				f->_flag |= _IOERR;
+		} else {
+			memcpy(f->_ptr, s, k);
+			f->_ptr += k;
+			f->_cnt -= k;
+		}
+		f->_flag |= _IOWROTE;
+		s += k;
+		n -= k;
+	}
+}
@@ -1,65 +1,157 @@
 /*
- *	Quicksort based on the algorithm given in
- *	"Algorithms + Data Structures = Programs" by N. Wirth.
+ *	Introsort: quicksort with the median of three as the pivot,
+ *	falling back to heapsort if it goes more than 2*log2(nel)
+ *	partitions deep, so it is never worse than n log n. Pieces of
+ *	up to CUTOFF elements are left for one pass of insertion sort
+ *	at the end. Elements are only ever exchanged, so no buffer is
+ *	needed, and 2 and 4 byte ones are exchanged a word at a time.
  */
+#include <stdlib.h>
 
-qsort(base, nel, width, compar)
-char *base; int (*compar)();
-unsigned width,nel;
+#define	CUTOFF	8
+
+static __qsort_compf	cmp;
+static size_t		wid;
+
+extern void	_swap(size_t, void *, void *);
+
+static void
+exch(char * a, char * b)
+{
+	short	t;
+	long	lt;
+
+	if(wid == 2) {
+		t = *(short *)a;
+		*(short *)a = *(short *)b;
+		*(short *)b = t;
+	} else if(wid == 4) {
+		lt = *(long *)a;
+		*(long *)a = *(long *)b;
+		*(long *)b = lt;
+	} else
+		_swap(wid, a, b);
+}
+
+/*	restore the heap property below the element at offset o in the
+ *	heap that starts at lo and ends with the element at offset e
+ */
+static void
+sift(char * lo, size_t o, size_t e)
+{
+	size_t	c, lim;
+
+	if(e < wid)
+		return;
+	lim = (e - wid) >> 1;		/* last offset with a child */
+	while(o <= lim) {
+		c = o + o + wid;
+		if(c < e && (*cmp)(lo+c, lo+c+wid) < 0)
+			c += wid;
+		if((*cmp)(lo+o, lo+c) >= 0)
+			return;
+		exch(lo+o, lo+c);
+		o = c;
+	}
+}
+
+static void
+heapsort(char * lo, char * hi)
+{
+	size_t	o, e;
+
+	e = hi - lo;
+	o = e;
+	for(;;) {
+		sift(lo, o, e);
+		if(!o)
+			break;
+		o -= wid;
+	}
+	while(e) {
+		exch(lo, lo+e);
+		e -= wid;
+		sift(lo, 0, e);
+	}
+}
+
+/*	partition the elements from lo to hi inclusive, sorting the
+ *	smaller side first and carrying on with the larger one
+ */
+static void
+sort(char * lo, char * hi, size_t small, int depth)
 {
-	register char *	x;
-	extern char *	malloc();
-	register int	i,j,l,r;
-	struct
-	{
-		int	l,r;
-	}	stack[20];
-	int	s;
-	char	xbuf[800];
+	register char *	i;
+	char *		j;
+	char *		mid;
 
-	if(width < sizeof xbuf)
-		x = xbuf;
-	else if(!(x = malloc(width+1)))
-		return;			/* can't do much */
-	x[width] = 0;
-	s = 0;
-	stack[0].l = 0;
-	stack[0].r = nel-1;
-	do {
-		/* take top request from stack */
-		l = stack[s].l;
-		r = stack[s--].r;
+	while(hi > lo && (size_t)(hi - lo) > small) {
+		if(!depth--) {
+			heapsort(lo, hi);
+			return;
+		}
+		mid = lo + ((size_t)(hi - lo) / wid >> 1) * wid;
+		if((*cmp)(mid, lo) < 0)
+			exch(mid, lo);
+		if((*cmp)(hi, mid) < 0) {
+			exch(hi, mid);
+			if((*cmp)(mid, lo) < 0)
+				exch(mid, lo);
+		}
+		/* the pivot goes to lo; what is left at hi stops the
+		 * upward scan, and the pivot itself the downward one */
+		exch(lo, mid);
+		i = lo;
+		j = hi + wid;
+		for(;;) {
+			do
+				i += wid;
+			while((*cmp)(i, lo) < 0);
+			do
+				j -= wid;
+			while((*cmp)(lo, j) < 0);
+			if(i >= j)
+				break;
+			exch(i, j);
+		}
+		exch(lo, j);
+		if((size_t)(j - lo) < (size_t)(hi - j)) {
+			sort(lo, j - wid, small, depth);
+			lo = j + wid;
+		} else {
+			sort(j + wid, hi, small, depth);
+			hi = j - wid;
+		}
+	}
+}
+
+void
+qsort(void * base, size_t nel, size_t width, __qsort_compf compar)
+{
+	register char *	p;
+	char *		q;
+	char *		end;
+	__qsort_compf	ocmp;
+	size_t		owid, n;
+	int		depth;
 
-		do {
-			i = l;
-			j = r;
-			bmove(base+width*((i+j)/2), x, width);
-			do {
-				while((*compar)(base+i*width, x) < 0)
-					i++;
-				while((*compar)(x, base+j*width) < 0)
-					j--;
-				if(i <= j) {
-					_swap(width, base+i*width, base+j*width);
-					i++;
-					j--;
-				}
-			} while(i <= j);
-			if(j-l < r-i) {
-				if(i < r) {	/* stack right partition */
-					stack[++s].l = i;
-					stack[s].r = r;
-				}
-				r = j;		/* continue with left */
-			} else {
-				if(l < j) {
-					stack[++s].l = l;
-					stack[s].r = j;
-				}
-				l = i;
-			}
-		} while(l < r);
-	} while(s >= 0);
-	if(x != xbuf)
-		free(x);
+	if(nel < 2 || !width)
+		return;
+	/* save the last ones, in case compar() calls qsort() */
+	ocmp = cmp;
+	owid = wid;
+	cmp = compar;
+	wid = width;
+	end = (char *)base + (nel-1) * width;
+	if(nel > CUTOFF) {
+		depth = 0;
+		for(n = nel ; n > 1 ; n >>= 1)
+			depth += 2;
+		sort(base, end, (CUTOFF-1) * width, depth);
+	}
+	for(p = (char *)base + width ; p <= end ; p += width)
+		for(q = p ; q > (char *)base && (*cmp)(q - width, q) > 0 ; q -= width)
+			exch(q - width, q);
+	cmp = ocmp;
+	wid = owid;
 }
@@ -9,8 +9,9 @@ static char RSXPB[]={0x7C,0};
 int read(uchar fd, char *buf, ushort nbytes)
 {
     register struct fcb *    fc;
-    uchar    size, offs, luid;
-    ushort    cnt;
+    uchar    offs, luid, nrec, single;
+    ushort    size, cnt;
+    short    err;
     ushort  pipev;
     char    buffer[SECSIZE+2];
 
@@ -70,29 +71,45 @@ int read(uchar fd, char *buf, ushort nbytes)
 
     case U_READ:
     case U_RDWR:
+        if (fc->host)
+            return _zxio(fc, ZXHREAD, buf, nbytes);
         if (nbytes + fc->rwp > fc->fsize)    /* Limit length */
             nbytes = fc->fsize - fc->rwp;
         luid = getuid();
         cnt = nbytes;
+        single = 0;
         while(nbytes) 
         {
             _sigchk();
-            setuid(fc->uid);
+            if(fc->uid != luid)
+                setuid(fc->uid);
             offs = fc->rwp%SECSIZE;
-            if((size = SECSIZE - offs) > nbytes)
-                size = nbytes;
             _putrno(fc->ranrec, fc->rwp/SECSIZE);
-            if(size == SECSIZE)
-             {
+            if(!offs && nbytes >= SECSIZE)
+            {
+                /* Whole sectors go straight to the caller, as many at
+                 * a time as the BDOS will take */
+                nrec = single ? 1 : _msect(nbytes);
+                size = nrec*SECSIZE;
                 bdos(CPMSDMA, buf);
 #ifdef    LARGE_MODEL
                 bdos(CPMDSEG, (int)((long)buf >> 16));    /* set DMA segment */
 #endif
-                if(bdos(CPMRRAN, fc))
-                    break;
+                err = bdos(CPMRRAN, fc);
+                if(nrec > 1)
+                    bdos(CPMSMSC, 1);
+                if(err)
+                {
+                    if(nrec == 1)
+                        break;
+                    single = 1;    /* Go over them one at a time */
+                    size = 0;
+                }
             }
             else
             {
+                if((size = SECSIZE - offs) > nbytes)
+                    size = nbytes;
                 bdos(CPMSDMA, buffer);
 #ifdef    LARGE_MODEL
                 bdos(CPMDSEG, (int)((long)buffer >> 16));    /* set DMA segment */
@@ -104,9 +121,11 @@ int read(uchar fd, char *buf, ushort nbytes)
             buf += size;
             fc->rwp += size;
             nbytes -= size;
-            setuid(luid);
+            if(fc->uid != luid)
+                setuid(luid);
         }
-        setuid(luid);
+        if(fc->uid != luid)
+            setuid(luid);
         return cnt - nbytes;
 
     default:
@@ -3,19 +3,31 @@
 ;	type operations, when it is in the memory location pointed to by
 ;	HL
 
+;	8 or more moves the low byte up first, then shifts what is left
+;	of the count a bit at a time
+
 	global	shll,shal	;shift left, arithmetic or logical
 	psect	text
 
 
 shll:
 shal:
-	ld	a,b		;check for zero shift
-	or	a
-	ret	z
+	ld	a,b
 	cp	16		;16 bits is maximum shift
-	jr	c,1f		;is ok
-	ld	b,16
+	jr	nc,2f
+	cp	8
+	jr	c,1f
+	ld	h,l
+	ld	l,0
+	sub	8
 1:
+	or	a		;check for zero shift
+	ret	z
+	ld	b,a
+3:
 	add	hl,hl		;shift left
-	djnz	1b
+	djnz	3b
+	ret
+2:
+	ld	hl,0
 	ret
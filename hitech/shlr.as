@@ -8,14 +8,23 @@
 
 
 shlr:
-	ld	a,b		;check for zero shift
-	or	a
-	ret	z
+	ld	a,b
 	cp	16		;16 bits is maximum shift
-	jr	c,1f		;is ok
-	ld	b,16
+	jr	nc,2f
+	cp	8
+	jr	c,1f
+	ld	l,h		;move the hi byte down
+	ld	h,0
+	sub	8
 1:
+	or	a		;check for zero shift
+	ret	z
+	ld	b,a
+3:
 	srl	h
 	rr	l
-	djnz	1b
+	djnz	3b
+	ret
+2:
+	ld	hl,0
 	ret
@@ -1,50 +1,80 @@
 #include	<math.h>
 
-#define	PI	3.14159265358979
-#define	TWO_PI	6.28318530717958
-#define	HALF_PI	1.570796326794895
+#define	PIO2_HI		201.0		/* pi/2 to 8 bits, times 2^7 */
+#define	PIO2_LO		4.8382679490e-4
+#define	TWO_OVER_PI	0.63661977237
+
+extern double	eval_poly();
+
+/*	minimax fits on [-pi/4, pi/4] to sin(x)/x and cos(x), as
+ *	polynomials in x*x
+ */
+/* const */ static double	sin_coeff[] =
+{
+	 9.9999999676e-01,
+	-1.6666650224e-01,
+	 8.3320164531e-03,
+	-1.9501822020e-04,
+};
+/* const */ static double	cos_coeff[] =
+{
+	 9.9999999994e-01,
+	-4.9999999572e-01,
+	 4.1666613233e-02,
+	-1.3886529148e-03,
+	 2.4372679212e-05,
+};
+
+/*	Reduce x to r = x - n*pi/2, between -pi/4 and pi/4, storing r and
+ *	returning n mod 4, the quadrant x is in. This, _sinr() and _cosr()
+ *	are shared with cos() and tan().
+ */
+
+int
+_trigred(x, rp)
+double	x, * rp;
+{
+	long	n;
+	double	t, dn;
+
+	t = x * TWO_OVER_PI;
+	n = (long)t;			/* ftol rounds to nearest */
+	dn = n;
+	/* n*201 needs no rounding, so the first subtraction is exact; the
+	 * second is a statement of its own to keep the compiler from adding
+	 * the two parts of n*pi/2 together first */
+	x -= ldexp(dn * PIO2_HI, -7);
+	*rp = x - dn * PIO2_LO;
+	return (int)n & 3;
+}
+
+double
+_sinr(r)
+double	r;
+{
+	return r * eval_poly(r * r, sin_coeff, 3);
+}
+
+double
+_cosr(r)
+double	r;
+{
+	return eval_poly(r * r, cos_coeff, 4);
+}
 
 double
 sin(f)
 double	f;
 {
-	/* const */ static double	coeff_a[] =
-	{
-		 207823.68416961012,
-		-76586.415638846949,
-		 7064.1360814006881,
-		-237.85932457812158,
-		 2.8078274176220686
-	};
-	/* const */ static double	coeff_b[] =
-	{
-		 132304.66650864931,
-		 5651.6867953169177,
-		 108.99981103712905,
-		 1.0
-	};
-	double	x2;
-	int	sgn;
-	extern double	eval_poly();
-
-	sgn = 0;
-	if(f < 0.0) {
-		f = -f;
-		sgn = 1;
-	}
-	f *= 1.0/TWO_PI;
-	f = 4.0 * (f - floor(f));
-	if(f > 2.0) {
-		f -= 2.0;
-		sgn = !sgn;
+	double	r;
+
+	switch(_trigred(f, &r)) {
+	case 0:
+		return _sinr(r);
+	case 1:
+		return _cosr(r);
+	case 2:
+		return -_sinr(r);
 	}
-	if( f > 1.0)
-		f = 2.0 - f;
-	x2 = f * f;
-	f *= eval_poly(x2, coeff_a, 4) / eval_poly(x2, coeff_b, 3);
-	if(sgn)
-		return -f;
-	return f;
+	return -_cosr(r);
 }
-
-
@@ -35,6 +35,7 @@ extern void	*memchr(void *, int, size_t);
 /* extern char	*strpbrk(char *, char *); */ /* missing */
 /* extern size_t	 strspn(char *, char *); *//* missing */
 extern char	*strstr(char *, char *);
+extern char	*strnstr(char *, char *, size_t);
 extern char	*strtok(char *, char *);
 extern void	*memset(void *, int, size_t);
 extern char	*strerror(int);
@@ -8,27 +8,32 @@
  *	the characters from s upto but not including the first NUL character 
  *	can be found starting from p, or
  *    -	NULL if there is no such pointer.
+ *
+ * Candidates for p are found with memchr(), one CPIR scan for each case
+ * of the first character of s; only there are the rest compared.
  */
 #include <ctype.h>
+#include <string.h>
 
 char * strcasestr (char *t, char *s) 
 {
-   char *t1;
-   char *s1;
-
-   do 
-     {
-       t1 = t;
-       s1 = s;
-       while(*s1) {
-         if (toupper(*s1) != toupper(*(t1++))) 
-	    break;
-	 else
-	    ++s1;
-       }
-       if (!*s1) return t;
-     } 
-   while (*(t++));
+   unsigned int l, n;
+   char lc, uc, *e, *lp, *up;
 
+   if (!*s) return t;
+   lc = tolower(*s);
+   uc = toupper(*s++);
+   n = strlen(s);
+   if ((l = strlen(t)) <= n) return (char *) 0;
+   e = t + l - n;               /* No room for s from here on */
+   lp = up = t - 1;
+   for (;;) {
+       /* The next place each case of the first character appears */
+       if (lp < t && !(lp = memchr(t, lc, e - t))) lp = e;
+       if (up < t && !(up = uc == lc ? lp : memchr(t, uc, e - t))) up = e;
+       if ((t = lp < up ? lp : up) == e) break;
+       if (!strncasecmp(t + 1, s, n)) return t;
+       ++t;
+   }
    return (char *) 0;
 }
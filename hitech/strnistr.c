@@ -9,30 +9,32 @@
  *	the characters from s upto but not including the first NUL character 
  *	can be found starting from p and strictly before t+n, or
  *    -	NULL if there is no such pointer.
+ *
+ * As strcasestr(), candidates for p are found with a CPIR scan (memchr())
+ * for each case of the first character of s.
  */
 #include <ctype.h>
+#include <string.h>
 
 char * strncasestr (char *t, char *s, unsigned int n) 
 {
-   char *t1;
-   char *s1;
-   unsigned int n1;
+   unsigned int l;
+   char lc, uc, *e, *lp, *up;
 
    if (!*s) return t;
-   while (*t && n) {
-       t1 = t;
-       n1 = n;
-       s1 = s;
-       while (*s1) {
-           if (toupper(*s1) != toupper(*(t1++))) break;
-           else {
-               ++s1;
-               if (!--n1) break;
-           }
-       }
-       if (!*s1) return t;
-       --n;
+   lc = tolower(*s);
+   uc = toupper(*s++);
+   if (e = memchr(t, 0, n)) n = e - t;  /* t may be shorter than n */
+   if (n <= (l = strlen(s))) return (char *) 0;
+   e = t + n - l;
+   lp = up = t - 1;
+   for (;;) {
+       /* The next place each case of the first character appears */
+       if (lp < t && !(lp = memchr(t, lc, e - t))) lp = e;
+       if (up < t && !(up = uc == lc ? lp : memchr(t, uc, e - t))) up = e;
+       if ((t = lp < up ? lp : up) == e) break;
+       if (!strncasecmp(t + 1, s, l)) return t;
        ++t;
-     }
+   }
    return (char *) 0;
 }
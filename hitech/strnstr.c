@@ -8,28 +8,24 @@
  *	the characters from s upto but not including the first NUL character 
  *	can be found starting from p and strictly before t+n, or
  *    -	NULL if there is no such pointer.
+ *
+ * As strstr(), candidates for p are found with a CPIR scan (memchr()) for
+ * the first character of s.
  */
+#include <string.h>
+
 char * strnstr (char *t, char *s, unsigned int n) 
 {
-   char *t1;
-   char *s1;
-   unsigned int n1;
+   unsigned int l;
+   char c, *e;
 
-   if (!*s) return t;
-   while (*t && n) {
-       t1 = t;
-       n1 = n;
-       s1 = s;
-       while (*s1) {
-           if (*s1 != *(t1++)) break;
-           else {
-               ++s1;
-               if (!--n1) break;
-           }
-       }
-       if (!*s1) return t;
-       --n;
+   if (!(c = *s++)) return t;
+   if (e = memchr(t, 0, n)) n = e - t;  /* t may be shorter than n */
+   if (n <= (l = strlen(s))) return (char *) 0;
+   e = t + n - l;
+   while (t = memchr(t, c, e - t)) {
+       if (!strncmp(t + 1, s, l)) return t;
        ++t;
-     }
+   }
    return (char *) 0;
 }
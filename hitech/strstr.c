@@ -8,25 +8,24 @@
  *	the characters from s upto but not including the first NUL character 
  *	can be found starting from p, or
  *    -	NULL if there is no such pointer.
+ *
+ * Candidates for p are found with memchr(), which looks for the first
+ * character of s with CPIR; only there are the rest compared.
  */
+#include <string.h>
+
 char * strstr (char *t, char *s) 
 {
-   char *t1;
-   char *s1;
-
-   do 
-     {
-       t1 = t;
-       s1 = s;
-       while(*s1) {
-         if (*s1 != *(t1++)) 
-	    break;
-	 else
-	    ++s1;
-       }
-       if (!*s1) return t;
-     } 
-   while (*(t++));
+   unsigned int l, n;
+   char c, *e;
 
+   if (!(c = *s++)) return t;
+   n = strlen(s);
+   if ((l = strlen(t)) <= n) return (char *) 0;
+   e = t + l - n;               /* No room for s from here on */
+   while (t = memchr(t, c, e - t)) {
+       if (!strncmp(t + 1, s, n)) return t;
+       ++t;
+   }
    return (char *) 0;
 }
@@ -1,8 +1,20 @@
 #include	<math.h>
 
+extern int	_trigred();
+extern double	_sinr(), _cosr();
+
 double
 tan(x)
 double	x;
 {
-	return sin(x)/cos(x);
+	double	r, s, c;
+
+	/* one reduction does for both; tan(r + pi/2) is -cos(r)/sin(r) */
+
+	if(_trigred(x, &r) & 1) {
+		s = _sinr(r);
+		return -_cosr(r)/s;
+	}
+	c = _cosr(r);
+	return _sinr(r)/c;
 }
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include "testutil.h"
+
+/* printf() and friends: fields against known strings, numbers in every
+ * base against a plain conversion, and a file written by fprintf()
+ * against the same text written a character at a time. With an
+ * argument, also time fprintf() to a file:
+ *
+ *	zxcc testfmt t
+ */
+
+struct fmt {
+    char *f;
+    char l;             /* the argument is a long */
+    long v;
+    char *want;
+} fmts[] = {
+    { "%d", 0, 0L, "0" },
+    { "%d", 0, -32768L, "-32768" },
+    { "%u", 0, 65535L, "65535" },
+    { "%5d|", 0, 42L, "   42|" },
+    { "%-5d|", 0, 42L, "42   |" },
+    { "%05d", 0, -42L, "-00042" },
+    { "%.3d", 0, 7L, "007" },
+    { "%x", 0, 0xBEEFL, "BEEF" },
+    { "%X", 1, 0xCAFEF00DL, "CAFEF00D" },
+    { "%o", 0, 8L, "10" },
+    { "%ld", 1, 2147483647L, "2147483647" },
+    { "%ld", 1, 0x80000000L, "-2147483648" },
+    { "%lu", 1, 4294967295L, "4294967295" },
+    { "%lx", 1, 0x12345678L, "12345678" },
+    { "%lo", 1, 037777777777L, "37777777777" },
+    { "%D", 1, 100000L, "100000" },
+    { "%10lu|", 1, 123456789L, " 123456789|" },
+    { "%-12ld|", 1, -98765L, "-98765      |" },
+    { "[%c]", 0, 'q', "[q]" },
+    { "%%%d%%", 0, 5L, "%5%" },
+};
+
+#define NFMTS	(sizeof(fmts) / sizeof(fmts[0]))
+
+/* The digits of v in base, the slow way */
+
+char *conv(char *buf, unsigned long v, int base)
+{
+    char tmp[40], *p = tmp;
+
+    do {
+        *p++ = "0123456789ABCDEF"[v % base];
+        v /= base;
+    } while (v);
+    while (p != tmp)
+        *buf++ = *--p;
+    *buf = 0;
+    return buf;
+}
+
+char line[600], want[600];
+
+int fields(void)
+{
+    int i, ok = 1;
+
+    for (i = 0; i < NFMTS; i++) {
+        if (fmts[i].l)
+            sprintf(line, fmts[i].f, fmts[i].v);
+        else
+            sprintf(line, fmts[i].f, (int)fmts[i].v);
+        if (strcmp(line, fmts[i].want)) {
+            printf("\"%s\" gave \"%s\", not \"%s\"\n", fmts[i].f, line,
+                   fmts[i].want);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+int numbers(void)
+{
+    int i, n;
+    unsigned long v;
+    char *p;
+
+    for (i = 0; i < 2000; i++) {
+        v = (unsigned long)rnd() << 16 | rnd();
+        v >>= rnd() & 31;
+        p = conv(want, v, 10);
+        *p++ = ' ';
+        p = conv(p, v, 16);
+        *p++ = ' ';
+        conv(p, v, 8);
+        n = sprintf(line, "%lu %lx %lo", v, v, v);
+        if (strcmp(line, want) || n != strlen(want)) {
+            printf("%s, not %s\n", line, want);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* A long literal run, long strings and padding, to go past the
+ * formatter's own buffer */
+
+char *text(char *buf, int n)
+{
+    static char many[] =
+"0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz";
+
+    return buf + sprintf(buf,
+"line %d: a literal run of more than sixty-four characters, then a string:\n"
+"%s|%-80s|%40s|%c\n", n, many + n % 50, many + n % 7, "right", 'A' + n % 26);
+}
+
+int longlines(void)
+{
+    char *p;
+
+    p = text(line, 3);
+    strcpy(want, "line 3: a literal run of more than sixty-four characters, "
+           "then a string:\n");
+    strcat(want, "3456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmno"
+           "pqrstuvwxyz|3456789abcdefghijklmnopqrstuvwxyz0123456789abcdefgh"
+           "ijklmnopqrstuvwxyz           |");
+    strcat(want, "                                   right|D\n");
+    if (strcmp(line, want) || p != line + strlen(want)) {
+        printf("%s", line);
+        return 0;
+    }
+    return 1;
+}
+
+/* fprintf() a file, write the same text with putc(), and compare them */
+
+int files(void)
+{
+    FILE *fp, *fq;
+    int i, c, ok;
+    char *p;
+
+    if (!(fp = fopen("fmt1.tmp", "w")) || !(fq = fopen("fmt2.tmp", "w")))
+        return 0;
+    for (i = 0; i < 40; i++) {
+        fprintf(fp, "%d %s|%5ld|%-6x|\n", i, "some text", (long)i * 9999, i);
+        text(line, i);
+        fprintf(fp, "%s", line);
+        sprintf(want, "%d %s|%5ld|%-6x|\n", i, "some text", (long)i * 9999, i);
+        strcat(want, line);
+        for (p = want; *p; p++)
+            putc(*p, fq);
+    }
+    fclose(fp);
+    fclose(fq);
+    fp = fopen("fmt1.tmp", "rb");
+    fq = fopen("fmt2.tmp", "rb");
+    ok = fp && fq;
+    while (ok && (c = getc(fp)) != EOF)
+        ok = (c == getc(fq));
+    if (ok)
+        ok = (getc(fq) == EOF);
+    if (fp)
+        fclose(fp);
+    if (fq)
+        fclose(fq);
+    remove("fmt1.tmp");
+    remove("fmt2.tmp");
+    return ok;
+}
+
+FILE *tfp;
+long tn;
+
+int b_fprintf()
+{
+    fprintf(tfp, "%5d %-8s %08lx %ld\n", (int)tn, "name", tn * 12345, tn);
+    ++tn;
+    return 0;
+}
+
+void timing(void)
+{
+    if (!(tfp = fopen("fmt1.tmp", "w")))
+        return;
+    printf("%ld fprintf calls a second\n", rate(b_fprintf, 1));
+    fclose(tfp);
+    remove("fmt1.tmp");
+}
+
+int main(int argc, char **argv)
+{
+    check("fields", fields());
+    check("numbers", numbers());
+    check("long lines", longlines());
+    check("files", files());
+    printf("%s|%-70s|\n", "to the console", "padded past the formatter's buffer");
+    if (argc > 1)
+        timing();
+    return bad;
+}
@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Write a COM file of random Z80 instructions, for zxcc's ZXCC_XLAT_CHECK
+ * to run through the interpreter and the translated code side by side:
+ *
+ *	zxcc testgen testrnd.com [--sseed] [--ncount]
+ *	zxcc testrnd
+ *
+ * The instructions are safe to run rather than meaningful: whatever they
+ * do to the registers, memory is only reached through pointers loaded just
+ * before, into a block of random data at DATA, and the stack is kept
+ * balanced. Between them are forward jumps and calls on the flags, DJNZ
+ * loops, JP (HL) and computed returns, and a few harmless BDOS calls.
+ */
+
+#define ORG	0x100
+#define DATA	0x1000			/* Random data, to DATA + DSIZE */
+#define DSIZE	0x800
+#define STACK	0x1FF0
+#define CODEMAX	0xD00			/* Stop adding code after this */
+
+#define F_REGION 1			/* Skipped over by a jump */
+#define F_SUB	2			/* In a subroutine */
+#define F_LOOP	4			/* In a DJNZ loop: leave B alone */
+
+unsigned char img[DATA + DSIZE - ORG];
+unsigned pos;				/* Next byte of img */
+int depth;				/* Words pushed */
+unsigned long seed = 1;
+
+unsigned rnd(unsigned n)
+{
+    seed = seed * 1103515245L + 12345;
+    return (unsigned)(seed >> 16) % n;
+}
+
+void emit(int b)
+{
+    img[pos++] = b;
+}
+
+void emit2(unsigned w)
+{
+    emit(w & 0xFF);
+    emit(w >> 8);
+}
+
+unsigned here(void)
+{
+    return ORG + pos;
+}
+
+/* A register other than (HL), and one other than (HL) and B */
+
+int reg(void)
+{
+    int r;
+
+    while ((r = rnd(8)) == 6)
+        ;
+    return r;
+}
+
+int notb(void)
+{
+    int r;
+
+    while ((r = rnd(8)) == 6 || r == 0)
+        ;
+    return r;
+}
+
+/* A pointer far enough inside the data for (IX+d) and short block moves */
+
+unsigned ptr(void)
+{
+    return DATA + 0x100 + rnd(DSIZE - 0x200);
+}
+
+void ldhl(void)
+{
+    emit(0x21);
+    emit2(ptr());
+}
+
+void gen(int n, int flags);
+
+/* One instruction, or a few that go together */
+
+void one(int flags)
+{
+    static unsigned char misc[] = {
+        0x00, 0x07, 0x0F, 0x17, 0x1F, 0x27, 0x2F, 0x37, 0x3F, 0x08, 0xEB, 0xD9
+    };
+    static unsigned char im[] = { 0x46, 0x56, 0x5E };
+    static unsigned char ixops[] = {
+        0x24, 0x25, 0x2C, 0x2D, 0x23, 0x2B, 0x09, 0x19, 0x29, 0x39
+    };
+    unsigned a, w;
+    int r, k;
+
+    if (flags & F_LOOP) {
+        switch (rnd(5)) {
+        case 0:
+            emit(0x80 | rnd(8) << 3 | reg());
+            break;
+        case 1:
+            emit(0xC6 | rnd(8) << 3);
+            emit(rnd(256));
+            break;
+        case 2:
+            emit(0xCB);
+            emit(rnd(32) << 3 | notb());
+            break;
+        case 3:
+            ldhl();
+            emit(0x86 | rnd(8) << 3);
+            break;
+        default:
+            emit(misc[rnd(sizeof(misc) - 1)]);	/* Not EXX */
+            break;
+        }
+        return;
+    }
+    switch (rnd(flags ? 16 : 21)) {
+    case 0:				/* LD r,r */
+        emit(0x40 | reg() << 3 | reg());
+        break;
+    case 1:				/* ALU A,r */
+        emit(0x80 | rnd(8) << 3 | reg());
+        break;
+    case 2:				/* ALU A,n */
+        emit(0xC6 | rnd(8) << 3);
+        emit(rnd(256));
+        break;
+    case 3:				/* INC r, DEC r, LD r,n */
+        r = reg();
+        switch (rnd(3)) {
+        case 0:
+            emit(0x04 | r << 3);
+            break;
+        case 1:
+            emit(0x05 | r << 3);
+            break;
+        default:
+            emit(0x06 | r << 3);
+            emit(rnd(256));
+            break;
+        }
+        break;
+    case 4:
+        emit(misc[rnd(sizeof(misc))]);
+        break;
+    case 5:				/* 16-bit arithmetic and loads */
+        k = rnd(3) << 4;
+        switch (rnd(4)) {
+        case 0:
+            emit(0x01 | k);
+            emit2(rnd(0xFFFF));
+            break;
+        case 1:
+            emit(0x03 | k | rnd(2) << 3);
+            break;
+        case 2:
+            emit(0x09 | rnd(4) << 4);
+            break;
+        default:
+            emit(0xED);
+            emit((rnd(2) ? 0x42 : 0x4A) | rnd(4) << 4);
+            break;
+        }
+        break;
+    case 6:				/* Through (HL) */
+        ldhl();
+        switch (rnd(7)) {
+        case 0:
+            emit(0x46 | reg() << 3);
+            break;
+        case 1:
+            emit(0x70 | reg());
+            break;
+        case 2:
+            emit(0x86 | rnd(8) << 3);
+            break;
+        case 3:
+            emit(0x34 | rnd(2));
+            break;
+        case 4:
+            emit(0x36);
+            emit(rnd(256));
+            break;
+        case 5:
+            emit(0xCB);
+            emit(rnd(32) << 3 | 6);
+            break;
+        default:
+            emit(0xED);
+            emit(rnd(2) ? 0x67 : 0x6F);
+            break;
+        }
+        break;
+    case 7:				/* Through (BC) and (DE) */
+        k = rnd(2) << 4;
+        emit(0x01 | k);
+        emit2(ptr());
+        emit((rnd(2) ? 0x02 : 0x0A) | k);
+        break;
+    case 8:				/* To and from (nn) */
+        a = ptr();
+        switch (rnd(5)) {
+        case 0:
+            emit(rnd(2) ? 0x32 : 0x3A);
+            break;
+        case 1:
+            emit(rnd(2) ? 0x22 : 0x2A);
+            break;
+        case 2:
+            emit(0xED);
+            emit(0x43 | rnd(4) << 4);
+            break;
+        case 3:
+            emit(0xED);
+            emit(0x4B | rnd(3) << 4);	/* Not SP */
+            break;
+        default:
+            emit(rnd(2) ? 0xDD : 0xFD);
+            emit(rnd(2) ? 0x22 : 0x2A);
+            break;
+        }
+        emit2(a);
+        break;
+    case 9:				/* CB on a register */
+        emit(0xCB);
+        emit(rnd(32) << 3 | reg());
+        break;
+    case 10:				/* Through (IX+d) and (IY+d) */
+        k = rnd(2) ? 0xDD : 0xFD;
+        emit(k);
+        emit(0x21);
+        emit2(ptr());
+        emit(k);
+        switch (rnd(6)) {
+        case 0:
+            emit(0x46 | reg() << 3);
+            break;
+        case 1:
+            emit(0x70 | reg());
+            break;
+        case 2:
+            emit(0x86 | rnd(8) << 3);
+            break;
+        case 3:
+            emit(0x34 | rnd(2));
+            break;
+        case 4:
+            emit(0x36);
+            emit(rnd(256));
+            emit(rnd(256));
+            return;
+        default:
+            emit(0xCB);
+            emit(rnd(256));
+            emit(rnd(256));
+            return;
+        }
+        emit(rnd(256));
+        break;
+    case 11:				/* IX and IY as registers */
+        emit(rnd(2) ? 0xDD : 0xFD);
+        switch (rnd(5)) {
+        case 0:
+            emit(ixops[rnd(sizeof(ixops))]);
+            break;
+        case 1:
+            emit(rnd(2) ? 0x26 : 0x2E);
+            emit(rnd(256));
+            break;
+        case 2:
+            emit(0x44 | rnd(2) | reg() << 3);
+            break;
+        case 3:
+            emit(0x60 | rnd(2) << 3 | reg());
+            break;
+        default:
+            emit(0x84 | rnd(2) | rnd(8) << 3);
+            break;
+        }
+        break;
+    case 12:				/* ED odds and ends */
+        emit(0xED);
+        switch (rnd(4)) {
+        case 0:
+            emit(0x44);
+            break;
+        case 1:
+            emit(rnd(2) ? 0x57 : 0x5F);
+            break;
+        case 2:
+            emit(rnd(2) ? 0x47 : 0x4F);
+            break;
+        default:
+            emit(im[rnd(3)]);
+            break;
+        }
+        break;
+    case 13:				/* Block moves, compares and loops */
+        w = 1 + rnd(32);
+        ldhl();
+        emit(0x11);
+        emit2(ptr());
+        emit(0x01);
+        emit2(w);
+        emit(0xED);
+        emit(0xA0 | rnd(2) << 4 | rnd(2) << 3 | rnd(2));
+        break;
+    case 14:				/* BDOS version or current drive */
+        emit(0x0E);
+        emit(rnd(2) ? 12 : 25);
+        emit(0xCD);
+        emit2(5);
+        break;
+    case 15:				/* JP (HL) and computed returns */
+        switch (rnd(3)) {
+        case 0:
+            emit(0x21);
+            emit2(here() + 3);
+            emit(0xE9);
+            break;
+        case 1:
+            k = rnd(2) ? 0xDD : 0xFD;
+            emit(k);
+            emit(0x21);
+            emit2(here() + 4);
+            emit(k);
+            emit(0xE9);
+            break;
+        default:
+            emit(0x21);
+            emit2(here() + 4);
+            emit(0xE5);
+            emit(0xC9);
+            break;
+        }
+        break;
+    case 16:				/* Forward jump over a few */
+        k = rnd(4);
+        if (k == 0)
+            emit(0x10);			/* DJNZ */
+        else if (k == 1)
+            emit(0x18);
+        else
+            emit(0x20 | rnd(4) << 3);
+        a = pos;
+        emit(0);
+        gen(1 + rnd(6), F_REGION);
+        img[a] = pos - a - 1;
+        break;
+    case 17:				/* JP and JP cc over a few */
+        emit(rnd(4) ? 0xC2 | rnd(8) << 3 : 0xC3);
+        a = pos;
+        emit2(0);
+        gen(1 + rnd(10), flags | F_REGION);
+        img[a] = here() & 0xFF;
+        img[a + 1] = here() >> 8;
+        break;
+    case 18:				/* Push and pop */
+        k = rnd(4) << 4;
+        if (depth && rnd(2)) {
+            if (rnd(4))
+                emit(0xC1 | k);
+            else {
+                emit(rnd(2) ? 0xDD : 0xFD);
+                emit(0xE1);
+            }
+            depth--;
+        } else if (depth < 8) {
+            if (rnd(4))
+                emit(0xC5 | k);
+            else {
+                emit(rnd(2) ? 0xDD : 0xFD);
+                emit(0xE5);
+            }
+            depth++;
+        }
+        if (depth && !rnd(4))
+            emit(0xE3);			/* EX (SP),HL */
+        break;
+    case 19:				/* A subroutine, and calls to it */
+        emit(0xC3);
+        a = pos;
+        emit2(0);
+        w = here();
+        gen(1 + rnd(4), F_SUB);
+        if (rnd(2)) {
+            emit(0xC0 | rnd(8) << 3);	/* RET cc */
+            gen(1 + rnd(4), F_SUB);
+        }
+        emit(0xC9);
+        img[a] = here() & 0xFF;
+        img[a + 1] = here() >> 8;
+        for (k = 1 + rnd(3); k; k--) {
+            emit(rnd(2) ? 0xCD : 0xC4 | rnd(8) << 3);
+            emit2(w);
+            gen(1, F_SUB);
+        }
+        break;
+    default:				/* A DJNZ loop */
+        emit(0x06);
+        emit(1 + rnd(8));
+        a = pos;
+        gen(1 + rnd(4), F_LOOP);
+        emit(0x10);
+        emit(a - pos - 1);
+        break;
+    }
+}
+
+void gen(int n, int flags)
+{
+    while (n--)
+        one(flags);
+}
+
+int main(int argc, char **argv)
+{
+    static char done[] = "testrnd: done\r\n$";
+    FILE *fp;
+    char *p;
+    unsigned n, count;
+
+    count = 2000;
+    for (n = 2; n < argc; n++)
+        if (argv[n][0] == '-' && (argv[n][1] == 's' || argv[n][1] == 'S'))
+            seed = atol(argv[n] + 2);
+        else if (argv[n][0] == '-' && (argv[n][1] == 'n' || argv[n][1] == 'N'))
+            count = atoi(argv[n] + 2);
+        else
+            argc = 0;
+    if (argc < 2) {
+        fprintf(stderr, "Usage: testgen file.com [-sseed] [-ncount]\n");
+        exit(1);
+    }
+
+    for (n = DATA - ORG; n < sizeof(img); n++)
+        img[n] = rnd(256);
+    emit(0x31);
+    emit2(STACK);
+    for (n = 0; n < 3; n++) {		/* Random BC, DE, HL, IX, IY, AF */
+        emit(0x01 | n << 4);
+        emit2(rnd(0xFFFF));
+    }
+    emit(0xDD);
+    emit(0x21);
+    emit2(rnd(0xFFFF));
+    emit(0xFD);
+    emit(0x21);
+    emit2(rnd(0xFFFF));
+    emit(0xD5);
+    emit(0xF1);
+
+    for (n = 0; n < count && pos < CODEMAX; n++)
+        one(0);
+
+    emit(0x11);				/* Print done and go back to CP/M */
+    emit2(here() + 10);
+    emit(0x0E);
+    emit(9);
+    emit(0xCD);
+    emit2(5);
+    emit(0xC3);
+    emit2(0);
+    for (p = done; *p; p++)
+        emit(*p);
+
+    if (!(fp = fopen(argv[1], "wb")) ||
+        fwrite(img, 1, sizeof(img), fp) != sizeof(img) || fclose(fp)) {
+        fprintf(stderr, "testgen: can't write %s\n", argv[1]);
+        exit(1);
+    }
+    printf("%u instructions, %u bytes of code\n", n, pos);
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include "testutil.h"
+
+/* The long multiply, divide and shift routines, and the int shifts,
+ * plain and in assignments. With an argument, also count the T-states
+ * each takes under zxcc, loop and all:
+ *
+ *	zxcc testlong t
+ */
+
+struct sums {
+    long a, b, mul, div, mod;
+    unsigned long umul, udiv, umod;
+} sums[] = {
+    { 0L, 7L, 0L, 0L, 0L, 0x0L, 0x0L, 0x0L },
+    { 1L, 1L, 1L, 1L, 0L, 0x1L, 0x1L, 0x0L },
+    { 123L, 45L, 5535L, 2L, 33L, 0x159FL, 0x2L, 0x21L },
+    { 255L, 255L, 65025L, 1L, 0L, 0xFE01L, 0x1L, 0x0L },
+    { 65535L, 65535L, -131071L, 1L, 0L, 0xFFFE0001L, 0x1L, 0x0L },
+    { 65536L, 3L, 196608L, 21845L, 1L, 0x30000L, 0x5555L, 0x1L },
+    { 100000L, 10L, 1000000L, 10000L, 0L, 0xF4240L, 0x2710L, 0x0L },
+    { 123456789L, 10L, 1234567890L, 12345678L, 9L, 0x499602D2L, 0xBC614EL, 0x9L },
+    { -1L, 1L, -1L, -1L, 0L, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0L },
+    { -123L, 45L, -5535L, -2L, -33L, 0xFFFFEA61L, 0x5B05B02L, 0x2BL },
+    { 123L, -45L, -5535L, -2L, 33L, 0xFFFFEA61L, 0x0L, 0x7BL },
+    { -100000L, -7L, 700000L, 14285L, -5L, 0xAAE60L, 0x0L, 0xFFFE7960L },
+    { 2147483647L, 2147483647L, 1L, 1L, 0L, 0x1L, 0x1L, 0x0L },
+    { 0x80000000L, 1L, 0x80000000L, 0x80000000L, 0L, 0x80000000L, 0x80000000L, 0x0L },
+    { 305419896L, 633805L, -1813813736L, 481L, 559691L, 0x93E36618L, 0x1E1L, 0x88A4BL },
+    { 987654321L, 12345L, -819560599L, 80004L, 4941L, 0xCF267F69L, 0x13884L, 0x134DL },
+    { -987654321L, 70000L, 286093712L, -14109L, -24321L, 0x110D7190L, 0xB88FL, 0x59BFL },
+    { 40000L, 40000L, 1600000000L, 1L, 0L, 0x5F5E1000L, 0x1L, 0x0L },
+    { 1L, -65536L, -65536L, 0L, 1L, 0xFFFF0000L, 0x0L, 0x1L },
+    { 65535L, 1000000L, 1110490560L, 0L, 65535L, 0x4230BDC0L, 0x0L, 0xFFFFL },
+    { 65536L, 65536L, 0L, 1L, 0L, 0x0L, 0x1L, 0x0L },
+    { -1L, 65535L, -65535L, 0L, -1L, 0xFFFF0001L, 0x10001L, 0x0L },
+    { -1L, 255L, -255L, 0L, -1L, 0xFFFFFF01L, 0x1010101L, 0x0L },
+};
+
+#define NSUMS	(sizeof(sums) / sizeof(sums[0]))
+
+void table(void)
+{
+    struct sums *s;
+    long x;
+    unsigned long u, ub;
+    int mul = 1, div = 1, as = 1;
+
+    for (s = sums; s < sums + NSUMS; s++) {
+        u = s->a;
+        ub = s->b;
+        if (s->a * s->b != s->mul || u * ub != s->umul) {
+            printf("%ld * %ld wrong\n", s->a, s->b);
+            mul = 0;
+        }
+        if (s->a / s->b != s->div || s->a % s->b != s->mod ||
+            u / ub != s->udiv || u % ub != s->umod) {
+            printf("%ld / %ld wrong\n", s->a, s->b);
+            div = 0;
+        }
+        x = s->a;
+        x *= s->b;
+        if (x != s->mul)
+            as = 0;
+        x = s->a;
+        x /= s->b;
+        if (x != s->div)
+            as = 0;
+        x = s->a;
+        x %= s->b;
+        if (x != s->mod)
+            as = 0;
+        u = s->a;
+        u /= ub;
+        if (u != s->udiv)
+            as = 0;
+    }
+    check("long multiply", mul);
+    check("long divide", div);
+    check("long *= /= %=", as);
+}
+
+/* Divide random numbers of every size by random numbers of every size,
+ * checking that q*d + r comes back to n */
+
+void divides(void)
+{
+    unsigned long n, d, q, r;
+    long sn, sd, sq, sr;
+    int i, ok = 1;
+
+    for (i = 0; i < 2000 && ok; i++) {
+        n = (unsigned long)rnd() << 16 | rnd();
+        n >>= rnd() & 31;
+        d = (unsigned long)rnd() << 16 | rnd();
+        d >>= rnd() & 31;
+        if (!d)
+            continue;
+        q = n / d;
+        r = n % d;
+        if (q * d + r != n || r >= d)
+            ok = 0;
+        sn = n;
+        sd = d;
+        if (i & 1)
+            sn = -sn;
+        if (i & 2)
+            sd = -sd;
+        sq = sn / sd;
+        sr = sn % sd;
+        if (sq * sd + sr != sn || (sr && (sr < 0) != (sn < 0)))
+            ok = 0;
+    }
+    check("random divides", ok);
+}
+
+/* Shifts by every count, against shifting one bit at a time */
+
+long vals[] = { 1L, -1L, 0x12345678L, -0x12345678L, 0x80000000L, 0x7FFFFFFFL };
+
+#define NVALS	(sizeof(vals) / sizeof(vals[0]))
+
+void shifts(void)
+{
+    int i, n, k, one = 1;
+    long v, l, al;
+    unsigned long u, lu;
+    int iv, ai, ii;
+    unsigned uv, iu;
+    int lok = 1, iok = 1, aok = 1;
+
+    for (i = 0; i < NVALS; i++) {
+        v = vals[i];
+        for (n = 0; n <= 32; n++) {
+            l = v;
+            u = v;
+            al = v;
+            for (k = 0; k < n; k++) {
+                l += l;
+                u >>= one;
+                al >>= one;
+            }
+            if (v << n != l || (unsigned long)v >> n != u || v >> n != al)
+                lok = 0;
+            lu = v;
+            lu >>= n;
+            if (lu != u)
+                aok = 0;
+        }
+        iv = v;
+        for (n = 0; n <= 16; n++) {
+            ii = iv;
+            uv = iv;
+            ai = iv;
+            for (k = 0; k < n; k++) {
+                ii += ii;
+                uv >>= one;
+                ai >>= one;
+            }
+            if ((iv << n) != ii || ((unsigned)iv >> n) != uv || (iv >> n) != ai)
+                iok = 0;
+            iu = iv;
+            iu >>= n;
+            if (iu != uv)
+                aok = 0;
+        }
+    }
+    check("long shifts", lok);
+    check("int shifts", iok);
+    check("shift assignments", aok);
+}
+
+long la, lb, lr;
+int ir, ic;
+
+int b_mul() { int i; for (i = 0; i < 100; i++) lr = la * lb; return 0; }
+int b_div() { int i; for (i = 0; i < 100; i++) lr = la / lb; return 0; }
+int b_lsh() { int i; for (i = 0; i < 100; i++) lr = la >> ic; return 0; }
+int b_ish() { int i; for (i = 0; i < 100; i++) ir = ic >> ic; return 0; }
+
+void timeit(char *what, bench fn, long a, long b)
+{
+    unsigned long t;
+
+    la = a;
+    lb = b;
+    ic = b;
+    t = tstates();
+    fn();
+    printf("%-24s %7ld\n", what, since(t) / 100);
+}
+
+int main(int argc, char **argv)
+{
+    table();
+    divides();
+    shifts();
+    if (argc > 1) {
+        printf("\n%-24s %7s\n", "", "T-states");
+        timeit("123 * 45", b_mul, 123L, 45L);
+        timeit("40000 * 40000", b_mul, 40000L, 40000L);
+        timeit("123456789 * -987", b_mul, 123456789L, -987L);
+        timeit("-5 * 7", b_mul, -5L, 7L);
+        timeit("12345 / 10", b_div, 12345L, 10L);
+        timeit("123456789 / 10", b_div, 123456789L, 10L);
+        timeit("1000000 / 1000", b_div, 1000000L, 1000L);
+        timeit("123456789 / 98765", b_div, 123456789L, 98765L);
+        timeit("123456789 / 987654", b_div, 123456789L, 987654L);
+        timeit("long >> 3", b_lsh, 123456789L, 3L);
+        timeit("long >> 16", b_lsh, 123456789L, 16L);
+        timeit("long >> 27", b_lsh, 123456789L, 27L);
+        timeit("int >> 9", b_ish, 0L, 9L);
+    }
+    return bad;
+}
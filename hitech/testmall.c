@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testutil.h"
+
+/* malloc(), free(), realloc() and calloc() under a compiler-like load:
+ * lots of small blocks of mixed sizes, a few big ones, freed in no
+ * particular order. With an argument, also time it:
+ *
+ *	zxcc testmall t
+ */
+
+#define SLOTS	150
+#define BIG	4000
+
+char *slot[SLOTS];
+unsigned len[SLOTS];
+/* Each block is filled with its own slot number, so that any overlap
+ * shows up when it is freed */
+
+int intact(int i)
+{
+    unsigned n;
+
+    for (n = 0; n < len[i]; n++)
+        if (slot[i][n] != (char)i)
+            return 0;
+    return 1;
+}
+
+/* ops allocations, frees and reallocs. Returns 0 if a block was found
+ * overwritten or an allocation failed. When timing, the blocks are left
+ * as they are, so as to time only the allocator. */
+
+int churn(unsigned ops, int timing)
+{
+    int i, ok = 1;
+    unsigned n;
+    char *p;
+
+    while (ops--) {
+        i = rnd() % SLOTS;
+        if (slot[i]) {
+            if (!timing && !intact(i))
+                ok = 0;
+            if (rnd() & 3) {
+                free(slot[i]);
+                slot[i] = 0;
+                continue;
+            }
+            n = rnd() % 200 + 1;               /* grow or shrink it */
+            if (!(p = realloc(slot[i], n))) {
+                ok = 0;
+                continue;
+            }
+            slot[i] = p;
+        } else {
+            n = rnd() & 15 ? rnd() % 40 + 1 : rnd() % BIG + 1;
+            if (!(slot[i] = malloc(n))) {
+                ok = 0;
+                continue;
+            }
+        }
+        len[i] = n;
+        if (!timing)
+            memset(slot[i], i, n);
+    }
+    return ok;
+}
+
+int freeall(void)
+{
+    int i, ok = 1;
+
+    for (i = 0; i < SLOTS; i++)
+        if (slot[i]) {
+            if (!intact(i))
+                ok = 0;
+            free(slot[i]);
+            slot[i] = 0;
+        }
+    return ok;
+}
+
+int b_churn()
+{
+    return churn(500, 1);
+}
+
+int main(int argc, char **argv)
+{
+    char *p, *q;
+    unsigned i;
+
+    check("free(NULL)", (free(NULL), 1));
+    check("malloc(0)", (p = malloc(0)) != NULL);
+    free(p);
+    check("too big", !malloc((unsigned)65000) && !malloc((unsigned)65535));
+
+    p = calloc(100, 3);
+    for (i = 0; p && i < 300 && !p[i]; i++)
+        ;
+    check("calloc", i == 300);
+    free(p);
+
+    p = malloc(10);
+    strcpy(p, "realloc");
+    q = realloc(p, 2000);
+    check("realloc up", q && !strcmp(q, "realloc"));
+    p = realloc(q, 5);
+    check("realloc down", p == q && !memcmp(p, "reall", 5));
+    free(p);
+
+    check("churn", churn(5000, 0));
+    check("free all", freeall());
+
+    /* Everything has been freed and coalesced again, so one block as big
+     * as all the slots could have needed must fit where they were */
+    p = malloc(SLOTS * 40);
+    q = malloc(BIG * 2);
+    check("coalesced", p && q);
+    free(q);
+    free(p);
+
+    if (argc > 1) {
+        printf("%ld operations a second\n", rate(b_churn, 500));
+        for (i = 0; i < SLOTS; i++)
+            free(slot[i]);
+    }
+    return bad;
+}
@@ -0,0 +1,468 @@
+#include <stdio.h>
+#include <math.h>
+#include "testutil.h"
+
+/* sqrt(), exp(), log(), sin(), cos(), tan() and atan() against values
+ * worked out to double precision elsewhere. The error is relative for
+ * results over 1, and absolute below that. With an argument, also show
+ * the errors, and the T-states a call takes under zxcc, of each function
+ * and of the version it replaced:
+ *
+ *	zxcc testmath t
+ */
+
+/* The bit patterns of each argument and its correctly rounded result, so
+ * that the compiler's conversion of decimal constants does not come into it */
+
+struct pair {
+    unsigned long x, y;
+};
+
+#define ARG(p)	(*(double *)&(p)->x)
+#define RES(p)	(*(double *)&(p)->y)
+
+struct pair sqrts[] = {
+    { 0x3B800000L, 0x3E800000L },	/* 0.015625, 0.125 */
+    { 0x3C800000L, 0x3EB504F3L },	/* 0.03125, 0.1767766953 */
+    { 0x3E900000L, 0x3FC00000L },	/* 0.140625, 0.375 */
+    { 0x3FE00000L, 0x40A953FDL },	/* 0.4375, 0.6614378278 */
+    { 0x41820000L, 0x4180FF02L },	/* 1.015625, 1.007782219 */
+    { 0x41FC0000L, 0x41B3997CL },	/* 1.96875, 1.40312152 */
+    { 0x42D90000L, 0x41EBB1D9L },	/* 3.390625, 1.841364983 */
+    { 0x43AC0000L, 0x429460BEL },	/* 5.375, 2.318404624 */
+    { 0x44804000L, 0x42B5322FL },	/* 8.015625, 2.831187913 */
+    { 0x44B68000L, 0x42D825EAL },	/* 11.40625, 3.377314022 */
+    { 0x44FA4000L, 0x42FD1BD2L },	/* 15.640625, 3.954823005 */
+    { 0x45A68000L, 0x4391FC7EL },	/* 20.8125, 4.562071898 */
+    { 0x45D82000L, 0x43A65332L },	/* 27.015625, 5.197655722 */
+    { 0x46896000L, 0x43BB8805L },	/* 34.34375, 5.860354085 */
+    { 0x46AB9000L, 0x43D1922CL },	/* 42.890625, 6.549093449 */
+    { 0x46D30000L, 0x43E869D6L },	/* 52.75, 7.262919523 */
+    { 0x47800800L, 0x44800400L },	/* 64.015625, 8.000976503 */
+    { 0x47999000L, 0x448C332AL },	/* 76.78125, 8.762491084 */
+    { 0x47B64800L, 0x4498BF87L },	/* 91.140625, 9.546759922 */
+    { 0x47D66000L, 0x44A5A676L },	/* 107.1875, 10.35313962 */
+    { 0x47FA0800L, 0x44B2E589L },	/* 125.015625, 11.18103864 */
+    { 0x4890B800L, 0x44C07A84L },	/* 144.71875, 12.02991064 */
+    { 0x48A66400L, 0x44CE6353L },	/* 166.390625, 12.89924901 */
+    { 0x48BE2000L, 0x44DC9E08L },	/* 190.125, 13.78858223 */
+    { 0x54F42400L, 0x4AFA0000L },	/* 1000000, 1000 */
+    { 0x58BC614EL, 0x4CDB9A44L },	/* 12345678, 3513.641701 */
+};
+
+struct pair exps[] = {
+    { 0xC5A00000L, 0x248DA433L },	/* -20, 2.061153622e-09 */
+    { 0xC5930000L, 0x26B3D41FL },	/* -18.375, 1.046740179e-08 */
+    { 0xC5860000L, 0x28E44FADL },	/* -16.75, 5.315785254e-08 */
+    { 0xC4F20000L, 0x2B90EEB9L },	/* -15.125, 2.699578503e-07 */
+    { 0xC4D80000L, 0x2DB801CCL },	/* -13.5, 1.370959086e-06 */
+    { 0xC4BE0000L, 0x2FE99DBEL },	/* -11.875, 6.962304723e-06 */
+    { 0xC4A40000L, 0x32944CD4L },	/* -10.25, 3.535750085e-05 */
+    { 0xC48A0000L, 0x34BC4853L },	/* -8.625, 0.0001795602054 */
+    { 0xC3E00000L, 0x36EF0B5DL },	/* -7, 0.0009118819656 */
+    { 0xC3AC0000L, 0x3997BEF6L },	/* -5.375, 0.004630918734 */
+    { 0xC2F00000L, 0x3BC0A84AL },	/* -3.75, 0.02351774586 */
+    { 0xC2880000L, 0x3DF49946L },	/* -2.125, 0.1194329683 */
+    { 0xC0800000L, 0x409B4598L },	/* -0.5, 0.6065306597 */
+    { 0x41900000L, 0x42C52246L },	/* 1.125, 3.080216849 */
+    { 0x42B00000L, 0x44FA4838L },	/* 2.75, 15.64263188 */
+    { 0x438C0000L, 0x479EE133L },	/* 4.375, 79.43983955 */
+    { 0x43C00000L, 0x49C9B6E3L },	/* 6, 403.4287935 */
+    { 0x43F40000L, 0x4C800C7DL },	/* 7.625, 2048.780465 */
+    { 0x44940000L, 0x4EA29243L },	/* 9.25, 10404.56572 */
+    { 0x44AE0000L, 0x50CE66BFL },	/* 10.875, 52838.74461 */
+    { 0x44C80000L, 0x53830629L },	/* 12.5, 268337.2865 */
+    { 0x44E20000L, 0x55A65949L },	/* 14.125, 1362729.184 */
+    { 0x44FC0000L, 0x57D3327CL },	/* 15.75, 6920509.832 */
+    { 0x458B0000L, 0x5A861188L },	/* 17.375, 35145248.88 */
+    { 0x45980000L, 0x5CAA36C8L },	/* 19, 178482301 */
+};
+
+struct pair logs[] = {
+    { 0x35800000L, 0xC4851592L },	/* 0.000244140625, -8.317766167 */
+    { 0x36840000L, 0xC3F300CCL },	/* 0.0005035400391, -7.593847327 */
+    { 0x37880000L, 0xC3DBDDFBL },	/* 0.001037597656, -6.870847184 */
+    { 0x388C0000L, 0xC3C4C241L },	/* 0.002136230469, -6.148712466 */
+    { 0x39900000L, 0xC3ADAD37L },	/* 0.00439453125, -5.427394409 */
+    { 0x3A940000L, 0xC3969E80L },	/* 0.009033203125, -4.706848254 */
+    { 0x3B980000L, 0xC2FF2B8CL },	/* 0.0185546875, -3.987032826 */
+    { 0x3C9C0000L, 0xC2D12571L },	/* 0.0380859375, -3.267910159 */
+    { 0x3DA00000L, 0xC2A32A1CL },	/* 0.078125, -2.549445171 */
+    { 0x3EA40000L, 0xC1EA720CL },	/* 0.16015625, -1.831605378 */
+    { 0x3FA80000L, 0xC18EA35FL },	/* 0.328125, -1.114360646 */
+    { 0x40AC0000L, 0xBFCB9D1AL },	/* 0.671875, -0.3976829677 */
+    { 0x41B00000L, 0x3FA30C5EL },	/* 1.375, 0.3184537311 */
+    { 0x42B40000L, 0x41845C87L },	/* 2.8125, 1.034073768 */
+    { 0x43B80000L, 0x41DFE5C8L },	/* 5.75, 1.749199855 */
+    { 0x44BC0000L, 0x429DAFC6L },	/* 11.75, 2.463853241 */
+    { 0x45C00000L, 0x42CB653CL },	/* 24, 3.17805383 */
+    { 0x46C40000L, 0x42F91395L },	/* 49, 3.891820298 */
+    { 0x47C80000L, 0x43935D8EL },	/* 100, 4.605170186 */
+    { 0x48CC0000L, 0x43AA2E0AL },	/* 204, 5.318119994 */
+    { 0x49D00000L, 0x43C0FB60L },	/* 416, 6.03068526 */
+    { 0x4AD40000L, 0x43D7C5AEL },	/* 848, 6.742880636 */
+    { 0x4BD80000L, 0x43EE8D11L },	/* 1728, 7.454719949 */
+    { 0x4CDC0000L, 0x4482A8D2L },	/* 3520, 8.166216269 */
+    { 0x4DE00000L, 0x448E09C2L },	/* 7168, 8.877381955 */
+};
+
+struct pair sins[] = {
+    { 0xC4A00000L, 0x408B44F8L },	/* -10, 0.5440211109 */
+    { 0xC4930000L, 0xBEF0B2F9L },	/* -9.1875, -0.235057729 */
+    { 0xC4860000L, 0xC0DE0835L },	/* -8.375, -0.8673127239 */
+    { 0xC3F20000L, 0xC0F533A3L },	/* -7.5625, -0.9578191473 */
+    { 0xC3D80000L, 0xBFE66C2DL },	/* -6.75, -0.4500440738 */
+    { 0xC3BE0000L, 0x3FAD7CA3L },	/* -5.9375, 0.3388415235 */
+    { 0xC3A40000L, 0x40EA8404L },	/* -5.125, 0.916076921 */
+    { 0xC38A0000L, 0x40EBCD7CL },	/* -4.3125, 0.9211042214 */
+    { 0xC2E00000L, 0x3FB399DCL },	/* -3.5, 0.3507832277 */
+    { 0xC2AC0000L, 0xBFE0965AL },	/* -2.6875, -0.4386470991 */
+    { 0xC1F00000L, 0xC0F43EF7L },	/* -1.875, -0.9540857816 */
+    { 0xC1880000L, 0xC0DFA29BL },	/* -1.0625, -0.8735749352 */
+    { 0xBF800000L, 0xBEFD5777L },	/* -0.25, -0.2474039593 */
+    { 0x40900000L, 0x40888686L },	/* 0.5625, 0.5333026735 */
+    { 0x41B00000L, 0x40FB1BCFL },	/* 1.375, 0.980893057 */
+    { 0x428C0000L, 0x40D0D792L },	/* 2.1875, 0.8157893133 */
+    { 0x42C00000L, 0x3E9081C3L },	/* 3, 0.1411200081 */
+    { 0x42F40000L, 0xC09F2788L },	/* 3.8125, -0.6216969291 */
+    { 0x43940000L, 0xC0FF05EAL },	/* 4.625, -0.9961840125 */
+    { 0x43AE0000L, 0xC0BF98D5L },	/* 5.4375, -0.7484257963 */
+    { 0x43C80000L, 0xBC87E6EEL },	/* 6.25, -0.03317921655 */
+    { 0x43E20000L, 0x40B3EA2EL },	/* 7.0625, 0.7027920599 */
+    { 0x43FC0000L, 0x40FFF186L },	/* 7.875, 0.9997791223 */
+    { 0x448B0000L, 0x40AC1A3CL },	/* 8.6875, 0.6722752757 */
+    { 0x44980000L, 0xBD99E8D5L },	/* 9.5, -0.07515112046 */
+    { 0x47C90000L, 0xBBFD9FC2L },	/* 100.5, -0.03095996678 */
+    { 0x4AFA1000L, 0x40F0B812L },	/* 1000.25, 0.9403086682 */
+};
+
+struct pair coss[] = {
+    { 0xC4A00000L, 0xC0D6CD64L },	/* -10, -0.8390715291 */
+    { 0xC4930000L, 0xC0F8D3C6L },	/* -9.1875, -0.9719814114 */
+    { 0xC4860000L, 0xBFFEDAE0L },	/* -8.375, -0.4977636376 */
+    { 0xC3F20000L, 0x3F932261L },	/* -7.5625, 0.2873716774 */
+    { 0xC3D80000L, 0x40E49C10L },	/* -6.75, 0.8930063447 */
+    { 0xC3BE0000L, 0x40F0DB1EL },	/* -5.9375, 0.940843463 */
+    { 0xC3A40000L, 0x3FCD5036L },	/* -5.125, 0.401002587 */
+    { 0xC38A0000L, 0xBFC75470L },	/* -4.3125, -0.3893160841 */
+    { 0xC2E00000L, 0xC0EFBBA0L },	/* -3.5, -0.9364566873 */
+    { 0xC2AC0000L, 0xC0E60E8BL },	/* -2.6875, -0.8986594029 */
+    { 0xC1F00000L, 0xBF995C75L },	/* -1.875, -0.2995335062 */
+    { 0xC1880000L, 0x3FF92F63L },	/* -1.0625, 0.4866896677 */
+    { 0xBF800000L, 0x40F80AA5L },	/* -0.25, 0.9689124217 */
+    { 0x40900000L, 0x40D88E82L },	/* 0.5625, 0.8459244992 */
+    { 0x41B00000L, 0x3EC73784L },	/* 1.375, 0.194547708 */
+    { 0x428C0000L, 0xC0940EB1L },	/* 2.1875, -0.5783491993 */
+    { 0x42C00000L, 0xC0FD7026L },	/* 3, -0.9899924966 */
+    { 0x42F40000L, 0xC0C88397L },	/* 3.8125, -0.7832578939 */
+    { 0x43940000L, 0xBDB2BEB3L },	/* 4.625, -0.08727779366 */
+    { 0x43AE0000L, 0x40A9C8B1L },	/* 5.4375, 0.6632185367 */
+    { 0x43C80000L, 0x40FFDBEBL },	/* 6.25, 0.9994494182 */
+    { 0x43E20000L, 0x40B61E01L },	/* 7.0625, 0.7113953335 */
+    { 0x43FC0000L, 0xBBAC2B77L },	/* 7.875, -0.02101681851 */
+    { 0x448B0000L, 0xC0BD8462L },	/* 8.6875, -0.7403012588 */
+    { 0x44980000L, 0xC0FF46ADL },	/* 9.5, -0.9971721562 */
+    { 0x47C90000L, 0x40FFE095L },	/* 100.5, 0.9995206253 */
+    { 0x4AFA1000L, 0x3FAE3ECAL },	/* 1000.25, 0.3403228006 */
+};
+
+struct pair tans[] = {
+    { 0xC1C00000L, 0xC4E19F6BL },	/* -1.5, -14.10141995 */
+    { 0xC1B00000L, 0xC3A1575FL },	/* -1.375, -5.041915256 */
+    { 0xC1A00000L, 0xC2C09CCAL },	/* -1.25, -3.009569674 */
+    { 0xC1900000L, 0xC285ECB0L },	/* -1.125, -2.092571276 */
+    { 0xC1800000L, 0xC1C75923L },	/* -1, -1.557407725 */
+    { 0xC0E00000L, 0xC199451DL },	/* -0.875, -1.197421629 */
+    { 0xC0C00000L, 0xC0EE7D1BL },	/* -0.75, -0.9315964599 */
+    { 0xC0A00000L, 0xC0B8B334L },	/* -0.625, -0.721484441 */
+    { 0xC0800000L, 0xC08BDA7BL },	/* -0.5, -0.5463024898 */
+    { 0xBFC00000L, 0xBFC9896CL },	/* -0.375, -0.3936265759 */
+    { 0xBF800000L, 0xBF82BC2DL },	/* -0.25, -0.2553419212 */
+    { 0xBE800000L, 0xBE80ABBDL },	/* -0.125, -0.1256551366 */
+    { 0x00000000L, 0x00000000L },	/* 0, 0 */
+    { 0x3E800000L, 0x3E80ABBDL },	/* 0.125, 0.1256551366 */
+    { 0x3F800000L, 0x3F82BC2DL },	/* 0.25, 0.2553419212 */
+    { 0x3FC00000L, 0x3FC9896CL },	/* 0.375, 0.3936265759 */
+    { 0x40800000L, 0x408BDA7BL },	/* 0.5, 0.5463024898 */
+    { 0x40A00000L, 0x40B8B334L },	/* 0.625, 0.721484441 */
+    { 0x40C00000L, 0x40EE7D1BL },	/* 0.75, 0.9315964599 */
+    { 0x40E00000L, 0x4199451DL },	/* 0.875, 1.197421629 */
+    { 0x41800000L, 0x41C75923L },	/* 1, 1.557407725 */
+    { 0x41900000L, 0x4285ECB0L },	/* 1.125, 2.092571276 */
+    { 0x41A00000L, 0x42C09CCAL },	/* 1.25, 3.009569674 */
+    { 0x41B00000L, 0x43A1575FL },	/* 1.375, 5.041915256 */
+    { 0x41C00000L, 0x44E19F6BL },	/* 1.5, 14.10141995 */
+};
+
+struct pair atans[] = {
+    { 0xC7D80000L, 0xC1C7E075L },	/* -108, -1.561537332 */
+    { 0xC7A66000L, 0xC1C785F8L },	/* -83.1875, -1.558775869 */
+    { 0xC6FA0000L, 0xC1C7039CL },	/* -62.5, -1.554797692 */
+    { 0xC6B64000L, 0xC1C640C8L },	/* -45.5625, -1.548851976 */
+    { 0xC6800000L, 0xC1C51030L },	/* -32, -1.539556493 */
+    { 0xC5AB8000L, 0xC1C3186DL },	/* -21.4375, -1.524182887 */
+    { 0xC4D80000L, 0xC1BF9905L },	/* -13.5, -1.496857289 */
+    { 0xC3FA0000L, 0xC1B8C43CL },	/* -7.8125, -1.443488585 */
+    { 0xC3800000L, 0xC1A9B465L },	/* -4, -1.325817664 */
+    { 0xC1D80000L, 0xC1849672L },	/* -1.6875, -1.035841253 */
+    { 0xC0800000L, 0xBFED6338L },	/* -0.5, -0.463647609 */
+    { 0xBD800000L, 0xBCFFAADEL },	/* -0.0625, -0.06241881 */
+    { 0x00000000L, 0x00000000L },	/* 0, 0 */
+    { 0x3D800000L, 0x3CFFAADEL },	/* 0.0625, 0.06241881 */
+    { 0x40800000L, 0x3FED6338L },	/* 0.5, 0.463647609 */
+    { 0x41D80000L, 0x41849672L },	/* 1.6875, 1.035841253 */
+    { 0x43800000L, 0x41A9B465L },	/* 4, 1.325817664 */
+    { 0x43FA0000L, 0x41B8C43CL },	/* 7.8125, 1.443488585 */
+    { 0x44D80000L, 0x41BF9905L },	/* 13.5, 1.496857289 */
+    { 0x45AB8000L, 0x41C3186DL },	/* 21.4375, 1.524182887 */
+    { 0x46800000L, 0x41C51030L },	/* 32, 1.539556493 */
+    { 0x46B64000L, 0x41C640C8L },	/* 45.5625, 1.548851976 */
+    { 0x46FA0000L, 0x41C7039CL },	/* 62.5, 1.554797692 */
+    { 0x47A66000L, 0x41C785F8L },	/* 83.1875, 1.558775869 */
+    { 0x47D80000L, 0x41C7E075L },	/* 108, 1.561537332 */
+};
+
+
+/* The old versions, for comparison */
+
+double old_poly(x, d, n)
+double x;
+double *d;
+int n;
+{
+    int i;
+    double res;
+
+    res = d[i = n];
+    while (i)
+        res = x * res + d[--i];
+    return res;
+}
+
+double old_sqrt(x)
+double x;
+{
+    double og, ng;
+    short niter;
+    int exp;
+
+    if (x <= 0.0)
+        return 0.0;
+    og = x;
+    if (og < 1.0)
+        og = 1.0 / og;
+    og = frexp(og, &exp);
+    og = ldexp(og, exp / 2);
+    if (x < 1.0)
+        og = 1.0 / og;
+    for (niter = 0; niter < 20; niter++) {
+        ng = (x / og + og) / 2.0;
+        if (ng == og)
+            break;
+        og = ng;
+    }
+    return og;
+}
+
+double old_exp(x)
+double x;
+{
+    int exp;
+    char sign;
+    static double coeff[] = {
+        1.0000000000e+00, 6.9314718056e-01, 2.4022650695e-01,
+        5.5504108945e-02, 9.6181261779e-03, 1.3333710529e-03,
+        1.5399104432e-04, 1.5327675257e-05, 1.2485143336e-06,
+        1.3908092221e-07,
+    };
+
+    if (x == 0.0)
+        return 1.0;
+    sign = x < 0.0;
+    if (sign)
+        x = -x;
+    x *= 1.4426950409;
+    exp = (int)floor(x);
+    x -= (double)exp;
+    x = ldexp(old_poly(x, coeff, 9), exp);
+    if (sign)
+        return 1.0 / x;
+    return x;
+}
+
+double old_log(x)
+double x;
+{
+    int exp;
+    static double coeff[] = {
+        0.0000000000, 0.9999964239, -0.4998741238, 0.3317990258,
+        -0.2407338084, 0.1676540711, -0.0953293897, 0.0360884937,
+        -0.0064535442,
+    };
+
+    if (x <= 0.0)
+        return 0.0;
+    x = frexp(x, &exp) * 2.0 - 1.0;
+    exp--;
+    x = old_poly(x, coeff, 8);
+    return x + 0.69314718055995 * exp;
+}
+
+double old_sin(f)
+double f;
+{
+    static double coeff_a[] = {
+        207823.68416961012, -76586.415638846949, 7064.1360814006881,
+        -237.85932457812158, 2.8078274176220686
+    };
+    static double coeff_b[] = {
+        132304.66650864931, 5651.6867953169177, 108.99981103712905, 1.0
+    };
+    double x2;
+    int sgn;
+
+    sgn = 0;
+    if (f < 0.0) {
+        f = -f;
+        sgn = 1;
+    }
+    f *= 1.0 / 6.28318530717958;
+    f = 4.0 * (f - floor(f));
+    if (f > 2.0) {
+        f -= 2.0;
+        sgn = !sgn;
+    }
+    if (f > 1.0)
+        f = 2.0 - f;
+    x2 = f * f;
+    f *= old_poly(x2, coeff_a, 4) / old_poly(x2, coeff_b, 3);
+    if (sgn)
+        return -f;
+    return f;
+}
+
+double old_cos(f)
+double f;
+{
+    if (f > 3.14159265358979)
+        return old_sin(f - (3.14159265358979 + 1.570796326794895));
+    return old_sin(f + 1.570796326794895);
+}
+
+double old_tan(x)
+double x;
+{
+    return old_sin(x) / old_cos(x);
+}
+
+double old_atan(f)
+double f;
+{
+    static double coeff_a[] = {
+        33.058618473989548, 58.655751569001961, 32.390974856200445,
+        5.8531952112628600, 0.19523741936234277, -.0024346033004411264
+    };
+    static double coeff_b[] = {
+        33.058618473992416, 69.675291059524653, 49.004348218216250,
+        12.975578862709239, 1.0
+    };
+    int recip;
+    double val, val_squared;
+
+    if ((val = fabs(f)) == 0.0)
+        return 0.0;
+    if (recip = (val > 1.0))
+        val = 1.0 / val;
+    val_squared = val * val;
+    val *= old_poly(val_squared, coeff_a, 5) / old_poly(val_squared, coeff_b, 4);
+    if (recip)
+        val = 1.570796326794895 - val;
+    return f < 0.0 ? -val : val;
+}
+
+typedef double (*func)();
+
+struct test {
+    char *name;
+    func fn, old;
+    struct pair *p;
+    int n;
+} tests[] = {
+    { "sqrt", sqrt, old_sqrt, sqrts, sizeof(sqrts) / sizeof(sqrts[0]) },
+    { "exp", exp, old_exp, exps, sizeof(exps) / sizeof(exps[0]) },
+    { "log", log, old_log, logs, sizeof(logs) / sizeof(logs[0]) },
+    { "sin", sin, old_sin, sins, sizeof(sins) / sizeof(sins[0]) },
+    { "cos", cos, old_cos, coss, sizeof(coss) / sizeof(coss[0]) },
+    { "tan", tan, old_tan, tans, sizeof(tans) / sizeof(tans[0]) },
+    { "atan", atan, old_atan, atans, sizeof(atans) / sizeof(atans[0]) },
+};
+
+#define NTESTS	(sizeof(tests) / sizeof(tests[0]))
+
+/* A float has 24 bits of mantissa, so one rounding can be out by 2^-23
+ * of the result, or 1.2e-7. The arithmetic truncates and keeps no guard
+ * bits, and a few steps of it are allowed to add up to a little more. */
+
+#define BOUND	1e-6
+
+double maxerr(func fn, struct pair *p, int n)
+{
+    double e, max = 0.0;
+
+    while (n--) {
+        e = fabs((*fn)(ARG(p)) - RES(p));
+        if (fabs(RES(p)) > 1.0)
+            e /= fabs(RES(p));
+        if (e > max)
+            max = e;
+        p++;
+    }
+    return max;
+}
+
+struct test *cur;
+func curfn;
+
+int pass()
+{
+    struct pair *p;
+    int n;
+
+    for (p = cur->p, n = cur->n; n--; p++)
+        (*curfn)(ARG(p));
+    return 0;
+}
+
+/* T-states a call of fn takes, over the arguments in cur's table */
+
+long count(func fn)
+{
+    unsigned long t;
+
+    curfn = fn;
+    t = tstates();
+    pass();
+    return since(t) / cur->n;
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+    long o, n;
+
+    for (i = 0; i < NTESTS; i++)
+        check(tests[i].name, maxerr(tests[i].fn, tests[i].p, tests[i].n) < BOUND);
+    if (argc > 1) {
+        printf("\n        max error            T-states\n");
+        printf("        old       new         old     new\n");
+        for (i = 0; i < NTESTS; i++) {
+            cur = &tests[i];
+            o = count(cur->old);
+            n = count(cur->fn);
+            printf("%-6s %9.2e %9.2e %7ld %7ld\n", cur->name,
+                   maxerr(cur->old, cur->p, cur->n),
+                   maxerr(cur->fn, cur->p, cur->n), o, n);
+        }
+    }
+    return bad;
+}
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <string.h>
+#include "testutil.h"
+
+/* memcpy() and friends, and the strstr() family. With an argument, also
+ * time them against the byte-at-a-time C loops they replaced:
+ *
+ *	zxcc testmem t
+ */
+
+#define LEN 1024
+
+char a[LEN + 16], b[LEN + 16];
+char text[] = "The quick brown fox jumps over the lazy dog; "
+              "the QUICK brown FOX jumps over the LAZY dog.";
+
+/* The old C versions, for comparison */
+
+char *old_memcpy(char *d, char *s, unsigned n)
+{
+    char *p = d;
+
+    while (n--)
+        *p++ = *s++;
+    return d;
+}
+
+char *old_memset(char *d, int c, unsigned n)
+{
+    char *p = d;
+
+    while (n--)
+        *p++ = c;
+    return d;
+}
+
+int old_memcmp(char *s1, char *s2, unsigned n)
+{
+    short i;
+
+    while (n--)
+        if (i = *s1++ - *s2++)
+            return i;
+    return 0;
+}
+
+char *old_strstr(char *t, char *s)
+{
+    char *t1, *s1;
+
+    do {
+        t1 = t;
+        s1 = s;
+        while (*s1) {
+            if (*s1 != *t1++)
+                break;
+            ++s1;
+        }
+        if (!*s1)
+            return t;
+    } while (*t++);
+    return (char *)0;
+}
+
+int sign(int n)
+{
+    return n < 0 ? -1 : n > 0;
+}
+
+void fill(char *p)
+{
+    int i;
+
+    for (i = 0; i < LEN + 16; i++)
+        p[i] = i * 7 + (i >> 8);
+}
+
+void tests(void)
+{
+    int i, ok;
+
+    fill(a);
+    memset(b, 0, sizeof(b));
+    check("memcpy", memcpy(b + 1, a, LEN) == b + 1 && !b[0]
+                    && !old_memcmp(a, b + 1, LEN) && !b[LEN + 1]);
+    check("memcpy 0", memcpy(b, a + 1, 0) == b && !b[0]);
+
+    fill(a);
+    check("memmove up", memmove(a + 3, a, LEN) == a + 3);
+    fill(b);
+    check("memmove up data", !old_memcmp(a + 3, b, LEN) && !old_memcmp(a, b, 3));
+    fill(a);
+    check("memmove down", memmove(a, a + 3, LEN) == a);
+    check("memmove down data", !old_memcmp(a, b + 3, LEN));
+
+    fill(a);
+    check("memset", memset(a + 1, 0x55, LEN) == a + 1 && a[0] == b[0]
+                    && a[LEN + 1] == b[LEN + 1]);
+    for (ok = 1, i = 1; i <= LEN; i++)
+        if (a[i] != 0x55)
+            ok = 0;
+    check("memset data", ok);
+    memset(a, 0x33, 1);
+    check("memset 1", a[0] == 0x33 && a[1] == 0x55);
+    check("memset 0", memset(a, 0, 0) == a && a[0] == 0x33);
+
+    fill(a);
+    fill(b);
+    check("memcmp equal", !memcmp(a, b, LEN));
+    b[LEN - 1] ^= 1;
+    check("memcmp last", sign(memcmp(a, b, LEN)) == sign((unsigned char)a[LEN - 1]
+                                                    - (unsigned char)b[LEN - 1]));
+    a[0] = 0x7F;
+    b[0] = 0x80;
+    check("memcmp unsigned", memcmp(a, b, LEN) < 0 && memcmp(b, a, LEN) > 0);
+    check("memcmp 0", !memcmp(a, b, 0));
+
+    check("memchr", memchr(text, 'q', sizeof(text)) == text + 4);
+    check("memchr last", memchr(text, '.', sizeof(text) - 1) == text + sizeof(text) - 2);
+    check("memchr none", !memchr(text, 'q', 4) && !memchr(text, 'T', 0));
+    check("memchr nul", memchr(text, 0, sizeof(text)) == text + sizeof(text) - 1);
+
+    check("strstr", strstr(text, "fox") == text + 16 && strstr(text, "FOX") == text + 61);
+    check("strstr ends", strstr(text, "The") == text && strstr(text, "dog.") == text + sizeof(text) - 5);
+    check("strstr none", !strstr(text, "cat") && !strstr(text, "dog.x") && !strstr("ab", "abc"));
+    check("strstr empty", strstr(text, "") == text && !strstr("", "a"));
+    check("strnstr", strnstr(text, "fox", 19) == text + 16 && !strnstr(text, "fox", 18));
+    check("strnstr nul", !strnstr("xy\0ab", "ab", 5) && !strnstr("", "a", 5));
+    check("stristr", stristr(text, "QUICK") == text + 4 && stristr(text, "lazy DOG.") == text + 80);
+    check("stristr none", !stristr(text, "cat") && stristr(text, ";") == text + 43);
+    check("strnistr", strnistr(text, "fox", 19) == text + 16 && !strnistr(text + 20, "fox", 43));
+    check("strnistr end", strnistr(text + 20, "FOX", 44) == text + 61);
+}
+
+int b_memcpy()     { return (int)memcpy(b, a, LEN); }
+int b_old_memcpy() { return (int)old_memcpy(b, a, LEN); }
+int b_memset()     { return (int)memset(b, 0, LEN); }
+int b_old_memset() { return (int)old_memset(b, 0, LEN); }
+int b_memcmp()     { return (int)memcmp(a, b, LEN); }
+int b_old_memcmp() { return (int)old_memcmp(a, b, LEN); }
+int b_strstr()     { return (int)strstr(a, "zebra"); }
+int b_old_strstr() { return (int)old_strstr(a, "zebra"); }
+
+void compare(char *what, bench cfn, bench fn)
+{
+    long c, n;
+
+    c = rate(cfn, 1);
+    n = rate(fn, 1);
+    printf("%-7s %5ld/s in C, %6ld/s now: %ld.%ld times faster\n",
+           what, c, n, n / c, n * 10 / c % 10);
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+
+    tests();
+    if (argc > 1) {
+        printf("\n%d bytes at a time:\n", LEN);
+        fill(a);
+        fill(b);
+        compare("memcpy", b_old_memcpy, b_memcpy);
+        compare("memset", b_old_memset, b_memset);
+        fill(b);
+        compare("memcmp", b_old_memcmp, b_memcmp);
+        for (i = 0; i < LEN; i++)
+            a[i] = text[i % (sizeof(text) - 1)];
+        a[LEN] = 0;
+        compare("strstr", b_old_strstr, b_strstr);
+    }
+    return bad;
+}
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+#include <unixio.h>
+
+/* read() and write() across sector boundaries: pieces that start and end
+ * inside a sector, and runs of whole sectors that go straight to and from
+ * the caller's buffer */
+
+#define LEN 5000
+
+char out[LEN], in[LEN];
+
+int check(char *what, char *want, int n, int got)
+{
+    int i;
+
+    if (got != n) {
+        printf("%s: %d bytes, not %d\n", what, got, n);
+        return 1;
+    }
+    for (i = 0; i < n; i++)
+        if (in[i] != want[i]) {
+            printf("%s: differs at %d\n", what, i);
+            return 1;
+        }
+    printf("%s: ok\n", what);
+    return 0;
+}
+
+int main()
+{
+    int fd, i, n, bad = 0;
+    FILE *f;
+
+    for (i = 0; i < LEN; i++)
+        out[i] = i * 7 + (i >> 8);
+
+    fd = creat("testrw.dat", 0);
+    write(fd, out, 100);            /* Part of a sector */
+    write(fd, out + 100, 3000);     /* Rest of it, 23 sectors, a part */
+    write(fd, out + 3100, LEN - 3100);
+    close(fd);
+
+    fd = open("testrw.dat", 0);
+    n = read(fd, in, 1);
+    n += read(fd, in + 1, 4000);
+    n += read(fd, in + 4001, LEN - 4001);
+    bad += check("read", out, LEN, n);
+    lseek(fd, 256L, 0);
+    bad += check("seek+read", out + 256, 2048, read(fd, in, 2048));
+    close(fd);
+
+    f = fopen("testrw.dat", "rb");
+    bad += check("fread", out, LEN, fread(in, 1, LEN, f));
+    fclose(f);
+
+    /* Overwrite whole sectors in the middle of the file */
+    fd = open("testrw.dat", 2);
+    lseek(fd, 128L, 0);
+    for (i = 0; i < 1024; i++)
+        out[128 + i] = ~out[128 + i];
+    write(fd, out + 128, 1024);
+    lseek(fd, 0L, 0);
+    bad += check("update", out, LEN, read(fd, in, LEN));
+    close(fd);
+    unlink("testrw.dat");
+
+    return bad;
+}
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testutil.h"
+
+/* qsort() on ints, longs, chars and bigger records, in random, sorted,
+ * reversed and equal orders, and on input chosen to make quicksort go
+ * quadratic. With an argument, also count the comparisons, and the
+ * T-states a sort takes under zxcc, against the quicksort it replaced:
+ *
+ *	zxcc testsort t
+ */
+
+#define N	1000
+
+int a[N], work[N], val[N];
+long ncmp;
+
+/* The old quicksort, for comparison */
+
+extern void bmove(void *, void *, unsigned);
+extern void _swap(unsigned, void *, void *);
+
+void oldsort(void *vbase, unsigned nel, unsigned width, __qsort_compf compar)
+{
+    char *base = vbase, *x;
+    int i, j, l, r;
+    struct {
+        int l, r;
+    } stack[20];
+    int s;
+    char xbuf[800];
+
+    if (width < sizeof xbuf)
+        x = xbuf;
+    else if (!(x = malloc(width + 1)))
+        return;
+    x[width] = 0;
+    s = 0;
+    stack[0].l = 0;
+    stack[0].r = nel - 1;
+    do {
+        l = stack[s].l;
+        r = stack[s--].r;
+        do {
+            i = l;
+            j = r;
+            bmove(base + width * ((i + j) / 2), x, width);
+            do {
+                while ((*compar)(base + i * width, x) < 0)
+                    i++;
+                while ((*compar)(x, base + j * width) < 0)
+                    j--;
+                if (i <= j) {
+                    _swap(width, base + i * width, base + j * width);
+                    i++;
+                    j--;
+                }
+            } while (i <= j);
+            if (j - l < r - i) {
+                if (i < r) {
+                    stack[++s].l = i;
+                    stack[s].r = r;
+                }
+                r = j;
+            } else {
+                if (l < j) {
+                    stack[++s].l = l;
+                    stack[s].r = j;
+                }
+                l = i;
+            }
+        } while (l < r);
+    } while (s >= 0);
+    if (x != xbuf)
+        free(x);
+}
+
+typedef void (*sorter)(void *, size_t, size_t, __qsort_compf);
+
+int icmp(void *x, void *y)
+{
+    ++ncmp;
+    return *(int *)x - *(int *)y;
+}
+
+int lcmp(void *x, void *y)
+{
+    return *(long *)x < *(long *)y ? -1 : *(long *)x > *(long *)y;
+}
+
+int ccmp(void *x, void *y)
+{
+    return *(char *)x - *(char *)y;
+}
+
+/* McIlroy's adversary: the array being sorted holds indexes into val[],
+ * whose values are only fixed when the sort compares them, always so as
+ * to make the pivot as bad as it can be. What they end up as is an input
+ * that drives that sort to its worst case. */
+
+int gas, nsolid, candidate;
+
+int acmp(void *px, void *py)
+{
+    int x = *(int *)px, y = *(int *)py;
+
+    if (val[x] == gas && val[y] == gas) {
+        if (x == candidate)
+            val[x] = nsolid++;
+        else
+            val[y] = nsolid++;
+    }
+    if (val[x] == gas)
+        candidate = x;
+    else if (val[y] == gas)
+        candidate = y;
+    return val[x] - val[y];
+}
+
+void killer(sorter sort, int n)
+{
+    int i;
+
+    gas = n;
+    nsolid = candidate = 0;
+    for (i = 0; i < n; i++) {
+        work[i] = i;
+        val[i] = gas;
+    }
+    (*sort)(work, n, sizeof(int), acmp);
+    for (i = 0; i < n; i++)
+        a[i] = val[i];
+}
+
+#define RANDOM	0
+#define SORTED	1
+#define REVERSE	2
+#define EQUAL	3
+#define PIPE	4
+
+void make(int kind, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        switch (kind) {
+        case RANDOM:  a[i] = rnd() & 0x7FFF; break;
+        case SORTED:  a[i] = i; break;
+        case REVERSE: a[i] = n - i; break;
+        case EQUAL:   a[i] = 42; break;
+        case PIPE:    a[i] = i < n / 2 ? i : n - i; break;
+        }
+}
+
+/* Sort a copy of a[], checking that it comes out in order and that the
+ * sum of the elements is what it was */
+
+int sorted(sorter sort, int n)
+{
+    int i;
+    unsigned s1 = 0, s2 = 0;
+
+    memcpy(work, a, n * sizeof(int));
+    (*sort)(work, n, sizeof(int), icmp);
+    for (i = 0; i < n; i++) {
+        s1 += a[i];
+        s2 += work[i];
+        if (i && work[i - 1] > work[i])
+            return 0;
+    }
+    return s1 == s2;
+}
+
+struct rec {
+    int key;
+    char name[4];
+};
+
+int rcmp(void *x, void *y)
+{
+    return ((struct rec *)x)->key - ((struct rec *)y)->key;
+}
+
+void tests(void)
+{
+    static char *kinds[] = { "random", "sorted", "reversed", "equal", "organ pipe" };
+    static char what[40];
+    static long l[300];
+    static char c[300];
+    static struct rec r[200];
+    int i, ok;
+    long n;
+
+    for (i = RANDOM; i <= PIPE; i++) {
+        make(i, N);
+        sprintf(what, "%s ints", kinds[i]);
+        check(what, sorted(qsort, N));
+    }
+    make(RANDOM, N);
+    check("0 and 1 element", (qsort(a, 0, sizeof(int), icmp), 1) && sorted(qsort, 1));
+    for (i = 2; i < 20; i++)
+        if (!sorted(qsort, i))
+            break;
+    check("2 to 19 elements", i == 20);
+
+    for (i = 0; i < 300; i++)
+        l[i] = (long)rnd() << 8 ^ rnd();
+    qsort(l, 300, sizeof(long), lcmp);
+    for (i = 1; i < 300 && l[i - 1] <= l[i]; i++)
+        ;
+    check("longs", i == 300);
+
+    for (i = 0; i < 300; i++)
+        c[i] = rnd() & 0x7F;
+    qsort(c, 300, 1, ccmp);
+    for (i = 1; i < 300 && c[i - 1] <= c[i]; i++)
+        ;
+    check("chars", i == 300);
+
+    for (i = 0; i < 200; i++) {
+        r[i].key = rnd() % 50;
+        sprintf(r[i].name, "%03d", r[i].key);
+    }
+    qsort(r, 200, sizeof(struct rec), rcmp);
+    for (ok = 1, i = 0; i < 200; i++) {
+        if (i && r[i - 1].key > r[i].key)
+            ok = 0;
+        if (atoi(r[i].name) != r[i].key)
+            ok = 0;
+    }
+    check("records", ok);
+
+    /* About N*N/4 comparisons would be quadratic */
+    killer(qsort, N);
+    ncmp = 0;
+    ok = sorted(qsort, N);
+    n = ncmp;
+    check("killer input", ok && n < 50000L);
+}
+
+/* Sort a copy of a[], returning the T-states it took and leaving the
+ * number of comparisons in ncmp */
+
+long count(sorter sort)
+{
+    unsigned long t;
+
+    memcpy(work, a, sizeof(a));
+    ncmp = 0;
+    t = tstates();
+    (*sort)(work, N, sizeof(int), icmp);
+    return since(t);
+}
+
+void compare(char *what)
+{
+    long oc, nc, ot, nt;
+
+    ot = count(oldsort);
+    oc = ncmp;
+    nt = count(qsort);
+    nc = ncmp;
+    printf("%-11s %7ld %6ld %9ld %9ld\n", what, oc, nc, ot, nt);
+}
+
+int main(int argc, char **argv)
+{
+    tests();
+    if (argc > 1) {
+        printf("\n%d ints:   comparisons     T-states a sort\n", N);
+        printf("%-11s %7s %6s %9s %9s\n", "", "old", "new", "old", "new");
+        make(RANDOM, N);
+        compare("random");
+        make(SORTED, N);
+        compare("sorted");
+        make(REVERSE, N);
+        compare("reversed");
+        make(EQUAL, N);
+        compare("equal");
+        make(PIPE, N);
+        compare("organ pipe");
+        killer(oldsort, N);
+        compare("old killer");
+        killer(qsort, N);
+        compare("new killer");
+    }
+    return bad;
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <time.h>
+#include <sys.h>
+#include "testutil.h"
+
+#define TSTATES 0xE4    /* zxcc's T-state count (see zxstats.h in zxcc) */
+
+int bad;
+unsigned seed = 1;
+
+void check(char *what, int ok)
+{
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok)
+        ++bad;
+}
+
+unsigned rnd(void)
+{
+    seed ^= seed << 7;
+    seed ^= seed >> 9;
+    seed ^= seed << 8;
+    return seed;
+}
+
+/* Call fn, which does ops operations, over and over for two seconds from
+ * the next tick of the clock. Returns operations per second */
+
+long rate(bench fn, int ops)
+{
+    long n = 0;
+    time_t t, end;
+
+    t = time((time_t *)0);
+    while (time((time_t *)0) == t)
+        ;
+    end = t + 3;
+    do {
+        fn();
+        n += ops;
+    } while (time((time_t *)0) < end);
+    return n / 2;
+}
+
+/* zxcc's count of T-states so far. Reading the first port latches it */
+
+unsigned long tstates(void)
+{
+    unsigned long t;
+
+    t = inp(TSTATES);
+    t |= (unsigned long)inp(TSTATES + 1) << 8;
+    t |= (unsigned long)inp(TSTATES + 2) << 16;
+    t |= (unsigned long)inp(TSTATES + 3) << 24;
+    return t;
+}
+
+/* T-states since start, a count from tstates(), less those taken to read
+ * the count */
+
+long since(unsigned long start)
+{
+    unsigned long t, u;
+
+    t = tstates();
+    u = tstates();
+    return t - start - (u - t);
+}
@@ -0,0 +1,18 @@
+/* What the tests of the library have in common. check() prints how a
+ * case went and counts the failures in bad, for main() to return. rnd()
+ * is a 16 bit xorshift, as rand() spends longer in its long multiply than
+ * most of what is being tested. rate() times a benchmark by the clock for
+ * the tests that take an argument. tstates() and since() count the
+ * T-states one takes under zxcc instead, which come out the same on every
+ * run. */
+
+extern int bad;
+extern unsigned seed;
+
+typedef int (*bench)();
+
+extern void check(char *what, int ok);
+extern unsigned rnd(void);
+extern long rate(bench fn, int ops);
+extern unsigned long tstates(void);
+extern long since(unsigned long start);
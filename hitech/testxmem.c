@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <string.h>
+#include <xmem.h>
+#include "testutil.h"
+
+/* Expanded memory under zxcc. Run with ZXCC_XMEM=0 to see it missing. */
+
+#define LEN 1000
+
+char a[LEN], b[LEN];
+
+int main()
+{
+    unsigned pages, i;
+    int ok;
+    long top;
+
+    pages = xmpages();
+    printf("%u pages of expanded memory\n", pages);
+    if (!pages) {
+        check("none", xmput(0L, a, LEN) == -1 && xmget(b, 0L, LEN) == -1);
+        return bad;
+    }
+    top = (long)pages * XMPAGE;
+
+    for (i = 0; i < LEN; i++)
+        a[i] = i * 7;
+    /* Straddling the first page boundary, and at the very end */
+    check("put", !xmput(XMPAGE - LEN / 2, a, LEN) && !xmput(top - LEN, a, LEN));
+    memset(b, 0, LEN);
+    check("get across pages", !xmget(b, XMPAGE - LEN / 2, LEN) && !memcmp(a, b, LEN));
+    memset(b, 0, LEN);
+    check("get at end", !xmget(b, top - LEN, LEN) && !memcmp(a, b, LEN));
+
+    /* Memory never written to reads as zeroes */
+    memset(b, 1, LEN);
+    ok = !xmget(b, (long)XMPAGE + LEN, LEN);
+    for (i = 0; i < LEN; i++)
+        if (b[i])
+            ok = 0;
+    check("unwritten", ok);
+
+    /* Past the end */
+    check("past end", xmput(top - LEN + 1, a, LEN) == -1 && xmget(b, top, 1) == -1);
+    return bad;
+}
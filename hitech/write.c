@@ -5,8 +5,9 @@ extern char _piped; /* PIPEMGR loaded? */
 write(uchar fd, char *buf, ushort nbytes)
 {
     register struct fcb *fc;
-    uchar   size, offs, luid;
-    short   c;
+    uchar   offs, luid, nrec, single;
+    ushort  size;
+    short   c, err;
     ushort  count;
     char    RSXPB[4];
     char    buffer[SECSIZE];
@@ -56,17 +57,24 @@ write(uchar fd, char *buf, ushort nbytes)
         return count;   
     case U_WRITE:
     case U_RDWR:
+        if (fc->host)
+            return _zxio(fc, ZXHWRITE, buf, nbytes);
         luid = getuid();
+        single = 0;
         while (nbytes)
         {
             _sigchk();
-            setuid(fc->uid);
+            if (fc->uid != luid)
+                setuid(fc->uid);
             offs = fc->rwp%SECSIZE;
-            if ((size = SECSIZE - offs) > nbytes)
-                size = nbytes;
             _putrno(fc->ranrec, fc->rwp/SECSIZE);
-            if (size == SECSIZE)
+            nrec = 0;
+            if (!offs && nbytes >= SECSIZE)
             {
+                /* Whole sectors go straight from the caller, as many at
+                 * a time as the BDOS will take */
+                nrec = single ? 1 : _msect(nbytes);
+                size = nrec*SECSIZE;
                 bdos(CPMSDMA, buf);
 #ifdef  LARGE_MODEL
                 bdos(CPMDSEG, (int)((long)buf >> 16));  /* set DMA segment */
@@ -74,6 +82,8 @@ write(uchar fd, char *buf, ushort nbytes)
             }
             else
             {
+                if ((size = SECSIZE - offs) > nbytes)
+                    size = nbytes;
                 bdos(CPMSDMA, buffer);
 #ifdef  LARGE_MODEL
                 bdos(CPMDSEG, (int)((long)buffer >> 16));   /* set DMA segment */
@@ -83,16 +93,26 @@ write(uchar fd, char *buf, ushort nbytes)
                 bdos(CPMRRAN, fc);
                 bmove(buf, buffer+offs, size);
             }
-            if (bdos(CPMWRAN, fc))
-                break;
+            err = bdos(CPMWRAN, fc);
+            if (nrec > 1)
+                bdos(CPMSMSC, 1);
+            if (err)
+            {
+                if (nrec < 2)
+                    break;
+                single = 1;     /* Go over them one at a time */
+                size = 0;
+            }
             buf += size;
             fc->rwp += size;
             if (fc->fsize < fc->rwp)
                 fc->fsize = fc->rwp;
             nbytes -= size;
-            setuid(luid);
+            if (fc->uid != luid)
+                setuid(luid);
         }
-        setuid(luid);
+        if (fc->uid != luid)
+            setuid(luid);
         return count-nbytes;
 
     default:
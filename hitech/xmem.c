@@ -0,0 +1,69 @@
+#include    <cpm.h>
+#include    <sys.h>
+#include    <xmem.h>
+
+/*
+    Expanded memory through zxcc's I/O ports (see zxmem.h in zxcc).
+    Each command is given the address of a parameter block, and status
+    is read back from the command port.  The ports are only touched
+    once the start-up code has found zxcc (by the time main() runs,
+    the stack has overwritten the serial number it looks for), and the
+    rest only once the ID port has answered.
+*/
+
+#define XMPBLO  0xE0        /* Parameter block address, low byte */
+#define XMPBHI  0xE1        /* and high byte */
+#define XMCMD   0xE2        /* Command out, status in */
+#define XMID    0xE3        /* Reads as XMIDBYTE */
+#define XMIDBYTE 0x58
+
+#define XMINFO  1           /* Commands */
+#define XMPUT   2
+#define XMGET   3
+
+static struct {
+    char *      addr;
+    unsigned    len;
+    long        off;
+} pb;
+
+static char checked;
+static unsigned pages;
+
+static int xmcmd(int cmd)
+{
+    outp(XMPBLO, (unsigned)&pb & 0xFF);
+    outp(XMPBHI, (unsigned)&pb >> 8);
+    outp(XMCMD, cmd);
+    return inp(XMCMD) ? -1 : 0;
+}
+
+unsigned xmpages(void)
+{
+    if (!checked) {
+        checked = 1;
+        if (_zxhost && inp(XMID) == XMIDBYTE && !xmcmd(XMINFO))
+            pages = pb.len;
+    }
+    return pages;
+}
+
+static int xmcopy(int cmd, char *addr, long off, unsigned n)
+{
+    if (!xmpages())
+        return -1;
+    pb.addr = addr;
+    pb.len = n;
+    pb.off = off;
+    return xmcmd(cmd);
+}
+
+int xmput(long off, void *from, unsigned n)
+{
+    return xmcopy(XMPUT, from, off, n);
+}
+
+int xmget(void *to, long off, unsigned n)
+{
+    return xmcopy(XMGET, to, off, n);
+}
@@ -0,0 +1,20 @@
+#ifndef _HTC_XMEM_H
+#define _HTC_XMEM_H
+
+/*
+ *	Expanded memory under zxcc: a pool of host memory that blocks
+ *	of the program's memory can be copied into and back out of.
+ *
+ *	xmpages() gives the size of the pool in XMPAGE-byte pages, or 0
+ *	if there is none.  xmput() and xmget() copy n bytes to and from
+ *	offset off in the pool, returning 0, or -1 if there is no pool or
+ *	the copy would run past its end.  The pool starts out as zeroes.
+ */
+
+#define	XMPAGE	16384
+
+extern unsigned	xmpages(void);
+extern int	xmput(long off, void *from, unsigned n);
+extern int	xmget(void *to, long off, unsigned n);
+
+#endif
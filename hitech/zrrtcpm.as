@@ -12,7 +12,7 @@
 	psect	cpm
 	defs	100h		;Base of CP/M's TPA
 	global	start,_main,_exit,__Lbss,__Hstack, __z3env
-	global	__piped,__initrsx,__exact
+	global	__piped,__initrsx,__exact,__zxhost
 
 
 reloc:		; DOS Protection	8080/Z80	x86
@@ -160,8 +160,39 @@ memok:
  	xor	a		; CP/M 2.2 has no RSX
  	jr	norsx
 
-    ;If the PIPEMGR RSX is loaded, initialise it.
 iscpm3:
+
+;Under zxcc 05 or later, do file I/O with its host file calls.
+
+	ld	hl,(6)
+	ld	l,0		;The BDOS page starts with a serial number
+	ld	de,zxsgn
+	ld	b,4		;Check 4 characters
+zxcmp:	ld	a,(de)
+	cp	(hl)
+	jr	nz,nozx
+	inc	hl
+	inc	de
+	djnz	zxcmp
+	ld	a,(hl)		;Then two digits of version
+	inc	hl
+	ld	l,(hl)
+	ld	h,a
+	ld	de,3035h	;'05'
+	and	a
+	sbc	hl,de
+	jr	c,nozx
+	ld	c,0D0h		;Probe for the host file calls
+	call	5
+	ld	de,5A58h	;Magic number
+	and	a
+	sbc	hl,de
+	jr	nz,nozx
+	ld	a,1
+	ld	(__zxhost),a
+nozx:
+
+    ;If the PIPEMGR RSX is loaded, initialise it.
 	ld	c,3Ch
 	ld	de,rsxpb
 	call	5
@@ -237,9 +268,12 @@ __piped:
         defw    0
 __exact:		; Exact file size mode
 	defb	'C',0	; 'C' is CP/M 2 (none), 'I' is ISIS, 'D' is DOSPLUS
+__zxhost:		; zxcc host file calls found
+	defb	0
 rsxpb:	defb	79h,1
 	defw	pipesgn
 pipesgn:
 	defm	'PIPEMGR '
+zxsgn:	defm	'ZXCC'
 
 	end	reloc
@@ -0,0 +1,60 @@
+#include    "cpm.h"
+
+/*
+    Files through zxcc's host file calls rather than FCBs.
+
+    The start-up code sets _zxhost when it finds zxcc's calls.  open()
+    and creat() then try _zxopen() before the FCB calls, and an FCB it
+    opened has its host field set, which read(), write(), close() and
+    _fsize() look for.  Reads and writes are done at fc->rwp, so lseek()
+    needn't change.
+*/
+
+static struct zxhpb pb;
+
+int _zxopen(struct fcb *fc, char *name, uchar mode)
+{
+    while (*name == ' ' || *name == '\t')
+        ++name;
+    pb.mode = mode;
+    pb.addr = name;
+    if (bdos(ZXHOPEN, &pb))
+        return -1;
+    fc->host = pb.handle + 1;
+    fc->fsize = pb.pos;
+    return 0;
+}
+
+int _zxio(struct fcb *fc, uchar func, char *buf, ushort nbytes)
+{
+    pb.handle = fc->host - 1;
+    pb.addr = buf;
+    pb.count = nbytes;
+    pb.pos = fc->rwp;
+    if (bdos(func, &pb))
+        return -1;
+    fc->rwp = pb.pos;
+    if (fc->fsize < fc->rwp)
+        fc->fsize = fc->rwp;
+    return pb.count;
+}
+
+int _zxclose(struct fcb *fc)
+{
+    register struct fcb *fp;
+
+    pb.handle = fc->host - 1;
+    fc->host = 0;
+    for (fp = _fcb ; fp < &_fcb[MAXFILE] ; fp++)
+        if (fp->use && fp->host == pb.handle + 1)
+            return 0;       /* still open through a dup() */
+    return bdos(ZXHCLOSE, &pb) ? -1 : 0;
+}
+
+long _zxsize(struct fcb *fc)
+{
+    pb.handle = fc->host - 1;
+    if (bdos(ZXHSIZE, &pb))
+        return -1;
+    return pb.pos;
+}
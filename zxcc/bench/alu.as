@@ -0,0 +1,51 @@
+;	Benchmark kernel: 8-bit and 16-bit arithmetic and logic on registers
+
+;	The inner loop is a DJNZ over register-to-register and immediate
+;	operations, the outer one a 16-bit count in DE, repeated ROUNDS
+;	times.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+
+PASSES	equ	30000
+ROUNDS	equ	6
+
+start:
+	ld	sp,(6)
+	ld	hl,0
+	ld	c,0
+	ld	a,ROUNDS
+9:
+	ld	(rounds),a
+	ld	de,PASSES
+1:
+	ld	b,0
+2:
+	ld	a,b
+	add	a,c
+	xor	l
+	and	7Fh
+	or	h
+	rlca
+	sub	c
+	sbc	a,l
+	cp	40h
+	adc	a,0
+	ld	c,a
+	inc	l
+	dec	h
+	add	hl,bc
+	djnz	2b
+	dec	de
+	ld	a,d
+	or	e
+	jp	nz,1b
+	ld	a,(rounds)
+	dec	a
+	jr	nz,9b
+	jp	0
+
+	psect	bss
+rounds:	defs	1
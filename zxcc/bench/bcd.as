@@ -0,0 +1,73 @@
+;	Benchmark kernel: packed decimal arithmetic with DAA
+
+;	Keeps two 16 digit decimal numbers, adding the second into the
+;	first and subtracting 1 from the second each time round, and
+;	shifts a copy of the first along by a digit with RLD.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+
+LEN	equ	8
+PASSES	equ	60000
+ROUNDS	equ	60
+
+start:
+	ld	sp,(6)
+	ld	a,ROUNDS
+1:
+	ld	(rounds),a
+	ld	bc,PASSES
+5:
+	push	bc
+	ld	hl,sum		;sum += step
+	ld	de,step
+	ld	b,LEN
+	or	a
+2:
+	ld	a,(de)
+	adc	a,(hl)
+	daa
+	ld	(hl),a
+	inc	hl
+	inc	de
+	djnz	2b
+	ld	hl,step		;step -= 1
+	ld	b,LEN
+	scf
+3:
+	ld	a,(hl)
+	sbc	a,0
+	daa
+	ld	(hl),a
+	inc	hl
+	djnz	3b
+	ld	hl,sum		;shift a copy of sum
+	ld	de,work
+	ld	bc,LEN
+	ldir
+	ld	hl,work
+	ld	b,LEN
+	xor	a
+4:
+	rld
+	inc	hl
+	djnz	4b
+	pop	bc
+	dec	bc
+	ld	a,b
+	or	c
+	jr	nz,5b
+	ld	a,(rounds)
+	dec	a
+	jr	nz,1b
+	jp	0
+
+	psect	data
+sum:	defb	0,0,0,0,0,0,0,0
+step:	defb	99h,99h,99h,99h,0,0,0,0
+
+	psect	bss
+work:	defs	LEN
+rounds:	defs	1
@@ -0,0 +1,57 @@
+;	Benchmark kernel: the repeating block instructions
+
+;	Copies a 2K buffer up with LDIR and back with LDDR, then searches
+;	it with CPIR for a byte that is only at the end.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+
+SIZE	equ	2048
+PASSES	equ	10000
+ROUNDS	equ	6
+
+start:
+	ld	sp,(6)
+	ld	hl,buf1
+	ld	bc,SIZE
+	xor	a
+	ld	(hl),a
+	ld	de,buf1+1
+	dec	bc
+	ldir
+	ld	a,0FFh
+	ld	(buf1+SIZE-1),a
+	ld	a,ROUNDS
+9:
+	ld	(rounds),a
+	ld	de,PASSES
+1:
+	push	de
+	ld	hl,buf1
+	ld	de,buf2
+	ld	bc,SIZE
+	ldir
+	ld	hl,buf2+SIZE-1
+	ld	de,buf1+SIZE-1
+	ld	bc,SIZE
+	lddr
+	ld	hl,buf1
+	ld	bc,SIZE
+	ld	a,0FFh
+	cpir
+	pop	de
+	dec	de
+	ld	a,d
+	or	e
+	jr	nz,1b
+	ld	a,(rounds)
+	dec	a
+	jr	nz,9b
+	jp	0
+
+	psect	bss
+buf1:	defs	SIZE
+buf2:	defs	SIZE
+rounds:	defs	1
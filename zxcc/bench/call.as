@@ -0,0 +1,42 @@
+;	Benchmark kernel: CALL and RET, with pushes and pops to match
+
+;	Works out the Fibonacci numbers the slow way, by a recursive call
+;	for each of n-1 and n-2.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+
+N	equ	28
+PASSES	equ	100
+
+start:
+	ld	sp,(6)
+	ld	b,PASSES
+1:
+	push	bc
+	ld	hl,N
+	call	fib
+	pop	bc
+	djnz	1b
+	jp	0
+
+;	fib(HL) to HL, for HL > 0
+
+fib:
+	ld	a,l
+	cp	3
+	jr	nc,1f
+	ld	hl,1
+	ret
+1:
+	dec	hl
+	push	hl
+	call	fib
+	ex	(sp),hl		;fib(n-1) saved, n-1 back
+	dec	hl
+	call	fib
+	pop	de
+	add	hl,de
+	ret
@@ -0,0 +1,60 @@
+;	Benchmark kernel: the CB prefixed shifts, rotates and bit operations
+
+;	On registers, on (HL), and on (IX+d) with its DD CB prefix.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+
+PASSES	equ	60000
+ROUNDS	equ	6
+
+start:
+	ld	sp,(6)
+	ld	ix,bits
+	ld	hl,bits+4
+	ld	c,5Ah
+	ld	a,ROUNDS
+9:
+	ld	(rounds),a
+	ld	de,PASSES
+1:
+	push	de
+	ld	b,64
+2:
+	rlc	c
+	rr	d
+	rl	d
+	sla	e
+	srl	e
+	sra	c
+	rlc	c
+	bit	3,c
+	jr	z,3f
+	set	1,(hl)
+	res	2,(ix+1)
+	jr	4f
+3:
+	res	1,(hl)
+	set	2,(ix+1)
+4:
+	rrc	(hl)
+	rl	(ix+2)
+	bit	7,(ix+2)
+	djnz	2b
+	pop	de
+	dec	de
+	ld	a,d
+	or	e
+	jr	nz,1b
+	ld	a,(rounds)
+	dec	a
+	jr	nz,9b
+	jp	0
+
+	psect	data
+bits:	defb	1,2,4,8,16,32,64,128
+
+	psect	bss
+rounds:	defs	1
@@ -0,0 +1,56 @@
+# Print the benchmark results, comparing the time per instruction with
+# the baseline when there is one. Called with the baseline (if any) and
+# the results; fails if any kernel is more than threshold per cent slower.
+# A run of less than mintime seconds, either now or in the baseline, is
+# too short to time reliably, so it is shown but not held to threshold.
+
+function field(line, name,    s)
+{
+    if (!match(line, "\"" name "\":"))
+        return ""
+    s = substr(line, RSTART + RLENGTH)
+    sub(/[,}].*/, "", s)
+    gsub(/"/, "", s)
+    return s
+}
+
+FNR == 1 {
+    nfile++
+}
+
+nfile == 1 && ARGC > 2 {
+    base[field($0, "kernel")] = field($0, "ns_per_insn")
+    basetime[field($0, "kernel")] = field($0, "seconds")
+    next
+}
+
+FNR == 1 {
+    printf "%-10s %12s %12s %9s %8s %8s %9s\n", "kernel", "insns",
+           "tstates", "ns/insn", "MIPS", "MHz", "baseline"
+}
+
+{
+    k = field($0, "kernel")
+    ns = field($0, "ns_per_insn")
+    printf "%-10s %12s %12s %9.3f %8.2f %8.2f", k, field($0, "insns"),
+           field($0, "tstates"), ns, field($0, "mips"), field($0, "mhz")
+    if (k in base) {
+        change = (ns - base[k]) * 100 / base[k]
+        printf " %+8.1f%%", change
+        if (field($0, "seconds") < mintime || basetime[k] < mintime)
+            printf "  too short to compare"
+        else if (change > threshold) {
+            printf "  slower than baseline"
+            failed++
+        }
+    }
+    printf "\n"
+}
+
+END {
+    if (failed) {
+        printf "%d of the benchmarks were more than %s%% slower\n",
+               failed, threshold
+        exit 1
+    }
+}
@@ -0,0 +1,47 @@
+;	Benchmark kernel: loads and stores through (IX+d) and (IY+d)
+
+;	Walks IX and IY along a 256 byte table a byte at a time, mixing
+;	each entry with its neighbours.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+
+PASSES	equ	60000
+ROUNDS	equ	5
+
+start:
+	ld	sp,(6)
+	ld	a,ROUNDS
+9:
+	ld	(rounds),a
+	ld	de,PASSES
+1:
+	ld	ix,table
+	ld	iy,table+128
+	ld	b,120
+2:
+	ld	a,(ix+0)
+	add	a,(ix+1)
+	ld	(iy+2),a
+	ld	c,(iy+0)
+	xor	(ix+3)
+	ld	(ix+4),c
+	inc	(iy+1)
+	ld	(iy+3),a
+	inc	ix
+	inc	iy
+	djnz	2b
+	dec	de
+	ld	a,d
+	or	e
+	jp	nz,1b
+	ld	a,(rounds)
+	dec	a
+	jr	nz,9b
+	jp	0
+
+	psect	bss
+table:	defs	256
+rounds:	defs	1
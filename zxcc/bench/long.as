@@ -0,0 +1,67 @@
+;	Benchmark kernel: calls to the C library's 32-bit helpers
+
+;	Runs a linear congruential generator on a long with almul, and
+;	takes each value apart with aldiv and almod, as compiled C would.
+
+	psect	text
+	psect	data		;all three, for the link's -P
+	psect	bss
+	psect	text
+	global	almul, aldiv, almod, aladd
+
+PASSES	equ	60000
+ROUNDS	equ	8
+
+start:
+	ld	sp,(6)
+	ld	a,ROUNDS
+9:
+	ld	(rounds),a
+	ld	bc,PASSES
+1:
+	push	bc
+	ld	hl,(seed+2)	;seed = seed * 1103515245 + 12345
+	ld	de,(seed)
+	ld	bc,41C6h
+	push	bc
+	ld	bc,4E6Dh
+	push	bc
+	call	almul
+	ld	bc,0
+	push	bc
+	ld	bc,3039h
+	push	bc
+	call	aladd
+	ld	(seed),de
+	ld	(seed+2),hl
+	res	7,h		;q = (seed & 7FFFFFFF) / 1000
+	ld	bc,0
+	push	bc
+	ld	bc,1000
+	push	bc
+	call	aldiv
+	ld	(quot),de
+	ld	(quot+2),hl
+	ld	bc,0		;r = q % 77
+	push	bc
+	ld	bc,77
+	push	bc
+	call	almod
+	ld	(rem),de
+	pop	bc
+	dec	bc
+	ld	a,b
+	or	c
+	jr	nz,1b
+	ld	a,(rounds)
+	dec	a
+	jr	nz,9b
+	jp	0
+
+	psect	data
+seed:	defw	1,0
+
+	psect	bss
+quot:	defs	4
+rem:	defs	2
+rounds:	defs	1
@@ -0,0 +1,33 @@
+# Reduce the ZXCC_STATS lines of several runs of one program to a line
+# of results, taking the run with the least CPU time
+
+function field(line, name,    s)
+{
+    if (!match(line, "\"" name "\":"))
+        return ""
+    s = substr(line, RSTART + RLENGTH)
+    sub(/[,}].*/, "", s)
+    return s
+}
+
+{
+    t = field($0, "user") + field($0, "sys")
+    if (best == "" || t < best) {
+        best = t
+        insns = field($0, "insns")
+        tstates = field($0, "tstates")
+    }
+}
+
+END {
+    if (best == "" || insns == 0) {
+        print kernel ": no statistics" > "/dev/stderr"
+        exit 1
+    }
+    if (best <= 0)
+        best = 1e-6
+    printf "{\"kernel\":\"%s\",\"insns\":%s,\"tstates\":%s,\"seconds\":%.6f,",
+           kernel, insns, tstates, best
+    printf "\"ns_per_insn\":%.3f,\"mips\":%.2f,\"mhz\":%.2f}\n",
+           best * 1e9 / insns, insns / best / 1e6, tstates / best / 1e6
+}
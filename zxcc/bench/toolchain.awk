@@ -0,0 +1,75 @@
+# Gather the ZXCC_STATS lines of the toolchain benchmark, one file per
+# stage (named <stage>.stats), into one JSON document:
+#
+#	{"stages":[
+#	 {"stage":"libc","runs":...,<totals>,"invocations":[
+#	  {<the ZXCC_STATS line of each run>},
+#	  ...]},
+#	 ...],
+#	 "total":{"runs":...,<totals>}}
+#
+# where the totals are the sums of insns, tstates, bdos, bios, wall, user
+# and sys, and the largest maxrss. A table of the totals goes to stderr.
+
+function field(line, name,    s)
+{
+    if (!match(line, "\"" name "\":"))
+        return ""
+    s = substr(line, RSTART + RLENGTH)
+    sub(/[,}].*/, "", s)
+    return s
+}
+
+function totals(k,    s, n)
+{
+    s = sprintf("\"runs\":%d", sum[k, "runs"])
+    for (n = 1; n <= nsums; n++)
+        s = s sprintf(",\"%s\":%" (sums[n] ~ /^(wall|user|sys)$/ ? ".6f" : ".0f"),
+                      sums[n], sum[k, sums[n]])
+    return s sprintf(",\"maxrss\":%d", sum[k, "maxrss"])
+}
+
+function row(name, k)
+{
+    printf "%-8s %5d %14.0f %8d %9.2f %9.2f %8.2f %8d\n", name,
+           sum[k, "runs"], sum[k, "insns"], sum[k, "bdos"], sum[k, "wall"],
+           sum[k, "user"], sum[k, "sys"], sum[k, "maxrss"] > "/dev/stderr"
+}
+
+BEGIN {
+    nsums = split("insns tstates bdos bios wall user sys", sums)
+}
+
+{
+    k = FILENAME
+    line[k, ++nlines[k]] = $0
+    for (n = 1; n <= nsums; n++) {
+        sum[k, sums[n]] += field($0, sums[n])
+        sum["", sums[n]] += field($0, sums[n])
+    }
+    sum[k, "runs"]++
+    sum["", "runs"]++
+    rss = field($0, "maxrss")
+    if (rss + 0 > sum[k, "maxrss"])
+        sum[k, "maxrss"] = rss
+    if (rss + 0 > sum["", "maxrss"])
+        sum["", "maxrss"] = rss
+}
+
+END {
+    printf "%-8s %5s %14s %8s %9s %9s %8s %8s\n", "stage", "runs",
+           "insns", "bdos", "wall", "user", "sys", "maxrss" > "/dev/stderr"
+    print "{\"stages\":["
+    for (a = 1; a < ARGC; a++) {
+        k = ARGV[a]
+        stage = k
+        sub(/\.stats$/, "", stage)
+        printf " {\"stage\":\"%s\",%s,\"invocations\":[\n", stage, totals(k)
+        for (n = 1; n <= nlines[k]; n++)
+            printf "  %s%s\n", line[k, n], n < nlines[k] ? "," : ""
+        printf " ]}%s\n", a < ARGC - 1 ? "," : ""
+        row(stage, k)
+    }
+    printf "],\n \"total\":{%s}}\n", totals("")
+    row("total", "")
+}
@@ -0,0 +1,55 @@
+/*
+
+    CPMREDIR: CP/M filesystem redirector
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This file describes the layout of a packed drive image, as written by
+    zxpack and served by cpmimage.c.
+*/
+
+#ifndef CPMIMAGE_H_INCLUDED
+
+#define CPMIMAGE_H_INCLUDED
+
+/* A packed image holds the files of one or more read-only CP/M drives in a
+ * single host file, so that it can be mapped into memory once and files
+ * found by hashing their names rather than by probing the host filesystem.
+ *
+ * All values are little-endian 32-bit words.
+ *
+ * Header (IMG_HDRLEN bytes):
+ *	0	"ZXIM"		magic
+ *	4	version		IMG_VERSION
+ *	8	nentries	number of directory entries
+ *	12	nbuckets	size of the hash table, a power of 2
+ *	16	buckets		file offset of the hash table
+ *	20	entries		file offset of the directory
+ *	24	reserved (0)
+ *
+ * Hash table: nbuckets words, each 0 for an empty bucket or 1 + the index of
+ * the first entry in the chain.
+ *
+ * Directory (IMG_ENTLEN bytes per entry), sorted by drive and then name:
+ *	0	byte		drive, 0 = A:
+ *	1	11 bytes	name and type, upper case and space padded
+ *	12	offset		file offset of the data
+ *	16	length		length of the data in bytes
+ *	20	mtime		host modification time
+ *	24	next		1 + index of the next entry in the chain, or 0
+ *	28	reserved (0)
+ */
+
+#define IMG_MAGIC   "ZXIM"
+#define IMG_VERSION 1
+#define IMG_HDRLEN  32
+#define IMG_ENTLEN  32
+#define IMG_KEYLEN  12	/* Drive and name */
+
+/* Hash of a 12-byte key (drive + name); reduce modulo nbuckets */
+unsigned long img_hash(const cpm_byte *key);
+
+#endif	/* def CPMIMAGE_H_INCLUDED */
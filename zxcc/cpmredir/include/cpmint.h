@@ -141,11 +141,18 @@ EXT char redir_passwd[8] INIT("");
 EXT cpm_word redir_l_drives  INIT(0);
 EXT cpm_word redir_ro_drives INIT(0);
 
+/* Drives served from a packed image */
+EXT cpm_word redir_img_drives INIT(0);
+
 #undef EXT
 #undef INIT
 
 
 
+/* Host directory for the file(s) an FCB names: the drive's directory, or
+ * the private directory for temporary files (see xlt_private) */
+char *redir_fcb_prefix(cpm_byte *fcb);
+
 /* Convert FCB to a Unix filename, returning 1 if it's ambiguous */
 int redir_fcb2unix(cpm_byte *fcb, char *fname);
 
@@ -155,6 +162,10 @@ int redir_ofile(cpm_byte * fcb, char *s);
 /* Check that the FCB we have is valid */
 int redir_verify_fcb(cpm_byte *fcb);
 
+/* Tell the directory cache (see cpmglob.c) that the host file an FCB
+ * names has been made (exists = 1) or removed (exists = 0) */
+void redir_dircache_update(cpm_byte *fcb, char *fname, int exists);
+
 #ifndef O_BINARY	/* Necessary in DOS, not present in Linux */
 #define O_BINARY 0
 #endif
@@ -213,6 +224,22 @@ void redir_log_fcb(cpm_byte *fcb);
 int  redir_ro_drv(cpm_byte drv);
 int  redir_ro_fcb(cpm_byte *fcb);
 
+/* Packed image drives (cpmimage.c). Files opened from the image get
+ * handles that cannot clash with host file descriptors. */
+
+#define IMG_HANDLE      0x7E000000L
+#define IMG_HANDLE_MASK 0xFF000000L
+
+#define redir_img_drv(drv)       ((drv) < 16 && (redir_img_drives & (1L << (drv))))
+#define redir_img_handle(handle) (((handle) & IMG_HANDLE_MASK) == IMG_HANDLE)
+
+int   redir_img_open(int drv, cpm_byte *fcb);
+int   redir_img_read(int handle, long pos, cpm_byte *dma, int len);
+long  redir_img_size(int handle);
+int   redir_img_stat(int drv, cpm_byte *fcb, struct stat *st);
+int   redir_img_find(int drv, int n, cpm_byte *fcb, cpm_byte *pattern,
+                     struct stat *st, int *entryno);
+
 /* Translate errno to a CP/M error */
 
 cpm_word redir_xlt_err(void);
@@ -91,6 +91,49 @@ int xlt_umap(int drive);
 
 char *xlt_getcwd(int drive);
 
+/* Keep temporary files private to this process. Files on P: matching any
+ * of the space- or comma-separated patterns ("*.$$$ *.TMP") go in a
+ * directory of their own, removed by fcb_deinit(). Returns the number of
+ * patterns, or 0 if one of them is not a valid CP/M name.
+ */
+
+int xlt_private(char *patterns);
+
+/* Serve drives from a packed image made by zxpack (see cpmimage.h). The
+ * drives it holds become read-only, and files on them are found in the
+ * image rather than in the directories the drives are mapped to.
+ *
+ * Returns a bitmap of the drives in the image, or 0 if it could not be
+ * loaded.
+ */
+
+cpm_word xlt_image(char *imgname);
+
+/* Find a host-style name ("cgen.com") on an image drive. Returns the
+ * file's data and sets *len, or returns NULL if it is not there. */
+
+const cpm_byte *xlt_image_file(int drive, char *name, long *len);
+
+/* Log the host names of files opened ("r name"), looked for but not
+ * found ("n name") and created or renamed into place ("w name") to a
+ * file. Returns 0 if it can't be opened.
+ * xlt_trace_name() adds a line of its own, such as a program loaded
+ * without going through the BDOS. */
+
+int  xlt_trace(char *fname);
+void xlt_trace_name(int type, char *name);
+
+/* Open the host file an FCB names, for an emulator that reads and writes
+ * it itself rather than through the FCB calls. flags are those of open();
+ * with O_CREAT the file is also truncated. The name is looked up as
+ * fcb_open() and fcb_creat() would, and traced in the same way.
+ *
+ * Returns a host file handle, which the caller closes, or -1 if the file
+ * can't be opened, the name is ambiguous, the drive is served from an
+ * image, or it is read-only and flags ask to write.
+ */
+int fcb_host_open(cpm_byte *fcb, int flags);
+
 
 /* BDOS functions. Eventually this should handle all disc-related BDOS
  * functions.
@@ -35,6 +35,22 @@ static cpm_byte lastdma[0x80];
 static long lastsize;
 static char target_name[CPM_MAXPATH];
 
+/* The names in the last host directory searched for one exact name, in
+ * readdir() order, with an open hash table indexing them. Files that the
+ * redirector makes there later are added after them, and ones it removes
+ * leave an empty name so the others keep their numbers */
+static struct
+{
+    char path[CPM_MAXPATH];
+    dev_t dev;
+    ino_t ino;
+    char **names;
+    int count;
+    int max;
+    int *index;		/* -1 for a free slot, -2 for a removed name */
+    int slots;
+} dircache;
+
 static char upper(char c)
 {
     if (islower(c)) return toupper(c);
@@ -136,11 +152,6 @@ static struct dirent *next_entry(DIR *dir, cpm_byte *fcb, cpm_byte *pattern,
 {
     struct dirent *en;
     int unsatisfied;
-    int drv = fcb[0] & 0x7F;
-
-    if (drv == '?') drv = 0;
-    if (!drv) drv = redir_cpmdrive;
-    else      drv--;
 
     for (unsatisfied = 1; unsatisfied; )
     {
@@ -159,7 +170,7 @@ static struct dirent *next_entry(DIR *dir, cpm_byte *fcb, cpm_byte *pattern,
         }
         /* 3. Stat it, & reject it if it's a directory */
 
-        strcpy(target_name, redir_drive_prefix[drv]);
+        strcpy(target_name, redir_fcb_prefix(fcb));
         strcat(target_name, en->d_name);
         
         if (stat(target_name, st)) 
@@ -181,6 +192,219 @@ static struct dirent *next_entry(DIR *dir, cpm_byte *fcb, cpm_byte *pattern,
 }
 
 
+/* Search-first on a name with no wildcards, which is how programs find the
+ * last record byte count of a file they open, is answered without reading
+ * the directory through: the FCB becomes the one host name that can match
+ * it, and that is stat()ed. The entry number that goes in the result is
+ * still the one readdir() would give, so the listing of the directory is
+ * kept. The redirector's own creates, renames and deletes update it, and
+ * it is only read again for a name that exists but is not in it. */
+
+static int exact_fcb(cpm_byte *fcb)
+{
+    int n, c, end = 0;
+
+    if ((fcb[0] & 0x7F) == '?' || (fcb[0] & 0x80)) return 0;
+    /* With no type, both "name" and "name." would match */
+    if ((fcb[1] & 0x7F) == ' ' || (fcb[9] & 0x7F) == ' ') return 0;
+    for (n = 1; n < 12; n++)
+    {
+        if (n == 9) end = 0;
+        c = fcb[n] & 0x7F;
+        if (c == ' ')
+        {
+            end = 1;
+            continue;
+        }
+        /* Names that cpm_match() would never give back */
+        if (end || c < ' ' || c == '?' || c == '.' || islower(c) ||
+            strchr(DIRSEP, c)) return 0;
+    }
+    return 1;
+}
+
+static unsigned name_hash(const char *s)
+{
+    unsigned h = 5381;
+
+    while (*s) h = h * 33 + (unsigned char)*s++;
+    return h;
+}
+
+static void dircache_free(void)
+{
+    int n;
+
+    for (n = 0; n < dircache.count; n++) free(dircache.names[n]);
+    free(dircache.names);
+    free(dircache.index);
+    dircache.names = NULL;
+    dircache.index = NULL;
+    dircache.count = dircache.max = dircache.slots = 0;
+    dircache.path[0] = 0;
+}
+
+/* Add a name to the end of the listing, without indexing it */
+
+static int dircache_append(const char *name)
+{
+    char **names;
+    int max;
+
+    if (dircache.count == dircache.max)
+    {
+        max = dircache.max ? 2 * dircache.max : 256;
+        names = realloc(dircache.names, max * sizeof(char *));
+        if (!names) return 0;
+        dircache.names = names;
+        dircache.max = max;
+    }
+    if (!(dircache.names[dircache.count] = strdup(name))) return 0;
+    ++dircache.count;
+    return 1;
+}
+
+/* Index the listing afresh, in a table at most half full */
+
+static int dircache_hash(void)
+{
+    int *index;
+    int slots, n, h;
+
+    for (slots = 64; slots < 2 * dircache.count; ) slots *= 2;
+    if (!(index = malloc(slots * sizeof(int)))) return 0;
+    memset(index, 0xFF, slots * sizeof(int));
+    for (n = 0; n < dircache.count; n++)
+    {
+        if (!dircache.names[n]) continue;
+        h = name_hash(dircache.names[n]) & (slots - 1);
+        while (index[h] >= 0) h = (h + 1) & (slots - 1);
+        index[h] = n;
+    }
+    free(dircache.index);
+    dircache.index = index;
+    dircache.slots = slots;
+    return 1;
+}
+
+static int dircache_read(char *dir, struct stat *st)
+{
+    DIR *hostdir;
+    struct dirent *en;
+
+    dircache_free();
+    hostdir = opendir(dir);
+    if (!hostdir) return 0;
+    while ((en = readdir(hostdir)))
+    {
+        if (!dircache_append(en->d_name)) break;
+    }
+    closedir(hostdir);
+    if (en || !dircache_hash())
+    {
+        dircache_free();
+        return 0;
+    }
+    strcpy(dircache.path, dir);
+    dircache.dev = st->st_dev;
+    dircache.ino = st->st_ino;
+    return 1;
+}
+
+/* The slot in the index that holds a name, or -1 */
+
+static int dircache_slot(const char *name)
+{
+    int h, n;
+
+    if (!dircache.slots) return -1;
+    h = name_hash(name) & (dircache.slots - 1);
+    for (; (n = dircache.index[h]) != -1; h = (h + 1) & (dircache.slots - 1))
+    {
+        if (n >= 0 && !strcmp(dircache.names[n], name)) return h;
+    }
+    return -1;
+}
+
+static int dircache_find(char *name)
+{
+    int h = dircache_slot(name);
+
+    return (h < 0) ? -1 : dircache.index[h];
+}
+
+/* Keep the listing up to date when the redirector makes or removes the
+ * host file fname, which an FCB names. Any other change to the directory
+ * is found when a name that exists turns out not to be listed. */
+
+void redir_dircache_update(cpm_byte *fcb, char *fname, int exists)
+{
+    char *dir = redir_fcb_prefix(fcb);
+    char *name = fname + strlen(dir);
+    int h, n;
+
+    if (!dircache.path[0] || strcmp(dircache.path, dir)) return;
+    h = dircache_slot(name);
+    if (exists)
+    {
+        if (h >= 0) return;
+        if (!dircache_append(name))
+        {
+            dircache_free();
+            return;
+        }
+        n = dircache.count - 1;
+        if (2 * dircache.count > dircache.slots)
+        {
+            if (!dircache_hash()) dircache_free();
+            return;
+        }
+        h = name_hash(name) & (dircache.slots - 1);
+        while (dircache.index[h] >= 0) h = (h + 1) & (dircache.slots - 1);
+        dircache.index[h] = n;
+    }
+    else if (h >= 0)
+    {
+        n = dircache.index[h];
+        free(dircache.names[n]);
+        dircache.names[n] = NULL;
+        dircache.index[h] = -2;
+    }
+}
+
+/* The number readdir() gives a name in a directory, or -1 */
+
+static int dir_entryno(char *dir, char *name)
+{
+    struct stat st;
+    int n = -1;
+
+    if (stat(dir, &st)) return -1;
+    if (!strcmp(dircache.path, dir) && st.st_dev == dircache.dev &&
+        st.st_ino == dircache.ino) n = dircache_find(name);
+    /* Made by something else since the listing was read? */
+    if (n < 0 && dircache_read(dir, &st)) n = dircache_find(name);
+    return n;
+}
+
+/* Look an exact name up. Returns 1 if it is there, 0 if it is not, or -1
+ * if the directory has to be searched after all */
+
+static int find_exact(cpm_byte *fcb, cpm_byte *pattern, struct stat *st)
+{
+    char *dir = redir_fcb_prefix(fcb);
+    int n;
+
+    redir_fcb2unix(fcb, target_name);
+    if (stat(target_name, st)) return (errno == ENOENT) ? 0 : -1;
+    if (S_ISDIR(st->st_mode)) return -1;
+    entryno = dir_entryno(dir, target_name + strlen(dir));
+    if (entryno < 0) return -1;
+    for (n = 0; n < 11; n++) pattern[n] = fcb[n + 1] & 0x7F;
+    return 1;
+}
+
+
 
 void volume_label(int drv, cpm_byte *dma)
 {
@@ -220,7 +444,7 @@ void volume_label(int drv, cpm_byte *dma)
 cpm_word redir_find(int n, cpm_byte *fcb, cpm_byte *dma)
 {
     DIR *hostdir;
-    int drv, attrib;
+    int drv, attrib, found;
     long recs;
     struct stat st;
     struct dirent *de;
@@ -285,23 +509,39 @@ cpm_word redir_find(int n, cpm_byte *fcb, cpm_byte *dma)
          */
 
     entryno = -1;
-    hostdir = opendir(redir_drive_prefix[drv]);
-
-    if (!hostdir) 	
+    if (redir_img_drv(drv))
     {
-        redir_Msg("opendir() fails on '%s'\n", redir_drive_prefix[drv]);
-        return 0xFF;
+        /* Image drives are searched in memory */
+        hostdir = NULL;
+        if (redir_img_find(drv, n, fcb, dma + 1, &st, &entryno)) return 0xFF;
+        target_name[0] = 0;
     }
-    /* We have a handle to the directory. */
-    while (n >= 0)
+    else if (exact_fcb(fcb) && (n || (found = find_exact(fcb, dma + 1, &st)) >= 0))
     {
-        de = next_entry(hostdir, fcb, dma + 1, &st);
-        if (!de) 
+        /* There is one host file at most that an exact name matches */
+        if (n || !found) return 0xFF;
+        hostdir = NULL;
+    }
+    else
+    {
+        hostdir = opendir(redir_fcb_prefix(fcb));
+
+        if (!hostdir)
         {
-            closedir(hostdir);
+            redir_Msg("opendir() fails on '%s'\n", redir_drive_prefix[drv]);
             return 0xFF;
         }
-        --n;
+        /* We have a handle to the directory. */
+        while (n >= 0)
+        {
+            de = next_entry(hostdir, fcb, dma + 1, &st);
+            if (!de)
+            {
+                closedir(hostdir);
+                return 0xFF;
+            }
+            --n;
+        }
     }
     /* Valid entry found & statted. dma+1 holds filename. */
 
@@ -351,7 +591,7 @@ cpm_word redir_find(int n, cpm_byte *fcb, cpm_byte *dma)
     redir_wr32(dma + 0x61, redir_cpmtime(st.st_atime));
     redir_wr32(dma + 0x65, redir_cpmtime(st.st_mtime));
 
-    closedir(hostdir);
+    if (hostdir) closedir(hostdir);
 
     if (st.st_size > 0x4000 && (fcb[0x0C] == '?')) /* All extents? */
     {
@@ -464,7 +704,7 @@ cpm_word fcb_unlink(cpm_byte *fcb, cpm_byte *dma)
           I can give.
          */
 
-    hostdir = opendir(redir_drive_prefix[drv]);
+    hostdir = opendir(redir_fcb_prefix(fcb));
 
     if (!hostdir) 	
     {
@@ -477,7 +717,7 @@ cpm_word fcb_unlink(cpm_byte *fcb, cpm_byte *dma)
         de = next_entry(hostdir, fcb, (cpm_byte *)fname, &st);
         if (de)
         {
-            strcpy(target_name, redir_drive_prefix[drv]);
+            strcpy(target_name, redir_fcb_prefix(fcb));
             strcat(target_name, de->d_name);
             redir_Msg("Deleting %s\n", de->d_name);
             if (unpasswd) 
@@ -512,6 +752,7 @@ cpm_word fcb_unlink(cpm_byte *fcb, cpm_byte *dma)
             }
             
             if (handle) de = NULL;	/* Delete failed */
+            else if (!unpasswd) redir_dircache_update(fcb, target_name, 0);
         }
     }
     while (de != NULL);
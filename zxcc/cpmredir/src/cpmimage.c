@@ -0,0 +1,280 @@
+/*
+
+	CPMREDIR: CP/M filesystem redirector
+
+	This library is free software; you can redistribute it and/or
+	modify it under the terms of the GNU Library General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This library is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+	Library General Public License for more details.
+
+	You should have received a copy of the GNU Library General Public
+	License along with this library; if not, write to the Free
+	Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+	This file serves read-only drives from a packed image. The layout
+	is described in cpmimage.h.
+*/
+
+#include "cpmint.h"
+#include "cpmimage.h"
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+static const cpm_byte *img_base;	/* The whole image */
+static long img_len;
+static dword img_nentries;
+static dword img_nbuckets;
+static const cpm_byte *img_buckets;
+static const cpm_byte *img_entries;
+
+/* First entry and number of entries for each drive */
+static dword img_first[16];
+static dword img_count[16];
+
+#define ENTRY(n) (img_entries + (dword)(n) * IMG_ENTLEN)
+
+unsigned long img_hash(const cpm_byte *key)
+{
+	unsigned long h = 2166136261UL;
+	int n;
+
+	for (n = 0; n < IMG_KEYLEN; n++)
+	{
+		h ^= key[n];
+		h = (h * 16777619UL) & 0xFFFFFFFFUL;
+	}
+	return h;
+}
+
+static dword rd32(const cpm_byte *p)
+{
+	return redir_rd32((cpm_byte *)p);
+}
+
+/* Load the image into memory: mapped where the host allows it, or else
+ * read in whole */
+
+static const cpm_byte *img_load(char *imgname, long *len)
+{
+	struct stat st;
+	cpm_byte *p;
+	int fd;
+
+	fd = open(imgname, O_RDONLY | O_BINARY);
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) || st.st_size < IMG_HDRLEN)
+	{
+		close(fd);
+		return NULL;
+	}
+	*len = st.st_size;
+#ifdef HAVE_SYS_MMAN_H
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) return NULL;
+#else
+	p = malloc(st.st_size);
+	if (p && read(fd, p, st.st_size) != st.st_size)
+	{
+		free(p);
+		p = NULL;
+	}
+	close(fd);
+#endif
+	return p;
+}
+
+cpm_word xlt_image(char *imgname)
+{
+	const cpm_byte *e;
+	dword n, offs, len, bkt, ent, size;
+	int drv;
+	cpm_word drives = 0;
+
+	img_base = img_load(imgname, &img_len);
+	if (!img_base) return 0;
+
+	size = img_len;
+	memset(img_count, 0, sizeof(img_count));
+	img_nentries = rd32(img_base + 8);
+	img_nbuckets = rd32(img_base + 12);
+	bkt = rd32(img_base + 16);
+	ent = rd32(img_base + 20);
+
+	/* Check everything the lookups will rely on, so they need not */
+	if (memcmp(img_base, IMG_MAGIC, 4) ||
+	    rd32(img_base + 4) != IMG_VERSION ||
+	    !img_nbuckets || (img_nbuckets & (img_nbuckets - 1)) ||
+	    img_nbuckets > size / 4 || bkt > size - img_nbuckets * 4 ||
+	    img_nentries > size / IMG_ENTLEN ||
+	    ent > size - img_nentries * IMG_ENTLEN)
+	{
+		redir_Msg("%s is not a valid image\n", imgname);
+		img_base = NULL;
+		return 0;
+	}
+	img_buckets = img_base + bkt;
+	img_entries = img_base + ent;
+
+	for (n = 0; n < img_nbuckets; n++)
+	{
+		if (rd32(img_buckets + 4 * n) > img_nentries)
+		{
+			img_base = NULL;
+			return 0;
+		}
+	}
+	for (n = 0; n < img_nentries; n++)
+	{
+		e = ENTRY(n);
+		offs = rd32(e + 12);
+		len = rd32(e + 16);
+		drv = e[0];
+		if (drv > 15 || offs > size || len > size - offs ||
+		    rd32(e + 24) > img_nentries ||
+		    (n && memcmp(ENTRY(n - 1), e, IMG_KEYLEN) >= 0))
+		{
+			redir_Msg("%s: bad directory entry %lu\n", imgname, n);
+			img_base = NULL;
+			return 0;
+		}
+		if (!img_count[drv]) img_first[drv] = n;
+		img_count[drv]++;
+		drives |= (1 << drv);
+	}
+	redir_img_drives = drives;
+	return drives;
+}
+
+/* Find the entry for a drive and an 11-byte CP/M name. Returns -1 if it is
+ * not in the image. */
+
+static long img_lookup(int drv, const cpm_byte *name)
+{
+	cpm_byte key[IMG_KEYLEN];
+	dword n;
+	int i;
+
+	key[0] = drv;
+	for (i = 0; i < 11; i++) key[i + 1] = toupper(name[i] & 0x7F);
+
+	n = rd32(img_buckets + 4 * (img_hash(key) & (img_nbuckets - 1)));
+	while (n)
+	{
+		if (!memcmp(ENTRY(n - 1), key, IMG_KEYLEN)) return n - 1;
+		n = rd32(ENTRY(n - 1) + 24);
+	}
+	return -1;
+}
+
+const cpm_byte *xlt_image_file(int drive, char *name, long *len)
+{
+	cpm_byte cname[11];
+	char *dot = strchr(name, '.');
+	size_t nl, tl;
+	long n;
+
+	if (!img_base || drive < 0 || drive > 15 || !redir_img_drv(drive))
+		return NULL;
+
+	nl = dot ? (size_t)(dot - name) : strlen(name);
+	tl = dot ? strlen(dot + 1) : 0;
+	if (!nl || nl > 8 || tl > 3) return NULL;
+
+	memset(cname, ' ', 11);
+	memcpy(cname, name, nl);
+	if (tl) memcpy(cname + 8, dot + 1, tl);
+
+	n = img_lookup(drive, cname);
+	if (n < 0) return NULL;
+	*len = rd32(ENTRY(n) + 16);
+	return img_base + rd32(ENTRY(n) + 12);
+}
+
+int redir_img_open(int drv, cpm_byte *fcb)
+{
+	long n = img_lookup(drv, fcb + 1);
+
+	if (n < 0) return -1;
+	fcb[9] |= 0x80;		/* Read-only */
+	return (int)(IMG_HANDLE | n);
+}
+
+/* Copy up to len bytes from pos in an open file; returns the number
+ * copied, like read() */
+
+int redir_img_read(int handle, long pos, cpm_byte *dma, int len)
+{
+	const cpm_byte *e = ENTRY(handle & ~IMG_HANDLE_MASK);
+	dword flen = rd32(e + 16);
+
+	if (pos < 0 || (dword)pos >= flen) return 0;
+	if ((dword)len > flen - pos) len = flen - pos;
+	memcpy(dma, img_base + rd32(e + 12) + pos, len);
+	return len;
+}
+
+long redir_img_size(int handle)
+{
+	return rd32(ENTRY(handle & ~IMG_HANDLE_MASK) + 16);
+}
+
+static void img_stat(dword n, struct stat *st)
+{
+	memset(st, 0, sizeof(*st));
+	st->st_mode  = S_IFREG | 0444;
+	st->st_size  = rd32(ENTRY(n) + 16);
+	st->st_mtime = rd32(ENTRY(n) + 20);
+	st->st_atime = st->st_mtime;
+	st->st_ctime = st->st_mtime;
+}
+
+/* stat() a file named by an FCB. Returns 0 if it is in the image. */
+
+int redir_img_stat(int drv, cpm_byte *fcb, struct stat *st)
+{
+	long n = img_lookup(drv, fcb + 1);
+
+	if (n < 0) return -1;
+	img_stat(n, st);
+	return 0;
+}
+
+/* Find the nth file on an image drive matching "fcb", as next_entry() does
+ * for host directories. The CP/M name goes into "pattern". Returns 0 if
+ * found. */
+
+int redir_img_find(int drv, int n, cpm_byte *fcb, cpm_byte *pattern,
+                   struct stat *st, int *entryno)
+{
+	const cpm_byte *e;
+	dword i;
+	int m;
+
+	for (i = 0; i < img_count[drv]; i++)
+	{
+		e = ENTRY(img_first[drv] + i);
+		if ((fcb[0] & 0x7F) != '?')
+		{
+			for (m = 0; m < 11; m++)
+			{
+				if (fcb[m + 1] == '?') continue;
+				if (e[m + 1] != toupper(fcb[m + 1] & 0x7F)) break;
+			}
+			if (m < 11) continue;
+		}
+		if (n--) continue;
+
+		memcpy(pattern, e + 1, 11);
+		img_stat(img_first[drv] + i, st);
+		*entryno = i;
+		return 0;
+	}
+	return -1;
+}
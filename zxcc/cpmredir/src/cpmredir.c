@@ -120,7 +120,13 @@ cpm_word fcb_open(cpm_byte* fcb, cpm_byte* dma)
 		 * file (which rewinds it); this causes FCB leaks under some
 		 * DOS-based emulators */
 
-	handle = redir_ofile(fcb, fname);
+	if (redir_img_drv(drv))
+	{
+		handle = redir_img_open(drv, fcb);
+		redir_Msg("fcb_open(\"%s\") from image: %x\r\n", fname, handle);
+		if (handle == -1) return 0xFF;
+	}
+	else handle = redir_ofile(fcb, fname);
 	redir_Msg("fcb_open(\"%s\")\r\n", fname);
 	if (handle < 0 && redir_password_error())
 	{
@@ -135,8 +141,11 @@ cpm_word fcb_open(cpm_byte* fcb, cpm_byte* dma)
 	{
 		redir_Msg("Ret: -1\n");
 		if (redir_password_error()) return 0x7FF;
+		xlt_trace_name('n', fname);
 		return 0xFF;
 	}
+	if (!redir_img_handle(handle)) xlt_trace_name('r', fname);
+
 	fcb[MAGIC_OFFSET] = 0xFD;		/* "Magic number"  */
 	fcb[MAGIC_OFFSET + 1] = 0x00;
 
@@ -151,8 +160,13 @@ cpm_word fcb_open(cpm_byte* fcb, cpm_byte* dma)
 				 */
 
 	/* Get the file length */
-	redir_wr32(fcb + LENGTH_OFFSET, zxlseek(handle, 0, SEEK_END));
-	zxlseek(handle, 0, SEEK_SET);
+	if (redir_img_handle(handle))
+		redir_wr32(fcb + LENGTH_OFFSET, redir_img_size(handle));
+	else
+	{
+		redir_wr32(fcb + LENGTH_OFFSET, zxlseek(handle, 0, SEEK_END));
+		zxlseek(handle, 0, SEEK_SET);
+	}
 
 	/* Set the last record byte count */
 	if (fcb[0x20] == 0xFF) fcb[0x20] = fcb[LENGTH_OFFSET] & 0x7F;
@@ -170,6 +184,7 @@ cpm_word fcb_close(cpm_byte* fcb)
 	SHOWNAME("fcb_close")
 
 		if ((handle = redir_verify_fcb(fcb)) < 0) return -1;
+	if (redir_img_handle(handle)) return 0;	/* Nothing to release */
 	redir_Msg("         (at   %lx)\n", zxlseek(handle, 0, SEEK_CUR));
 
 	if (fcb[0] & 0x80)	/* Close directory */
@@ -259,12 +274,17 @@ cpm_word fcb_read(cpm_byte* fcb, cpm_byte* dma)
 		 * do an lseek() to where it should be. */
 
 	npos = redir_get_fcb_pos(fcb);
-	zxlseek(handle, npos, SEEK_SET);
-	redir_Msg("        (from %lx)\n", zxlseek(handle, 0, SEEK_CUR));
 
 /* Read in the required amount */
 
-	rv = read(handle, dma, redir_rec_len);
+	if (redir_img_handle(handle))
+		rv = redir_img_read(handle, npos, dma, redir_rec_len);
+	else
+	{
+		zxlseek(handle, npos, SEEK_SET);
+		redir_Msg("        (from %lx)\n", zxlseek(handle, 0, SEEK_CUR));
+		rv = read(handle, dma, redir_rec_len);
+	}
 
 /* rd_len = length supposedly read, bytes. Round to nearest 128 bytes.
 	 */
@@ -358,6 +378,7 @@ cpm_word fcb_creat(cpm_byte* fcb, cpm_byte* dma)
 	{
 		handle = mkdir(fname, 0x777);
 		if (handle) return redir_xlt_err();
+		redir_dircache_update(fcb, fname, 1);
 		return 0;
 	}
 	releaseFile(fname);  /* purge any open handles for this file */
@@ -366,6 +387,8 @@ cpm_word fcb_creat(cpm_byte* fcb, cpm_byte* dma)
 	if (handle < 0) return 0xFF;
 	
 	trackFile(fname, fcb, handle); /* track new file */
+	xlt_trace_name('w', fname);
+	redir_dircache_update(fcb, fname, 1);
 
 	fcb[MAGIC_OFFSET] = 0xFD;   /* "Magic number"  */
 	fcb[MAGIC_OFFSET + 1] = 0;
@@ -385,6 +408,52 @@ cpm_word fcb_creat(cpm_byte* fcb, cpm_byte* dma)
 }
 
 
+/* Open the file an FCB names for the caller to read and write itself. See
+ * cpmredir.h */
+
+int fcb_host_open(cpm_byte* fcb, int flags)
+{
+	char fname[CPM_MAXPATH];
+	struct stat st;
+	int handle, drv;
+
+	/* Don't support ambiguous filenames */
+	if (redir_fcb2unix(fcb, fname)) return -1;
+
+	drv = fcb[0] & 0x7F;
+	if (!drv) drv = redir_cpmdrive; else --drv;
+
+	/* The FCB calls know how to read files in an image */
+	if (redir_img_drv(drv)) return -1;
+
+	/* Software write-protection */
+	if ((flags & (O_WRONLY | O_RDWR)) && redir_ro_fcb(fcb)) return -1;
+
+	redir_log_fcb(fcb);
+
+	if (flags & O_CREAT)
+	{
+		releaseFile(fname);  /* purge any open handles for this file */
+		flags |= O_TRUNC;
+	}
+	handle = open(fname, flags | O_BINARY, S_IREAD | S_IWRITE);
+	redir_Msg("fcb_host_open(\"%s\", %x): %d\n", fname, flags, handle);
+	if (handle < 0)
+	{
+		if (!(flags & O_CREAT)) xlt_trace_name('n', fname);
+		return -1;
+	}
+	if (fstat(handle, &st) || S_ISDIR(st.st_mode))
+	{
+		close(handle);
+		return -1;
+	}
+	xlt_trace_name((flags & O_CREAT) ? 'w' : 'r', fname);
+	if (flags & O_CREAT) redir_dircache_update(fcb, fname, 1);
+	return handle;
+}
+
+
 
 cpm_word fcb_rename(cpm_byte* fcb, cpm_byte* dma)
 {
@@ -425,6 +494,9 @@ cpm_word fcb_rename(cpm_byte* fcb, cpm_byte* dma)
 		}
 		return 0xFF;
 	}
+	xlt_trace_name('w', nfname);
+	redir_dircache_update(fcb, ofname, 0);
+	redir_dircache_update(fcb + 0x10, nfname, 1);
 
 	return 0;
 }
@@ -442,9 +514,14 @@ cpm_word fcb_randrd(cpm_byte* fcb, cpm_byte* dma)
 
 		if ((handle = redir_verify_fcb(fcb)) < 0) return 9;	/* Invalid FCB */
 
-	if (zxlseek(handle, offs, SEEK_SET) < 0) return 6; /* bad record no. */
-	rv = read(handle, dma, redir_rec_len);
-	zxlseek(handle, offs, SEEK_SET);
+	if (redir_img_handle(handle))
+		rv = redir_img_read(handle, offs, dma, redir_rec_len);
+	else
+	{
+		if (zxlseek(handle, offs, SEEK_SET) < 0) return 6; /* bad record no. */
+		rv = read(handle, dma, redir_rec_len);
+		zxlseek(handle, offs, SEEK_SET);
+	}
 
 	redir_put_fcb_pos(fcb, offs);
 
@@ -564,7 +641,9 @@ cpm_word fcb_tell(cpm_byte* fcb)
 
 		if ((handle = redir_verify_fcb(fcb)) < 0) return 9;   /* Invalid FCB */
 
-	rv = zxlseek(handle, 0, SEEK_CUR);
+	/* Image files have no host file pointer; the FCB holds the position */
+	if (redir_img_handle(handle)) rv = redir_get_fcb_pos(fcb);
+	else rv = zxlseek(handle, 0, SEEK_CUR);
 
 	if (rv < 0) return 0xFF;
 
@@ -576,6 +655,18 @@ cpm_word fcb_tell(cpm_byte* fcb)
 }
 
 
+/* stat() the file an FCB names, on the host or in an image */
+
+static int redir_stat(cpm_byte* fcb, char* fname, struct stat* st)
+{
+	int drv = fcb[0] & 0x7F;
+
+	if (!drv) drv = redir_cpmdrive; else --drv;
+	if (redir_img_drv(drv)) return redir_img_stat(drv, fcb, st);
+	return stat(fname, st);
+}
+
+
 cpm_word fcb_stat(cpm_byte* fcb)
 {
 	char fname[CPM_MAXPATH];
@@ -585,7 +676,7 @@ cpm_word fcb_stat(cpm_byte* fcb)
 	/* Don't support ambiguous filenames */
 	if (redir_fcb2unix(fcb, fname)) return 0x09FF;
 
-	rv = stat(fname, &st);
+	rv = redir_stat(fcb, fname, &st);
 
 	redir_Msg("fcb_stat(\"%s\") fcb=%p\n", fname, fcb);
 	if (rv < 0)
@@ -625,7 +716,7 @@ cpm_word fcb_date(cpm_byte* fcb)
 	/* Don't support ambiguous filenames */
 	if (redir_fcb2unix(fcb, fname)) return 0x09FF;
 
-	rv = stat(fname, &st);
+	rv = redir_stat(fcb, fname, &st);
 
 	redir_Msg("fcb_stat(\"%s\")\n", fname);
 	if (rv < 0) return 0xFF;
@@ -103,8 +103,7 @@ int redir_fcb2unix(cpm_byte* fcb, char* fname)
 		fcb + 1,
 		fcb + 9);
 
-	if (!drv) strcpy(fname, redir_drive_prefix[redir_cpmdrive]);
-	else	  strcpy(fname, redir_drive_prefix[drv - 1]);
+	strcpy(fname, redir_fcb_prefix(fcb));
 
 	for (n = 1; n < 12; n++)
 	{
@@ -286,8 +285,8 @@ void redir_log_fcb(cpm_byte* fcb)
 
 int redir_ro_drv(cpm_byte drv)
 {
-	if (!drv) return redir_ro_drives & 1;
-	else	  return redir_ro_drives & (1L << drv);
+	/* Image drives are always read-only; fcb_resro() can't change that */
+	return (redir_ro_drives | redir_img_drives) & (1L << drv);
 }
 
 int redir_ro_fcb(cpm_byte* fcb)
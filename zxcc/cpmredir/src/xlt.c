@@ -23,6 +23,16 @@
 
 #include "cpmint.h"
 static char* skipUser(char* localname);
+
+/* Private names (see xlt_private) */
+#define MAX_PRIVATE 16
+
+static cpm_byte private_pat[MAX_PRIVATE][11];
+static int  n_private;
+static char private_dir[CPM_MAXPATH];	/* Empty until first used */
+
+/* Where xlt_trace() writes, if anywhere */
+static FILE *trace_fp;
 /* Detect DRDOS */
 
 #ifdef __MSDOS__
@@ -85,7 +95,22 @@ int fcb_init(void)
 
 void fcb_deinit(void)
 {
-    /* Nothing */
+    DIR *dir;
+    struct dirent *en;
+    char fname[CPM_MAXPATH];
+
+    /* Remove the private directory and anything left in it */
+    if (!private_dir[0] || !(dir = opendir(private_dir))) return;
+    while ((en = readdir(dir)))
+    {
+        if (!strcmp(en->d_name, ".") || !strcmp(en->d_name, "..")) continue;
+        sprintf(fname, "%s%s", private_dir, en->d_name);
+        releaseFile(fname);
+        unlink(fname);
+    }
+    closedir(dir);
+    rmdir(private_dir);
+    private_dir[0] = 0;
 }
 
 /* Translate a name from the host FS to a CP/M name. This will (if necessary)
@@ -239,3 +264,152 @@ static char* skipUser(char* localname) {
     *--s = drive;                       /* reinsert the drive just before the : */
     return s;
 }
+
+
+/* Files on P: whose names match one of the given patterns ("*.$$$ *.TMP")
+ * are kept in a directory private to this process, so two programs run in
+ * the same directory can't see or clobber each other's temporary files.
+ * The directory is made in the current directory when first needed, so
+ * renames between it and P: stay on one filesystem, and fcb_deinit()
+ * removes it. Its name starts with a dot, so CP/M never sees it.
+ *
+ * Patterns are separated by spaces or commas. Returns the number of
+ * patterns accepted, or 0 if any of them is not a valid CP/M name.
+ */
+
+int xlt_private(char *patterns)
+{
+    cpm_byte *pat;
+    char *s = patterns;
+    int n, len;
+
+    n_private = 0;
+    while (*s)
+    {
+        if (*s == ' ' || *s == ',')
+        {
+            ++s;
+            continue;
+        }
+        if (n_private == MAX_PRIVATE) return 0;
+        pat = private_pat[n_private++];
+        memset(pat, ' ', 11);
+        for (n = 0, len = 8; *s && *s != ' ' && *s != ','; ++s)
+        {
+            if (*s == '.')
+            {
+                if (len == 3) return 0;	/* Two dots */
+                n = 8;
+                len = 3;
+            }
+            else if (*s == '*')
+            {
+                while (n < (len == 8 ? 8 : 11)) pat[n++] = '?';
+            }
+            else
+            {
+                if (n >= (len == 8 ? 8 : 11)) return 0;	/* Too long */
+                pat[n++] = toupper(*s);
+            }
+        }
+    }
+    return n_private;
+}
+
+/* Does every name the FCB could match fall within a private pattern? A '?'
+ * in the FCB only matches a '?' in the pattern, so "DEL *.$$$" is private
+ * but "DIR *.*" is not. */
+
+static int is_private(cpm_byte *fcb)
+{
+    int n, m;
+    cpm_byte c;
+
+    for (n = 0; n < n_private; n++)
+    {
+        for (m = 0; m < 11; m++)
+        {
+            c = fcb[m + 1] & 0x7F;
+            if (islower(c)) c = toupper(c);
+            if (private_pat[n][m] != '?' && private_pat[n][m] != c) break;
+        }
+        if (m == 11) return 1;
+    }
+    return 0;
+}
+
+/* Create a directory with a name of its own, filling in the X's that end
+ * path. mkdtemp() does this where there is one; DOS and Windows have none,
+ * so there numbered names are tried until one is free. */
+
+#if defined(_WIN32) || defined(__MSDOS__)
+#define PRIVATE_NAME "zxccXXXX"	/* 8.3 for DOS */
+
+static int make_dir(char *path)
+{
+    char *x = path + strlen(path);
+    unsigned n, len = 0;
+
+    while (x > path && x[-1] == 'X') { x--; len++; }
+    for (n = 0; n < 10000; n++)
+    {
+        sprintf(x, "%0*u", (int)len, n);
+        if (!mkdir(path, 0700)) return 1;
+        if (errno != EEXIST) break;
+    }
+    return 0;
+}
+#else
+#define PRIVATE_NAME ".zxccXXXXXX"
+
+static int make_dir(char *path)
+{
+    return mkdtemp(path) != NULL;
+}
+#endif
+
+/* The host directory that the file(s) an FCB names are in */
+
+char *redir_fcb_prefix(cpm_byte *fcb)
+{
+    int drv = fcb[0] & 0x7F;
+
+    if (!drv || drv == '?') drv = redir_cpmdrive;
+    else                    drv--;
+
+    if (drv != 15 || !n_private || !is_private(fcb))
+        return redir_drive_prefix[drv];
+
+    if (!private_dir[0])
+    {
+        strcpy(private_dir, redir_drive_prefix[15]);
+        strcat(private_dir, PRIVATE_NAME);
+        if (!make_dir(private_dir))
+        {
+            redir_Msg("Cannot create private directory %s\n", private_dir);
+            private_dir[0] = 0;
+            return redir_drive_prefix[drv];
+        }
+        strcat(private_dir, "/");
+    }
+    return private_dir;
+}
+
+/* Log the names of files used, for tools like the zxc compile cache that
+ * need to know what a program read and wrote. Each line is "r name" for a
+ * file opened or "w name" for one created or renamed into place, with the
+ * host name as the redirector saw it. Returns 0 if the log can't be
+ * opened. */
+
+int xlt_trace(char *fname)
+{
+    trace_fp = fopen(fname, "a");
+    return trace_fp != NULL;
+}
+
+void xlt_trace_name(int type, char *name)
+{
+    if (!trace_fp) return;
+    fprintf(trace_fp, "%c %s\n", type, name);
+    fflush(trace_fp);
+}
@@ -34,21 +34,21 @@
 
 {
    unsigned short addr;
-   unsigned char op,reg,val;
-   if(ixoriy){
-      addr=(ixoriy==1?ix:iy)+(signed char)fetch(pc);
-      pc++;
-      tstates+=8;
-      op=fetch(pc);
-      reg=op&7;
-      op=(op&0xf8)|6;
-   }
-   else{
-      op=fetch(pc);
-      tstates+=4;
-      radjust++;
-      addr=hl;
-   }
+   unsigned char op,val;
+#if IXORIY
+   unsigned char reg;
+   addr=xhl+(signed char)fetch(pc);
+   pc++;
+   tstates+=8;
+   op=fetch(pc);
+   reg=op&7;
+   op=(op&0xf8)|6;
+#else
+   op=fetch(pc);
+   tstates+=4;
+   radjust++;
+   addr=hl;
+#endif
    pc++;
 
    if(op<64)switch(op){
@@ -146,7 +146,8 @@
       case 0xc7: set(n,a); break;
       }
    }
-   if(ixoriy)switch(reg){
+#if IXORIY
+   switch(reg){
       case 0:b=val; break;
       case 1:c=val; break;
       case 2:d=val; break;
@@ -155,6 +156,7 @@
       case 5:l=val; break;
       case 7:a=val; break;
    }
+#endif
 }
 
 #undef var_t
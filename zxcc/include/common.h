@@ -8,4 +8,7 @@ extern char cmdbuf[CMD_BUF_SIZE];
 int fname_opt(char *arg, char c, char *cmdbuf);
 int cref_opt(char *arg, char *cmdbuf);
 
+/* Append " prefix arg" to the command in cmdbuf */
+void add_arg(char *cmdbuf, const char *prefix, const char *arg);
+
 #endif /* COMMON_H */
\ No newline at end of file
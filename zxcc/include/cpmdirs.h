@@ -0,0 +1,42 @@
+#ifndef CPMDIRS_H
+#define CPMDIRS_H
+
+/*
+ *  Change the directories in these #defines if necessary. Note trailing slash.
+ */
+#ifndef _WIN32
+#include "config.h"
+#define ISDIRSEP(c) ((c) == '/')
+#define DIRSEPCH '/'
+#define DIRSEP "/"
+#else
+#include "config-win.h"
+#define ISDIRSEP(c) ((c) == '/' || (c) == '\\')
+#define DIRSEPCH '\\'
+#define DIRSEP "/\\:"
+#endif
+
+#ifndef CPMDIR80
+#ifdef _MSC_VER
+#define CPMDIR80 "d:/local/lib/cpm/"
+#else
+#define CPMDIR80 "/usr/local/lib/cpm/"
+#endif
+#endif
+
+/* the default sub directories trailing / is required */
+#define BIN80 "bin80/"
+#define LIB80 "lib80/"
+#define INC80 "include80/"
+
+#ifndef BINDIR80
+#define BINDIR80 CPMDIR80 BIN80
+#endif
+#ifndef LIBDIR80
+#define LIBDIR80 CPMDIR80 LIB80
+#endif
+#ifndef INCDIR80
+#define INCDIR80 CPMDIR80 INC80
+#endif
+
+#endif /* CPMDIRS_H */
@@ -27,8 +27,7 @@
                         (((hl&0xfff)<(z&0xfff)+cy)<<4)|\
                         (((hl^z)&(hl^t)&0x8000)>>13)|\
                         ((!(t&0xffff))<<6)|2;\
-                      l=t;\
-                      h=t>>8;\
+                      hl=t;\
                    }
 
 #define adchl(x) {    unsigned short z=(x);\
@@ -37,8 +36,7 @@
                         (((hl&0xfff)+(z&0xfff)+cy>0xfff)<<4)|\
                         (((~hl^z)&(hl^t)&0x8000)>>13)|\
                         ((!(t&0xffff))<<6)/*|2*/;\
-                      l=t;\
-                      h=t>>8;\
+                      hl=t;\
                  }
 /* [JCE] The "|2" should not be there, at least according to my tests on 
  * a PCW16. The PCW16's ADC always resets that bit. */
@@ -350,19 +348,19 @@ endinstr;
 instr(0xa0,12);
    {unsigned char x=fetch(hl);
     store(de,x);
-    if(!++l)h++;
-    if(!++e)d++;
-    if(!c--)b--;
-    f=(f&0xc1)|(x&0x28)|(((b|c)>0)<<2);
+    hl++;
+    de++;
+    bc--;
+    f=(f&0xc1)|(x&0x28)|((bc!=0)<<2);
    }
 endinstr;
 
 instr(0xa1,12);
    {unsigned char carry=cy;
     cpa(fetch(hl));
-    if(!++l)h++;
-    if(!c--)b--;
-    f=(f&0xfa)|carry|(((b|c)>0)<<2);
+    hl++;
+    bc--;
+    f=(f&0xfa)|carry|((bc!=0)<<2);
    }
 endinstr;
 
@@ -370,7 +368,7 @@ instr(0xa2,12);
    {unsigned short t=in(tstates,b,c);
     store(hl,t);
     tstates+=t>>8;
-    if(!++l)h++;
+    hl++;
     b--;
     f=(b&0xa8)|((b==0)<<6)|2|((parity(b)^c)&4);
    }
@@ -382,7 +380,7 @@ instr(0xa3,12); /* I can't determine the correct flags outcome for the
                    doesn't seem to be the case... */
    {unsigned char x=fetch(hl);
     tstates+=out(tstates,b,c,x);
-    if(!++l)h++;
+    hl++;
     b--;
     f=(f&1)|0x12|(b&0xa8)|((b==0)<<6);
    }
@@ -391,19 +389,19 @@ endinstr;
 instr(0xa8,12);
    {unsigned char x=fetch(hl);
     store(de,x);
-    if(!l--)h--;
-    if(!e--)d--;
-    if(!c--)b--;
-    f=(f&0xc1)|(x&0x28)|(((b|c)>0)<<2);
+    hl--;
+    de--;
+    bc--;
+    f=(f&0xc1)|(x&0x28)|((bc!=0)<<2);
    }
 endinstr;
 
 instr(0xa9,12);
    {unsigned char carry=cy;
     cpa(fetch(hl));
-    if(!l--)h--;
-    if(!c--)b--;
-    f=(f&0xfa)|carry|(((b|c)>0)<<2);
+    hl--;
+    bc--;
+    f=(f&0xfa)|carry|((bc!=0)<<2);
    }
 endinstr;
 
@@ -411,7 +409,7 @@ instr(0xaa,12);
    {unsigned short t=in(tstates,b,c);
     store(hl,t);
     tstates+=t>>8;
-    if(!l--)h--;
+    hl--;
     b--;
     f=(b&0xa8)|((b==0)<<6)|2|((parity(b)^c^4)&4);
    }
@@ -420,7 +418,7 @@ endinstr;
 instr(0xab,12);
    {unsigned char x=fetch(hl);
     tstates+=out(tstates,b,c,x);
-    if(!l--)h--;
+    hl--;
     b--;
     f=(f&1)|0x12|(b&0xa8)|((b==0)<<6);
    }
@@ -432,20 +430,20 @@ endinstr;
 instr(0xb0,12);
    {unsigned char x=fetch(hl);
     store(de,x);
-    if(!++l)h++;
-    if(!++e)d++;
-    if(!c--)b--;
-    f=(f&0xc1)|(x&0x28)|(((b|c)>0)<<2);
-    if(b|c)pc-=2,tstates+=5;
+    hl++;
+    de++;
+    bc--;
+    f=(f&0xc1)|(x&0x28)|((bc!=0)<<2);
+    if(bc)pc-=2,tstates+=5;
    }
 endinstr;
 
 instr(0xb1,12);
    {unsigned char carry=cy;
     cpa(fetch(hl));
-    if(!++l)h++;
-    if(!c--)b--;
-    f=(f&0xfa)|carry|(((b|c)>0)<<2);
+    hl++;
+    bc--;
+    f=(f&0xfa)|carry|((bc!=0)<<2);
     if((f&0x44)==4)pc-=2,tstates+=5;
    }
 endinstr;
@@ -454,7 +452,7 @@ instr(0xb2,12);
    {unsigned short t=in(tstates,b,c);
     store(hl,t);
     tstates+=t>>8;
-    if(!++l)h++;
+    hl++;
     b--;
     f=(b&0xa8)|((b==0)<<6)|2|((parity(b)^c)&4);
     if(b)pc-=2,tstates+=5;
@@ -464,7 +462,7 @@ endinstr;
 instr(0xb3,12);
    {unsigned char x=fetch(hl);
     tstates+=out(tstates,b,c,x);
-    if(!++l)h++;
+    hl++;
     b--;
     f=(f&1)|0x12|(b&0xa8)|((b==0)<<6);
     if(b)pc-=2,tstates+=5;
@@ -474,20 +472,20 @@ endinstr;
 instr(0xb8,12);
    {unsigned char x=fetch(hl);
     store(de,x);
-    if(!l--)h--;
-    if(!e--)d--;
-    if(!c--)b--;
-    f=(f&0xc1)|(x&0x28)|(((b|c)>0)<<2);
-    if(b|c)pc-=2,tstates+=5;
+    hl--;
+    de--;
+    bc--;
+    f=(f&0xc1)|(x&0x28)|((bc!=0)<<2);
+    if(bc)pc-=2,tstates+=5;
    }
 endinstr;
 
 instr(0xb9,12);
    {unsigned char carry=cy;
     cpa(fetch(hl));
-    if(!l--)h--;
-    if(!c--)b--;
-    f=(f&0xfa)|carry|(((b|c)>0)<<2);
+    hl--;
+    bc--;
+    f=(f&0xfa)|carry|((bc!=0)<<2);
     if((f&0x44)==4)pc-=2,tstates+=5;
    }
 endinstr;
@@ -496,7 +494,7 @@ instr(0xba,12);
    {unsigned short t=in(tstates,b,c);
     store(hl,t);
     tstates+=t>>8;
-    if(!l--)h--;
+    hl--;
     b--;
     f=(b&0xa8)|((b==0)<<6)|2|((parity(b)^c^4)&4);
     if(b)pc-=2,tstates+=5;
@@ -506,7 +504,7 @@ endinstr;
 instr(0xbb,12);
    {unsigned char x=fetch(hl);
     tstates+=out(tstates,b,c,x);
-    if(!l--)h--;
+    hl--;
     b--;
     f=(f&1)|0x12|(b&0xa8)|((b==0)<<6);
     if(b)pc-=2,tstates+=5;
@@ -559,6 +557,7 @@ instr(0xfe, 4);
 	
 	xa = a; xb = b; xc = c; xd = d; xe = e; xf = f; xxh = h; xxl = l;
 	xp = pc; xx = ix; xy = iy;
+	z80_insns = insns; z80_tstates = tstates;
 	
 	ed_fe(&xa,&xb,&xc,&xd,&xe,&xf,&xxh,&xxl,&xp,&xx,&xy);
 	
@@ -0,0 +1,101 @@
+#ifndef HTOBJ_H
+#define HTOBJ_H
+
+#include <stddef.h>
+
+/* Hi-Tech C object files and libraries, as written by ZAS and LIBR.
+ *
+ * An object file is a run of records, each a 16-bit little-endian length,
+ * a type byte and that many bytes of data, ending with an END record. On
+ * disk it is padded with ^Z to a whole number of CP/M records.
+ *
+ * A library starts with the size of its directory and the number of
+ * modules (16 bits each), then for each module:
+ *
+ *     16 bits    size of the symbol list
+ *     16 bits    number of symbols
+ *     32 bits    length of the module
+ *     32 bits    zero
+ *     name\0     module name, as it was given to LIBR
+ *     symbols    for each global symbol: a flag byte (0 defined, 6
+ *                undefined) and name\0
+ *
+ * The modules follow the directory in the same order.
+ */
+
+/* Record types */
+#define HT_TEXT     1
+#define HT_PSECT    2
+#define HT_RELOC    3
+#define HT_SYM      4
+#define HT_START    5
+#define HT_END      6
+#define HT_IDENT    7
+
+/* Symbol flags in SYM records */
+#define HT_GLOBAL   0x10
+#define HT_SYMTYPE  0x0F
+#define HT_EXTERN   6
+
+typedef struct {
+    char *name;
+    unsigned char *data;    /* The object file, up to its END record */
+    long len;
+    unsigned char *syms;    /* Directory symbols: flag byte and name\0 */
+    int symlen;
+    int nsyms;
+} ht_module;
+
+typedef struct {
+    ht_module *mods;
+    int nmods;
+    int maxmods;
+} ht_library;
+
+/* Length of the object file in data[0..size) up to and including its END
+ * record, or -1 if it is not a well-formed object file. */
+long ht_objlen(const unsigned char *data, long size);
+
+/* Load an object file as a module called name. Returns 0 if it could not
+ * be read (errno is set) or -1 if it is not an object file. */
+int ht_readobj(const char *path, const char *name, ht_module *m);
+
+/* Load a library. Returns 0 if it could not be read (errno is set) or -1
+ * if it is not a library. */
+int ht_readlib(const char *path, ht_library *lib);
+
+/* The library file as LIBR would write it, in malloc'd memory. */
+unsigned char *ht_packlib(const ht_library *lib, long *size);
+
+/* Find a module by name, ignoring case as LIBR does. Returns its index or
+ * -1. */
+int ht_findmod(const ht_library *lib, const char *name);
+
+/* Add a module at the end, taking over its memory. */
+void ht_addmod(ht_library *lib, ht_module *m);
+
+/* Remove module n */
+void ht_delmod(ht_library *lib, int n);
+
+void ht_freemod(ht_module *m);
+void ht_freelib(ht_library *lib);
+
+/* Helpers for the tools that use these files */
+
+/* realloc(), exiting if there is no memory */
+void *ht_realloc(void *p, size_t size);
+
+/* Little-endian words and long words, as in the files */
+unsigned ht_rd16(const unsigned char *p);
+unsigned long ht_rd32(const unsigned char *p);
+
+/* Write data[0..size) to path. Returns 0 if it could not be written
+ * (errno is set). */
+int ht_writefile(const char *path, const unsigned char *data, long size);
+
+/* Compare the file at path with data[0..size). Returns 1 if they are the
+ * same, 0 if not, with *pos set to the offset of the first difference, or
+ * -1 if the file could not be opened (errno is set). */
+int ht_cmpfile(const char *path, const unsigned char *data, long size, long *pos);
+
+#endif /* HTOBJ_H */
@@ -44,6 +44,10 @@ int interrupt();
 int snapload();
 void snapsave();
 void mainloop(word xpc, word xsp);
+
+/* Instructions run and T-states taken by mainloop(), as they were at the
+ * last ZXCC trap (so, when the program exits, at its end) */
+extern unsigned long z80_insns, z80_tstates;
 void eachframe();
 void itimeron();
 void itimeroff();
@@ -60,9 +64,22 @@ void drawborder();
 #define fetch(x) (RAM[x])
 #define fetch2(x) ((fetch((x)+1)<<8)|fetch(x))
 
-#define store(x,y) do { RAM[(x)] = (y); } while(0)
+/* A store over translated code (see zxxlat.h) has to drop the translation.
+ * Telling the compiler that translation is off keeps the check out of the
+ * way of the interpreter when it is. */
+#ifdef __GNUC__
+#define unlikely(x) __builtin_expect((x), 0)
+#else
+#define unlikely(x) (x)
+#endif
+#define xlat_stored(x) do { if (unlikely(xlat_code != NULL) && \
+                                xlat_code[(x)]) \
+                               xlat_smc(x); } while(0)
+
+#define store(x,y) do { xlat_stored(x); RAM[(x)] = (y); } while(0)
 
 #define store2b(x,hi,lo) do {\
+	  xlat_stored(x); xlat_stored((x+1) & 0xFFFF); \
           RAM[(x)]=(lo); \
 	  RAM[((x+1) & 0xFFFF)]=(hi); } while(0)
 
@@ -81,7 +98,3 @@ static void inline store2func(unsigned short ad,unsigned char b1,unsigned char b
 #undef store2b
 #define store2b(x,hi,lo) store2func(x,hi,lo)
 #endif
-
-#define bc ((b<<8)|c)
-#define de ((d<<8)|e)
-#define hl ((h<<8)|l)
@@ -16,31 +16,25 @@
  * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+/* This file is included three times by z80.c to build one opcode table
+ * each for unprefixed, DD and FD prefixed instructions, with IXORIY set
+ * to 0, 1 and 2.  xhl, xh and xl name HL, IX or IY and their halves for
+ * the table being built.  Instructions that a DD or FD prefix does not
+ * affect only appear in the first table; the other two fall back to it.
+ */
+
+#ifndef Z80OPS_COMMON
+#define Z80OPS_COMMON
+
 #ifdef __linux__
 #include <sys/vfs.h>
 #endif
 
 #define instr(opcode,cycles) case opcode: {tstates+=cycles
-#define HLinstr(opcode,cycles,morecycles) \
-                             case opcode: {unsigned short addr; \
-                                tstates+=cycles; \
-                                if(ixoriy==0)addr=hl; \
-                                else tstates+=morecycles, \
-                                   addr=(ixoriy==1?ix:iy)+ \
-                                        (signed char)fetch(pc),\
-                                   pc++
 #define endinstr             }; break
 
 #define cy (f&1)
 
-#define xh (ixoriy==0?h:ixoriy==1?(ix>>8):(iy>>8))
-#define xl (ixoriy==0?l:ixoriy==1?(ix&0xff):(iy&0xff))
-
-#define setxh(x) (ixoriy==0?(h=(x)):ixoriy==1?(ix=(ix&0xff)|((x)<<8)):\
-                  (iy=(iy&0xff)|((x)<<8)))
-#define setxl(x) (ixoriy==0?(l=(x)):ixoriy==1?(ix=(ix&0xff00)|(x)):\
-                  (iy=(iy&0xff00)|(x)))
-
 #define inc(var) /* 8-bit increment */ ( var++,\
                                          f=(f&1)|(var&0xa8)|\
                                            ((!(var&15))<<4)|((!var)<<6)|\
@@ -52,17 +46,11 @@
                                             ((!var)<<6)\
                                        )
 #define swap(x,y) {unsigned char t=x; x=y; y=t;}
-#define addhl(hi,lo) /* 16-bit add */ if(!ixoriy){\
-                      unsigned short t;\
-                      l=t=l+(lo);\
-                      f=(f&0xc4)|(((t>>=8)+(h&0x0f)+((hi)&0x0f)>15)<<4);\
-                      h=t+=h+(hi);\
-                      f|=(h&0x28)|(t>>8);\
-                   }\
-                   else do{unsigned long t=(ixoriy==1?ix:iy);\
-                      f=(f&0xc4)|(((t&0xfff)+((hi<<8)|lo)>0xfff)<<4);\
-                      t+=(hi<<8)|lo;\
-                      if(ixoriy==1)ix=t; else iy=t;\
+#define swap2(x,y) {unsigned short t=x; x=y; y=t;}
+#define add16(var,x) /* 16-bit add */ do{unsigned long t=(x);\
+                      f=(f&0xc4)|((((var)&0xfff)+(t&0xfff)>0xfff)<<4);\
+                      t+=(var);\
+                      var=t;\
                       f|=((t>>8)&0x28)|(t>>16);\
                    } while(0)
 #define adda(x,c) /* 8-bit add */ do{unsigned short y;\
@@ -121,6 +109,33 @@
                                                  store2b(sp,v1,v2);\
                                               }while(0)
 
+#endif
+
+#if IXORIY==0
+#define xhl hl
+#define xh  h
+#define xl  l
+#define HLinstr(opcode,cycles,morecycles) \
+                             case opcode: {unsigned short addr=hl; \
+                                tstates+=cycles
+#else
+#if IXORIY==1
+#define xhl ix
+#define xh  ixh
+#define xl  ixl
+#else
+#define xhl iy
+#define xh  iyh
+#define xl  iyl
+#endif
+#define HLinstr(opcode,cycles,morecycles) \
+                             case opcode: {unsigned short addr; \
+                                tstates+=cycles+morecycles; \
+                                addr=xhl+(signed char)fetch(pc); \
+                                pc++
+#endif
+
+#if IXORIY==0
 instr(0,4);
    /* nop */
 endinstr;
@@ -135,7 +150,7 @@ instr(2,7);
 endinstr;
 
 instr(3,6);
-   if(!++c)b++;
+   bc++;
 endinstr;
 
 instr(4,4);
@@ -159,17 +174,19 @@ instr(8,4);
    swap(a,a1);
    swap(f,f1);
 endinstr;
+#endif
 
 instr(9,11);
-   addhl(b,c);
+   add16(xhl,bc);
 endinstr;
 
+#if IXORIY==0
 instr(10,7);
    a=fetch(bc);
 endinstr;
 
 instr(11,6);
-   if(!c--)b--;
+   bc--;
 endinstr;
 
 instr(12,4);
@@ -205,7 +222,7 @@ instr(18,7);
 endinstr;
 
 instr(19,6);
-   if(!++e)d++;
+   de++;
 endinstr;
 
 instr(20,4);
@@ -230,17 +247,19 @@ endinstr;
 instr(24,7);
    jr;
 endinstr;
+#endif
 
 instr(25,11);
-   addhl(d,e);
+   add16(xhl,de);
 endinstr;
 
+#if IXORIY==0
 instr(26,7);
    a=fetch(de);
 endinstr;
 
 instr(27,6);
-   if(!e--)d--;
+   de--;
 endinstr;
 
 instr(28,4);
@@ -266,59 +285,47 @@ instr(32,7);
   if(f&0x40)pc++;
   else jr;
 endinstr;
+#endif
 
 instr(33,10);
-   if(!ixoriy){
-      l=fetch(pc),pc++;
-      h=fetch(pc),pc++;
-   }
-   else {
-      if(ixoriy==1)ix=fetch2(pc);
-      else iy=fetch2(pc);
-      pc+=2;
-   }
+#if IXORIY==0
+   l=fetch(pc),pc++;
+   h=fetch(pc),pc++;
+#else
+   xhl=fetch2(pc);
+   pc+=2;
+#endif
 endinstr;
 
 instr(34,16);
    {unsigned short addr=fetch2(pc);
     pc+=2;
-    if(!ixoriy)store2b(addr,h,l);
-    else if(ixoriy==1)store2(addr,ix);
-    else store2(addr,iy);
+#if IXORIY==0
+    store2b(addr,h,l);
+#else
+    store2(addr,xhl);
+#endif
    }
 endinstr;
 
 instr(35,6);
-   if(!ixoriy){if(!++l)h++;}
-   else if(ixoriy==1)ix++;
-   else iy++;
+   xhl++;
 endinstr;
 
 instr(36,4);
-   if(ixoriy==0)inc(h);
-   else{unsigned char t;
-      t=(ixoriy==1?ix:iy)>>8;
-      inc(t);
-      if(ixoriy==1)ix=(ix&0xff)|(t<<8);
-      else iy=(iy&0xff)|(t<<8);
-   }
+   inc(xh);
 endinstr;
 
 instr(37,4);
-   if(ixoriy==0)dec(h);
-   else{unsigned char t;
-      t=(ixoriy==1?ix:iy)>>8;
-      dec(t);
-      if(ixoriy==1)ix=(ix&0xff)|(t<<8);
-      else iy=(iy&0xff)|(t<<8);
-   }
+   dec(xh);
 endinstr;
 
 instr(38,7);
-   setxh(fetch(pc));
+   xh=fetch(pc);
    pc++;
 endinstr;
 
+#if IXORIY==0
 instr(39,4);
    {
    /* Frank D. Cringle's DAA implementation, converted from yaze 1.10 */
@@ -365,56 +372,42 @@ instr(40,7);
    if(f&0x40)jr;
    else pc++;
 endinstr;
+#endif
 
 instr(41,11);
-   if(!ixoriy)addhl(h,l);
-   else if(ixoriy==1)addhl((ix>>8),(ix&0xff));
-   else addhl((iy>>8),(iy&0xff));
+   add16(xhl,xhl);
 endinstr;
 
 instr(42,16);
   {unsigned short addr=fetch2(pc);
    pc+=2;
-   if(!ixoriy){
-      l=fetch(addr);
-      h=fetch(addr+1);
-   }
-   else if(ixoriy==1)ix=fetch2(addr);
-   else iy=fetch2(addr);
+#if IXORIY==0
+   l=fetch(addr);
+   h=fetch(addr+1);
+#else
+   xhl=fetch2(addr);
+#endif
   }
 endinstr;
 
 instr(43,6);
-   if(!ixoriy){if(!l--)h--;}
-   else if(ixoriy==1)ix--;
-   else iy--;
+   xhl--;
 endinstr;
 
 instr(44,4);
-   if(!ixoriy)inc(l);
-   else {unsigned char t;
-      t=(ixoriy==1?ix:iy);
-      inc(t);
-      if(ixoriy==1)ix=(ix&0xff00)|t;
-      else iy=(iy&0xff00)|t;
-   }
+   inc(xl);
 endinstr;
 
 instr(45,4);
-   if(!ixoriy)dec(l);
-   else {unsigned char t;
-      t=(ixoriy==1?ix:iy);
-      dec(t);
-      if(ixoriy==1)ix=(ix&0xff00)|t;
-      else iy=(iy&0xff00)|t;
-   }
+   dec(xl);
 endinstr;
 
 instr(46,7);
-   setxl(fetch(pc));
+   xl=fetch(pc);
    pc++;
 endinstr;
 
+#if IXORIY==0
 instr(47,4);
    a=~a;
    f=(f&0xc5)|(a&0x28)|0x12;
@@ -440,6 +433,7 @@ endinstr;
 instr(51,6);
    sp++;
 endinstr;
+#endif
 
 HLinstr(52,11,8);
   {unsigned char t=fetch(addr);
@@ -460,6 +454,7 @@ HLinstr(54,10,5);
    pc++;
 endinstr;
 
+#if IXORIY==0
 instr(55,4);
    f=(f&0xc4)|1|(a&0x28);
 endinstr;
@@ -468,11 +463,13 @@ instr(56,7);
    if(f&1)jr;
    else pc++;
 endinstr;
+#endif
 
 instr(57,11);
-   addhl((sp>>8),(sp&0xff));
+   add16(xhl,sp);
 endinstr;
 
+#if IXORIY==0
 instr(58,13);
   {unsigned short addr=fetch2(pc);
    pc+=2;
@@ -515,6 +512,7 @@ endinstr;
 instr(0x43,4);
    b=e;
 endinstr;
+#endif
 
 instr(0x44,4);
    b=xh;
@@ -528,6 +526,7 @@ HLinstr(0x46,7,8);
    b=fetch(addr);
 endinstr;
 
+#if IXORIY==0
 instr(0x47,4);
    b=a;
 endinstr;
@@ -547,6 +546,7 @@ endinstr;
 instr(0x4b,4);
    c=e;
 endinstr;
+#endif
 
 instr(0x4c,4);
    c=xh;
@@ -560,6 +560,7 @@ HLinstr(0x4e,7,8);
    c=fetch(addr);
 endinstr;
 
+#if IXORIY==0
 instr(0x4f,4);
    c=a;
 endinstr;
@@ -579,6 +580,7 @@ endinstr;
 instr(0x53,4);
    d=e;
 endinstr;
+#endif
 
 instr(0x54,4);
    d=xh;
@@ -592,6 +594,7 @@ HLinstr(0x56,7,8);
    d=fetch(addr);
 endinstr;
 
+#if IXORIY==0
 instr(0x57,4);
    d=a;
 endinstr;
@@ -611,6 +614,7 @@ endinstr;
 instr(0x5b,4);
    /* ld e,e */
 endinstr;
+#endif
 
 instr(0x5c,4);
    e=xh;
@@ -624,32 +628,36 @@ HLinstr(0x5e,7,8);
    e=fetch(addr);
 endinstr;
 
+#if IXORIY==0
 instr(0x5f,4);
    e=a;
 endinstr;
+#endif
 
 instr(0x60,4);
-   setxh(b);
+   xh=b;
 endinstr;
 
 instr(0x61,4);
-   setxh(c);
+   xh=c;
 endinstr;
 
 instr(0x62,4);
-   setxh(d);
+   xh=d;
 endinstr;
 
 instr(0x63,4);
-   setxh(e);
+   xh=e;
 endinstr;
 
+#if IXORIY==0
 instr(0x64,4);
    /* ld h,h */
 endinstr;
+#endif
 
 instr(0x65,4);
-   setxh(xl);
+   xh=xl;
 endinstr;
 
 HLinstr(0x66,7,8);
@@ -657,39 +665,41 @@ HLinstr(0x66,7,8);
 endinstr;
 
 instr(0x67,4);
-   setxh(a);
+   xh=a;
 endinstr;
 
 instr(0x68,4);
-   setxl(b);
+   xl=b;
 endinstr;
 
 instr(0x69,4);
-   setxl(c);
+   xl=c;
 endinstr;
 
 instr(0x6a,4);
-   setxl(d);
+   xl=d;
 endinstr;
 
 instr(0x6b,4);
-   setxl(e);
+   xl=e;
 endinstr;
 
 instr(0x6c,4);
-   setxl(xh);
+   xl=xh;
 endinstr;
 
+#if IXORIY==0
 instr(0x6d,4);
    /* ld l,l */
 endinstr;
+#endif
 
 HLinstr(0x6e,7,8);
    l=fetch(addr);
 endinstr;
 
 instr(0x6f,4);
-   setxl(a);
+   xl=a;
 endinstr;
 
 HLinstr(0x70,7,8);
@@ -716,14 +726,17 @@ HLinstr(0x75,7,8);
    store(addr,l);
 endinstr;
 
+#if IXORIY==0
 instr(0x76,4);
 	/* Was HALT - ZXCC ignores HALT */
 endinstr;
+#endif
 
 HLinstr(0x77,7,8);
    store(addr,a);
 endinstr;
 
+#if IXORIY==0
 instr(0x78,4);
    a=b;
 endinstr;
@@ -739,6 +752,7 @@ endinstr;
 instr(0x7b,4);
    a=e;
 endinstr;
+#endif
 
 instr(0x7c,4);
    a=xh;
@@ -752,6 +766,7 @@ HLinstr(0x7e,7,8);
    a=fetch(addr);
 endinstr;
 
+#if IXORIY==0
 instr(0x7f,4);
    /* ld a,a */
 endinstr;
@@ -771,6 +786,7 @@ endinstr;
 instr(0x83,4);
    adda(e,0);
 endinstr;
+#endif
 
 instr(0x84,4);
    adda(xh,0);
@@ -784,6 +800,7 @@ HLinstr(0x86,7,8);
    adda(fetch(addr),0);
 endinstr;
 
+#if IXORIY==0
 instr(0x87,4);
    adda(a,0);
 endinstr;
@@ -803,6 +820,7 @@ endinstr;
 instr(0x8b,4);
    adda(e,cy);
 endinstr;
+#endif
 
 instr(0x8c,4);
    adda(xh,cy);
@@ -816,6 +834,7 @@ HLinstr(0x8e,7,8);
    adda(fetch(addr),cy);
 endinstr;
 
+#if IXORIY==0
 instr(0x8f,4);
    adda(a,cy);
 endinstr;
@@ -835,6 +854,7 @@ endinstr;
 instr(0x93,4);
    suba(e,0);
 endinstr;
+#endif
 
 instr(0x94,4);
    suba(xh,0);
@@ -848,6 +868,7 @@ HLinstr(0x96,7,8);
    suba(fetch(addr),0);
 endinstr;
 
+#if IXORIY==0
 instr(0x97,4);
    suba(a,0);
 endinstr;
@@ -867,6 +888,7 @@ endinstr;
 instr(0x9b,4);
    suba(e,cy);
 endinstr;
+#endif
 
 instr(0x9c,4);
    suba(xh,cy);
@@ -880,6 +902,7 @@ HLinstr(0x9e,7,8);
    suba(fetch(addr),cy);
 endinstr;
 
+#if IXORIY==0
 instr(0x9f,4);
    suba(a,cy);
 endinstr;
@@ -899,6 +922,7 @@ endinstr;
 instr(0xa3,4);
    anda(e);
 endinstr;
+#endif
 
 instr(0xa4,4);
    anda(xh);
@@ -912,6 +936,7 @@ HLinstr(0xa6,7,8);
    anda(fetch(addr));
 endinstr;
 
+#if IXORIY==0
 instr(0xa7,4);
    anda(a);
 endinstr;
@@ -931,6 +956,7 @@ endinstr;
 instr(0xab,4);
    xora(e);
 endinstr;
+#endif
 
 instr(0xac,4);
    xora(xh);
@@ -944,6 +970,7 @@ HLinstr(0xae,7,8);
    xora(fetch(addr));
 endinstr;
 
+#if IXORIY==0
 instr(0xaf,4);
    xora(a);
 endinstr;
@@ -963,6 +990,7 @@ endinstr;
 instr(0xb3,4);
    ora(e);
 endinstr;
+#endif
 
 instr(0xb4,4);
    ora(xh);
@@ -976,6 +1004,7 @@ HLinstr(0xb6,7,8);
    ora(fetch(addr));
 endinstr;
 
+#if IXORIY==0
 instr(0xb7,4);
    ora(a);
 endinstr;
@@ -995,6 +1024,7 @@ endinstr;
 instr(0xbb,4);
    cpa(e);
 endinstr;
+#endif
 
 instr(0xbc,4);
    cpa(xh);
@@ -1008,6 +1038,7 @@ HLinstr(0xbe,7,8);
    cpa(fetch(addr));
 endinstr;
 
+#if IXORIY==0
 instr(0xbf,4);
    cpa(a);
 endinstr;
@@ -1017,7 +1048,7 @@ instr(0xc0,5);
 endinstr;
 
 instr(0xc1,10);
-   pop1(b,c);
+   pop2(bc);
 endinstr;
 
 instr(0xc2,10);
@@ -1035,7 +1066,7 @@ instr(0xc4,10);
 endinstr;
 
 instr(0xc5,11);
-   push1(b,c);
+   push2(bc);
 endinstr;
 
 instr(0xc6,7);
@@ -1060,11 +1091,13 @@ instr(0xca,10);
    if(f&0x40)jp;
    else pc+=2;
 endinstr;
+#endif
 
 instr(0xcb,4);
 #include "cbops.h"
 endinstr;
 
+#if IXORIY==0
 instr(0xcc,10);
    if(f&0x40)call;
    else pc+=2;
@@ -1089,7 +1122,7 @@ instr(0xd0,5);
 endinstr;
 
 instr(0xd1,10);
-   pop1(d,e);
+   pop2(de);
 endinstr;
 
 instr(0xd2,10);
@@ -1108,7 +1141,7 @@ instr(0xd4,10);
 endinstr;
 
 instr(0xd5,11);
-   push1(d,e);
+   push2(de);
 endinstr;
 
 instr(0xd6,7);
@@ -1126,12 +1159,9 @@ instr(0xd8,5);
 endinstr;
 
 instr(0xd9,4);
-   swap(b,b1);
-   swap(c,c1);
-   swap(d,d1);
-   swap(e,e1);
-   swap(h,h1);
-   swap(l,l1);
+   swap2(bc,bc1);
+   swap2(de,de1);
+   swap2(hl,hl1);
 endinstr;
 
 instr(0xda,10);
@@ -1153,8 +1183,7 @@ instr(0xdc,10);
 endinstr;
 
 instr(0xdd,4);
-   new_ixoriy=1;
-   intsample=0;
+   goto ixprefix;
 endinstr;
 
 instr(0xde,7);
@@ -1170,48 +1199,38 @@ endinstr;
 instr(0xe0,5);
    if(!(f&4))ret;
 endinstr;
+#endif
 
 instr(0xe1,10);
-   if(!ixoriy)pop1(h,l);
-   else if(ixoriy==1)pop2(ix);
-   else pop2(iy);
+   pop2(xhl);
 endinstr;
 
+#if IXORIY==0
 instr(0xe2,10);
    if(!(f&4))jp;
    else pc+=2;
 endinstr;
+#endif
 
 instr(0xe3,19);
-   if(!ixoriy){
-      unsigned short t=fetch2(sp);
-      store2b(sp,h,l);
-      l=t;
-      h=t>>8;
-   }
-   else if(ixoriy==1){
-      unsigned short t=fetch2(sp);
-      store2(sp,ix);
-      ix=t;
-   }
-   else{
-      unsigned short t=fetch2(sp);
-      store2(sp,iy);
-      iy=t;
-   }
+  {unsigned short t=fetch2(sp);
+   store2(sp,xhl);
+   xhl=t;
+  }
 endinstr;
 
+#if IXORIY==0
 instr(0xe4,10);
    if(!(f&4))call;
    else pc+=2;
 endinstr;
+#endif
 
 instr(0xe5,11);
-   if(!ixoriy)push1(h,l);
-   else if(ixoriy==1)push2(ix);
-   else push2(iy);
+   push2(xhl);
 endinstr;
 
+#if IXORIY==0
 instr(0xe6,7);
    anda(fetch(pc));
    pc++;
@@ -1225,19 +1244,20 @@ endinstr;
 instr(0xe8,5);
    if(f&4)ret;
 endinstr;
+#endif
 
 instr(0xe9,4);
-   pc=!ixoriy?hl:ixoriy==1?ix:iy;
+   pc=xhl;
 endinstr;
 
+#if IXORIY==0
 instr(0xea,10);
    if(f&4)jp;
    else pc+=2;
 endinstr;
 
 instr(0xeb,4);
-   swap(h,d);
-   swap(e,l);
+   swap2(de,hl);
 endinstr;
 
 instr(0xec,10);
@@ -1299,11 +1319,13 @@ endinstr;
 instr(0xf8,5);
    if(f&0x80)ret;
 endinstr;
+#endif
 
 instr(0xf9,6);
-   sp=!ixoriy?hl:ixoriy==1?ix:iy;
+   sp=xhl;
 endinstr;
 
+#if IXORIY==0
 instr(0xfa,10);
    if(f&0x80)jp;
    else pc+=2;
@@ -1320,8 +1342,7 @@ instr(0xfc,10);
 endinstr;
 
 instr(0xfd,4);
-   new_ixoriy=2;
-   intsample=0;
+   goto iyprefix;
 endinstr;
 
 instr(0xfe,7);
@@ -1333,4 +1354,9 @@ instr(0xff,11);
    push2(pc);
    pc=56;
 endinstr;
+#endif
 
+#undef xhl
+#undef xh
+#undef xl
+#undef HLinstr
@@ -0,0 +1,36 @@
+/* The Z80 registers as local variables of mainloop() in z80.c, and of
+ * each chunk of translated code (see zxxlat.h), for z80ops.h to use. */
+
+/* A register pair, used whole or a byte at a time */
+typedef union {
+   unsigned short w;
+   struct {
+#if defined(WORDS_BIGENDIAN) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+      unsigned char hi, lo;
+#else
+      unsigned char lo, hi;
+#endif
+   } x;
+} regpair;
+
+/* The registers other than A and F are kept as pairs, the 8-bit ones being
+ * the halves of them, so that 16-bit operations need no shifting */
+#define bc  (rbc.w)
+#define b   (rbc.x.hi)
+#define c   (rbc.x.lo)
+#define de  (rde.w)
+#define d   (rde.x.hi)
+#define e   (rde.x.lo)
+#define hl  (rhl.w)
+#define h   (rhl.x.hi)
+#define l   (rhl.x.lo)
+#define ix  (rix.w)
+#define ixh (rix.x.hi)
+#define ixl (rix.x.lo)
+#define iy  (riy.w)
+#define iyh (riy.x.hi)
+#define iyl (riy.x.lo)
+#define bc1 (rbc1.w)
+#define de1 (rde1.w)
+#define hl1 (rhl1.w)
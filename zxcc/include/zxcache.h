@@ -0,0 +1,31 @@
+#ifndef ZXCACHE_H
+#define ZXCACHE_H
+
+/* Compile cache for zxc and zxas.
+ *
+ * With ZXCC_CACHE set to a directory, a zxcc command line is run with
+ * ZXCC_TRACE so that cpmredir lists every file the program read and wrote.
+ * The files it leaves behind (.obj, .sym, listings, ...) and what it
+ * printed are then stored under a hash of the command line and of the
+ * contents of everything it read: the source, each header it opened, and
+ * the COM files of the compiler itself. Run again with the same inputs,
+ * the command is answered from the cache without starting the emulator.
+ * The files it looked for and did not find count as well, so that a header
+ * added where it is found before the one that was read is not overlooked.
+ *
+ * ZXCC_CACHE_SIZE limits the size of the cache (64M if not set; k, M and G
+ * suffixes are understood), dropping the least recently used results
+ * first. Several processes can share one cache directory: entries are
+ * written under temporary names and renamed into place, and the counters
+ * kept in its "stats" file are updated under a lock.
+ */
+
+/* Run a zxcc command line, through the cache if there is one. Returns its
+ * exit code. */
+int zxcache_run(char *cmd);
+
+/* Handle --cache-stats (show the counters), --cache-zero (reset them) and
+ * --cache-clear (empty the cache). Returns 1 if arg was one of these. */
+int zxcache_option(char *arg);
+
+#endif /* ZXCACHE_H */
@@ -1,40 +1,4 @@
-/*
- *  Change the directories in these #defines if necessary. Note trailing slash.
- */
-#ifndef _WIN32
-#include "config.h"
-#define ISDIRSEP(c) ((c) == '/')
-#define DIRSEPCH '/'
-#define DIRSEP "/"
-#else
-#include "config-win.h"
-#define ISDIRSEP(c) ((c) == '/' || (c) == '\\')
-#define DIRSEPCH '\\'
-#define DIRSEP "/\\:"
-#endif
-
-#ifndef CPMDIR80
-#ifdef _MSC_VER
-#define CPMDIR80 "d:/local/lib/cpm/"
-#else
-#define CPMDIR80 "/usr/local/lib/cpm/"
-#endif
-#endif
-
-/* the default sub directories trailing / is required */
-#define BIN80 "bin80/"
-#define LIB80 "lib80/"
-#define INC80 "include80/"
-
-#ifndef BINDIR80
-#define BINDIR80 CPMDIR80 BIN80
-#endif
-#ifndef LIBDIR80
-#define LIBDIR80 CPMDIR80 LIB80
-#endif
-#ifndef INCDIR80
-#define INCDIR80 CPMDIR80 INC80
-#endif
+#include "cpmdirs.h"
 
 extern char bindir80[];
 extern char libdir80[];
@@ -42,6 +6,9 @@ extern char incdir80[];
 
 #define SERIAL "ZXCC05"
 
+/* Temporary names for ZXCC_PRIVATE=1: those of C.COM, OC.COM and LIBR */
+#define PRIVATE_DEFAULT "*.$$$ *.TMP $L.OBJ L.OBJ"
+
 /* System include files */
 
 #include <stdio.h>
@@ -98,6 +65,11 @@ extern int argc;
 extern byte RAM[65536]; /* The Z80's address space */
 extern int file_conin;  /* non zero if stdin not a terminal */
 extern int eof_conin;   /* non zero if eof of stdin */
+
+/* bios.bin, compiled in (obj/biosbin.c is generated by the Makefile) */
+extern const unsigned char zxcc_bios[];
+extern const unsigned zxcc_bios_len;
 /* Z80 CPU emulation */
 
+#include "zxxlat.h"
 #include "z80.h"
@@ -0,0 +1,55 @@
+#ifndef ZXFOOT_H
+#define ZXFOOT_H
+
+/* Memory footprint.
+ *
+ * When ZXCC_FOOTPRINT names a file, zxcc runs the program in a second
+ * build of the Z80 core, mainloop_foot(), that notes every byte the
+ * program stores to, every 256-byte page it reads or runs code from and
+ * the lowest value SP takes. Translated code (ZXCC_XLAT) is not used in
+ * that mode. When the program stops (at zxcc_term()) a report is appended
+ * to the file, for sizing overlays and seeing how near a program comes to
+ * running into the BDOS at 0FE00h:
+ *
+ *	program		the CP/M program, as named on the command line
+ *	written		the highest address written below the stack, taking
+ *			in what the BDOS read from files as well as stores
+ *	heap		where the Hi-Tech C sbrk() in the program started its
+ *			heap and how far it got, when its code can be found
+ *	stack		the lowest SP, and how far that is below 0FE00h
+ *	free		the bytes between the two that were never written,
+ *			and so could still have been used
+ *	pages		a map of the 256 pages, with x for those code was run
+ *			from, w for those written, r for those only read
+ *	read, write, exec  the same as bitmaps of 64 hex digits, four pages
+ *			to a digit with the lowest in its top bit
+ *
+ * Programs that run others in their place (as Hi-Tech C's EXEC runs the
+ * compiler passes) are taken together, with the sbrk() of whichever ran
+ * last.
+ */
+
+/* Open fname for the report. Returns 0 if it can't be opened. */
+int zxfoot_init(char *fname);
+
+/* Nonzero once zxfoot_init() has worked */
+extern FILE *zxfoot_fp;
+
+/* The Z80 core with the footprint taken */
+void mainloop_foot(word xpc, word xsp);
+
+/* Called by mainloop_foot() as it starts, with the program loaded */
+void zxfoot_start(void);
+
+/* Append the report for the run, if there is to be one */
+void zxfoot_report(void);
+
+/* Kept by mainloop_foot() */
+#define FOOT_R 1
+#define FOOT_W 2
+#define FOOT_X 4
+extern unsigned char zxfoot_page[256];     /* FOOT_ bits for each page */
+extern unsigned char zxfoot_written[8192]; /* A bit for each byte */
+extern unsigned short zxfoot_sp;           /* Lowest SP */
+
+#endif /* ZXFOOT_H */
@@ -0,0 +1,68 @@
+#ifndef ZXHOST_H
+#define ZXHOST_H
+
+/* Host file calls.
+ *
+ * BDOS functions D0h to D5h let a program that knows it is running under
+ * zxcc read and write files a byte range at a time, instead of through
+ * FCBs, the DMA address and 128-byte records. The Hi-Tech C library uses
+ * them for open(), creat(), read(), write() and close() when its start-up
+ * code finds them, and the FCB calls otherwise.
+ *
+ * Other systems, and zxccs before these calls, stop the program or do
+ * something else with them, so a program must first check that the BDOS
+ * page starts with "ZXCC" and a version of "05" or later (the serial
+ * number at 0FE00h), and then that function D0h returns ZXHOST_MAGIC.
+ *
+ * Functions D1h to D5h take DE pointing at a parameter block:
+ *
+ *	byte	handle	returned by D1h, given to the rest
+ *	byte	mode	D1h: ZXH_RDONLY, ZXH_WRONLY or ZXH_RDWR, plus ZXH_CREAT
+ *			to create the file or truncate it
+ *	word	addr	D1h: the file's name, "[du:][d:]name.typ" and a zero
+ *			byte; D3h, D4h: the data
+ *	word	count	D3h, D4h: bytes to move; returns the number moved,
+ *			which for a read is short only at the end of the file
+ *	dword	pos	D3h, D4h: where in the file to start; returns where
+ *			the transfer finished. D1h, D5h: returns the size
+ *
+ * and return HL = 0 if they worked, 0FFFFh if not. Reads and writes carry
+ * their own file position, so seeking is left to the program.
+ *
+ * A name means the same file it would in an FCB: drives are mapped as for
+ * the FCB calls, and ZXCC_PRIVATE and ZXCC_TRACE apply. The user number is
+ * ignored, as it is there. Files on a drive served from a ZXCC_IMAGE can't
+ * be opened this way, so the program falls back to FCBs for them.
+ * ZXCC_RECORD logs functions D1h to D5h along with the FCB calls.
+ */
+
+#define ZXH_PROBE 0xD0 /* Returns ZXHOST_MAGIC */
+#define ZXH_OPEN  0xD1
+#define ZXH_CLOSE 0xD2
+#define ZXH_READ  0xD3
+#define ZXH_WRITE 0xD4
+#define ZXH_SIZE  0xD5
+
+#define ZXHOST_MAGIC 0x5A58 /* "ZX" */
+
+/* Open modes */
+#define ZXH_RDONLY 0
+#define ZXH_WRONLY 1
+#define ZXH_RDWR   2
+#define ZXH_CREAT  0x10
+
+/* Offsets in the parameter block */
+#define ZXH_PB_HANDLE 0
+#define ZXH_PB_MODE   1
+#define ZXH_PB_ADDR   2
+#define ZXH_PB_COUNT  4
+#define ZXH_PB_POS    6
+#define ZXH_PB_LEN    10
+
+/* Files a program can have open at once */
+#define ZXHOST_FILES 16
+
+/* Carry out function func, with DE = de. Returns HL. */
+word zxhost_call(byte func, word de);
+
+#endif /* ZXHOST_H */
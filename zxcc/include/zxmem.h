@@ -0,0 +1,58 @@
+#ifndef ZXMEM_H
+#define ZXMEM_H
+
+/* Expanded memory.
+ *
+ * zxcc keeps a pool of host memory, ZXCC_XMEM kilobytes of it (16Mb if
+ * that isn't set, none if it is 0), that a program can copy blocks of its
+ * own memory into and back out of through the I/O ports below. It lets
+ * overlays, large tables and the like be kept out of the TPA without
+ * going to disc. The pool is empty when the program starts, and is only
+ * given host memory a 16K page at a time as the program writes to it.
+ *
+ *	out (XM_PBLO),a		low byte of the parameter block's address
+ *	out (XM_PBHI),a		high byte
+ *	out (XM_CMD),a		carry out a command
+ *	in a,(XM_CMD)		0 if the last command worked, 0FFh if not
+ *	in a,(XM_ID)		XM_IDBYTE
+ *
+ * The parameter block is
+ *
+ *	word	addr	where the data is in the Z80's memory
+ *	word	len	bytes to copy
+ *	dword	offset	where it is in the pool
+ *
+ * and the commands are XM_INFO, which sets len to the size of the pool in
+ * 16K pages, XM_PUT, which copies len bytes from addr to offset, and XM_GET,
+ * which copies them back. A copy that would run past the end of the pool
+ * or of the Z80's memory is not done.
+ *
+ * Other systems, and zxccs before these ports, read 0 or something else
+ * from them, so a program must check that the BDOS page starts with "ZXCC"
+ * and that XM_ID reads as XM_IDBYTE before using the rest. The first check
+ * is best made as the program starts, as the stack zxcc gives it runs down
+ * from the BDOS page and soon covers the serial number.
+ */
+
+#define XM_PBLO 0xE0
+#define XM_PBHI 0xE1
+#define XM_CMD  0xE2
+#define XM_ID   0xE3
+
+#define XM_IDBYTE 0x58 /* "X" */
+
+/* Commands */
+#define XM_INFO 1
+#define XM_PUT  2
+#define XM_GET  3
+
+#define XM_PAGE 16384
+
+/* Set the size of the pool in kilobytes, from ZXCC_XMEM */
+void zxmem_init(unsigned long kbytes);
+
+/* IN and OUT for port c */
+byte zxmem_in(byte c);
+void zxmem_out(byte c, byte value);
+
+#endif /* ZXMEM_H */
@@ -0,0 +1,76 @@
+#ifndef ZXREC_H
+#define ZXREC_H
+
+/* BDOS call recorder.
+ *
+ * When ZXCC_RECORD names a file, zxcc logs every disc BDOS call that it
+ * passes to cpmredir. zxreplay reads the log back and drives the cpmredir
+ * functions directly, so the redirector can be timed and checked without
+ * running the Z80 program that produced the calls.
+ *
+ * All multi-byte values in the log are little-endian.
+ *
+ * File header:
+ *	"ZXRC"			magic
+ *	byte	version		ZXREC_VERSION
+ *	byte	drive		CP/M drive logged in at start (0-15)
+ *	byte	user		CP/M user at start
+ *	byte	reserved
+ *	16 x { word len; len bytes }	host directory mapped to A: .. P:
+ *
+ * Each call is one record:
+ *	byte	func		BDOS function (C register)
+ *	byte	e		E register
+ *	word	de		DE register (FCB address)
+ *	word	dma		DMA address
+ *	36 bytes		FCB before the call	(ZXREC_FCB)
+ *	n bytes			DMA before the call	(ZXREC_DMAIN_*)
+ *	10 bytes		host file call parameter block before the
+ *				call, at DE (ZXREC_HOST, see zxhost.h)
+ *	n bytes			the name for an open, ZXREC_NAMELEN bytes,
+ *				or the data for a write (ZXREC_HOST)
+ *	word	ret		HL on return
+ *	dword	digest		checksum of the call's results (see zxrec_digest)
+ */
+
+#define ZXREC_MAGIC   "ZXRC"
+#define ZXREC_VERSION 2
+
+#define ZXREC_FCBLEN 36
+#define ZXREC_MAXLEN (128 * 128) /* Longest transfer, after BDOS 0x2C */
+#define ZXREC_NAMELEN 128        /* Name logged for a host file open */
+
+/* Per-function flags */
+#define ZXREC_FCB       0x01 /* DE points at an FCB */
+#define ZXREC_DMAIN_REC 0x02 /* DMA holds one transfer of data to write */
+#define ZXREC_DMAIN_8   0x04 /* DMA holds 8 bytes of parameters */
+#define ZXREC_DMAOUT    0x08 /* DMA receives one transfer of data */
+#define ZXREC_DIRENT    0x10 /* DMA receives a directory entry */
+#define ZXREC_HANDLE    0x20 /* FCB must already be open */
+#define ZXREC_NORET     0x40 /* No meaningful return value */
+#define ZXREC_HOST      0x80 /* DE points at a host file parameter block */
+
+int zxrec_flags(byte func);
+int zxrec_reclen(void);
+void zxrec_track(byte func, byte e, word ret);
+dword zxrec_digest(byte func, word ret, byte *fcb, byte *dma, int dmalen);
+
+/* The memory a host file call uses besides its parameter block at pb:
+ * the name for an open, the data for a read or a write. Returns the
+ * number of bytes and sets *addr to where they are. */
+int zxrec_hostin(byte func, word pb, word *addr);
+
+/* Copy len bytes out of and into the Z80's memory at addr, wrapping round
+ * the top as the Z80 would */
+void zxrec_get(byte *buf, word addr, int len);
+void zxrec_put(word addr, byte *buf, int len);
+
+/* Recording, used by zxcc */
+
+extern int zxrec_active;
+
+void zxrec_init(char *fname);
+void zxrec_before(byte func, byte e, word fcb, word dma);
+void zxrec_after(word ret);
+
+#endif /* ZXREC_H */
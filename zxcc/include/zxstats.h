@@ -0,0 +1,47 @@
+#ifndef ZXSTATS_H
+#define ZXSTATS_H
+
+/* Run statistics.
+ *
+ * When ZXCC_STATS names a file, zxcc appends one line to it as it exits,
+ * holding a JSON object that describes the run:
+ *
+ *	program		the CP/M program, as named on the command line
+ *	args		the rest of the command line, as given to zxcc
+ *	insns		Z80 instructions run (a DD or FD prefix that does
+ *			nothing counts with the instruction after it)
+ *	tstates		T-states those instructions would take on a Z80
+ *	bdos		BDOS calls made
+ *	bdos_calls	the same by function: {"15":3,"20":41,...}
+ *	bios		BIOS calls made
+ *	wall		seconds from start to exit
+ *	user, sys	CPU seconds spent in zxcc and in the host's kernel
+ *	maxrss		zxcc's peak resident set, in kilobytes
+ *
+ * The counts are those of the interpreter and of any translated code
+ * (ZXCC_XLAT) together. They are taken at the ZXCC trap the program left
+ * by, so a run stopped by zxcc itself (a bad BDOS call, say) leaves them
+ * short of where it stopped.
+ *
+ * A program can also read the T-state count itself, to time a stretch of
+ * its own code the same way on every run and every host:
+ *
+ *	in a,(ZS_TSTATES)	latch the count, and read its low byte
+ *	in a,(ZS_TSTATES+1)	then the next byte of the latched count,
+ *	...			up to ZS_TSTATES+3
+ *
+ * The count is that of the interpreter and of translated code alike, and
+ * wraps at 32 bits. Other systems read 0 or anything else from the ports.
+ */
+
+#define ZS_TSTATES 0xE4
+
+/* Start timing the run, and arrange for fname to be written at exit.
+ * Returns 0 if fname can't be opened. */
+int zxstats_init(char *fname);
+
+/* Counted by ed_fe() whether or not ZXCC_STATS is set */
+extern unsigned long zxstats_bdos[256];
+extern unsigned long zxstats_bios;
+
+#endif /* ZXSTATS_H */
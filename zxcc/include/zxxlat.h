@@ -0,0 +1,88 @@
+#ifndef ZXXLAT_H
+#define ZXXLAT_H
+
+/* Translation cache for COM images.
+ *
+ * With ZXCC_XLAT set to a directory, the code of each COM file zxcc runs is
+ * translated into C, compiled with the host's C compiler ($CC, or cc) into
+ * a shared object and kept in that directory under a hash of the image and
+ * of the emulator's own instruction sources. Later runs of the same image
+ * load the object and run the translated code instead of interpreting it.
+ *
+ * The code translated is what can be reached from 0100h by following
+ * jumps, calls and restarts, together with the addresses that earlier runs
+ * saw translated code leave for because it was not translated (the targets
+ * of JP (HL) and of computed returns): these are kept in a ".tgt" file
+ * beside the object, and when a run finds new ones the image is translated
+ * again once the program is done with. Translating is left to a background
+ * process, so the first run of an image is simply interpreted; if the
+ * compiler fails, a ".bad" file stops the image being tried again.
+ *
+ * Besides the COM file zxcc was started with, programs that a CP/M
+ * program reads in at 0100h and jumps to (as Hi-Tech's C and EXEC run the
+ * compiler passes) are translated in the same way.
+ *
+ * Anything not translated runs in the interpreter: code outside the image
+ * (the BDOS and BIOS), IN and OUT, and the ZXCC trap. If the program writes
+ * over any of the translated code, or reads a file over it, the
+ * translation is dropped until the next program is started.
+ *
+ * This file is also copied into each translation, so it must not include
+ * anything or depend on zxcc.h.
+ */
+
+/* The Z80's registers, as passed between the interpreter and the
+ * translated code. The pairs are in capitals as z80regs.h defines the
+ * lower case names as macros. */
+struct xlat_cpu {
+    unsigned char a, f, a1, f1, i, r, iff1, iff2, im;
+    unsigned short BC, DE, HL, IX, IY, BC1, DE1, HL1, sp, pc;
+    unsigned long tstates;
+    unsigned int radjust;
+    unsigned long insns;        /* Instructions run, for ZXCC_STATS */
+    unsigned char *mem;         /* The 64k address space */
+    const unsigned char *code;  /* Nonzero for bytes of translated code */
+    int smc;                    /* 10000h plus the address, when one of
+                                 * those was written to */
+    int miss;                   /* Left for an address with no entry */
+    unsigned long steps;        /* Instructions left to run, when compiled
+                                 * with XLAT_CHECK */
+};
+
+/* Bumped whenever struct xlat_cpu or the symbols of a translation change */
+#define XLAT_ABI 3
+
+typedef void (*xlat_chunk)(struct xlat_cpu *cpu);
+
+/* xlat_map gives for each address where translated code can be entered
+ * its chunk number plus one, or XLAT_NEW at 0100h while a program is being
+ * read in there; xlat_code marks the bytes the translation was made from.
+ * Both are NULL unless ZXCC_XLAT is set. */
+extern unsigned short *xlat_map;
+extern unsigned char *xlat_code;
+
+#define XLAT_NEW 0xFFFF
+
+/* Keep translations in dir, making it if need be. With check set, run
+ * each block of translated code beside the interpreter and stop at the
+ * first difference (see zxxlat.c). Returns 0 if dir can't be used. */
+int xlat_init(const char *dir, int check);
+
+/* Called with the COM file just loaded at 0100h */
+void xlat_load(unsigned len);
+
+/* Run translated code from cpu->pc until it leaves for somewhere that is
+ * not translated */
+void xlat_run(struct xlat_cpu *cpu);
+
+/* The interpreter stored to a byte of translated code */
+void xlat_smc(unsigned short addr);
+
+/* The BDOS wrote len bytes at addr */
+void xlat_written(unsigned short addr, unsigned len);
+
+/* The BDOS read len bytes of a file to addr. A file read to 0100h and
+ * then jumped to is taken to be a COM file, as loaded by EXEC. */
+void xlat_read(unsigned short addr, unsigned len);
+
+#endif /* ZXXLAT_H */
@@ -0,0 +1,34 @@
+/* Generated from bios/bios.bin by make. Do not edit. */
+const unsigned char zxcc_bios[] = {
+ 0x5a, 0x58, 0x43, 0x43, 0x30, 0x35, 0xc3, 0x09, 0xfe, 0x3e, 0xc0, 0xed, 0xfe, 0xc9, 0xdd, 0x22,
+ 0x24, 0xfe, 0xdd, 0xe1, 0xd5, 0x11, 0xb0, 0x00, 0xdd, 0x19, 0xd1, 0x3e, 0xc3, 0xed, 0xfe, 0xdd,
+ 0x2a, 0x24, 0xfe, 0xc9, 0x00, 0x00, 0x21, 0x03, 0xff, 0x22, 0x01, 0x00, 0x21, 0x06, 0xfe, 0x22,
+ 0x06, 0x00, 0x3e, 0xc3, 0x32, 0x00, 0x00, 0x32, 0x05, 0x00, 0x3e, 0xc9, 0x32, 0x38, 0x00, 0x3e,
+ 0xc1, 0xed, 0xfe, 0x21, 0x00, 0x00, 0xe5, 0xc3, 0x00, 0x01, 0x3e, 0xc3, 0xdd, 0x21, 0x06, 0x00,
+ 0xed, 0xfe, 0x76, 0xc3, 0x53, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd,
+ 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e,
+ 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe,
+ 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd,
+ 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e,
+ 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe, 0xcd, 0x0e, 0xfe,
+ 0xcd, 0x0e, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0xc3, 0x26, 0xfe, 0xc3, 0x4a, 0xfe, 0xc3, 0x56, 0xfe, 0xc3, 0x59, 0xfe, 0xc3, 0x5c, 0xfe, 0xc3,
+ 0x5f, 0xfe, 0xc3, 0x62, 0xfe, 0xc3, 0x65, 0xfe, 0xc3, 0x68, 0xfe, 0xc3, 0x6b, 0xfe, 0xc3, 0x6e,
+ 0xfe, 0xc3, 0x71, 0xfe, 0xc3, 0x74, 0xfe, 0xc3, 0x77, 0xfe, 0xc3, 0x7a, 0xfe, 0xc3, 0x7d, 0xfe,
+ 0xc3, 0x80, 0xfe, 0xc3, 0x83, 0xfe, 0xc3, 0x86, 0xfe, 0xc3, 0x89, 0xfe, 0xc3, 0x8c, 0xfe, 0xc3,
+ 0x8f, 0xfe, 0xc3, 0x92, 0xfe, 0xc3, 0x95, 0xfe, 0xc3, 0x98, 0xfe, 0xc3, 0x9b, 0xfe, 0xc3, 0x9e,
+ 0xfe, 0xc3, 0xa1, 0xfe, 0xc3, 0xa4, 0xfe, 0xc3, 0xa7, 0xfe, 0xc3, 0xaa, 0xfe, 0xc3, 0xad, 0xfe,
+ 0xc3, 0xb0, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+const unsigned zxcc_bios_len = sizeof(zxcc_bios);
@@ -0,0 +1,2577 @@
+/* Generated from include/zxxlat.h include/z80regs.h include/z80ops.h include/cbops.h include/edops.h by make. Do not edit. */
+const char xlat_src_zxxlat[] = {
+ 0x23, 0x69, 0x66, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x5a, 0x58, 0x58, 0x4c, 0x41, 0x54, 0x5f, 0x48,
+ 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x5a, 0x58, 0x58, 0x4c, 0x41, 0x54,
+ 0x5f, 0x48, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x54, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61,
+ 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x63, 0x61, 0x63, 0x68, 0x65, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x43,
+ 0x4f, 0x4d, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x73, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x57, 0x69, 0x74, 0x68, 0x20, 0x5a, 0x58, 0x43, 0x43, 0x5f, 0x58, 0x4c, 0x41,
+ 0x54, 0x20, 0x73, 0x65, 0x74, 0x20, 0x74, 0x6f, 0x20, 0x61, 0x20, 0x64, 0x69, 0x72, 0x65, 0x63,
+ 0x74, 0x6f, 0x72, 0x79, 0x2c, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x6f,
+ 0x66, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20, 0x43, 0x4f, 0x4d, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20,
+ 0x7a, 0x78, 0x63, 0x63, 0x20, 0x72, 0x75, 0x6e, 0x73, 0x20, 0x69, 0x73, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x74, 0x6f,
+ 0x20, 0x43, 0x2c, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x64, 0x20, 0x77, 0x69, 0x74,
+ 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x68, 0x6f, 0x73, 0x74, 0x27, 0x73, 0x20, 0x43, 0x20, 0x63,
+ 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x72, 0x20, 0x28, 0x24, 0x43, 0x43, 0x2c, 0x20, 0x6f, 0x72,
+ 0x20, 0x63, 0x63, 0x29, 0x20, 0x69, 0x6e, 0x74, 0x6f, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x61, 0x20,
+ 0x73, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x20, 0x61, 0x6e,
+ 0x64, 0x20, 0x6b, 0x65, 0x70, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x64,
+ 0x69, 0x72, 0x65, 0x63, 0x74, 0x6f, 0x72, 0x79, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x61,
+ 0x20, 0x68, 0x61, 0x73, 0x68, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61,
+ 0x67, 0x65, 0x20, 0x61, 0x6e, 0x64, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68,
+ 0x65, 0x20, 0x65, 0x6d, 0x75, 0x6c, 0x61, 0x74, 0x6f, 0x72, 0x27, 0x73, 0x20, 0x6f, 0x77, 0x6e,
+ 0x20, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x73, 0x6f, 0x75,
+ 0x72, 0x63, 0x65, 0x73, 0x2e, 0x20, 0x4c, 0x61, 0x74, 0x65, 0x72, 0x20, 0x72, 0x75, 0x6e, 0x73,
+ 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x61, 0x6d, 0x65, 0x20, 0x69, 0x6d, 0x61,
+ 0x67, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x6c, 0x6f, 0x61, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20,
+ 0x6f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x72, 0x75, 0x6e, 0x20, 0x74,
+ 0x68, 0x65, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f,
+ 0x64, 0x65, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x65, 0x61, 0x64, 0x20, 0x6f, 0x66, 0x20, 0x69, 0x6e,
+ 0x74, 0x65, 0x72, 0x70, 0x72, 0x65, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x69, 0x74, 0x2e, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54, 0x68, 0x65, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20,
+ 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x69, 0x73, 0x20, 0x77, 0x68,
+ 0x61, 0x74, 0x20, 0x63, 0x61, 0x6e, 0x20, 0x62, 0x65, 0x20, 0x72, 0x65, 0x61, 0x63, 0x68, 0x65,
+ 0x64, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x30, 0x31, 0x30, 0x30, 0x68, 0x20, 0x62, 0x79, 0x20,
+ 0x66, 0x6f, 0x6c, 0x6c, 0x6f, 0x77, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x6a, 0x75,
+ 0x6d, 0x70, 0x73, 0x2c, 0x20, 0x63, 0x61, 0x6c, 0x6c, 0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x72,
+ 0x65, 0x73, 0x74, 0x61, 0x72, 0x74, 0x73, 0x2c, 0x20, 0x74, 0x6f, 0x67, 0x65, 0x74, 0x68, 0x65,
+ 0x72, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x64, 0x64, 0x72, 0x65,
+ 0x73, 0x73, 0x65, 0x73, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x65, 0x61, 0x72, 0x6c, 0x69, 0x65,
+ 0x72, 0x20, 0x72, 0x75, 0x6e, 0x73, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x73, 0x61, 0x77, 0x20, 0x74,
+ 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x6c,
+ 0x65, 0x61, 0x76, 0x65, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x62, 0x65, 0x63, 0x61, 0x75, 0x73, 0x65,
+ 0x20, 0x69, 0x74, 0x20, 0x77, 0x61, 0x73, 0x20, 0x6e, 0x6f, 0x74, 0x20, 0x74, 0x72, 0x61, 0x6e,
+ 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x28, 0x74, 0x68, 0x65, 0x20, 0x74, 0x61, 0x72, 0x67,
+ 0x65, 0x74, 0x73, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x6f, 0x66, 0x20, 0x4a, 0x50, 0x20, 0x28, 0x48,
+ 0x4c, 0x29, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6f, 0x66, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x75, 0x74,
+ 0x65, 0x64, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x73, 0x29, 0x3a, 0x20, 0x74, 0x68, 0x65,
+ 0x73, 0x65, 0x20, 0x61, 0x72, 0x65, 0x20, 0x6b, 0x65, 0x70, 0x74, 0x20, 0x69, 0x6e, 0x20, 0x61,
+ 0x20, 0x22, 0x2e, 0x74, 0x67, 0x74, 0x22, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x62, 0x65, 0x73, 0x69, 0x64, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x62, 0x6a, 0x65,
+ 0x63, 0x74, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x77, 0x68, 0x65, 0x6e, 0x20, 0x61, 0x20, 0x72,
+ 0x75, 0x6e, 0x20, 0x66, 0x69, 0x6e, 0x64, 0x73, 0x20, 0x6e, 0x65, 0x77, 0x20, 0x6f, 0x6e, 0x65,
+ 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x20, 0x69, 0x73, 0x20, 0x74,
+ 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x61, 0x67,
+ 0x61, 0x69, 0x6e, 0x20, 0x6f, 0x6e, 0x63, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x70, 0x72, 0x6f,
+ 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x64, 0x6f, 0x6e, 0x65, 0x20, 0x77, 0x69, 0x74,
+ 0x68, 0x2e, 0x20, 0x54, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x69,
+ 0x73, 0x20, 0x6c, 0x65, 0x66, 0x74, 0x20, 0x74, 0x6f, 0x20, 0x61, 0x20, 0x62, 0x61, 0x63, 0x6b,
+ 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x70, 0x72, 0x6f, 0x63, 0x65,
+ 0x73, 0x73, 0x2c, 0x20, 0x73, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x66, 0x69, 0x72, 0x73, 0x74,
+ 0x20, 0x72, 0x75, 0x6e, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x6e, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65,
+ 0x20, 0x69, 0x73, 0x20, 0x73, 0x69, 0x6d, 0x70, 0x6c, 0x79, 0x20, 0x69, 0x6e, 0x74, 0x65, 0x72,
+ 0x70, 0x72, 0x65, 0x74, 0x65, 0x64, 0x3b, 0x20, 0x69, 0x66, 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x72, 0x20, 0x66, 0x61, 0x69, 0x6c,
+ 0x73, 0x2c, 0x20, 0x61, 0x20, 0x22, 0x2e, 0x62, 0x61, 0x64, 0x22, 0x20, 0x66, 0x69, 0x6c, 0x65,
+ 0x20, 0x73, 0x74, 0x6f, 0x70, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65,
+ 0x20, 0x62, 0x65, 0x69, 0x6e, 0x67, 0x20, 0x74, 0x72, 0x69, 0x65, 0x64, 0x20, 0x61, 0x67, 0x61,
+ 0x69, 0x6e, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x42, 0x65, 0x73, 0x69,
+ 0x64, 0x65, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x4f, 0x4d, 0x20, 0x66, 0x69, 0x6c, 0x65,
+ 0x20, 0x7a, 0x78, 0x63, 0x63, 0x20, 0x77, 0x61, 0x73, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x65,
+ 0x64, 0x20, 0x77, 0x69, 0x74, 0x68, 0x2c, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x73,
+ 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x61, 0x20, 0x43, 0x50, 0x2f, 0x4d, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x72, 0x65, 0x61, 0x64, 0x73, 0x20, 0x69,
+ 0x6e, 0x20, 0x61, 0x74, 0x20, 0x30, 0x31, 0x30, 0x30, 0x68, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6a,
+ 0x75, 0x6d, 0x70, 0x73, 0x20, 0x74, 0x6f, 0x20, 0x28, 0x61, 0x73, 0x20, 0x48, 0x69, 0x2d, 0x54,
+ 0x65, 0x63, 0x68, 0x27, 0x73, 0x20, 0x43, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x45, 0x58, 0x45, 0x43,
+ 0x20, 0x72, 0x75, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x63, 0x6f, 0x6d,
+ 0x70, 0x69, 0x6c, 0x65, 0x72, 0x20, 0x70, 0x61, 0x73, 0x73, 0x65, 0x73, 0x29, 0x20, 0x61, 0x72,
+ 0x65, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20,
+ 0x74, 0x68, 0x65, 0x20, 0x73, 0x61, 0x6d, 0x65, 0x20, 0x77, 0x61, 0x79, 0x2e, 0x0d, 0x0a, 0x20,
+ 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x41, 0x6e, 0x79, 0x74, 0x68, 0x69, 0x6e, 0x67, 0x20, 0x6e,
+ 0x6f, 0x74, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x72, 0x75,
+ 0x6e, 0x73, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x70,
+ 0x72, 0x65, 0x74, 0x65, 0x72, 0x3a, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x6f, 0x75, 0x74, 0x73,
+ 0x69, 0x64, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x0d, 0x0a, 0x20,
+ 0x2a, 0x20, 0x28, 0x74, 0x68, 0x65, 0x20, 0x42, 0x44, 0x4f, 0x53, 0x20, 0x61, 0x6e, 0x64, 0x20,
+ 0x42, 0x49, 0x4f, 0x53, 0x29, 0x2c, 0x20, 0x49, 0x4e, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x4f, 0x55,
+ 0x54, 0x2c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x20, 0x5a, 0x58, 0x43, 0x43, 0x20,
+ 0x74, 0x72, 0x61, 0x70, 0x2e, 0x20, 0x49, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x70, 0x72, 0x6f,
+ 0x67, 0x72, 0x61, 0x6d, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x73, 0x0d, 0x0a, 0x20, 0x2a, 0x20,
+ 0x6f, 0x76, 0x65, 0x72, 0x20, 0x61, 0x6e, 0x79, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20,
+ 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x2c,
+ 0x20, 0x6f, 0x72, 0x20, 0x72, 0x65, 0x61, 0x64, 0x73, 0x20, 0x61, 0x20, 0x66, 0x69, 0x6c, 0x65,
+ 0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x69, 0x74, 0x2c, 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a, 0x20,
+ 0x2a, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x69, 0x73,
+ 0x20, 0x64, 0x72, 0x6f, 0x70, 0x70, 0x65, 0x64, 0x20, 0x75, 0x6e, 0x74, 0x69, 0x6c, 0x20, 0x74,
+ 0x68, 0x65, 0x20, 0x6e, 0x65, 0x78, 0x74, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20,
+ 0x69, 0x73, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x65, 0x64, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d,
+ 0x0a, 0x20, 0x2a, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x69, 0x73,
+ 0x20, 0x61, 0x6c, 0x73, 0x6f, 0x20, 0x63, 0x6f, 0x70, 0x69, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x74,
+ 0x6f, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x69,
+ 0x6f, 0x6e, 0x2c, 0x20, 0x73, 0x6f, 0x20, 0x69, 0x74, 0x20, 0x6d, 0x75, 0x73, 0x74, 0x20, 0x6e,
+ 0x6f, 0x74, 0x20, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x61,
+ 0x6e, 0x79, 0x74, 0x68, 0x69, 0x6e, 0x67, 0x20, 0x6f, 0x72, 0x20, 0x64, 0x65, 0x70, 0x65, 0x6e,
+ 0x64, 0x20, 0x6f, 0x6e, 0x20, 0x7a, 0x78, 0x63, 0x63, 0x2e, 0x68, 0x2e, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x54, 0x68, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x27,
+ 0x73, 0x20, 0x72, 0x65, 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x73, 0x2c, 0x20, 0x61, 0x73, 0x20,
+ 0x70, 0x61, 0x73, 0x73, 0x65, 0x64, 0x20, 0x62, 0x65, 0x74, 0x77, 0x65, 0x65, 0x6e, 0x20, 0x74,
+ 0x68, 0x65, 0x20, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x70, 0x72, 0x65, 0x74, 0x65, 0x72, 0x20, 0x61,
+ 0x6e, 0x64, 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73,
+ 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x2e, 0x20, 0x54, 0x68, 0x65, 0x20,
+ 0x70, 0x61, 0x69, 0x72, 0x73, 0x20, 0x61, 0x72, 0x65, 0x20, 0x69, 0x6e, 0x20, 0x63, 0x61, 0x70,
+ 0x69, 0x74, 0x61, 0x6c, 0x73, 0x20, 0x61, 0x73, 0x20, 0x7a, 0x38, 0x30, 0x72, 0x65, 0x67, 0x73,
+ 0x2e, 0x68, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x73, 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x6c, 0x6f, 0x77, 0x65, 0x72, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x6e, 0x61,
+ 0x6d, 0x65, 0x73, 0x20, 0x61, 0x73, 0x20, 0x6d, 0x61, 0x63, 0x72, 0x6f, 0x73, 0x2e, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x63,
+ 0x70, 0x75, 0x20, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x61, 0x2c, 0x20, 0x66, 0x2c, 0x20, 0x61, 0x31,
+ 0x2c, 0x20, 0x66, 0x31, 0x2c, 0x20, 0x69, 0x2c, 0x20, 0x72, 0x2c, 0x20, 0x69, 0x66, 0x66, 0x31,
+ 0x2c, 0x20, 0x69, 0x66, 0x66, 0x32, 0x2c, 0x20, 0x69, 0x6d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20,
+ 0x42, 0x43, 0x2c, 0x20, 0x44, 0x45, 0x2c, 0x20, 0x48, 0x4c, 0x2c, 0x20, 0x49, 0x58, 0x2c, 0x20,
+ 0x49, 0x59, 0x2c, 0x20, 0x42, 0x43, 0x31, 0x2c, 0x20, 0x44, 0x45, 0x31, 0x2c, 0x20, 0x48, 0x4c,
+ 0x31, 0x2c, 0x20, 0x73, 0x70, 0x2c, 0x20, 0x70, 0x63, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69,
+ 0x67, 0x6e, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x72, 0x61, 0x64, 0x6a, 0x75, 0x73, 0x74,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20,
+ 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x69, 0x6e, 0x73, 0x6e, 0x73, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x49, 0x6e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f,
+ 0x6e, 0x73, 0x20, 0x72, 0x75, 0x6e, 0x2c, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x5a, 0x58, 0x43, 0x43,
+ 0x5f, 0x53, 0x54, 0x41, 0x54, 0x53, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x2a, 0x6d, 0x65,
+ 0x6d, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x54, 0x68,
+ 0x65, 0x20, 0x36, 0x34, 0x6b, 0x20, 0x61, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x20, 0x73, 0x70,
+ 0x61, 0x63, 0x65, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x6f, 0x6e, 0x73,
+ 0x74, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20,
+ 0x2a, 0x63, 0x6f, 0x64, 0x65, 0x3b, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x4e, 0x6f, 0x6e, 0x7a, 0x65,
+ 0x72, 0x6f, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x62, 0x79, 0x74, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20,
+ 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x73, 0x6d, 0x63, 0x3b,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x31, 0x30, 0x30, 0x30, 0x30, 0x68, 0x20, 0x70, 0x6c,
+ 0x75, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x61, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x2c, 0x20,
+ 0x77, 0x68, 0x65, 0x6e, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f, 0x66, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2a, 0x20,
+ 0x74, 0x68, 0x6f, 0x73, 0x65, 0x20, 0x77, 0x61, 0x73, 0x20, 0x77, 0x72, 0x69, 0x74, 0x74, 0x65,
+ 0x6e, 0x20, 0x74, 0x6f, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x74,
+ 0x20, 0x6d, 0x69, 0x73, 0x73, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x4c, 0x65, 0x66, 0x74,
+ 0x20, 0x66, 0x6f, 0x72, 0x20, 0x61, 0x6e, 0x20, 0x61, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x20,
+ 0x77, 0x69, 0x74, 0x68, 0x20, 0x6e, 0x6f, 0x20, 0x65, 0x6e, 0x74, 0x72, 0x79, 0x20, 0x2a, 0x2f,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c,
+ 0x6f, 0x6e, 0x67, 0x20, 0x73, 0x74, 0x65, 0x70, 0x73, 0x3b, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x49, 0x6e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e,
+ 0x73, 0x20, 0x6c, 0x65, 0x66, 0x74, 0x20, 0x74, 0x6f, 0x20, 0x72, 0x75, 0x6e, 0x2c, 0x20, 0x77,
+ 0x68, 0x65, 0x6e, 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x69, 0x6c, 0x65, 0x64, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2a,
+ 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x58, 0x4c, 0x41, 0x54, 0x5f, 0x43, 0x48, 0x45, 0x43, 0x4b,
+ 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x7d, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x42, 0x75,
+ 0x6d, 0x70, 0x65, 0x64, 0x20, 0x77, 0x68, 0x65, 0x6e, 0x65, 0x76, 0x65, 0x72, 0x20, 0x73, 0x74,
+ 0x72, 0x75, 0x63, 0x74, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x63, 0x70, 0x75, 0x20, 0x6f, 0x72,
+ 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x79, 0x6d, 0x62, 0x6f, 0x6c, 0x73, 0x20, 0x6f, 0x66, 0x20,
+ 0x61, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x63, 0x68,
+ 0x61, 0x6e, 0x67, 0x65, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+ 0x20, 0x58, 0x4c, 0x41, 0x54, 0x5f, 0x41, 0x42, 0x49, 0x20, 0x33, 0x0d, 0x0a, 0x0d, 0x0a, 0x74,
+ 0x79, 0x70, 0x65, 0x64, 0x65, 0x66, 0x20, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x28, 0x2a, 0x78, 0x6c,
+ 0x61, 0x74, 0x5f, 0x63, 0x68, 0x75, 0x6e, 0x6b, 0x29, 0x28, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74,
+ 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x63, 0x70, 0x75, 0x20, 0x2a, 0x63, 0x70, 0x75, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x6d, 0x61, 0x70, 0x20,
+ 0x67, 0x69, 0x76, 0x65, 0x73, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20, 0x61,
+ 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x20, 0x77, 0x68, 0x65, 0x72, 0x65, 0x20, 0x74, 0x72, 0x61,
+ 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x63, 0x61, 0x6e,
+ 0x20, 0x62, 0x65, 0x20, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x65, 0x64, 0x0d, 0x0a, 0x20, 0x2a, 0x20,
+ 0x69, 0x74, 0x73, 0x20, 0x63, 0x68, 0x75, 0x6e, 0x6b, 0x20, 0x6e, 0x75, 0x6d, 0x62, 0x65, 0x72,
+ 0x20, 0x70, 0x6c, 0x75, 0x73, 0x20, 0x6f, 0x6e, 0x65, 0x2c, 0x20, 0x6f, 0x72, 0x20, 0x58, 0x4c,
+ 0x41, 0x54, 0x5f, 0x4e, 0x45, 0x57, 0x20, 0x61, 0x74, 0x20, 0x30, 0x31, 0x30, 0x30, 0x68, 0x20,
+ 0x77, 0x68, 0x69, 0x6c, 0x65, 0x20, 0x61, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20,
+ 0x69, 0x73, 0x20, 0x62, 0x65, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x72, 0x65, 0x61,
+ 0x64, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x72, 0x65, 0x3b, 0x20, 0x78, 0x6c, 0x61, 0x74,
+ 0x5f, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x6d, 0x61, 0x72, 0x6b, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20,
+ 0x62, 0x79, 0x74, 0x65, 0x73, 0x20, 0x74, 0x68, 0x65, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c,
+ 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x77, 0x61, 0x73, 0x20, 0x6d, 0x61, 0x64, 0x65, 0x20, 0x66,
+ 0x72, 0x6f, 0x6d, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x42, 0x6f, 0x74, 0x68, 0x20, 0x61, 0x72,
+ 0x65, 0x20, 0x4e, 0x55, 0x4c, 0x4c, 0x20, 0x75, 0x6e, 0x6c, 0x65, 0x73, 0x73, 0x20, 0x5a, 0x58,
+ 0x43, 0x43, 0x5f, 0x58, 0x4c, 0x41, 0x54, 0x20, 0x69, 0x73, 0x20, 0x73, 0x65, 0x74, 0x2e, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x2a, 0x78, 0x6c, 0x61, 0x74, 0x5f,
+ 0x6d, 0x61, 0x70, 0x3b, 0x0d, 0x0a, 0x65, 0x78, 0x74, 0x65, 0x72, 0x6e, 0x20, 0x75, 0x6e, 0x73,
+ 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x2a, 0x78, 0x6c, 0x61, 0x74,
+ 0x5f, 0x63, 0x6f, 0x64, 0x65, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e,
+ 0x65, 0x20, 0x58, 0x4c, 0x41, 0x54, 0x5f, 0x4e, 0x45, 0x57, 0x20, 0x30, 0x78, 0x46, 0x46, 0x46,
+ 0x46, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x4b, 0x65, 0x65, 0x70, 0x20, 0x74, 0x72, 0x61,
+ 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x20, 0x69, 0x6e, 0x20, 0x64, 0x69, 0x72,
+ 0x2c, 0x20, 0x6d, 0x61, 0x6b, 0x69, 0x6e, 0x67, 0x20, 0x69, 0x74, 0x20, 0x69, 0x66, 0x20, 0x6e,
+ 0x65, 0x65, 0x64, 0x20, 0x62, 0x65, 0x2e, 0x20, 0x57, 0x69, 0x74, 0x68, 0x20, 0x63, 0x68, 0x65,
+ 0x63, 0x6b, 0x20, 0x73, 0x65, 0x74, 0x2c, 0x20, 0x72, 0x75, 0x6e, 0x0d, 0x0a, 0x20, 0x2a, 0x20,
+ 0x65, 0x61, 0x63, 0x68, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x72,
+ 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x62, 0x65,
+ 0x73, 0x69, 0x64, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x70, 0x72,
+ 0x65, 0x74, 0x65, 0x72, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x73, 0x74, 0x6f, 0x70, 0x20, 0x61, 0x74,
+ 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x66, 0x69, 0x72, 0x73, 0x74, 0x20, 0x64,
+ 0x69, 0x66, 0x66, 0x65, 0x72, 0x65, 0x6e, 0x63, 0x65, 0x20, 0x28, 0x73, 0x65, 0x65, 0x20, 0x7a,
+ 0x78, 0x78, 0x6c, 0x61, 0x74, 0x2e, 0x63, 0x29, 0x2e, 0x20, 0x52, 0x65, 0x74, 0x75, 0x72, 0x6e,
+ 0x73, 0x20, 0x30, 0x20, 0x69, 0x66, 0x20, 0x64, 0x69, 0x72, 0x20, 0x63, 0x61, 0x6e, 0x27, 0x74,
+ 0x20, 0x62, 0x65, 0x20, 0x75, 0x73, 0x65, 0x64, 0x2e, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x74, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x69, 0x6e, 0x69, 0x74, 0x28, 0x63, 0x6f, 0x6e, 0x73,
+ 0x74, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x2a, 0x64, 0x69, 0x72, 0x2c, 0x20, 0x69, 0x6e, 0x74,
+ 0x20, 0x63, 0x68, 0x65, 0x63, 0x6b, 0x29, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x43,
+ 0x61, 0x6c, 0x6c, 0x65, 0x64, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43,
+ 0x4f, 0x4d, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20, 0x6a, 0x75, 0x73, 0x74, 0x20, 0x6c, 0x6f, 0x61,
+ 0x64, 0x65, 0x64, 0x20, 0x61, 0x74, 0x20, 0x30, 0x31, 0x30, 0x30, 0x68, 0x20, 0x2a, 0x2f, 0x0d,
+ 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x6c, 0x6f, 0x61, 0x64, 0x28,
+ 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x52, 0x75, 0x6e, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61,
+ 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x63, 0x70,
+ 0x75, 0x2d, 0x3e, 0x70, 0x63, 0x20, 0x75, 0x6e, 0x74, 0x69, 0x6c, 0x20, 0x69, 0x74, 0x20, 0x6c,
+ 0x65, 0x61, 0x76, 0x65, 0x73, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x73, 0x6f, 0x6d, 0x65, 0x77, 0x68,
+ 0x65, 0x72, 0x65, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x69, 0x73, 0x0d, 0x0a, 0x20, 0x2a, 0x20,
+ 0x6e, 0x6f, 0x74, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x72, 0x75, 0x6e,
+ 0x28, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x63, 0x70, 0x75,
+ 0x20, 0x2a, 0x63, 0x70, 0x75, 0x29, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x54, 0x68,
+ 0x65, 0x20, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x70, 0x72, 0x65, 0x74, 0x65, 0x72, 0x20, 0x73, 0x74,
+ 0x6f, 0x72, 0x65, 0x64, 0x20, 0x74, 0x6f, 0x20, 0x61, 0x20, 0x62, 0x79, 0x74, 0x65, 0x20, 0x6f,
+ 0x66, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64,
+ 0x65, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f,
+ 0x73, 0x6d, 0x63, 0x28, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f,
+ 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20,
+ 0x54, 0x68, 0x65, 0x20, 0x42, 0x44, 0x4f, 0x53, 0x20, 0x77, 0x72, 0x6f, 0x74, 0x65, 0x20, 0x6c,
+ 0x65, 0x6e, 0x20, 0x62, 0x79, 0x74, 0x65, 0x73, 0x20, 0x61, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72,
+ 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x78, 0x6c, 0x61, 0x74, 0x5f, 0x77,
+ 0x72, 0x69, 0x74, 0x74, 0x65, 0x6e, 0x28, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20,
+ 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x20, 0x75, 0x6e, 0x73, 0x69,
+ 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a,
+ 0x20, 0x54, 0x68, 0x65, 0x20, 0x42, 0x44, 0x4f, 0x53, 0x20, 0x72, 0x65, 0x61, 0x64, 0x20, 0x6c,
+ 0x65, 0x6e, 0x20, 0x62, 0x79, 0x74, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x61, 0x20, 0x66, 0x69,
+ 0x6c, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x61, 0x64, 0x64, 0x72, 0x2e, 0x20, 0x41, 0x20, 0x66, 0x69,
+ 0x6c, 0x65, 0x20, 0x72, 0x65, 0x61, 0x64, 0x20, 0x74, 0x6f, 0x20, 0x30, 0x31, 0x30, 0x30, 0x68,
+ 0x20, 0x61, 0x6e, 0x64, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x68, 0x65, 0x6e, 0x20, 0x6a, 0x75,
+ 0x6d, 0x70, 0x65, 0x64, 0x20, 0x74, 0x6f, 0x20, 0x69, 0x73, 0x20, 0x74, 0x61, 0x6b, 0x65, 0x6e,
+ 0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x61, 0x20, 0x43, 0x4f, 0x4d, 0x20, 0x66, 0x69, 0x6c,
+ 0x65, 0x2c, 0x20, 0x61, 0x73, 0x20, 0x6c, 0x6f, 0x61, 0x64, 0x65, 0x64, 0x20, 0x62, 0x79, 0x20,
+ 0x45, 0x58, 0x45, 0x43, 0x2e, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x76, 0x6f, 0x69, 0x64, 0x20, 0x78,
+ 0x6c, 0x61, 0x74, 0x5f, 0x72, 0x65, 0x61, 0x64, 0x28, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x20, 0x75, 0x6e,
+ 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c, 0x65, 0x6e, 0x29, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x20, 0x2f, 0x2a, 0x20, 0x5a, 0x58, 0x58, 0x4c, 0x41, 0x54,
+ 0x5f, 0x48, 0x20, 0x2a, 0x2f, 0x0d, 0x0a,
+0};
+const char xlat_src_z80regs[] = {
+ 0x2f, 0x2a, 0x20, 0x54, 0x68, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x20, 0x72, 0x65, 0x67, 0x69, 0x73,
+ 0x74, 0x65, 0x72, 0x73, 0x20, 0x61, 0x73, 0x20, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x20, 0x76, 0x61,
+ 0x72, 0x69, 0x61, 0x62, 0x6c, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x6d, 0x61, 0x69, 0x6e, 0x6c,
+ 0x6f, 0x6f, 0x70, 0x28, 0x29, 0x20, 0x69, 0x6e, 0x20, 0x7a, 0x38, 0x30, 0x2e, 0x63, 0x2c, 0x20,
+ 0x61, 0x6e, 0x64, 0x20, 0x6f, 0x66, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x65, 0x61, 0x63, 0x68, 0x20,
+ 0x63, 0x68, 0x75, 0x6e, 0x6b, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x72, 0x61, 0x6e, 0x73, 0x6c, 0x61,
+ 0x74, 0x65, 0x64, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x28, 0x73, 0x65, 0x65, 0x20, 0x7a, 0x78,
+ 0x78, 0x6c, 0x61, 0x74, 0x2e, 0x68, 0x29, 0x2c, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x7a, 0x38, 0x30,
+ 0x6f, 0x70, 0x73, 0x2e, 0x68, 0x20, 0x74, 0x6f, 0x20, 0x75, 0x73, 0x65, 0x2e, 0x20, 0x2a, 0x2f,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x41, 0x20, 0x72, 0x65, 0x67, 0x69, 0x73, 0x74, 0x65,
+ 0x72, 0x20, 0x70, 0x61, 0x69, 0x72, 0x2c, 0x20, 0x75, 0x73, 0x65, 0x64, 0x20, 0x77, 0x68, 0x6f,
+ 0x6c, 0x65, 0x20, 0x6f, 0x72, 0x20, 0x61, 0x20, 0x62, 0x79, 0x74, 0x65, 0x20, 0x61, 0x74, 0x20,
+ 0x61, 0x20, 0x74, 0x69, 0x6d, 0x65, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x74, 0x79, 0x70, 0x65, 0x64,
+ 0x65, 0x66, 0x20, 0x75, 0x6e, 0x69, 0x6f, 0x6e, 0x20, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x77, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x20, 0x7b, 0x0d, 0x0a, 0x23,
+ 0x69, 0x66, 0x20, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x57, 0x4f, 0x52, 0x44, 0x53,
+ 0x5f, 0x42, 0x49, 0x47, 0x45, 0x4e, 0x44, 0x49, 0x41, 0x4e, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x5c,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x28, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x64, 0x28, 0x5f,
+ 0x5f, 0x42, 0x59, 0x54, 0x45, 0x5f, 0x4f, 0x52, 0x44, 0x45, 0x52, 0x5f, 0x5f, 0x29, 0x20, 0x26,
+ 0x26, 0x20, 0x5f, 0x5f, 0x42, 0x59, 0x54, 0x45, 0x5f, 0x4f, 0x52, 0x44, 0x45, 0x52, 0x5f, 0x5f,
+ 0x20, 0x3d, 0x3d, 0x20, 0x5f, 0x5f, 0x4f, 0x52, 0x44, 0x45, 0x52, 0x5f, 0x42, 0x49, 0x47, 0x5f,
+ 0x45, 0x4e, 0x44, 0x49, 0x41, 0x4e, 0x5f, 0x5f, 0x29, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x68,
+ 0x69, 0x2c, 0x20, 0x6c, 0x6f, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68,
+ 0x61, 0x72, 0x20, 0x6c, 0x6f, 0x2c, 0x20, 0x68, 0x69, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64,
+ 0x69, 0x66, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x78, 0x3b, 0x0d, 0x0a, 0x7d, 0x20, 0x72,
+ 0x65, 0x67, 0x70, 0x61, 0x69, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x54, 0x68,
+ 0x65, 0x20, 0x72, 0x65, 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x73, 0x20, 0x6f, 0x74, 0x68, 0x65,
+ 0x72, 0x20, 0x74, 0x68, 0x61, 0x6e, 0x20, 0x41, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x46, 0x20, 0x61,
+ 0x72, 0x65, 0x20, 0x6b, 0x65, 0x70, 0x74, 0x20, 0x61, 0x73, 0x20, 0x70, 0x61, 0x69, 0x72, 0x73,
+ 0x2c, 0x20, 0x74, 0x68, 0x65, 0x20, 0x38, 0x2d, 0x62, 0x69, 0x74, 0x20, 0x6f, 0x6e, 0x65, 0x73,
+ 0x20, 0x62, 0x65, 0x69, 0x6e, 0x67, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x68, 0x65, 0x20, 0x68,
+ 0x61, 0x6c, 0x76, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x6d, 0x2c, 0x20, 0x73,
+ 0x6f, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x31, 0x36, 0x2d, 0x62, 0x69, 0x74, 0x20, 0x6f, 0x70,
+ 0x65, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x20, 0x6e, 0x65, 0x65, 0x64, 0x20, 0x6e, 0x6f,
+ 0x20, 0x73, 0x68, 0x69, 0x66, 0x74, 0x69, 0x6e, 0x67, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x23, 0x64,
+ 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x62, 0x63, 0x20, 0x20, 0x28, 0x72, 0x62, 0x63, 0x2e, 0x77,
+ 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x62, 0x20, 0x20, 0x20, 0x28,
+ 0x72, 0x62, 0x63, 0x2e, 0x78, 0x2e, 0x68, 0x69, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
+ 0x6e, 0x65, 0x20, 0x63, 0x20, 0x20, 0x20, 0x28, 0x72, 0x62, 0x63, 0x2e, 0x78, 0x2e, 0x6c, 0x6f,
+ 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x64, 0x65, 0x20, 0x20, 0x28,
+ 0x72, 0x64, 0x65, 0x2e, 0x77, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x64, 0x20, 0x20, 0x20, 0x28, 0x72, 0x64, 0x65, 0x2e, 0x78, 0x2e, 0x68, 0x69, 0x29, 0x0d, 0x0a,
+ 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x65, 0x20, 0x20, 0x20, 0x28, 0x72, 0x64, 0x65,
+ 0x2e, 0x78, 0x2e, 0x6c, 0x6f, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x68, 0x6c, 0x20, 0x20, 0x28, 0x72, 0x68, 0x6c, 0x2e, 0x77, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65,
+ 0x66, 0x69, 0x6e, 0x65, 0x20, 0x68, 0x20, 0x20, 0x20, 0x28, 0x72, 0x68, 0x6c, 0x2e, 0x78, 0x2e,
+ 0x68, 0x69, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x6c, 0x20, 0x20,
+ 0x20, 0x28, 0x72, 0x68, 0x6c, 0x2e, 0x78, 0x2e, 0x6c, 0x6f, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65,
+ 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69, 0x78, 0x20, 0x20, 0x28, 0x72, 0x69, 0x78, 0x2e, 0x77, 0x29,
+ 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69, 0x78, 0x68, 0x20, 0x28, 0x72,
+ 0x69, 0x78, 0x2e, 0x78, 0x2e, 0x68, 0x69, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e,
+ 0x65, 0x20, 0x69, 0x78, 0x6c, 0x20, 0x28, 0x72, 0x69, 0x78, 0x2e, 0x78, 0x2e, 0x6c, 0x6f, 0x29,
+ 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69, 0x79, 0x20, 0x20, 0x28, 0x72,
+ 0x69, 0x79, 0x2e, 0x77, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69,
+ 0x79, 0x68, 0x20, 0x28, 0x72, 0x69, 0x79, 0x2e, 0x78, 0x2e, 0x68, 0x69, 0x29, 0x0d, 0x0a, 0x23,
+ 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69, 0x79, 0x6c, 0x20, 0x28, 0x72, 0x69, 0x79, 0x2e,
+ 0x78, 0x2e, 0x6c, 0x6f, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x62,
+ 0x63, 0x31, 0x20, 0x28, 0x72, 0x62, 0x63, 0x31, 0x2e, 0x77, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65,
+ 0x66, 0x69, 0x6e, 0x65, 0x20, 0x64, 0x65, 0x31, 0x20, 0x28, 0x72, 0x64, 0x65, 0x31, 0x2e, 0x77,
+ 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x68, 0x6c, 0x31, 0x20, 0x28,
+ 0x72, 0x68, 0x6c, 0x31, 0x2e, 0x77, 0x29, 0x0d, 0x0a,
+0};
+const char xlat_src_z80ops[] = {
+ 0x2f, 0x2a, 0x20, 0x45, 0x6d, 0x75, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x20, 0x6f, 0x66,
+ 0x20, 0x74, 0x68, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x20, 0x43, 0x50, 0x55, 0x20, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x73, 0x65, 0x74, 0x20, 0x2d, 0x20, 0x70,
+ 0x61, 0x72, 0x74, 0x20, 0x6f, 0x66, 0x20, 0x78, 0x7a, 0x38, 0x30, 0x2e, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x43, 0x6f, 0x70, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x43, 0x29, 0x20, 0x31,
+ 0x39, 0x39, 0x34, 0x20, 0x49, 0x61, 0x6e, 0x20, 0x43, 0x6f, 0x6c, 0x6c, 0x69, 0x65, 0x72, 0x2e,
+ 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20, 0x70, 0x72,
+ 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x66, 0x72, 0x65, 0x65, 0x20, 0x73, 0x6f,
+ 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x3b, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x63, 0x61, 0x6e, 0x20,
+ 0x72, 0x65, 0x64, 0x69, 0x73, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x20, 0x69, 0x74, 0x20,
+ 0x61, 0x6e, 0x64, 0x2f, 0x6f, 0x72, 0x20, 0x6d, 0x6f, 0x64, 0x69, 0x66, 0x79, 0x0d, 0x0a, 0x20,
+ 0x2a, 0x20, 0x69, 0x74, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x74,
+ 0x65, 0x72, 0x6d, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x47, 0x4e, 0x55, 0x20,
+ 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c,
+ 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x20, 0x61, 0x73, 0x20, 0x70, 0x75, 0x62, 0x6c, 0x69, 0x73,
+ 0x68, 0x65, 0x64, 0x20, 0x62, 0x79, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x68, 0x65, 0x20, 0x46,
+ 0x72, 0x65, 0x65, 0x20, 0x53, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x20, 0x46, 0x6f, 0x75,
+ 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x3b, 0x20, 0x65, 0x69, 0x74, 0x68, 0x65, 0x72, 0x20,
+ 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x32, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x2c, 0x20, 0x6f, 0x72, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x28, 0x61, 0x74, 0x20, 0x79, 0x6f, 0x75, 0x72, 0x20, 0x6f, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+ 0x29, 0x20, 0x61, 0x6e, 0x79, 0x20, 0x6c, 0x61, 0x74, 0x65, 0x72, 0x20, 0x76, 0x65, 0x72, 0x73,
+ 0x69, 0x6f, 0x6e, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54, 0x68, 0x69,
+ 0x73, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x64, 0x69, 0x73,
+ 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20,
+ 0x68, 0x6f, 0x70, 0x65, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x69, 0x74, 0x20, 0x77, 0x69, 0x6c,
+ 0x6c, 0x20, 0x62, 0x65, 0x20, 0x75, 0x73, 0x65, 0x66, 0x75, 0x6c, 0x2c, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x62, 0x75, 0x74, 0x20, 0x57, 0x49, 0x54, 0x48, 0x4f, 0x55, 0x54, 0x20, 0x41, 0x4e, 0x59,
+ 0x20, 0x57, 0x41, 0x52, 0x52, 0x41, 0x4e, 0x54, 0x59, 0x3b, 0x20, 0x77, 0x69, 0x74, 0x68, 0x6f,
+ 0x75, 0x74, 0x20, 0x65, 0x76, 0x65, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d, 0x70, 0x6c,
+ 0x69, 0x65, 0x64, 0x20, 0x77, 0x61, 0x72, 0x72, 0x61, 0x6e, 0x74, 0x79, 0x20, 0x6f, 0x66, 0x0d,
+ 0x0a, 0x20, 0x2a, 0x20, 0x4d, 0x45, 0x52, 0x43, 0x48, 0x41, 0x4e, 0x54, 0x41, 0x42, 0x49, 0x4c,
+ 0x49, 0x54, 0x59, 0x20, 0x6f, 0x72, 0x20, 0x46, 0x49, 0x54, 0x4e, 0x45, 0x53, 0x53, 0x20, 0x46,
+ 0x4f, 0x52, 0x20, 0x41, 0x20, 0x50, 0x41, 0x52, 0x54, 0x49, 0x43, 0x55, 0x4c, 0x41, 0x52, 0x20,
+ 0x50, 0x55, 0x52, 0x50, 0x4f, 0x53, 0x45, 0x2e, 0x20, 0x20, 0x53, 0x65, 0x65, 0x20, 0x74, 0x68,
+ 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x47, 0x4e, 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61,
+ 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65,
+ 0x20, 0x66, 0x6f, 0x72, 0x20, 0x6d, 0x6f, 0x72, 0x65, 0x20, 0x64, 0x65, 0x74, 0x61, 0x69, 0x6c,
+ 0x73, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x59, 0x6f, 0x75, 0x20, 0x73,
+ 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x72, 0x65, 0x63, 0x65, 0x69,
+ 0x76, 0x65, 0x64, 0x20, 0x61, 0x20, 0x63, 0x6f, 0x70, 0x79, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68,
+ 0x65, 0x20, 0x47, 0x4e, 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75,
+ 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x61, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x74, 0x68, 0x69, 0x73,
+ 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x3b, 0x20, 0x69, 0x66, 0x20, 0x6e, 0x6f, 0x74,
+ 0x2c, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65, 0x20, 0x46,
+ 0x72, 0x65, 0x65, 0x20, 0x53, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x20, 0x46, 0x6f, 0x75, 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x49, 0x6e, 0x63,
+ 0x2e, 0x2c, 0x20, 0x36, 0x37, 0x35, 0x20, 0x4d, 0x61, 0x73, 0x73, 0x20, 0x41, 0x76, 0x65, 0x2c,
+ 0x20, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x2c, 0x20, 0x4d, 0x41, 0x20, 0x30,
+ 0x32, 0x31, 0x33, 0x39, 0x2c, 0x20, 0x55, 0x53, 0x41, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x2f, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20, 0x66, 0x69, 0x6c, 0x65, 0x20,
+ 0x69, 0x73, 0x20, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x64, 0x20, 0x74, 0x68, 0x72, 0x65,
+ 0x65, 0x20, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x20, 0x62, 0x79, 0x20, 0x7a, 0x38, 0x30, 0x2e, 0x63,
+ 0x20, 0x74, 0x6f, 0x20, 0x62, 0x75, 0x69, 0x6c, 0x64, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x6f, 0x70,
+ 0x63, 0x6f, 0x64, 0x65, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x65,
+ 0x61, 0x63, 0x68, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x75, 0x6e, 0x70, 0x72, 0x65, 0x66, 0x69, 0x78,
+ 0x65, 0x64, 0x2c, 0x20, 0x44, 0x44, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x46, 0x44, 0x20, 0x70, 0x72,
+ 0x65, 0x66, 0x69, 0x78, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x69,
+ 0x6f, 0x6e, 0x73, 0x2c, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59,
+ 0x20, 0x73, 0x65, 0x74, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x6f, 0x20, 0x30, 0x2c, 0x20, 0x31,
+ 0x20, 0x61, 0x6e, 0x64, 0x20, 0x32, 0x2e, 0x20, 0x20, 0x78, 0x68, 0x6c, 0x2c, 0x20, 0x78, 0x68,
+ 0x20, 0x61, 0x6e, 0x64, 0x20, 0x78, 0x6c, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x20, 0x48, 0x4c, 0x2c,
+ 0x20, 0x49, 0x58, 0x20, 0x6f, 0x72, 0x20, 0x49, 0x59, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x74, 0x68,
+ 0x65, 0x69, 0x72, 0x20, 0x68, 0x61, 0x6c, 0x76, 0x65, 0x73, 0x20, 0x66, 0x6f, 0x72, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x74, 0x68, 0x65, 0x20, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x62, 0x65, 0x69,
+ 0x6e, 0x67, 0x20, 0x62, 0x75, 0x69, 0x6c, 0x74, 0x2e, 0x20, 0x20, 0x49, 0x6e, 0x73, 0x74, 0x72,
+ 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x61, 0x20, 0x44,
+ 0x44, 0x20, 0x6f, 0x72, 0x20, 0x46, 0x44, 0x20, 0x70, 0x72, 0x65, 0x66, 0x69, 0x78, 0x20, 0x64,
+ 0x6f, 0x65, 0x73, 0x20, 0x6e, 0x6f, 0x74, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x61, 0x66, 0x66, 0x65,
+ 0x63, 0x74, 0x20, 0x6f, 0x6e, 0x6c, 0x79, 0x20, 0x61, 0x70, 0x70, 0x65, 0x61, 0x72, 0x20, 0x69,
+ 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x66, 0x69, 0x72, 0x73, 0x74, 0x20, 0x74, 0x61, 0x62, 0x6c,
+ 0x65, 0x3b, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6f, 0x74, 0x68, 0x65, 0x72, 0x20, 0x74, 0x77, 0x6f,
+ 0x20, 0x66, 0x61, 0x6c, 0x6c, 0x20, 0x62, 0x61, 0x63, 0x6b, 0x20, 0x74, 0x6f, 0x20, 0x69, 0x74,
+ 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x6e, 0x64, 0x65,
+ 0x66, 0x20, 0x5a, 0x38, 0x30, 0x4f, 0x50, 0x53, 0x5f, 0x43, 0x4f, 0x4d, 0x4d, 0x4f, 0x4e, 0x0d,
+ 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x4f, 0x50, 0x53, 0x5f,
+ 0x43, 0x4f, 0x4d, 0x4d, 0x4f, 0x4e, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x64, 0x65, 0x66,
+ 0x20, 0x5f, 0x5f, 0x6c, 0x69, 0x6e, 0x75, 0x78, 0x5f, 0x5f, 0x0d, 0x0a, 0x23, 0x69, 0x6e, 0x63,
+ 0x6c, 0x75, 0x64, 0x65, 0x20, 0x3c, 0x73, 0x79, 0x73, 0x2f, 0x76, 0x66, 0x73, 0x2e, 0x68, 0x3e,
+ 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66,
+ 0x69, 0x6e, 0x65, 0x20, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x6f, 0x70, 0x63, 0x6f, 0x64, 0x65,
+ 0x2c, 0x63, 0x79, 0x63, 0x6c, 0x65, 0x73, 0x29, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x6f, 0x70,
+ 0x63, 0x6f, 0x64, 0x65, 0x3a, 0x20, 0x7b, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d,
+ 0x63, 0x79, 0x63, 0x6c, 0x65, 0x73, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x63, 0x79, 0x20, 0x28, 0x66, 0x26, 0x31,
+ 0x29, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69, 0x6e, 0x63,
+ 0x28, 0x76, 0x61, 0x72, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x38, 0x2d, 0x62, 0x69, 0x74, 0x20, 0x69,
+ 0x6e, 0x63, 0x72, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x2a, 0x2f, 0x20, 0x28, 0x20, 0x76, 0x61,
+ 0x72, 0x2b, 0x2b, 0x2c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x28, 0x76, 0x61, 0x72, 0x26, 0x30, 0x78, 0x61,
+ 0x38, 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x28, 0x28, 0x21, 0x28, 0x76, 0x61, 0x72, 0x26, 0x31, 0x35, 0x29, 0x29, 0x3c, 0x3c, 0x34,
+ 0x29, 0x7c, 0x28, 0x28, 0x21, 0x76, 0x61, 0x72, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x76, 0x61,
+ 0x72, 0x3d, 0x3d, 0x31, 0x32, 0x38, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x64, 0x65, 0x63, 0x28, 0x76, 0x61, 0x72, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x38, 0x2d, 0x62, 0x69,
+ 0x74, 0x20, 0x64, 0x65, 0x63, 0x72, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x2a, 0x2f, 0x20, 0x28,
+ 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x28, 0x76, 0x61, 0x72,
+ 0x26, 0x31, 0x35, 0x29, 0x29, 0x3c, 0x3c, 0x34, 0x29, 0x7c, 0x32, 0x2c, 0x5c, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2d, 0x2d, 0x76, 0x61, 0x72, 0x2c, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x7c, 0x3d, 0x28, 0x76, 0x61,
+ 0x72, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x76, 0x61, 0x72, 0x3d, 0x3d, 0x31,
+ 0x32, 0x37, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x21, 0x76, 0x61, 0x72, 0x29, 0x3c, 0x3c,
+ 0x36, 0x29, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x29, 0x0d, 0x0a, 0x23,
+ 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x73, 0x77, 0x61, 0x70, 0x28, 0x78, 0x2c, 0x79, 0x29,
+ 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20,
+ 0x74, 0x3d, 0x78, 0x3b, 0x20, 0x78, 0x3d, 0x79, 0x3b, 0x20, 0x79, 0x3d, 0x74, 0x3b, 0x7d, 0x0d,
+ 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x73, 0x77, 0x61, 0x70, 0x32, 0x28, 0x78,
+ 0x2c, 0x79, 0x29, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68,
+ 0x6f, 0x72, 0x74, 0x20, 0x74, 0x3d, 0x78, 0x3b, 0x20, 0x78, 0x3d, 0x79, 0x3b, 0x20, 0x79, 0x3d,
+ 0x74, 0x3b, 0x7d, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x61, 0x64, 0x64,
+ 0x31, 0x36, 0x28, 0x76, 0x61, 0x72, 0x2c, 0x78, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x31, 0x36, 0x2d,
+ 0x62, 0x69, 0x74, 0x20, 0x61, 0x64, 0x64, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x75, 0x6e,
+ 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x74, 0x3d, 0x28, 0x78,
+ 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26,
+ 0x30, 0x78, 0x63, 0x34, 0x29, 0x7c, 0x28, 0x28, 0x28, 0x28, 0x76, 0x61, 0x72, 0x29, 0x26, 0x30,
+ 0x78, 0x66, 0x66, 0x66, 0x29, 0x2b, 0x28, 0x74, 0x26, 0x30, 0x78, 0x66, 0x66, 0x66, 0x29, 0x3e,
+ 0x30, 0x78, 0x66, 0x66, 0x66, 0x29, 0x3c, 0x3c, 0x34, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x74, 0x2b, 0x3d, 0x28, 0x76, 0x61, 0x72, 0x29, 0x3b, 0x5c, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x76, 0x61, 0x72, 0x3d, 0x74, 0x3b, 0x5c, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x7c, 0x3d, 0x28, 0x28, 0x74, 0x3e, 0x3e, 0x38, 0x29, 0x26,
+ 0x30, 0x78, 0x32, 0x38, 0x29, 0x7c, 0x28, 0x74, 0x3e, 0x3e, 0x31, 0x36, 0x29, 0x3b, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a,
+ 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x78, 0x2c, 0x63,
+ 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x38, 0x2d, 0x62, 0x69, 0x74, 0x20, 0x61, 0x64, 0x64, 0x20, 0x2a,
+ 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68,
+ 0x6f, 0x72, 0x74, 0x20, 0x79, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x7a, 0x3d, 0x28,
+ 0x78, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x79, 0x3d, 0x61, 0x2b,
+ 0x7a, 0x2b, 0x28, 0x63, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66,
+ 0x3d, 0x28, 0x79, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x79, 0x3e, 0x3e, 0x38, 0x29,
+ 0x7c, 0x28, 0x28, 0x28, 0x61, 0x26, 0x30, 0x78, 0x30, 0x66, 0x29, 0x2b, 0x28, 0x7a, 0x26, 0x30,
+ 0x78, 0x30, 0x66, 0x29, 0x2b, 0x28, 0x63, 0x29, 0x3e, 0x31, 0x35, 0x29, 0x3c, 0x3c, 0x34, 0x29,
+ 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x28, 0x7e,
+ 0x61, 0x5e, 0x7a, 0x29, 0x26, 0x30, 0x78, 0x38, 0x30, 0x26, 0x28, 0x79, 0x5e, 0x61, 0x29, 0x29,
+ 0x3e, 0x3e, 0x35, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x7c,
+ 0x3d, 0x28, 0x21, 0x28, 0x61, 0x3d, 0x79, 0x29, 0x29, 0x3c, 0x3c, 0x36, 0x3b, 0x5c, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23,
+ 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x78, 0x2c, 0x63, 0x29,
+ 0x20, 0x2f, 0x2a, 0x20, 0x38, 0x2d, 0x62, 0x69, 0x74, 0x20, 0x73, 0x75, 0x62, 0x74, 0x72, 0x61,
+ 0x63, 0x74, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x79, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72,
+ 0x20, 0x7a, 0x3d, 0x28, 0x78, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x79, 0x3d, 0x28, 0x61, 0x2d, 0x7a, 0x2d, 0x28, 0x63, 0x29, 0x29, 0x26, 0x30, 0x78, 0x31, 0x66,
+ 0x66, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x79, 0x26,
+ 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x79, 0x3e, 0x3e, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x28,
+ 0x61, 0x26, 0x30, 0x78, 0x30, 0x66, 0x29, 0x3c, 0x28, 0x7a, 0x26, 0x30, 0x78, 0x30, 0x66, 0x29,
+ 0x2b, 0x28, 0x63, 0x29, 0x29, 0x3c, 0x3c, 0x34, 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x28, 0x61, 0x5e, 0x7a, 0x29, 0x26, 0x30, 0x78, 0x38,
+ 0x30, 0x26, 0x28, 0x79, 0x5e, 0x61, 0x29, 0x29, 0x3e, 0x3e, 0x35, 0x29, 0x7c, 0x32, 0x3b, 0x5c,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x7c, 0x3d, 0x28, 0x21, 0x28, 0x61, 0x3d,
+ 0x79, 0x29, 0x29, 0x3c, 0x3c, 0x36, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77,
+ 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+ 0x20, 0x63, 0x70, 0x61, 0x28, 0x78, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x38, 0x2d, 0x62, 0x69, 0x74,
+ 0x20, 0x63, 0x6f, 0x6d, 0x70, 0x61, 0x72, 0x65, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x79, 0x3b,
+ 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x7a, 0x3d, 0x28, 0x78, 0x29, 0x3b, 0x5c, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x79, 0x3d, 0x28, 0x61, 0x2d, 0x7a, 0x29, 0x26, 0x30, 0x78,
+ 0x31, 0x66, 0x66, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28,
+ 0x79, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x79, 0x3e, 0x3e, 0x38, 0x29, 0x7c, 0x28,
+ 0x28, 0x28, 0x61, 0x26, 0x30, 0x78, 0x30, 0x66, 0x29, 0x3c, 0x28, 0x7a, 0x26, 0x30, 0x78, 0x30,
+ 0x66, 0x29, 0x29, 0x3c, 0x3c, 0x34, 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x28, 0x28, 0x28, 0x61, 0x5e, 0x7a, 0x29, 0x26, 0x30, 0x78, 0x38, 0x30, 0x26,
+ 0x28, 0x79, 0x5e, 0x61, 0x29, 0x29, 0x3e, 0x3e, 0x35, 0x29, 0x7c, 0x32, 0x7c, 0x28, 0x28, 0x21,
+ 0x79, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77,
+ 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+ 0x20, 0x61, 0x6e, 0x64, 0x61, 0x28, 0x78, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x6f, 0x67, 0x69,
+ 0x63, 0x61, 0x6c, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x26, 0x3d, 0x28, 0x78, 0x29, 0x3b, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x61, 0x26, 0x30, 0x78, 0x61, 0x38,
+ 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x30, 0x78, 0x31, 0x30,
+ 0x7c, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x61, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x7d, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65,
+ 0x66, 0x69, 0x6e, 0x65, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x78, 0x29, 0x20, 0x2f, 0x2a, 0x20,
+ 0x6c, 0x6f, 0x67, 0x69, 0x63, 0x61, 0x6c, 0x20, 0x78, 0x6f, 0x72, 0x20, 0x2a, 0x2f, 0x20, 0x64,
+ 0x6f, 0x7b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x5e, 0x3d, 0x28, 0x78,
+ 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x61, 0x26,
+ 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c,
+ 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x61, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x7d, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66,
+ 0x69, 0x6e, 0x65, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x78, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x6f,
+ 0x67, 0x69, 0x63, 0x61, 0x6c, 0x20, 0x6f, 0x72, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x5c,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x7c, 0x3d, 0x28, 0x78, 0x29, 0x3b, 0x5c,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x61, 0x26, 0x30, 0x78, 0x61,
+ 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x70, 0x61, 0x72,
+ 0x69, 0x74, 0x79, 0x28, 0x61, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77,
+ 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
+ 0x6e, 0x65, 0x20, 0x6a, 0x72, 0x20, 0x2f, 0x2a, 0x20, 0x65, 0x78, 0x65, 0x63, 0x75, 0x74, 0x65,
+ 0x20, 0x72, 0x65, 0x6c, 0x61, 0x74, 0x69, 0x76, 0x65, 0x20, 0x6a, 0x75, 0x6d, 0x70, 0x20, 0x2a,
+ 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x69, 0x6e, 0x74, 0x20, 0x6a, 0x3d, 0x28, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x29, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63,
+ 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x6a,
+ 0x2b, 0x31, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61,
+ 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77,
+ 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+ 0x20, 0x6a, 0x70, 0x20, 0x2f, 0x2a, 0x20, 0x65, 0x78, 0x65, 0x63, 0x75, 0x74, 0x65, 0x20, 0x6a,
+ 0x75, 0x6d, 0x70, 0x20, 0x2a, 0x2f, 0x20, 0x28, 0x70, 0x63, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x32, 0x28, 0x70, 0x63, 0x29, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x63, 0x61, 0x6c, 0x6c, 0x20, 0x2f, 0x2a, 0x20, 0x65, 0x78, 0x65, 0x63, 0x75, 0x74, 0x65, 0x20,
+ 0x63, 0x61, 0x6c, 0x6c, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x5c,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63,
+ 0x2b, 0x32, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x6a, 0x70, 0x3b,
+ 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29,
+ 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x72, 0x65, 0x74, 0x20, 0x2f, 0x2a,
+ 0x20, 0x65, 0x78, 0x65, 0x63, 0x75, 0x74, 0x65, 0x20, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6e, 0x20,
+ 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x74,
+ 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x36, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x70, 0x6f, 0x70, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x7d, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64,
+ 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x70, 0x6f, 0x70, 0x32, 0x28, 0x76, 0x61, 0x72, 0x29, 0x20,
+ 0x2f, 0x2a, 0x20, 0x70, 0x6f, 0x70, 0x20, 0x31, 0x36, 0x2d, 0x62, 0x69, 0x74, 0x20, 0x72, 0x65,
+ 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x20, 0x2a, 0x2f, 0x20, 0x28, 0x76, 0x61, 0x72, 0x3d, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x73, 0x70, 0x29, 0x2c, 0x73, 0x70, 0x2b, 0x3d, 0x32, 0x29,
+ 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x70, 0x6f, 0x70, 0x31, 0x28, 0x76,
+ 0x31, 0x2c, 0x76, 0x32, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x70, 0x6f, 0x70, 0x20, 0x72, 0x65, 0x67,
+ 0x69, 0x73, 0x74, 0x65, 0x72, 0x20, 0x70, 0x61, 0x69, 0x72, 0x20, 0x2a, 0x2f, 0x20, 0x28, 0x76,
+ 0x32, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x73, 0x70, 0x29, 0x2c, 0x5c, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x76, 0x31, 0x3d, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x28, 0x73, 0x70, 0x2b, 0x31, 0x29, 0x2c, 0x73, 0x70, 0x2b, 0x3d, 0x32,
+ 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32,
+ 0x28, 0x76, 0x61, 0x6c, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x70, 0x75, 0x73, 0x68, 0x20, 0x31, 0x36,
+ 0x2d, 0x62, 0x69, 0x74, 0x20, 0x72, 0x65, 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x20, 0x2a, 0x2f,
+ 0x20, 0x64, 0x6f, 0x7b, 0x73, 0x70, 0x2d, 0x3d, 0x32, 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32,
+ 0x28, 0x73, 0x70, 0x2c, 0x28, 0x76, 0x61, 0x6c, 0x29, 0x29, 0x3b, 0x7d, 0x5c, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x77, 0x68, 0x69,
+ 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x70,
+ 0x75, 0x73, 0x68, 0x31, 0x28, 0x76, 0x31, 0x2c, 0x76, 0x32, 0x29, 0x20, 0x2f, 0x2a, 0x20, 0x70,
+ 0x75, 0x73, 0x68, 0x20, 0x72, 0x65, 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x20, 0x70, 0x61, 0x69,
+ 0x72, 0x20, 0x2a, 0x2f, 0x20, 0x64, 0x6f, 0x7b, 0x73, 0x70, 0x2d, 0x3d, 0x32, 0x3b, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x62, 0x28, 0x73, 0x70, 0x2c, 0x76, 0x31, 0x2c,
+ 0x76, 0x32, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20,
+ 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
+ 0x6e, 0x65, 0x20, 0x78, 0x68, 0x6c, 0x20, 0x68, 0x6c, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
+ 0x6e, 0x65, 0x20, 0x78, 0x68, 0x20, 0x20, 0x68, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e,
+ 0x65, 0x20, 0x78, 0x6c, 0x20, 0x20, 0x6c, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+ 0x20, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x6f, 0x70, 0x63, 0x6f, 0x64, 0x65, 0x2c,
+ 0x63, 0x79, 0x63, 0x6c, 0x65, 0x73, 0x2c, 0x6d, 0x6f, 0x72, 0x65, 0x63, 0x79, 0x63, 0x6c, 0x65,
+ 0x73, 0x29, 0x20, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x6f, 0x70, 0x63, 0x6f, 0x64, 0x65, 0x3a, 0x20,
+ 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20,
+ 0x61, 0x64, 0x64, 0x72, 0x3d, 0x68, 0x6c, 0x3b, 0x20, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61,
+ 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x63, 0x79, 0x63, 0x6c, 0x65, 0x73, 0x0d, 0x0a, 0x23, 0x65, 0x6c,
+ 0x73, 0x65, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d,
+ 0x31, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x78, 0x68, 0x6c, 0x20, 0x69,
+ 0x78, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x78, 0x68, 0x20, 0x20, 0x69,
+ 0x78, 0x68, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x78, 0x6c, 0x20, 0x20,
+ 0x69, 0x78, 0x6c, 0x0d, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66,
+ 0x69, 0x6e, 0x65, 0x20, 0x78, 0x68, 0x6c, 0x20, 0x69, 0x79, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66,
+ 0x69, 0x6e, 0x65, 0x20, 0x78, 0x68, 0x20, 0x20, 0x69, 0x79, 0x68, 0x0d, 0x0a, 0x23, 0x64, 0x65,
+ 0x66, 0x69, 0x6e, 0x65, 0x20, 0x78, 0x6c, 0x20, 0x20, 0x69, 0x79, 0x6c, 0x0d, 0x0a, 0x23, 0x65,
+ 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x48, 0x4c,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x6f, 0x70, 0x63, 0x6f, 0x64, 0x65, 0x2c, 0x63, 0x79, 0x63,
+ 0x6c, 0x65, 0x73, 0x2c, 0x6d, 0x6f, 0x72, 0x65, 0x63, 0x79, 0x63, 0x6c, 0x65, 0x73, 0x29, 0x20,
+ 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x6f, 0x70, 0x63, 0x6f, 0x64, 0x65, 0x3a, 0x20, 0x7b, 0x75, 0x6e,
+ 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64,
+ 0x72, 0x3b, 0x20, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x63,
+ 0x79, 0x63, 0x6c, 0x65, 0x73, 0x2b, 0x6d, 0x6f, 0x72, 0x65, 0x63, 0x79, 0x63, 0x6c, 0x65, 0x73,
+ 0x3b, 0x20, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x78, 0x68, 0x6c, 0x2b, 0x28, 0x73,
+ 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x29, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x70, 0x63, 0x29, 0x3b, 0x20, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x0d, 0x0a, 0x23,
+ 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f,
+ 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x2c,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6e, 0x6f, 0x70, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x63, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b,
+ 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x62, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70,
+ 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x2c, 0x37,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x62, 0x63, 0x2c,
+ 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33, 0x2c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x62, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28, 0x62, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x63, 0x28,
+ 0x62, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x36, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x62, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63,
+ 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x61, 0x3d, 0x28, 0x61, 0x3c, 0x3c, 0x31, 0x29, 0x7c, 0x28, 0x61, 0x3e, 0x3e, 0x37,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78, 0x63, 0x34,
+ 0x29, 0x7c, 0x28, 0x61, 0x26, 0x30, 0x78, 0x32, 0x39, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x77, 0x61, 0x70, 0x28, 0x61,
+ 0x2c, 0x61, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x77, 0x61, 0x70, 0x28, 0x66,
+ 0x2c, 0x66, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x39, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64,
+ 0x31, 0x36, 0x28, 0x78, 0x68, 0x6c, 0x2c, 0x62, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58,
+ 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31,
+ 0x30, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x28, 0x62, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31, 0x31, 0x2c, 0x36, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x31, 0x32, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28, 0x63,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x64, 0x65, 0x63, 0x28, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31, 0x34,
+ 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31,
+ 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30,
+ 0x78, 0x63, 0x34, 0x29, 0x7c, 0x28, 0x61, 0x26, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x61, 0x3d, 0x28, 0x61, 0x3e, 0x3e, 0x31, 0x29, 0x7c, 0x28, 0x61, 0x3c, 0x3c, 0x37, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x7c, 0x3d, 0x61, 0x26, 0x30, 0x78, 0x32, 0x38, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x31, 0x36, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69,
+ 0x66, 0x28, 0x21, 0x2d, 0x2d, 0x62, 0x29, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x6a, 0x72, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31, 0x37,
+ 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x64, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x31, 0x38, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x64, 0x65, 0x2c, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x31, 0x39, 0x2c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x2b,
+ 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x30, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x31,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x63, 0x28, 0x64, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x32, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x64, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x7b, 0x69, 0x6e, 0x74, 0x20, 0x74, 0x3d, 0x61, 0x3e, 0x3e, 0x37, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x61, 0x3d, 0x28, 0x61, 0x3c, 0x3c, 0x31, 0x29, 0x7c, 0x28, 0x66, 0x26, 0x31, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78, 0x63, 0x34, 0x29, 0x7c,
+ 0x28, 0x61, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x7c, 0x74, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7d,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x34, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x6a, 0x72, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x32, 0x35, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x31,
+ 0x36, 0x28, 0x78, 0x68, 0x6c, 0x2c, 0x64, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f,
+ 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x36,
+ 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x64, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x37, 0x2c, 0x36, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32,
+ 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28, 0x65, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x32, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x64, 0x65, 0x63, 0x28, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33, 0x30, 0x2c,
+ 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28,
+ 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33, 0x31,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7b, 0x69, 0x6e, 0x74, 0x20, 0x74, 0x3d, 0x61,
+ 0x26, 0x31, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x28, 0x61, 0x3e, 0x3e, 0x31, 0x29,
+ 0x7c, 0x28, 0x66, 0x3c, 0x3c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28,
+ 0x66, 0x26, 0x30, 0x78, 0x63, 0x34, 0x29, 0x7c, 0x28, 0x61, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29,
+ 0x7c, 0x74, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33, 0x32, 0x2c,
+ 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x30,
+ 0x29, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x6a,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23,
+ 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33,
+ 0x33, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52,
+ 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x68, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b, 0x2b,
+ 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x6c,
+ 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x33, 0x34, 0x2c, 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20,
+ 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x23, 0x69,
+ 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x62, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x68, 0x2c,
+ 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x78, 0x68, 0x6c, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x33, 0x35, 0x2c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78,
+ 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33, 0x36, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28, 0x78, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x33, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x63,
+ 0x28, 0x78, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x33, 0x38, 0x2c, 0x37, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49,
+ 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x33, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x2f, 0x2a, 0x20, 0x46, 0x72, 0x61, 0x6e, 0x6b, 0x20, 0x44, 0x2e, 0x20, 0x43, 0x72, 0x69,
+ 0x6e, 0x67, 0x6c, 0x65, 0x27, 0x73, 0x20, 0x44, 0x41, 0x41, 0x20, 0x69, 0x6d, 0x70, 0x6c, 0x65,
+ 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x63, 0x6f, 0x6e, 0x76, 0x65,
+ 0x72, 0x74, 0x65, 0x64, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x79, 0x61, 0x7a, 0x65, 0x20, 0x31,
+ 0x2e, 0x31, 0x30, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x61, 0x63, 0x75, 0x2c, 0x74, 0x65, 0x6d, 0x70,
+ 0x2c, 0x63, 0x62, 0x69, 0x74, 0x73, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x61, 0x63, 0x75, 0x3d, 0x61, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x65, 0x6d, 0x70,
+ 0x3d, 0x28, 0x61, 0x63, 0x75, 0x26, 0x31, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63,
+ 0x62, 0x69, 0x74, 0x73, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x69, 0x66, 0x28, 0x66, 0x26, 0x32, 0x29, 0x09, 0x2f, 0x2a, 0x20, 0x69, 0x66, 0x20, 0x4e, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x61, 0x73, 0x74, 0x20, 0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69,
+ 0x6f, 0x6e, 0x20, 0x77, 0x61, 0x73, 0x20, 0x61, 0x20, 0x73, 0x75, 0x62, 0x74, 0x72, 0x61, 0x63,
+ 0x74, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x68,
+ 0x64, 0x3d, 0x28, 0x63, 0x62, 0x69, 0x74, 0x73, 0x20, 0x7c, 0x7c, 0x20, 0x28, 0x61, 0x63, 0x75,
+ 0x3e, 0x30, 0x78, 0x39, 0x39, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69,
+ 0x66, 0x28, 0x28, 0x66, 0x26, 0x31, 0x36, 0x29, 0x20, 0x7c, 0x7c, 0x20, 0x28, 0x74, 0x65, 0x6d,
+ 0x70, 0x3e, 0x39, 0x29, 0x29, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x20,
+ 0x2f, 0x2a, 0x20, 0x61, 0x64, 0x6a, 0x75, 0x73, 0x74, 0x20, 0x6c, 0x6f, 0x77, 0x20, 0x64, 0x69,
+ 0x67, 0x69, 0x74, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69,
+ 0x66, 0x28, 0x74, 0x65, 0x6d, 0x70, 0x3e, 0x35, 0x29, 0x20, 0x66, 0x26, 0x3d, 0x7e, 0x31, 0x36,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x63, 0x75, 0x2d, 0x3d, 0x36,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x63, 0x75, 0x26, 0x3d, 0x30,
+ 0x78, 0x66, 0x66, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x61, 0x64, 0x6a, 0x75, 0x73, 0x74, 0x20, 0x68,
+ 0x69, 0x67, 0x68, 0x20, 0x64, 0x69, 0x67, 0x69, 0x74, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x68, 0x64, 0x29, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x61, 0x63, 0x75, 0x2d, 0x3d, 0x30, 0x78, 0x31, 0x36, 0x30, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20,
+ 0x6c, 0x61, 0x73, 0x74, 0x20, 0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x77,
+ 0x61, 0x73, 0x20, 0x61, 0x6e, 0x20, 0x61, 0x64, 0x64, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x28, 0x66, 0x26, 0x31, 0x36, 0x29, 0x20, 0x7c, 0x7c, 0x20,
+ 0x28, 0x74, 0x65, 0x6d, 0x70, 0x3e, 0x39, 0x29, 0x29, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x61,
+ 0x64, 0x6a, 0x75, 0x73, 0x74, 0x20, 0x6c, 0x6f, 0x77, 0x20, 0x64, 0x69, 0x67, 0x69, 0x74, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x74, 0x65,
+ 0x6d, 0x70, 0x3e, 0x39, 0x29, 0x20, 0x66, 0x7c, 0x3d, 0x31, 0x36, 0x3b, 0x20, 0x65, 0x6c, 0x73,
+ 0x65, 0x20, 0x66, 0x26, 0x3d, 0x7e, 0x31, 0x36, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x61, 0x63, 0x75, 0x2b, 0x3d, 0x36, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x61, 0x64, 0x6a,
+ 0x75, 0x73, 0x74, 0x20, 0x68, 0x69, 0x67, 0x68, 0x20, 0x64, 0x69, 0x67, 0x69, 0x74, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x63, 0x62, 0x69, 0x74, 0x73,
+ 0x20, 0x7c, 0x7c, 0x20, 0x28, 0x28, 0x61, 0x63, 0x75, 0x26, 0x30, 0x78, 0x31, 0x66, 0x30, 0x29,
+ 0x3e, 0x30, 0x78, 0x39, 0x30, 0x29, 0x29, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x61, 0x63, 0x75, 0x2b, 0x3d, 0x30, 0x78, 0x36, 0x30, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x7d, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x62, 0x69, 0x74, 0x73, 0x7c, 0x3d, 0x28, 0x28,
+ 0x61, 0x63, 0x75, 0x3e, 0x3e, 0x38, 0x29, 0x26, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x61, 0x63, 0x75, 0x26, 0x3d, 0x30, 0x78, 0x66, 0x66, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61,
+ 0x3d, 0x61, 0x63, 0x75, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x28, 0x61, 0x63,
+ 0x75, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x61, 0x63, 0x75, 0x3d, 0x3d, 0x30,
+ 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x28, 0x66, 0x26, 0x30, 0x78, 0x31, 0x32, 0x29, 0x7c, 0x70,
+ 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x61, 0x29, 0x7c, 0x63, 0x62, 0x69, 0x74, 0x73, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34, 0x30, 0x2c, 0x37, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x30, 0x29,
+ 0x6a, 0x72, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b,
+ 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23,
+ 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34,
+ 0x31, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x31, 0x36,
+ 0x28, 0x78, 0x68, 0x6c, 0x2c, 0x78, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34,
+ 0x32, 0x2c, 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70,
+ 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49,
+ 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x68, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2b, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x23, 0x65,
+ 0x6c, 0x73, 0x65, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x32, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69,
+ 0x66, 0x0d, 0x0a, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34, 0x33, 0x2c, 0x36, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x34, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28,
+ 0x78, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x63, 0x28, 0x78, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x34, 0x36, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6c, 0x3d, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63,
+ 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x61, 0x3d, 0x7e, 0x61, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66,
+ 0x26, 0x30, 0x78, 0x63, 0x35, 0x29, 0x7c, 0x28, 0x61, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x7c,
+ 0x30, 0x78, 0x31, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x34, 0x38, 0x2c, 0x37, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x31, 0x29, 0x70, 0x63, 0x2b, 0x2b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x6a, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x34, 0x39, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73,
+ 0x70, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x35, 0x30, 0x2c,
+ 0x31, 0x33, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b,
+ 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x2c, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x35, 0x31, 0x2c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x70, 0x2b, 0x2b, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e,
+ 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x35,
+ 0x32, 0x2c, 0x31, 0x31, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73,
+ 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x74, 0x3d, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e,
+ 0x63, 0x28, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28,
+ 0x61, 0x64, 0x64, 0x72, 0x2c, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x35, 0x33, 0x2c, 0x31, 0x31, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20,
+ 0x74, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x64, 0x65, 0x63, 0x28, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73,
+ 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x35, 0x34, 0x2c, 0x31, 0x30, 0x2c, 0x35,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64,
+ 0x72, 0x2c, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59,
+ 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x35, 0x35, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78, 0x63, 0x34, 0x29,
+ 0x7c, 0x31, 0x7c, 0x28, 0x61, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x35, 0x36, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66,
+ 0x26, 0x31, 0x29, 0x6a, 0x72, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20,
+ 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x35, 0x37, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64,
+ 0x64, 0x31, 0x36, 0x28, 0x78, 0x68, 0x6c, 0x2c, 0x73, 0x70, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49,
+ 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x35, 0x38, 0x2c, 0x31, 0x33, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69,
+ 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d,
+ 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7d, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x35, 0x39, 0x2c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x70,
+ 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x36, 0x30, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x69, 0x6e, 0x63, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x36,
+ 0x31, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x65, 0x63, 0x28, 0x61, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x36, 0x32, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x61, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x70, 0x63, 0x2b,
+ 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x36, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78, 0x63, 0x34, 0x29, 0x7c, 0x28, 0x63, 0x79,
+ 0x5e, 0x31, 0x29, 0x7c, 0x28, 0x63, 0x79, 0x3c, 0x3c, 0x34, 0x29, 0x7c, 0x28, 0x61, 0x26, 0x30,
+ 0x78, 0x32, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x30, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x64, 0x20, 0x62, 0x2c, 0x62,
+ 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x31, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x62, 0x3d, 0x63, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x34, 0x32, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x62, 0x3d, 0x64, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x62, 0x3d, 0x65, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x34, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x62,
+ 0x3d, 0x78, 0x68, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x35, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x62, 0x3d, 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x34, 0x36, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x62, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69,
+ 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x62, 0x3d, 0x61, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x38, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x3d, 0x62, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x34, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6c,
+ 0x64, 0x20, 0x63, 0x2c, 0x63, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34,
+ 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x3d, 0x64, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x3d, 0x65, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x34, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x3d,
+ 0x78, 0x68, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x64, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x3d, 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x34, 0x65, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66,
+ 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x34, 0x66, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63,
+ 0x3d, 0x61, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x30, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x3d, 0x62, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x35, 0x31, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x3d, 0x63, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x32, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x64, 0x20, 0x64, 0x2c, 0x64, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x35, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64,
+ 0x3d, 0x65, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x35, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x3d, 0x78,
+ 0x68, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x64, 0x3d, 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x35, 0x36, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64,
+ 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20,
+ 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x35, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x64, 0x3d,
+ 0x61, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d, 0x62, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35,
+ 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d, 0x63, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x65, 0x3d, 0x64, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x62, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x64, 0x20, 0x65, 0x2c, 0x65, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23,
+ 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x35, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d, 0x78, 0x68,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x65, 0x3d, 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x35, 0x65, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d,
+ 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49,
+ 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x35, 0x66, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x3d, 0x61,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65,
+ 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x36, 0x30, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x3d, 0x62, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x31, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x78, 0x68, 0x3d, 0x63, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x32,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x3d, 0x64, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x78, 0x68, 0x3d, 0x65, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d,
+ 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x34, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x64, 0x20, 0x68, 0x2c, 0x68, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23,
+ 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x36, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x3d, 0x78,
+ 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x36, 0x2c, 0x37, 0x2c,
+ 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x68, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28,
+ 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x37, 0x2c,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x3d, 0x61, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x36, 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78,
+ 0x6c, 0x3d, 0x62, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x39, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6c, 0x3d, 0x63, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x36, 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6c, 0x3d,
+ 0x64, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6c, 0x3d, 0x65, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x36, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6c, 0x3d, 0x78, 0x68,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x64, 0x20, 0x6c, 0x2c, 0x6c, 0x20, 0x2a, 0x2f, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69,
+ 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36,
+ 0x65, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6c, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x36, 0x66, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6c, 0x3d, 0x61,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x30, 0x2c, 0x37, 0x2c, 0x38,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64,
+ 0x72, 0x2c, 0x62, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x31,
+ 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65,
+ 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x37, 0x32, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73,
+ 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x33, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x65, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x34, 0x2c, 0x37, 0x2c, 0x38,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64,
+ 0x72, 0x2c, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x35,
+ 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65,
+ 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52,
+ 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37,
+ 0x36, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x09, 0x2f, 0x2a, 0x20, 0x57, 0x61, 0x73, 0x20, 0x48,
+ 0x41, 0x4c, 0x54, 0x20, 0x2d, 0x20, 0x5a, 0x58, 0x43, 0x43, 0x20, 0x69, 0x67, 0x6e, 0x6f, 0x72,
+ 0x65, 0x73, 0x20, 0x48, 0x41, 0x4c, 0x54, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x37, 0x2c, 0x37, 0x2c,
+ 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x2c, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d,
+ 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x38, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x62, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x37, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x63,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x61, 0x3d, 0x64, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x62,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x65, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x63, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x78, 0x68, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x37, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d,
+ 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x65, 0x2c, 0x37,
+ 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59,
+ 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x66, 0x2c,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x2f, 0x2a, 0x20, 0x6c, 0x64, 0x20, 0x61, 0x2c,
+ 0x61, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x30, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x62, 0x2c, 0x30, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x31, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x63, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x38, 0x32, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64,
+ 0x64, 0x61, 0x28, 0x64, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38,
+ 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x65,
+ 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x38, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64,
+ 0x64, 0x61, 0x28, 0x78, 0x68, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x38, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28,
+ 0x78, 0x6c, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38,
+ 0x36, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61,
+ 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x2c, 0x30, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23,
+ 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x61, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x38, 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64,
+ 0x61, 0x28, 0x62, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38,
+ 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x63,
+ 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x61, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x64, 0x2c, 0x63, 0x79,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x65, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64,
+ 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x63,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x78, 0x68,
+ 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x64, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x78, 0x6c, 0x2c, 0x63,
+ 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x38, 0x65, 0x2c, 0x37,
+ 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66,
+ 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x38, 0x66, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61,
+ 0x64, 0x64, 0x61, 0x28, 0x61, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x39, 0x30, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61,
+ 0x28, 0x62, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x31, 0x2c,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x63, 0x2c, 0x30,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x32, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x64, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x73, 0x75, 0x62, 0x61, 0x28, 0x65, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x78, 0x68, 0x2c, 0x30, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x78, 0x6c, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x36, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64,
+ 0x72, 0x29, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d,
+ 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x37, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x61, 0x2c, 0x30, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x62, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x73, 0x75, 0x62, 0x61, 0x28, 0x63, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x39, 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62,
+ 0x61, 0x28, 0x64, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39,
+ 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x65,
+ 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x39, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73,
+ 0x75, 0x62, 0x61, 0x28, 0x78, 0x68, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x39, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62,
+ 0x61, 0x28, 0x78, 0x6c, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x39, 0x65, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73,
+ 0x75, 0x62, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x2c,
+ 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x39, 0x66, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x61, 0x2c, 0x63, 0x79, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x30, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x61, 0x6e, 0x64, 0x61, 0x28, 0x62, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x61, 0x31, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x6e, 0x64, 0x61,
+ 0x28, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x32, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x6e, 0x64, 0x61, 0x28, 0x64, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x61, 0x6e, 0x64, 0x61, 0x28, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x61, 0x6e, 0x64, 0x61, 0x28, 0x78, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x61, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x6e, 0x64,
+ 0x61, 0x28, 0x78, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61,
+ 0x36, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x6e, 0x64, 0x61,
+ 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66,
+ 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x61, 0x37, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61,
+ 0x6e, 0x64, 0x61, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x38,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x62, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x61, 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72,
+ 0x61, 0x28, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x62, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x65, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64,
+ 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x63,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x78, 0x68,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x78, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x65, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d,
+ 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x66, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x30, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x6f, 0x72, 0x61, 0x28, 0x62, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x31,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x63, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x32, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x62, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x65,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23,
+ 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x62, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28,
+ 0x78, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x35, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x78, 0x6c, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x36, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d,
+ 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x37, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x62, 0x38, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63,
+ 0x70, 0x61, 0x28, 0x62, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x39, 0x2c,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x63, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x61, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x63, 0x70, 0x61, 0x28, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62,
+ 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x65, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65,
+ 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x62, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x78,
+ 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x64, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x78, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x48, 0x4c, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x65, 0x2c, 0x37, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64,
+ 0x72, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x66, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x63, 0x30, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66,
+ 0x28, 0x21, 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x30, 0x29, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x31, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x6f, 0x70, 0x32, 0x28, 0x62, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x63, 0x32, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66,
+ 0x28, 0x21, 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x30, 0x29, 0x29, 0x6a, 0x70, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x33, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x6a, 0x70, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x34, 0x2c, 0x31, 0x30,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x21, 0x28, 0x66, 0x26, 0x30, 0x78,
+ 0x34, 0x30, 0x29, 0x29, 0x63, 0x61, 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c,
+ 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x63, 0x35, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68,
+ 0x32, 0x28, 0x62, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x36, 0x2c,
+ 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70,
+ 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x37, 0x2c, 0x31, 0x31,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x3d, 0x30, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x63, 0x38, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28,
+ 0x66, 0x26, 0x30, 0x78, 0x34, 0x30, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x63, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x61, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x30, 0x29, 0x6a, 0x70,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65,
+ 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x63, 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x23, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65,
+ 0x20, 0x22, 0x63, 0x62, 0x6f, 0x70, 0x73, 0x2e, 0x68, 0x22, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f,
+ 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x63, 0x63, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66,
+ 0x26, 0x30, 0x78, 0x34, 0x30, 0x29, 0x63, 0x61, 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x63, 0x64, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x65, 0x2c, 0x37, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28,
+ 0x70, 0x63, 0x29, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b,
+ 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x63, 0x66, 0x2c, 0x31, 0x31, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x3d, 0x38, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x64, 0x30, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x21, 0x63,
+ 0x79, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x31, 0x2c,
+ 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x6f, 0x70, 0x32, 0x28, 0x64, 0x65,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x32, 0x2c, 0x31, 0x30, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x21, 0x63, 0x79, 0x29, 0x6a, 0x70, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x33, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74,
+ 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x61, 0x2c, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70,
+ 0x63, 0x29, 0x2c, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x34, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x21, 0x63, 0x79, 0x29, 0x63, 0x61, 0x6c, 0x6c, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x35, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x64, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x64, 0x36, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x75,
+ 0x62, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x2c, 0x30, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x64, 0x37, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73,
+ 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x3d, 0x31,
+ 0x36, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x38, 0x2c, 0x35, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x63, 0x79, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x39, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x73, 0x77, 0x61, 0x70, 0x32, 0x28, 0x62, 0x63, 0x2c, 0x62, 0x63, 0x31, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x73, 0x77, 0x61, 0x70, 0x32, 0x28, 0x64, 0x65, 0x2c, 0x64, 0x65, 0x31, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x77, 0x61, 0x70, 0x32, 0x28, 0x68, 0x6c, 0x2c, 0x68,
+ 0x6c, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x61, 0x2c, 0x31, 0x30,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x63, 0x79, 0x29, 0x6a, 0x70, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x62, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f,
+ 0x72, 0x74, 0x20, 0x74, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x74,
+ 0x3d, 0x69, 0x6e, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x61, 0x2c, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x74, 0x3e, 0x3e, 0x38, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x63, 0x2c, 0x31, 0x30, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x63, 0x79, 0x29, 0x63, 0x61, 0x6c, 0x6c, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x67, 0x6f, 0x74, 0x6f, 0x20, 0x69, 0x78, 0x70, 0x72, 0x65, 0x66, 0x69, 0x78, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x65, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x73, 0x75, 0x62, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29,
+ 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x64, 0x66, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x70, 0x63, 0x3d, 0x32, 0x34, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x30,
+ 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x21, 0x28, 0x66, 0x26,
+ 0x34, 0x29, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x31, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x6f, 0x70, 0x32, 0x28, 0x78, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49,
+ 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x65, 0x32, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66,
+ 0x28, 0x21, 0x28, 0x66, 0x26, 0x34, 0x29, 0x29, 0x6a, 0x70, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x33, 0x2c, 0x31, 0x39, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73,
+ 0x68, 0x6f, 0x72, 0x74, 0x20, 0x74, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x73, 0x70,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x28, 0x73, 0x70,
+ 0x2c, 0x78, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x68, 0x6c, 0x3d, 0x74,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d,
+ 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x34, 0x2c, 0x31,
+ 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x21, 0x28, 0x66, 0x26, 0x34,
+ 0x29, 0x29, 0x63, 0x61, 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65,
+ 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x35, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x78, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20,
+ 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x65, 0x36, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x6e,
+ 0x64, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65,
+ 0x37, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32,
+ 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x3d, 0x33, 0x32, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x38, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x34, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x39, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x3d, 0x78, 0x68, 0x6c, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66,
+ 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d, 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x65, 0x61, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x69, 0x66, 0x28, 0x66, 0x26, 0x34, 0x29, 0x6a, 0x70, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65,
+ 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x65, 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x77, 0x61, 0x70,
+ 0x32, 0x28, 0x64, 0x65, 0x2c, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x65, 0x63, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66,
+ 0x26, 0x34, 0x29, 0x63, 0x61, 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73,
+ 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65,
+ 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x23, 0x69, 0x6e, 0x63, 0x6c, 0x75, 0x64, 0x65, 0x22,
+ 0x65, 0x64, 0x6f, 0x70, 0x73, 0x2e, 0x68, 0x22, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65,
+ 0x65, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x78, 0x6f, 0x72, 0x61, 0x28, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70,
+ 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x65, 0x66, 0x2c, 0x31, 0x31,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x3d, 0x34, 0x30, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x66, 0x30, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66,
+ 0x28, 0x21, 0x28, 0x66, 0x26, 0x30, 0x78, 0x38, 0x30, 0x29, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x31, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x6f, 0x70, 0x31, 0x28, 0x61, 0x2c, 0x66, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x66, 0x32, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69,
+ 0x66, 0x28, 0x21, 0x28, 0x66, 0x26, 0x30, 0x78, 0x38, 0x30, 0x29, 0x29, 0x6a, 0x70, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x33, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x69, 0x66, 0x66, 0x31, 0x3d, 0x69, 0x66, 0x66, 0x32, 0x3d, 0x30, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x69, 0x6e, 0x74, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x3d, 0x30, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x34, 0x2c, 0x31, 0x30, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x69, 0x66, 0x28, 0x21, 0x28, 0x66, 0x26, 0x30, 0x78, 0x38, 0x30, 0x29, 0x29, 0x63, 0x61,
+ 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63, 0x2b,
+ 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x35, 0x2c, 0x31, 0x31, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x31, 0x28, 0x61, 0x2c, 0x66, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x36, 0x2c, 0x37, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x6f, 0x72, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x66, 0x37, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70,
+ 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63,
+ 0x3d, 0x34, 0x38, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x38, 0x2c, 0x35, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x30, 0x78, 0x38, 0x30, 0x29,
+ 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x66, 0x39, 0x2c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x70,
+ 0x3d, 0x78, 0x68, 0x6c, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x3d, 0x3d,
+ 0x30, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x61, 0x2c, 0x31, 0x30,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x30, 0x78, 0x38, 0x30,
+ 0x29, 0x6a, 0x70, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70, 0x63,
+ 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x62, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x66, 0x31, 0x3d, 0x69, 0x66, 0x66, 0x32, 0x3d,
+ 0x31, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x74, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+ 0x3d, 0x30, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x63, 0x2c, 0x31, 0x30, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x66, 0x26, 0x30, 0x78, 0x38, 0x30, 0x29,
+ 0x63, 0x61, 0x6c, 0x6c, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x70,
+ 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x64, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x67, 0x6f, 0x74, 0x6f, 0x20, 0x69, 0x79, 0x70, 0x72,
+ 0x65, 0x66, 0x69, 0x78, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x65, 0x2c, 0x37,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x70, 0x63, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x66, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x70, 0x75, 0x73, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x70, 0x63, 0x3d, 0x35, 0x36, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x0d, 0x0a, 0x23,
+ 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x78, 0x68, 0x6c, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65,
+ 0x66, 0x20, 0x78, 0x68, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x78, 0x6c, 0x0d,
+ 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x48, 0x4c, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x0d,
+ 0x0a,
+0};
+const char xlat_src_cbops[] = {
+ 0x2f, 0x2a, 0x20, 0x45, 0x6d, 0x75, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x20, 0x6f, 0x66,
+ 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x42, 0x20, 0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6f,
+ 0x6e, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x20, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x73, 0x65, 0x74, 0x2e, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x43, 0x6f, 0x70, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x43, 0x29,
+ 0x20, 0x31, 0x39, 0x39, 0x34, 0x20, 0x49, 0x61, 0x6e, 0x20, 0x43, 0x6f, 0x6c, 0x6c, 0x69, 0x65,
+ 0x72, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20,
+ 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x66, 0x72, 0x65, 0x65, 0x20,
+ 0x73, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x3b, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x63, 0x61,
+ 0x6e, 0x20, 0x72, 0x65, 0x64, 0x69, 0x73, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x20, 0x69,
+ 0x74, 0x20, 0x61, 0x6e, 0x64, 0x2f, 0x6f, 0x72, 0x20, 0x6d, 0x6f, 0x64, 0x69, 0x66, 0x79, 0x0d,
+ 0x0a, 0x20, 0x2a, 0x20, 0x69, 0x74, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x74, 0x65, 0x72, 0x6d, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x47, 0x4e,
+ 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63,
+ 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x20, 0x61, 0x73, 0x20, 0x70, 0x75, 0x62, 0x6c,
+ 0x69, 0x73, 0x68, 0x65, 0x64, 0x20, 0x62, 0x79, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x46, 0x72, 0x65, 0x65, 0x20, 0x53, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x20, 0x46,
+ 0x6f, 0x75, 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x3b, 0x20, 0x65, 0x69, 0x74, 0x68, 0x65,
+ 0x72, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x32, 0x20, 0x6f, 0x66, 0x20, 0x74,
+ 0x68, 0x65, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x2c, 0x20, 0x6f, 0x72, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x28, 0x61, 0x74, 0x20, 0x79, 0x6f, 0x75, 0x72, 0x20, 0x6f, 0x70, 0x74, 0x69,
+ 0x6f, 0x6e, 0x29, 0x20, 0x61, 0x6e, 0x79, 0x20, 0x6c, 0x61, 0x74, 0x65, 0x72, 0x20, 0x76, 0x65,
+ 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54,
+ 0x68, 0x69, 0x73, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x64,
+ 0x69, 0x73, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68,
+ 0x65, 0x20, 0x68, 0x6f, 0x70, 0x65, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x69, 0x74, 0x20, 0x77,
+ 0x69, 0x6c, 0x6c, 0x20, 0x62, 0x65, 0x20, 0x75, 0x73, 0x65, 0x66, 0x75, 0x6c, 0x2c, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x62, 0x75, 0x74, 0x20, 0x57, 0x49, 0x54, 0x48, 0x4f, 0x55, 0x54, 0x20, 0x41,
+ 0x4e, 0x59, 0x20, 0x57, 0x41, 0x52, 0x52, 0x41, 0x4e, 0x54, 0x59, 0x3b, 0x20, 0x77, 0x69, 0x74,
+ 0x68, 0x6f, 0x75, 0x74, 0x20, 0x65, 0x76, 0x65, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d,
+ 0x70, 0x6c, 0x69, 0x65, 0x64, 0x20, 0x77, 0x61, 0x72, 0x72, 0x61, 0x6e, 0x74, 0x79, 0x20, 0x6f,
+ 0x66, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x4d, 0x45, 0x52, 0x43, 0x48, 0x41, 0x4e, 0x54, 0x41, 0x42,
+ 0x49, 0x4c, 0x49, 0x54, 0x59, 0x20, 0x6f, 0x72, 0x20, 0x46, 0x49, 0x54, 0x4e, 0x45, 0x53, 0x53,
+ 0x20, 0x46, 0x4f, 0x52, 0x20, 0x41, 0x20, 0x50, 0x41, 0x52, 0x54, 0x49, 0x43, 0x55, 0x4c, 0x41,
+ 0x52, 0x20, 0x50, 0x55, 0x52, 0x50, 0x4f, 0x53, 0x45, 0x2e, 0x20, 0x20, 0x53, 0x65, 0x65, 0x20,
+ 0x74, 0x68, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x47, 0x4e, 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65,
+ 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e,
+ 0x73, 0x65, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x6d, 0x6f, 0x72, 0x65, 0x20, 0x64, 0x65, 0x74, 0x61,
+ 0x69, 0x6c, 0x73, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x59, 0x6f, 0x75,
+ 0x20, 0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x72, 0x65, 0x63,
+ 0x65, 0x69, 0x76, 0x65, 0x64, 0x20, 0x61, 0x20, 0x63, 0x6f, 0x70, 0x79, 0x20, 0x6f, 0x66, 0x20,
+ 0x74, 0x68, 0x65, 0x20, 0x47, 0x4e, 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20,
+ 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x61, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x74, 0x68,
+ 0x69, 0x73, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x3b, 0x20, 0x69, 0x66, 0x20, 0x6e,
+ 0x6f, 0x74, 0x2c, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x46, 0x72, 0x65, 0x65, 0x20, 0x53, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x46, 0x6f, 0x75, 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x49,
+ 0x6e, 0x63, 0x2e, 0x2c, 0x20, 0x36, 0x37, 0x35, 0x20, 0x4d, 0x61, 0x73, 0x73, 0x20, 0x41, 0x76,
+ 0x65, 0x2c, 0x20, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x2c, 0x20, 0x4d, 0x41,
+ 0x20, 0x30, 0x32, 0x31, 0x33, 0x39, 0x2c, 0x20, 0x55, 0x53, 0x41, 0x2e, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x76, 0x61, 0x72,
+ 0x5f, 0x74, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68,
+ 0x61, 0x72, 0x20, 0x74, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x72, 0x6c,
+ 0x63, 0x28, 0x78, 0x29, 0x20, 0x20, 0x28, 0x78, 0x3d, 0x28, 0x78, 0x3c, 0x3c, 0x31, 0x29, 0x7c,
+ 0x28, 0x78, 0x3e, 0x3e, 0x37, 0x29, 0x2c, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x28, 0x78, 0x2c,
+ 0x78, 0x26, 0x31, 0x29, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x72,
+ 0x72, 0x63, 0x28, 0x78, 0x29, 0x20, 0x20, 0x64, 0x6f, 0x7b, 0x76, 0x61, 0x72, 0x5f, 0x74, 0x3d,
+ 0x78, 0x26, 0x31, 0x3b, 0x78, 0x3d, 0x28, 0x78, 0x3e, 0x3e, 0x31, 0x29, 0x7c, 0x28, 0x74, 0x3c,
+ 0x3c, 0x37, 0x29, 0x3b, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x28, 0x78, 0x2c, 0x74, 0x29, 0x3b,
+ 0x7d, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69,
+ 0x6e, 0x65, 0x20, 0x72, 0x6c, 0x28, 0x78, 0x29, 0x20, 0x20, 0x20, 0x64, 0x6f, 0x7b, 0x76, 0x61,
+ 0x72, 0x5f, 0x74, 0x3d, 0x78, 0x3e, 0x3e, 0x37, 0x3b, 0x78, 0x3d, 0x28, 0x78, 0x3c, 0x3c, 0x31,
+ 0x29, 0x7c, 0x28, 0x66, 0x26, 0x31, 0x29, 0x3b, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x28, 0x78,
+ 0x2c, 0x74, 0x29, 0x3b, 0x7d, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23,
+ 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x72, 0x72, 0x28, 0x78, 0x29, 0x20, 0x20, 0x20, 0x64,
+ 0x6f, 0x7b, 0x76, 0x61, 0x72, 0x5f, 0x74, 0x3d, 0x78, 0x26, 0x31, 0x3b, 0x78, 0x3d, 0x28, 0x78,
+ 0x3e, 0x3e, 0x31, 0x29, 0x7c, 0x28, 0x66, 0x3c, 0x3c, 0x37, 0x29, 0x3b, 0x72, 0x66, 0x6c, 0x61,
+ 0x67, 0x73, 0x28, 0x78, 0x2c, 0x74, 0x29, 0x3b, 0x7d, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30,
+ 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x73, 0x6c, 0x61, 0x28, 0x78,
+ 0x29, 0x20, 0x20, 0x64, 0x6f, 0x7b, 0x76, 0x61, 0x72, 0x5f, 0x74, 0x3d, 0x78, 0x3e, 0x3e, 0x37,
+ 0x3b, 0x78, 0x3c, 0x3c, 0x3d, 0x31, 0x3b, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x28, 0x78, 0x2c,
+ 0x74, 0x29, 0x3b, 0x7d, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64,
+ 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x73, 0x72, 0x61, 0x28, 0x78, 0x29, 0x20, 0x20, 0x64, 0x6f,
+ 0x7b, 0x76, 0x61, 0x72, 0x5f, 0x74, 0x3d, 0x78, 0x26, 0x31, 0x3b, 0x78, 0x3d, 0x28, 0x28, 0x73,
+ 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x29, 0x78, 0x29, 0x3e, 0x3e, 0x31,
+ 0x3b, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x28, 0x78, 0x2c, 0x74, 0x29, 0x3b, 0x7d, 0x77, 0x68,
+ 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x73, 0x6c, 0x6c, 0x28, 0x78, 0x29, 0x20, 0x20, 0x64, 0x6f, 0x7b, 0x76, 0x61, 0x72, 0x5f, 0x74,
+ 0x3d, 0x78, 0x3e, 0x3e, 0x37, 0x3b, 0x78, 0x3d, 0x28, 0x78, 0x3c, 0x3c, 0x31, 0x29, 0x7c, 0x31,
+ 0x3b, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x28, 0x78, 0x2c, 0x74, 0x29, 0x3b, 0x7d, 0x77, 0x68,
+ 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20,
+ 0x73, 0x72, 0x6c, 0x28, 0x78, 0x29, 0x20, 0x20, 0x64, 0x6f, 0x7b, 0x76, 0x61, 0x72, 0x5f, 0x74,
+ 0x3d, 0x78, 0x26, 0x31, 0x3b, 0x78, 0x3e, 0x3e, 0x3d, 0x31, 0x3b, 0x72, 0x66, 0x6c, 0x61, 0x67,
+ 0x73, 0x28, 0x78, 0x2c, 0x74, 0x29, 0x3b, 0x7d, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x28, 0x30, 0x29,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x72, 0x66, 0x6c, 0x61,
+ 0x67, 0x73, 0x28, 0x78, 0x2c, 0x63, 0x29, 0x20, 0x28, 0x66, 0x3d, 0x28, 0x63, 0x29, 0x7c, 0x28,
+ 0x78, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x78, 0x29, 0x3c, 0x3c, 0x36,
+ 0x29, 0x7c, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x78, 0x29, 0x29, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x78, 0x29,
+ 0x20, 0x28, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x28, 0x28, 0x78, 0x26, 0x28, 0x31,
+ 0x3c, 0x3c, 0x6e, 0x29, 0x29, 0x3f, 0x30, 0x78, 0x31, 0x30, 0x3a, 0x30, 0x78, 0x35, 0x34, 0x29,
+ 0x7c, 0x28, 0x78, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66,
+ 0x69, 0x6e, 0x65, 0x20, 0x73, 0x65, 0x74, 0x28, 0x6e, 0x2c, 0x78, 0x29, 0x20, 0x28, 0x78, 0x7c,
+ 0x3d, 0x28, 0x31, 0x3c, 0x3c, 0x6e, 0x29, 0x29, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e,
+ 0x65, 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x78, 0x29, 0x20, 0x28, 0x78, 0x26, 0x3d, 0x7e,
+ 0x28, 0x31, 0x3c, 0x3c, 0x6e, 0x29, 0x29, 0x0d, 0x0a, 0x0d, 0x0a, 0x7b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20,
+ 0x61, 0x64, 0x64, 0x72, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x6f, 0x70, 0x2c, 0x76, 0x61, 0x6c, 0x3b, 0x0d,
+ 0x0a, 0x23, 0x69, 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x72, 0x65,
+ 0x67, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x78, 0x68, 0x6c, 0x2b,
+ 0x28, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x29, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x38,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x70, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70,
+ 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x67, 0x3d, 0x6f, 0x70, 0x26, 0x37,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6f, 0x70, 0x3d, 0x28, 0x6f, 0x70, 0x26, 0x30, 0x78, 0x66,
+ 0x38, 0x29, 0x7c, 0x36, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6c, 0x73, 0x65, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x6f, 0x70, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x34, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x72, 0x61, 0x64, 0x6a, 0x75, 0x73, 0x74, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x68, 0x6c, 0x3b, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64,
+ 0x69, 0x66, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x6f, 0x70, 0x3c, 0x36, 0x34, 0x29, 0x73, 0x77, 0x69, 0x74,
+ 0x63, 0x68, 0x28, 0x6f, 0x70, 0x29, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x20, 0x30, 0x3a, 0x20, 0x72, 0x6c, 0x63, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x31, 0x3a,
+ 0x20, 0x72, 0x6c, 0x63, 0x28, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x32, 0x3a, 0x20, 0x72, 0x6c, 0x63,
+ 0x28, 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x33, 0x3a, 0x20, 0x72, 0x6c, 0x63, 0x28, 0x65, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x20, 0x34, 0x3a, 0x20, 0x72, 0x6c, 0x63, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x35, 0x3a,
+ 0x20, 0x72, 0x6c, 0x63, 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x36, 0x3a, 0x20, 0x74, 0x73, 0x74,
+ 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x72, 0x6c, 0x63, 0x28, 0x76, 0x61, 0x6c, 0x29,
+ 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29,
+ 0x3b, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x20, 0x37, 0x3a, 0x20, 0x72, 0x6c, 0x63, 0x28, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x38, 0x3a,
+ 0x20, 0x72, 0x72, 0x63, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x20, 0x39, 0x3a, 0x20, 0x72, 0x72, 0x63,
+ 0x28, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x31, 0x30, 0x3a, 0x20, 0x72, 0x72, 0x63, 0x28, 0x64, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x31, 0x31, 0x3a, 0x20, 0x72, 0x72, 0x63, 0x28, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x31, 0x32, 0x3a,
+ 0x20, 0x72, 0x72, 0x63, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x31, 0x33, 0x3a, 0x20, 0x72, 0x72, 0x63,
+ 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x31, 0x34, 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73,
+ 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x29, 0x3b, 0x72, 0x72, 0x63, 0x28, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f,
+ 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x31, 0x35, 0x3a,
+ 0x20, 0x72, 0x72, 0x63, 0x28, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x30, 0x3a, 0x20, 0x72,
+ 0x6c, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x31, 0x3a, 0x20, 0x72, 0x6c, 0x28, 0x63,
+ 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x32, 0x3a, 0x20, 0x72, 0x6c, 0x28, 0x64, 0x29, 0x3b, 0x20,
+ 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20,
+ 0x30, 0x78, 0x31, 0x33, 0x3a, 0x20, 0x72, 0x6c, 0x28, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31,
+ 0x34, 0x3a, 0x20, 0x72, 0x6c, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x35, 0x3a, 0x20,
+ 0x72, 0x6c, 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x36, 0x3a, 0x20, 0x74, 0x73, 0x74,
+ 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x72, 0x6c, 0x28, 0x76, 0x61, 0x6c, 0x29, 0x3b,
+ 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b,
+ 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20,
+ 0x30, 0x78, 0x31, 0x37, 0x3a, 0x20, 0x72, 0x6c, 0x28, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31,
+ 0x38, 0x3a, 0x20, 0x72, 0x72, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x39, 0x3a, 0x20,
+ 0x72, 0x72, 0x28, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x61, 0x3a, 0x20, 0x72, 0x72, 0x28,
+ 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63,
+ 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x62, 0x3a, 0x20, 0x72, 0x72, 0x28, 0x65, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x31, 0x63, 0x3a, 0x20, 0x72, 0x72, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72,
+ 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78,
+ 0x31, 0x64, 0x3a, 0x20, 0x72, 0x72, 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x65, 0x3a,
+ 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d,
+ 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x72, 0x72, 0x28, 0x76,
+ 0x61, 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76,
+ 0x61, 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63,
+ 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x31, 0x66, 0x3a, 0x20, 0x72, 0x72, 0x28, 0x61, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x32, 0x30, 0x3a, 0x20, 0x73, 0x6c, 0x61, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30,
+ 0x78, 0x32, 0x31, 0x3a, 0x20, 0x73, 0x6c, 0x61, 0x28, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32,
+ 0x32, 0x3a, 0x20, 0x73, 0x6c, 0x61, 0x28, 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x33, 0x3a,
+ 0x20, 0x73, 0x6c, 0x61, 0x28, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x34, 0x3a, 0x20, 0x73,
+ 0x6c, 0x61, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x35, 0x3a, 0x20, 0x73, 0x6c, 0x61,
+ 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x36, 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74,
+ 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28,
+ 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x73, 0x6c, 0x61, 0x28, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x73,
+ 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30,
+ 0x78, 0x32, 0x37, 0x3a, 0x20, 0x73, 0x6c, 0x61, 0x28, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32,
+ 0x38, 0x3a, 0x20, 0x73, 0x72, 0x61, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x39, 0x3a,
+ 0x20, 0x73, 0x72, 0x61, 0x28, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x61, 0x3a, 0x20, 0x73,
+ 0x72, 0x61, 0x28, 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x62, 0x3a, 0x20, 0x73, 0x72, 0x61,
+ 0x28, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x63, 0x3a, 0x20, 0x73, 0x72, 0x61, 0x28, 0x68,
+ 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x64, 0x3a, 0x20, 0x73, 0x72, 0x61, 0x28, 0x6c, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x32, 0x65, 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d,
+ 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72,
+ 0x29, 0x3b, 0x73, 0x72, 0x61, 0x28, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65,
+ 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x32, 0x66, 0x3a,
+ 0x20, 0x73, 0x72, 0x61, 0x28, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x30, 0x3a, 0x20, 0x73,
+ 0x6c, 0x6c, 0x28, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x31, 0x3a, 0x20, 0x73, 0x6c, 0x6c,
+ 0x28, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x32, 0x3a, 0x20, 0x73, 0x6c, 0x6c, 0x28, 0x64,
+ 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x33, 0x3a, 0x20, 0x73, 0x6c, 0x6c, 0x28, 0x65, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x33, 0x34, 0x3a, 0x20, 0x73, 0x6c, 0x6c, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30,
+ 0x78, 0x33, 0x35, 0x3a, 0x20, 0x73, 0x6c, 0x6c, 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33,
+ 0x36, 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61,
+ 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x73, 0x6c,
+ 0x6c, 0x28, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64,
+ 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x37, 0x3a, 0x20, 0x73, 0x6c, 0x6c,
+ 0x28, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x38, 0x3a, 0x20, 0x73, 0x72, 0x6c, 0x28, 0x62,
+ 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x39, 0x3a, 0x20, 0x73, 0x72, 0x6c, 0x28, 0x63, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x33, 0x61, 0x3a, 0x20, 0x73, 0x72, 0x6c, 0x28, 0x64, 0x29, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30,
+ 0x78, 0x33, 0x62, 0x3a, 0x20, 0x73, 0x72, 0x6c, 0x28, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33,
+ 0x63, 0x3a, 0x20, 0x73, 0x72, 0x6c, 0x28, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x64, 0x3a,
+ 0x20, 0x73, 0x72, 0x6c, 0x28, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x65, 0x3a, 0x20, 0x74,
+ 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x37, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x73, 0x72, 0x6c, 0x28, 0x76, 0x61,
+ 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61,
+ 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x73, 0x65, 0x20, 0x30, 0x78, 0x33, 0x66, 0x3a, 0x20, 0x73, 0x72, 0x6c, 0x28, 0x61, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x6e, 0x3d, 0x28,
+ 0x6f, 0x70, 0x3e, 0x3e, 0x33, 0x29, 0x26, 0x37, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x73, 0x77, 0x69, 0x74, 0x63, 0x68, 0x28, 0x6f, 0x70, 0x26, 0x30, 0x78, 0x63, 0x37, 0x29,
+ 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78,
+ 0x34, 0x30, 0x3a, 0x20, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72,
+ 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x34, 0x31, 0x3a, 0x20, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x63, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63,
+ 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x34, 0x32, 0x3a, 0x20, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c,
+ 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x34, 0x33, 0x3a, 0x20, 0x62, 0x69, 0x74,
+ 0x28, 0x6e, 0x2c, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x34, 0x34, 0x3a, 0x20,
+ 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x34,
+ 0x35, 0x3a, 0x20, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65,
+ 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20,
+ 0x30, 0x78, 0x34, 0x36, 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x34,
+ 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29,
+ 0x3b, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f, 0x72,
+ 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65, 0x61,
+ 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30,
+ 0x78, 0x34, 0x37, 0x3a, 0x20, 0x62, 0x69, 0x74, 0x28, 0x6e, 0x2c, 0x61, 0x29, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73,
+ 0x65, 0x20, 0x30, 0x78, 0x38, 0x30, 0x3a, 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x62, 0x29,
+ 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x38, 0x31, 0x3a, 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e,
+ 0x2c, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x38, 0x32, 0x3a, 0x20, 0x72, 0x65,
+ 0x73, 0x28, 0x6e, 0x2c, 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x38, 0x33, 0x3a,
+ 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x65, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78,
+ 0x38, 0x34, 0x3a, 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x68, 0x29, 0x3b, 0x20, 0x62, 0x72,
+ 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65,
+ 0x20, 0x30, 0x78, 0x38, 0x35, 0x3a, 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x6c, 0x29, 0x3b,
+ 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63,
+ 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x38, 0x36, 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65,
+ 0x73, 0x2b, 0x3d, 0x34, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61,
+ 0x64, 0x64, 0x72, 0x29, 0x3b, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b,
+ 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76, 0x61, 0x6c, 0x29, 0x3b,
+ 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61,
+ 0x73, 0x65, 0x20, 0x30, 0x78, 0x38, 0x37, 0x3a, 0x20, 0x72, 0x65, 0x73, 0x28, 0x6e, 0x2c, 0x61,
+ 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x63, 0x30, 0x3a, 0x20, 0x73, 0x65, 0x74, 0x28,
+ 0x6e, 0x2c, 0x62, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x63, 0x31, 0x3a, 0x20, 0x73,
+ 0x65, 0x74, 0x28, 0x6e, 0x2c, 0x63, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x63, 0x32,
+ 0x3a, 0x20, 0x73, 0x65, 0x74, 0x28, 0x6e, 0x2c, 0x64, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61,
+ 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30,
+ 0x78, 0x63, 0x33, 0x3a, 0x20, 0x73, 0x65, 0x74, 0x28, 0x6e, 0x2c, 0x65, 0x29, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73,
+ 0x65, 0x20, 0x30, 0x78, 0x63, 0x34, 0x3a, 0x20, 0x73, 0x65, 0x74, 0x28, 0x6e, 0x2c, 0x68, 0x29,
+ 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x63, 0x35, 0x3a, 0x20, 0x73, 0x65, 0x74, 0x28, 0x6e,
+ 0x2c, 0x6c, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x63, 0x36, 0x3a, 0x20, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x34, 0x3b, 0x76, 0x61, 0x6c, 0x3d, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x73, 0x65, 0x74, 0x28, 0x6e, 0x2c, 0x76,
+ 0x61, 0x6c, 0x29, 0x3b, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x76,
+ 0x61, 0x6c, 0x29, 0x3b, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x78, 0x63, 0x37, 0x3a, 0x20, 0x73, 0x65, 0x74,
+ 0x28, 0x6e, 0x2c, 0x61, 0x29, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x23, 0x69,
+ 0x66, 0x20, 0x49, 0x58, 0x4f, 0x52, 0x49, 0x59, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x77, 0x69,
+ 0x74, 0x63, 0x68, 0x28, 0x72, 0x65, 0x67, 0x29, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x30, 0x3a, 0x62, 0x3d, 0x76, 0x61, 0x6c, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73,
+ 0x65, 0x20, 0x31, 0x3a, 0x63, 0x3d, 0x76, 0x61, 0x6c, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x32, 0x3a,
+ 0x64, 0x3d, 0x76, 0x61, 0x6c, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x33, 0x3a, 0x65, 0x3d, 0x76, 0x61,
+ 0x6c, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x34, 0x3a, 0x68, 0x3d, 0x76, 0x61, 0x6c, 0x3b, 0x20, 0x62,
+ 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73,
+ 0x65, 0x20, 0x35, 0x3a, 0x6c, 0x3d, 0x76, 0x61, 0x6c, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x63, 0x61, 0x73, 0x65, 0x20, 0x37, 0x3a,
+ 0x61, 0x3d, 0x76, 0x61, 0x6c, 0x3b, 0x20, 0x62, 0x72, 0x65, 0x61, 0x6b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x23, 0x65, 0x6e, 0x64, 0x69, 0x66, 0x0d, 0x0a, 0x7d, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x76, 0x61, 0x72, 0x5f, 0x74, 0x0d, 0x0a,
+ 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x72, 0x6c, 0x63, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64,
+ 0x65, 0x66, 0x20, 0x72, 0x72, 0x63, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x72,
+ 0x6c, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x72, 0x72, 0x0d, 0x0a, 0x23, 0x75,
+ 0x6e, 0x64, 0x65, 0x66, 0x20, 0x73, 0x6c, 0x61, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66,
+ 0x20, 0x73, 0x72, 0x61, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x73, 0x6c, 0x6c,
+ 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x73, 0x72, 0x6c, 0x0d, 0x0a, 0x23, 0x75,
+ 0x6e, 0x64, 0x65, 0x66, 0x20, 0x72, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x0d, 0x0a, 0x23, 0x75, 0x6e,
+ 0x64, 0x65, 0x66, 0x20, 0x62, 0x69, 0x74, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20,
+ 0x73, 0x65, 0x74, 0x0d, 0x0a, 0x23, 0x75, 0x6e, 0x64, 0x65, 0x66, 0x20, 0x72, 0x65, 0x73, 0x0d,
+ 0x0a,
+0};
+const char xlat_src_edops[] = {
+ 0x2f, 0x2a, 0x20, 0x45, 0x6d, 0x75, 0x6c, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x20, 0x6f, 0x66,
+ 0x20, 0x74, 0x68, 0x65, 0x20, 0x45, 0x44, 0x20, 0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6f,
+ 0x6e, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x20, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x73, 0x65, 0x74, 0x2e, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x43, 0x6f, 0x70, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x43, 0x29,
+ 0x20, 0x31, 0x39, 0x39, 0x34, 0x20, 0x49, 0x61, 0x6e, 0x20, 0x43, 0x6f, 0x6c, 0x6c, 0x69, 0x65,
+ 0x72, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54, 0x68, 0x69, 0x73, 0x20,
+ 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x66, 0x72, 0x65, 0x65, 0x20,
+ 0x73, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x3b, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x63, 0x61,
+ 0x6e, 0x20, 0x72, 0x65, 0x64, 0x69, 0x73, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x20, 0x69,
+ 0x74, 0x20, 0x61, 0x6e, 0x64, 0x2f, 0x6f, 0x72, 0x20, 0x6d, 0x6f, 0x64, 0x69, 0x66, 0x79, 0x0d,
+ 0x0a, 0x20, 0x2a, 0x20, 0x69, 0x74, 0x20, 0x75, 0x6e, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x74, 0x65, 0x72, 0x6d, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x47, 0x4e,
+ 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63,
+ 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x20, 0x61, 0x73, 0x20, 0x70, 0x75, 0x62, 0x6c,
+ 0x69, 0x73, 0x68, 0x65, 0x64, 0x20, 0x62, 0x79, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x46, 0x72, 0x65, 0x65, 0x20, 0x53, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x20, 0x46,
+ 0x6f, 0x75, 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x3b, 0x20, 0x65, 0x69, 0x74, 0x68, 0x65,
+ 0x72, 0x20, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x20, 0x32, 0x20, 0x6f, 0x66, 0x20, 0x74,
+ 0x68, 0x65, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x2c, 0x20, 0x6f, 0x72, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x28, 0x61, 0x74, 0x20, 0x79, 0x6f, 0x75, 0x72, 0x20, 0x6f, 0x70, 0x74, 0x69,
+ 0x6f, 0x6e, 0x29, 0x20, 0x61, 0x6e, 0x79, 0x20, 0x6c, 0x61, 0x74, 0x65, 0x72, 0x20, 0x76, 0x65,
+ 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x54,
+ 0x68, 0x69, 0x73, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x64,
+ 0x69, 0x73, 0x74, 0x72, 0x69, 0x62, 0x75, 0x74, 0x65, 0x64, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68,
+ 0x65, 0x20, 0x68, 0x6f, 0x70, 0x65, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x69, 0x74, 0x20, 0x77,
+ 0x69, 0x6c, 0x6c, 0x20, 0x62, 0x65, 0x20, 0x75, 0x73, 0x65, 0x66, 0x75, 0x6c, 0x2c, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x62, 0x75, 0x74, 0x20, 0x57, 0x49, 0x54, 0x48, 0x4f, 0x55, 0x54, 0x20, 0x41,
+ 0x4e, 0x59, 0x20, 0x57, 0x41, 0x52, 0x52, 0x41, 0x4e, 0x54, 0x59, 0x3b, 0x20, 0x77, 0x69, 0x74,
+ 0x68, 0x6f, 0x75, 0x74, 0x20, 0x65, 0x76, 0x65, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x69, 0x6d,
+ 0x70, 0x6c, 0x69, 0x65, 0x64, 0x20, 0x77, 0x61, 0x72, 0x72, 0x61, 0x6e, 0x74, 0x79, 0x20, 0x6f,
+ 0x66, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x4d, 0x45, 0x52, 0x43, 0x48, 0x41, 0x4e, 0x54, 0x41, 0x42,
+ 0x49, 0x4c, 0x49, 0x54, 0x59, 0x20, 0x6f, 0x72, 0x20, 0x46, 0x49, 0x54, 0x4e, 0x45, 0x53, 0x53,
+ 0x20, 0x46, 0x4f, 0x52, 0x20, 0x41, 0x20, 0x50, 0x41, 0x52, 0x54, 0x49, 0x43, 0x55, 0x4c, 0x41,
+ 0x52, 0x20, 0x50, 0x55, 0x52, 0x50, 0x4f, 0x53, 0x45, 0x2e, 0x20, 0x20, 0x53, 0x65, 0x65, 0x20,
+ 0x74, 0x68, 0x65, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x47, 0x4e, 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65,
+ 0x72, 0x61, 0x6c, 0x20, 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e,
+ 0x73, 0x65, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x6d, 0x6f, 0x72, 0x65, 0x20, 0x64, 0x65, 0x74, 0x61,
+ 0x69, 0x6c, 0x73, 0x2e, 0x0d, 0x0a, 0x20, 0x2a, 0x0d, 0x0a, 0x20, 0x2a, 0x20, 0x59, 0x6f, 0x75,
+ 0x20, 0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x68, 0x61, 0x76, 0x65, 0x20, 0x72, 0x65, 0x63,
+ 0x65, 0x69, 0x76, 0x65, 0x64, 0x20, 0x61, 0x20, 0x63, 0x6f, 0x70, 0x79, 0x20, 0x6f, 0x66, 0x20,
+ 0x74, 0x68, 0x65, 0x20, 0x47, 0x4e, 0x55, 0x20, 0x47, 0x65, 0x6e, 0x65, 0x72, 0x61, 0x6c, 0x20,
+ 0x50, 0x75, 0x62, 0x6c, 0x69, 0x63, 0x20, 0x4c, 0x69, 0x63, 0x65, 0x6e, 0x73, 0x65, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x61, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x77, 0x69, 0x74, 0x68, 0x20, 0x74, 0x68,
+ 0x69, 0x73, 0x20, 0x70, 0x72, 0x6f, 0x67, 0x72, 0x61, 0x6d, 0x3b, 0x20, 0x69, 0x66, 0x20, 0x6e,
+ 0x6f, 0x74, 0x2c, 0x20, 0x77, 0x72, 0x69, 0x74, 0x65, 0x20, 0x74, 0x6f, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x46, 0x72, 0x65, 0x65, 0x20, 0x53, 0x6f, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x0d, 0x0a,
+ 0x20, 0x2a, 0x20, 0x46, 0x6f, 0x75, 0x6e, 0x64, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x2c, 0x20, 0x49,
+ 0x6e, 0x63, 0x2e, 0x2c, 0x20, 0x36, 0x37, 0x35, 0x20, 0x4d, 0x61, 0x73, 0x73, 0x20, 0x41, 0x76,
+ 0x65, 0x2c, 0x20, 0x43, 0x61, 0x6d, 0x62, 0x72, 0x69, 0x64, 0x67, 0x65, 0x2c, 0x20, 0x4d, 0x41,
+ 0x20, 0x30, 0x32, 0x31, 0x33, 0x39, 0x2c, 0x20, 0x55, 0x53, 0x41, 0x2e, 0x0d, 0x0a, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x69, 0x6e, 0x70,
+ 0x75, 0x74, 0x28, 0x76, 0x61, 0x72, 0x29, 0x20, 0x7b, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x75, 0x3b, 0x5c, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x76, 0x61, 0x72, 0x3d, 0x75, 0x3d, 0x69, 0x6e, 0x28, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x75, 0x3e, 0x3e,
+ 0x38, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26,
+ 0x31, 0x29, 0x7c, 0x28, 0x76, 0x61, 0x72, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28,
+ 0x21, 0x76, 0x61, 0x72, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79,
+ 0x28, 0x76, 0x61, 0x72, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x23,
+ 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x73, 0x62, 0x63, 0x68, 0x6c, 0x28, 0x78, 0x29, 0x20,
+ 0x7b, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68,
+ 0x6f, 0x72, 0x74, 0x20, 0x7a, 0x3d, 0x28, 0x78, 0x29, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x6c, 0x6f, 0x6e, 0x67,
+ 0x20, 0x74, 0x3d, 0x28, 0x68, 0x6c, 0x2d, 0x7a, 0x2d, 0x63, 0x79, 0x29, 0x26, 0x30, 0x78, 0x31,
+ 0x66, 0x66, 0x66, 0x66, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d,
+ 0x28, 0x28, 0x74, 0x3e, 0x3e, 0x38, 0x29, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x74,
+ 0x3e, 0x3e, 0x31, 0x36, 0x29, 0x7c, 0x32, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x28, 0x28, 0x28, 0x68, 0x6c, 0x26, 0x30, 0x78, 0x66, 0x66, 0x66, 0x29, 0x3c,
+ 0x28, 0x7a, 0x26, 0x30, 0x78, 0x66, 0x66, 0x66, 0x29, 0x2b, 0x63, 0x79, 0x29, 0x3c, 0x3c, 0x34,
+ 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x28,
+ 0x68, 0x6c, 0x5e, 0x7a, 0x29, 0x26, 0x28, 0x68, 0x6c, 0x5e, 0x74, 0x29, 0x26, 0x30, 0x78, 0x38,
+ 0x30, 0x30, 0x30, 0x29, 0x3e, 0x3e, 0x31, 0x33, 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x21, 0x28, 0x74, 0x26, 0x30, 0x78, 0x66, 0x66, 0x66,
+ 0x66, 0x29, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x32, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x68, 0x6c, 0x3d, 0x74, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65, 0x20, 0x61, 0x64, 0x63, 0x68, 0x6c,
+ 0x28, 0x78, 0x29, 0x20, 0x7b, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x7a, 0x3d, 0x28, 0x78, 0x29, 0x3b, 0x5c, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20,
+ 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x74, 0x3d, 0x68, 0x6c, 0x2b, 0x7a, 0x2b, 0x63, 0x79, 0x3b, 0x5c,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x28, 0x74, 0x3e, 0x3e, 0x38,
+ 0x29, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x74, 0x3e, 0x3e, 0x31, 0x36, 0x29, 0x7c,
+ 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x28, 0x68, 0x6c,
+ 0x26, 0x30, 0x78, 0x66, 0x66, 0x66, 0x29, 0x2b, 0x28, 0x7a, 0x26, 0x30, 0x78, 0x66, 0x66, 0x66,
+ 0x29, 0x2b, 0x63, 0x79, 0x3e, 0x30, 0x78, 0x66, 0x66, 0x66, 0x29, 0x3c, 0x3c, 0x34, 0x29, 0x7c,
+ 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x28, 0x7e, 0x68,
+ 0x6c, 0x5e, 0x7a, 0x29, 0x26, 0x28, 0x68, 0x6c, 0x5e, 0x74, 0x29, 0x26, 0x30, 0x78, 0x38, 0x30,
+ 0x30, 0x30, 0x29, 0x3e, 0x3e, 0x31, 0x33, 0x29, 0x7c, 0x5c, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x28, 0x28, 0x21, 0x28, 0x74, 0x26, 0x30, 0x78, 0x66, 0x66, 0x66, 0x66,
+ 0x29, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x2f, 0x2a, 0x7c, 0x32, 0x2a, 0x2f, 0x3b, 0x5c, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x3d, 0x74, 0x3b, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d,
+ 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x5b, 0x4a, 0x43, 0x45, 0x5d, 0x20, 0x54, 0x68, 0x65, 0x20, 0x22,
+ 0x7c, 0x32, 0x22, 0x20, 0x73, 0x68, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x6e, 0x6f, 0x74, 0x20, 0x62,
+ 0x65, 0x20, 0x74, 0x68, 0x65, 0x72, 0x65, 0x2c, 0x20, 0x61, 0x74, 0x20, 0x6c, 0x65, 0x61, 0x73,
+ 0x74, 0x20, 0x61, 0x63, 0x63, 0x6f, 0x72, 0x64, 0x69, 0x6e, 0x67, 0x20, 0x74, 0x6f, 0x20, 0x6d,
+ 0x79, 0x20, 0x74, 0x65, 0x73, 0x74, 0x73, 0x20, 0x6f, 0x6e, 0x20, 0x0d, 0x0a, 0x20, 0x2a, 0x20,
+ 0x61, 0x20, 0x50, 0x43, 0x57, 0x31, 0x36, 0x2e, 0x20, 0x54, 0x68, 0x65, 0x20, 0x50, 0x43, 0x57,
+ 0x31, 0x36, 0x27, 0x73, 0x20, 0x41, 0x44, 0x43, 0x20, 0x61, 0x6c, 0x77, 0x61, 0x79, 0x73, 0x20,
+ 0x72, 0x65, 0x73, 0x65, 0x74, 0x73, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x62, 0x69, 0x74, 0x2e,
+ 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x0d, 0x0a, 0x0d, 0x0a, 0x23, 0x64, 0x65, 0x66, 0x69, 0x6e, 0x65,
+ 0x20, 0x6e, 0x65, 0x67, 0x20, 0x28, 0x61, 0x3d, 0x2d, 0x61, 0x2c, 0x5c, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x61, 0x26, 0x30,
+ 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x28,
+ 0x28, 0x28, 0x61, 0x26, 0x31, 0x35, 0x29, 0x3e, 0x30, 0x29, 0x3c, 0x3c, 0x34, 0x29, 0x7c, 0x28,
+ 0x28, 0x61, 0x3d, 0x3d, 0x31, 0x32, 0x38, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x7c, 0x32, 0x7c, 0x28,
+ 0x61, 0x3e, 0x30, 0x29, 0x29, 0x0d, 0x0a, 0x0d, 0x0a, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x6f, 0x70, 0x3d,
+ 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x70,
+ 0x63, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x61, 0x64, 0x6a, 0x75, 0x73, 0x74,
+ 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x77, 0x69, 0x74, 0x63, 0x68, 0x28, 0x6f,
+ 0x70, 0x29, 0x7b, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x30, 0x2c,
+ 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x28, 0x62, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x31, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28,
+ 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x62, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x32, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x73, 0x62, 0x63, 0x68, 0x6c, 0x28, 0x62, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x34, 0x33, 0x2c, 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b,
+ 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61,
+ 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x62, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x62, 0x2c,
+ 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x34, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6e, 0x65, 0x67, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x35, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x69, 0x66, 0x66, 0x31, 0x3d, 0x69, 0x66, 0x66, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x36, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6d, 0x3d, 0x30, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x34, 0x37, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x3d, 0x61,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x38, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x28, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x34, 0x39, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74,
+ 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x34, 0x61, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x63,
+ 0x68, 0x6c, 0x28, 0x62, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x62,
+ 0x2c, 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x62, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2b, 0x31, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x63, 0x2c,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6e, 0x65, 0x67, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x34, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65,
+ 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x34, 0x65, 0x2c, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6d, 0x3d, 0x31, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x34, 0x66, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x3d, 0x61, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x72, 0x61, 0x64, 0x6a, 0x75, 0x73, 0x74, 0x3d, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x30, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x69, 0x6e, 0x70, 0x75, 0x74, 0x28, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x35, 0x31, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74,
+ 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c,
+ 0x62, 0x2c, 0x63, 0x2c, 0x64, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x32,
+ 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x62, 0x63, 0x68, 0x6c, 0x28,
+ 0x64, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x33, 0x2c, 0x31, 0x36,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64,
+ 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65, 0x74, 0x63,
+ 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b,
+ 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x62,
+ 0x28, 0x61, 0x64, 0x64, 0x72, 0x2c, 0x64, 0x2c, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x6e, 0x65, 0x67, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x35,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x35, 0x36, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69,
+ 0x6d, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x37, 0x2c, 0x35, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x69, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66,
+ 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x28, 0x61, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c,
+ 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x28, 0x69, 0x66, 0x66, 0x32, 0x3c,
+ 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x38, 0x2c, 0x38, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x28, 0x65, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x39, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x35, 0x61, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x61, 0x64, 0x63, 0x68, 0x6c, 0x28, 0x64, 0x65, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x35, 0x62, 0x2c, 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e,
+ 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64,
+ 0x72, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x65,
+ 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x64, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2b,
+ 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x35, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6e, 0x65, 0x67, 0x3b, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x35, 0x65, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6d, 0x3d, 0x33, 0x3b, 0x0d, 0x0a, 0x65, 0x6e,
+ 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x28, 0x30, 0x78, 0x35, 0x66, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x3d,
+ 0x28, 0x72, 0x26, 0x30, 0x78, 0x38, 0x30, 0x29, 0x7c, 0x28, 0x72, 0x61, 0x64, 0x6a, 0x75, 0x73,
+ 0x74, 0x26, 0x30, 0x78, 0x37, 0x66, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x28, 0x61,
+ 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29,
+ 0x7c, 0x28, 0x69, 0x66, 0x66, 0x32, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x36, 0x30, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6e, 0x70,
+ 0x75, 0x74, 0x28, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x31, 0x2c,
+ 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b,
+ 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63,
+ 0x2c, 0x68, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x32, 0x2c, 0x31, 0x31,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x62, 0x63, 0x68, 0x6c, 0x28, 0x68, 0x6c, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x33, 0x2c, 0x31, 0x36, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73, 0x68,
+ 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32, 0x28,
+ 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x62, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x2c, 0x68, 0x2c, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a,
+ 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x6e, 0x65, 0x67, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x35, 0x2c, 0x34, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30,
+ 0x78, 0x36, 0x36, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6d, 0x3d, 0x30,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x37, 0x2c, 0x31, 0x34, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68,
+ 0x61, 0x72, 0x20, 0x74, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68,
+ 0x61, 0x72, 0x20, 0x75, 0x3d, 0x28, 0x61, 0x3c, 0x3c, 0x34, 0x29, 0x7c, 0x28, 0x74, 0x3e, 0x3e,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x61, 0x3d, 0x28, 0x61, 0x26, 0x30, 0x78,
+ 0x66, 0x30, 0x29, 0x7c, 0x28, 0x74, 0x26, 0x30, 0x78, 0x30, 0x66, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x68, 0x6c, 0x2c, 0x75, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x28, 0x61, 0x26,
+ 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c,
+ 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x38, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x28, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x36, 0x39, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74,
+ 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65,
+ 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x36, 0x61, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x63, 0x68,
+ 0x6c, 0x28, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x62, 0x2c,
+ 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70,
+ 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x6c, 0x3d, 0x66, 0x65, 0x74,
+ 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68,
+ 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x61, 0x64, 0x64, 0x72, 0x2b, 0x31, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x63, 0x2c, 0x34,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6e, 0x65, 0x67, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x36, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74,
+ 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36, 0x65, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x69, 0x6d, 0x3d, 0x31, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x36,
+ 0x66, 0x2c, 0x35, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x74, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68,
+ 0x28, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x75, 0x6e, 0x73, 0x69, 0x67,
+ 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x75, 0x3d, 0x28, 0x61, 0x26, 0x30, 0x78,
+ 0x30, 0x66, 0x29, 0x7c, 0x28, 0x74, 0x3c, 0x3c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x61, 0x3d, 0x28, 0x61, 0x26, 0x30, 0x78, 0x66, 0x30, 0x29, 0x7c, 0x28, 0x74, 0x3e, 0x3e,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x68,
+ 0x6c, 0x2c, 0x75, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26,
+ 0x31, 0x29, 0x7c, 0x28, 0x61, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x21, 0x61,
+ 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x61, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x30, 0x2c,
+ 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69,
+ 0x6e, 0x70, 0x75, 0x74, 0x28, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74,
+ 0x6f, 0x72, 0x65, 0x28, 0x68, 0x6c, 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x31, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72,
+ 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28,
+ 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x78, 0x29, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x32, 0x2c, 0x31,
+ 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x73, 0x62, 0x63, 0x68, 0x6c, 0x28, 0x73, 0x70,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x33, 0x2c, 0x31, 0x36, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73,
+ 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x32,
+ 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70, 0x63, 0x2b, 0x3d, 0x32,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x32, 0x28, 0x61, 0x64,
+ 0x64, 0x72, 0x2c, 0x73, 0x70, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x37, 0x34, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x6e,
+ 0x65, 0x67, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x35, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x37, 0x36, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69, 0x6d, 0x3d, 0x32, 0x3b,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x38, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x69, 0x6e, 0x70, 0x75, 0x74, 0x28, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x37, 0x39, 0x2c, 0x38, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74,
+ 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65,
+ 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x37, 0x61, 0x2c, 0x31, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x61, 0x64, 0x63, 0x68,
+ 0x6c, 0x28, 0x73, 0x70, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x62, 0x2c,
+ 0x31, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x61, 0x64, 0x64, 0x72, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x32, 0x28, 0x70, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x70,
+ 0x63, 0x2b, 0x3d, 0x32, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x70, 0x3d, 0x66, 0x65,
+ 0x74, 0x63, 0x68, 0x32, 0x28, 0x61, 0x64, 0x64, 0x72, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x63, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x6e, 0x65, 0x67, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x37, 0x64,
+ 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x37, 0x65, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x69,
+ 0x6d, 0x3d, 0x33, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x30, 0x2c, 0x31, 0x32,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64,
+ 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x64, 0x65,
+ 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x65, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26,
+ 0x30, 0x78, 0x63, 0x31, 0x29, 0x7c, 0x28, 0x78, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x7c, 0x28,
+ 0x28, 0x62, 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x31, 0x2c, 0x31, 0x32, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63,
+ 0x68, 0x61, 0x72, 0x20, 0x63, 0x61, 0x72, 0x72, 0x79, 0x3d, 0x63, 0x79, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d,
+ 0x28, 0x66, 0x26, 0x30, 0x78, 0x66, 0x61, 0x29, 0x7c, 0x63, 0x61, 0x72, 0x72, 0x79, 0x7c, 0x28,
+ 0x28, 0x62, 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x32, 0x2c, 0x31, 0x32, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x73,
+ 0x68, 0x6f, 0x72, 0x74, 0x20, 0x74, 0x3d, 0x69, 0x6e, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65,
+ 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f,
+ 0x72, 0x65, 0x28, 0x68, 0x6c, 0x2c, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x74,
+ 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x74, 0x3e, 0x3e, 0x38, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x2d,
+ 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x62, 0x26, 0x30, 0x78, 0x61,
+ 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c, 0x32,
+ 0x7c, 0x28, 0x28, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x62, 0x29, 0x5e, 0x63, 0x29, 0x26,
+ 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78,
+ 0x61, 0x33, 0x2c, 0x31, 0x32, 0x29, 0x3b, 0x20, 0x2f, 0x2a, 0x20, 0x49, 0x20, 0x63, 0x61, 0x6e,
+ 0x27, 0x74, 0x20, 0x64, 0x65, 0x74, 0x65, 0x72, 0x6d, 0x69, 0x6e, 0x65, 0x20, 0x74, 0x68, 0x65,
+ 0x20, 0x63, 0x6f, 0x72, 0x72, 0x65, 0x63, 0x74, 0x20, 0x66, 0x6c, 0x61, 0x67, 0x73, 0x20, 0x6f,
+ 0x75, 0x74, 0x63, 0x6f, 0x6d, 0x65, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x74, 0x68, 0x65, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x20, 0x4f, 0x55, 0x54, 0x20, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x75, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x2e, 0x20, 0x20, 0x53, 0x70, 0x65, 0x63,
+ 0x20, 0x73, 0x61, 0x79, 0x73, 0x20, 0x74, 0x68, 0x61, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63,
+ 0x61, 0x72, 0x72, 0x79, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6c, 0x61, 0x67, 0x20, 0x69, 0x73,
+ 0x20, 0x6c, 0x65, 0x66, 0x74, 0x20, 0x75, 0x6e, 0x63, 0x68, 0x61, 0x6e, 0x67, 0x65, 0x64, 0x20,
+ 0x61, 0x6e, 0x64, 0x20, 0x4e, 0x20, 0x69, 0x73, 0x20, 0x73, 0x65, 0x74, 0x20, 0x74, 0x6f, 0x20,
+ 0x31, 0x2c, 0x20, 0x62, 0x75, 0x74, 0x20, 0x74, 0x68, 0x61, 0x74, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x64, 0x6f, 0x65, 0x73, 0x6e, 0x27, 0x74, 0x20, 0x73, 0x65, 0x65, 0x6d, 0x20, 0x74, 0x6f, 0x20,
+ 0x62, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x61, 0x73, 0x65, 0x2e, 0x2e, 0x2e, 0x20, 0x2a,
+ 0x2f, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20,
+ 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d,
+ 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c,
+ 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x62, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d,
+ 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x30, 0x78, 0x31, 0x32, 0x7c, 0x28, 0x62, 0x26, 0x30, 0x78,
+ 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x38, 0x2c,
+ 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28,
+ 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28,
+ 0x64, 0x65, 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x65, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28,
+ 0x66, 0x26, 0x30, 0x78, 0x63, 0x31, 0x29, 0x7c, 0x28, 0x78, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29,
+ 0x7c, 0x28, 0x28, 0x62, 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x39, 0x2c, 0x31, 0x32,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64,
+ 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x63, 0x61, 0x72, 0x72, 0x79, 0x3d, 0x63, 0x79, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x70, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68,
+ 0x6c, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78, 0x66, 0x61, 0x29, 0x7c, 0x63, 0x61, 0x72, 0x72, 0x79,
+ 0x7c, 0x28, 0x28, 0x62, 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d,
+ 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x61, 0x61, 0x2c, 0x31, 0x32,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64,
+ 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x74, 0x3d, 0x69, 0x6e, 0x28, 0x74, 0x73, 0x74, 0x61,
+ 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73,
+ 0x74, 0x6f, 0x72, 0x65, 0x28, 0x68, 0x6c, 0x2c, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x74, 0x3e, 0x3e, 0x38, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x62, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x62, 0x26, 0x30,
+ 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x36, 0x29,
+ 0x7c, 0x32, 0x7c, 0x28, 0x28, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x62, 0x29, 0x5e, 0x63,
+ 0x5e, 0x34, 0x29, 0x26, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x61, 0x62, 0x2c, 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78,
+ 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x2d,
+ 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c,
+ 0x30, 0x78, 0x31, 0x32, 0x7c, 0x28, 0x62, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28,
+ 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f,
+ 0x2a, 0x20, 0x4e, 0x6f, 0x74, 0x65, 0x3a, 0x20, 0x74, 0x68, 0x65, 0x20, 0x5a, 0x38, 0x30, 0x20,
+ 0x69, 0x6d, 0x70, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x73, 0x20, 0x22, 0x2a, 0x52, 0x22, 0x20,
+ 0x61, 0x73, 0x20, 0x22, 0x2a, 0x22, 0x20, 0x66, 0x6f, 0x6c, 0x6c, 0x6f, 0x77, 0x65, 0x64, 0x20,
+ 0x62, 0x79, 0x20, 0x4a, 0x52, 0x20, 0x2d, 0x32, 0x2e, 0x20, 0x20, 0x4e, 0x6f, 0x20, 0x72, 0x65,
+ 0x61, 0x73, 0x6f, 0x6e, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x74, 0x6f, 0x20, 0x63, 0x68, 0x61, 0x6e,
+ 0x67, 0x65, 0x20, 0x74, 0x68, 0x69, 0x73, 0x2e, 0x2e, 0x2e, 0x20, 0x2a, 0x2f, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x30, 0x2c, 0x31, 0x32, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63,
+ 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x64, 0x65, 0x2c, 0x78,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x64, 0x65, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x63,
+ 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78,
+ 0x63, 0x31, 0x29, 0x7c, 0x28, 0x78, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62,
+ 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x69, 0x66, 0x28, 0x62, 0x63, 0x29, 0x70, 0x63, 0x2d, 0x3d, 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61,
+ 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65,
+ 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74,
+ 0x72, 0x28, 0x30, 0x78, 0x62, 0x31, 0x2c, 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x63,
+ 0x61, 0x72, 0x72, 0x79, 0x3d, 0x63, 0x79, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x63, 0x70,
+ 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x63,
+ 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x30, 0x78,
+ 0x66, 0x61, 0x29, 0x7c, 0x63, 0x61, 0x72, 0x72, 0x79, 0x7c, 0x28, 0x28, 0x62, 0x63, 0x21, 0x3d,
+ 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28,
+ 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x34, 0x29, 0x3d, 0x3d, 0x34, 0x29, 0x70, 0x63, 0x2d, 0x3d,
+ 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x32, 0x2c, 0x31, 0x32, 0x29,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20,
+ 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x74, 0x3d, 0x69, 0x6e, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74,
+ 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74,
+ 0x6f, 0x72, 0x65, 0x28, 0x68, 0x6c, 0x2c, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x74, 0x3e, 0x3e, 0x38, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62,
+ 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x62, 0x26, 0x30, 0x78,
+ 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x7c,
+ 0x32, 0x7c, 0x28, 0x28, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x62, 0x29, 0x5e, 0x63, 0x29,
+ 0x26, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x62, 0x29, 0x70,
+ 0x63, 0x2d, 0x3d, 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x33, 0x2c,
+ 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28,
+ 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65,
+ 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62,
+ 0x2c, 0x63, 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2b, 0x2b,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x30, 0x78, 0x31, 0x32, 0x7c, 0x28, 0x62,
+ 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c,
+ 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x62, 0x29, 0x70, 0x63,
+ 0x2d, 0x3d, 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b, 0x0d,
+ 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b,
+ 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x38, 0x2c, 0x31,
+ 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65,
+ 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68,
+ 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x64,
+ 0x65, 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x64, 0x65, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66,
+ 0x26, 0x30, 0x78, 0x63, 0x31, 0x29, 0x7c, 0x28, 0x78, 0x26, 0x30, 0x78, 0x32, 0x38, 0x29, 0x7c,
+ 0x28, 0x28, 0x62, 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x62, 0x63, 0x29, 0x70, 0x63, 0x2d, 0x3d, 0x32, 0x2c, 0x74,
+ 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d,
+ 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x39, 0x2c, 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61,
+ 0x72, 0x20, 0x63, 0x61, 0x72, 0x72, 0x79, 0x3d, 0x63, 0x79, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x63, 0x70, 0x61, 0x28, 0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x62, 0x63, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66,
+ 0x26, 0x30, 0x78, 0x66, 0x61, 0x29, 0x7c, 0x63, 0x61, 0x72, 0x72, 0x79, 0x7c, 0x28, 0x28, 0x62,
+ 0x63, 0x21, 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x69, 0x66, 0x28, 0x28, 0x66, 0x26, 0x30, 0x78, 0x34, 0x34, 0x29, 0x3d, 0x3d, 0x34, 0x29, 0x70,
+ 0x63, 0x2d, 0x3d, 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x35, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72,
+ 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x62, 0x61, 0x2c,
+ 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75, 0x6e, 0x73, 0x69, 0x67, 0x6e,
+ 0x65, 0x64, 0x20, 0x73, 0x68, 0x6f, 0x72, 0x74, 0x20, 0x74, 0x3d, 0x69, 0x6e, 0x28, 0x74, 0x73,
+ 0x74, 0x61, 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x28, 0x68, 0x6c, 0x2c, 0x74, 0x29, 0x3b, 0x0d, 0x0a, 0x20,
+ 0x20, 0x20, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x74, 0x3e, 0x3e, 0x38,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x62, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x62,
+ 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d, 0x3d, 0x30, 0x29, 0x3c, 0x3c,
+ 0x36, 0x29, 0x7c, 0x32, 0x7c, 0x28, 0x28, 0x70, 0x61, 0x72, 0x69, 0x74, 0x79, 0x28, 0x62, 0x29,
+ 0x5e, 0x63, 0x5e, 0x34, 0x29, 0x26, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69,
+ 0x66, 0x28, 0x62, 0x29, 0x70, 0x63, 0x2d, 0x3d, 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65,
+ 0x73, 0x2b, 0x3d, 0x35, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64,
+ 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28,
+ 0x30, 0x78, 0x62, 0x62, 0x2c, 0x31, 0x32, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x75,
+ 0x6e, 0x73, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x20, 0x63, 0x68, 0x61, 0x72, 0x20, 0x78, 0x3d, 0x66,
+ 0x65, 0x74, 0x63, 0x68, 0x28, 0x68, 0x6c, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x74,
+ 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x6f, 0x75, 0x74, 0x28, 0x74, 0x73, 0x74, 0x61,
+ 0x74, 0x65, 0x73, 0x2c, 0x62, 0x2c, 0x63, 0x2c, 0x78, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20,
+ 0x20, 0x68, 0x6c, 0x2d, 0x2d, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x62, 0x2d, 0x2d, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x66, 0x3d, 0x28, 0x66, 0x26, 0x31, 0x29, 0x7c, 0x30, 0x78,
+ 0x31, 0x32, 0x7c, 0x28, 0x62, 0x26, 0x30, 0x78, 0x61, 0x38, 0x29, 0x7c, 0x28, 0x28, 0x62, 0x3d,
+ 0x3d, 0x30, 0x29, 0x3c, 0x3c, 0x36, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66,
+ 0x28, 0x62, 0x29, 0x70, 0x63, 0x2d, 0x3d, 0x32, 0x2c, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73,
+ 0x2b, 0x3d, 0x35, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x58, 0x5a, 0x38, 0x30,
+ 0x20, 0x50, 0x73, 0x65, 0x75, 0x64, 0x6f, 0x2d, 0x6f, 0x70, 0x73, 0x20, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x62, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x6d, 0x75, 0x6c, 0x74, 0x69, 0x6c, 0x6f, 0x61, 0x64, 0x65, 0x72, 0x28, 0x68, 0x6c, 0x2c,
+ 0x61, 0x29, 0x3b, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a,
+ 0x0d, 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x63, 0x2c, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7b, 0x20, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x61, 0x6e, 0x73, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x70, 0x77, 0x61, 0x74, 0x63,
+ 0x68, 0x28, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x6e, 0x73, 0x3d,
+ 0x6c, 0x6f, 0x61, 0x64, 0x65, 0x72, 0x28, 0x70, 0x63, 0x2c, 0x69, 0x78, 0x2c, 0x64, 0x65, 0x2c,
+ 0x61, 0x2c, 0x63, 0x79, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66,
+ 0x28, 0x61, 0x6e, 0x73, 0x3e, 0x3d, 0x30, 0x29, 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x61, 0x6e, 0x73, 0x3d, 0x3d, 0x31, 0x29, 0x70, 0x63,
+ 0x3d, 0x30, 0x78, 0x30, 0x38, 0x30, 0x36, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x69, 0x66, 0x28, 0x61, 0x6e, 0x73, 0x3d, 0x3d,
+ 0x32, 0x29, 0x66, 0x26, 0x3d, 0x32, 0x35, 0x34, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x66, 0x7c, 0x3d, 0x31, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x78, 0x2b, 0x3d, 0x64, 0x65, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x64, 0x3d, 0x65, 0x3d, 0x30,
+ 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x61,
+ 0x6e, 0x73, 0x21, 0x3d, 0x31, 0x29, 0x72, 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74,
+ 0x77, 0x61, 0x74, 0x63, 0x68, 0x28, 0x31, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d,
+ 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x69, 0x6e,
+ 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x64, 0x2c, 0x34, 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x7b, 0x20, 0x20, 0x69, 0x6e, 0x74, 0x20, 0x61, 0x6e, 0x73, 0x3b, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x6f, 0x70, 0x77, 0x61, 0x74, 0x63, 0x68, 0x28, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x61, 0x6e, 0x73, 0x3d, 0x73, 0x61, 0x76, 0x65,
+ 0x72, 0x28, 0x70, 0x63, 0x2c, 0x69, 0x78, 0x2c, 0x64, 0x65, 0x2c, 0x61, 0x29, 0x3b, 0x0d, 0x0a,
+ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x66, 0x28, 0x61, 0x6e, 0x73, 0x3e, 0x30, 0x29, 0x70,
+ 0x63, 0x3d, 0x30, 0x78, 0x30, 0x38, 0x30, 0x36, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+ 0x20, 0x65, 0x6c, 0x73, 0x65, 0x20, 0x69, 0x66, 0x28, 0x61, 0x6e, 0x73, 0x3d, 0x3d, 0x30, 0x29,
+ 0x7b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x69, 0x78, 0x2b, 0x3d,
+ 0x64, 0x65, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x64, 0x3d,
+ 0x65, 0x3d, 0x30, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x72,
+ 0x65, 0x74, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x20, 0x20,
+ 0x20, 0x20, 0x20, 0x20, 0x73, 0x74, 0x61, 0x72, 0x74, 0x77, 0x61, 0x74, 0x63, 0x68, 0x28, 0x31,
+ 0x29, 0x3b, 0x0d, 0x0a, 0x20, 0x20, 0x20, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69, 0x6e, 0x73,
+ 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x2a, 0x2f, 0x0d, 0x0a, 0x0d, 0x0a, 0x2f, 0x2a, 0x20, 0x5a, 0x58,
+ 0x43, 0x43, 0x20, 0x70, 0x73, 0x65, 0x75, 0x64, 0x6f, 0x2d, 0x6f, 0x70, 0x20, 0x2a, 0x2f, 0x0d,
+ 0x0a, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x28, 0x30, 0x78, 0x66, 0x65, 0x2c, 0x20, 0x34, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x7b, 0x0d, 0x0a, 0x09, 0x2f, 0x2a, 0x20, 0x43, 0x72, 0x65, 0x61, 0x74, 0x65, 0x20,
+ 0x63, 0x6f, 0x70, 0x69, 0x65, 0x73, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72, 0x65,
+ 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x73, 0x20, 0x68, 0x65, 0x72, 0x65, 0x20, 0x73, 0x6f, 0x20,
+ 0x77, 0x65, 0x20, 0x63, 0x61, 0x6e, 0x20, 0x74, 0x61, 0x6b, 0x65, 0x20, 0x74, 0x68, 0x65, 0x69,
+ 0x72, 0x20, 0x61, 0x64, 0x64, 0x72, 0x65, 0x73, 0x73, 0x65, 0x73, 0x0d, 0x0a, 0x09, 0x20, 0x2a,
+ 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6e, 0x6f, 0x74, 0x20, 0x6c, 0x6f, 0x73, 0x65, 0x20, 0x72, 0x65,
+ 0x67, 0x69, 0x73, 0x74, 0x65, 0x72, 0x20, 0x6f, 0x70, 0x74, 0x69, 0x6d, 0x69, 0x73, 0x61, 0x74,
+ 0x69, 0x6f, 0x6e, 0x20, 0x69, 0x6e, 0x20, 0x74, 0x68, 0x65, 0x20, 0x72, 0x65, 0x73, 0x74, 0x20,
+ 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x43, 0x50, 0x55, 0x20, 0x63, 0x6f, 0x64, 0x65, 0x20,
+ 0x2a, 0x2f, 0x0d, 0x0a, 0x09, 0x62, 0x79, 0x74, 0x65, 0x20, 0x78, 0x61, 0x2c, 0x78, 0x62, 0x2c,
+ 0x78, 0x63, 0x2c, 0x78, 0x64, 0x2c, 0x78, 0x65, 0x2c, 0x78, 0x66, 0x2c, 0x78, 0x78, 0x68, 0x2c,
+ 0x78, 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x09, 0x77, 0x6f, 0x72, 0x64, 0x20, 0x78, 0x70, 0x2c, 0x78,
+ 0x78, 0x2c, 0x78, 0x79, 0x3b, 0x0d, 0x0a, 0x09, 0x0d, 0x0a, 0x09, 0x78, 0x61, 0x20, 0x3d, 0x20,
+ 0x61, 0x3b, 0x20, 0x78, 0x62, 0x20, 0x3d, 0x20, 0x62, 0x3b, 0x20, 0x78, 0x63, 0x20, 0x3d, 0x20,
+ 0x63, 0x3b, 0x20, 0x78, 0x64, 0x20, 0x3d, 0x20, 0x64, 0x3b, 0x20, 0x78, 0x65, 0x20, 0x3d, 0x20,
+ 0x65, 0x3b, 0x20, 0x78, 0x66, 0x20, 0x3d, 0x20, 0x66, 0x3b, 0x20, 0x78, 0x78, 0x68, 0x20, 0x3d,
+ 0x20, 0x68, 0x3b, 0x20, 0x78, 0x78, 0x6c, 0x20, 0x3d, 0x20, 0x6c, 0x3b, 0x0d, 0x0a, 0x09, 0x78,
+ 0x70, 0x20, 0x3d, 0x20, 0x70, 0x63, 0x3b, 0x20, 0x78, 0x78, 0x20, 0x3d, 0x20, 0x69, 0x78, 0x3b,
+ 0x20, 0x78, 0x79, 0x20, 0x3d, 0x20, 0x69, 0x79, 0x3b, 0x0d, 0x0a, 0x09, 0x7a, 0x38, 0x30, 0x5f,
+ 0x69, 0x6e, 0x73, 0x6e, 0x73, 0x20, 0x3d, 0x20, 0x69, 0x6e, 0x73, 0x6e, 0x73, 0x3b, 0x20, 0x7a,
+ 0x38, 0x30, 0x5f, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x20, 0x3d, 0x20, 0x74, 0x73, 0x74,
+ 0x61, 0x74, 0x65, 0x73, 0x3b, 0x0d, 0x0a, 0x09, 0x0d, 0x0a, 0x09, 0x65, 0x64, 0x5f, 0x66, 0x65,
+ 0x28, 0x26, 0x78, 0x61, 0x2c, 0x26, 0x78, 0x62, 0x2c, 0x26, 0x78, 0x63, 0x2c, 0x26, 0x78, 0x64,
+ 0x2c, 0x26, 0x78, 0x65, 0x2c, 0x26, 0x78, 0x66, 0x2c, 0x26, 0x78, 0x78, 0x68, 0x2c, 0x26, 0x78,
+ 0x78, 0x6c, 0x2c, 0x26, 0x78, 0x70, 0x2c, 0x26, 0x78, 0x78, 0x2c, 0x26, 0x78, 0x79, 0x29, 0x3b,
+ 0x0d, 0x0a, 0x09, 0x0d, 0x0a, 0x09, 0x61, 0x20, 0x3d, 0x20, 0x78, 0x61, 0x3b, 0x20, 0x62, 0x20,
+ 0x3d, 0x20, 0x78, 0x62, 0x3b, 0x20, 0x63, 0x20, 0x3d, 0x20, 0x78, 0x63, 0x3b, 0x20, 0x64, 0x20,
+ 0x3d, 0x20, 0x78, 0x64, 0x3b, 0x20, 0x65, 0x20, 0x3d, 0x20, 0x78, 0x65, 0x3b, 0x20, 0x66, 0x20,
+ 0x3d, 0x20, 0x78, 0x66, 0x3b, 0x20, 0x68, 0x20, 0x3d, 0x20, 0x78, 0x78, 0x68, 0x3b, 0x20, 0x6c,
+ 0x20, 0x3d, 0x20, 0x78, 0x78, 0x6c, 0x3b, 0x0d, 0x0a, 0x09, 0x70, 0x63, 0x20, 0x3d, 0x20, 0x78,
+ 0x70, 0x3b, 0x20, 0x69, 0x78, 0x20, 0x3d, 0x20, 0x78, 0x78, 0x3b, 0x20, 0x69, 0x79, 0x20, 0x3d,
+ 0x20, 0x78, 0x79, 0x3b, 0x09, 0x09, 0x09, 0x0d, 0x0a, 0x7d, 0x0d, 0x0a, 0x65, 0x6e, 0x64, 0x69,
+ 0x6e, 0x73, 0x74, 0x72, 0x3b, 0x0d, 0x0a, 0x0d, 0x0a, 0x64, 0x65, 0x66, 0x61, 0x75, 0x6c, 0x74,
+ 0x3a, 0x20, 0x74, 0x73, 0x74, 0x61, 0x74, 0x65, 0x73, 0x2b, 0x3d, 0x34, 0x3b, 0x0d, 0x0a, 0x0d,
+ 0x0a, 0x7d, 0x7d, 0x0d, 0x0a,
+0};
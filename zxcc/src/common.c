@@ -35,3 +35,14 @@ int cref_opt(char *arg, char *cmdbuf)
     }
     return 0;
 }
+
+void add_arg(char *cmdbuf, const char *prefix, const char *arg)
+{
+    size_t len = strlen(cmdbuf);
+
+    if (len + strlen(prefix) + strlen(arg) + 2 >= CMD_BUF_SIZE) {
+        fprintf(stderr, "Warning: Command buffer full, truncating arguments\n");
+        return;
+    }
+    sprintf(cmdbuf + len, " %s%s", prefix, arg);
+}
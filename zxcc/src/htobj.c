@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include "htobj.h"
+
+/* Hi-Tech object files and libraries (see htobj.h) */
+
+void *ht_realloc(void *p, size_t size)
+{
+    p = realloc(p, size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+unsigned ht_rd16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+unsigned long ht_rd32(const unsigned char *p)
+{
+    return ht_rd16(p) | ((unsigned long)ht_rd16(p + 2) << 16);
+}
+
+static void wr16(unsigned char *p, unsigned v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void wr32(unsigned char *p, unsigned long v)
+{
+    wr16(p, v & 0xFFFF);
+    wr16(p + 2, (v >> 16) & 0xFFFF);
+}
+
+/* Read a whole file into malloc'd memory */
+static unsigned char *read_file(const char *path, long *size)
+{
+    FILE *fp = fopen(path, "rb");
+    unsigned char *data = NULL;
+    long len = 0, max = 0;
+    size_t n;
+
+    if (!fp) return NULL;
+    do {
+        if (len == max) {
+            max = max ? max * 2 : 16384;
+            data = ht_realloc(data, max);
+        }
+        n = fread(data + len, 1, max - len, fp);
+        len += n;
+    } while (n);
+    if (ferror(fp)) {
+        fclose(fp);
+        free(data);
+        errno = EIO;
+        return NULL;
+    }
+    fclose(fp);
+    *size = len;
+    return data;
+}
+
+int ht_writefile(const char *path, const unsigned char *data, long size)
+{
+    FILE *fp = fopen(path, "wb");
+
+    if (!fp) return 0;
+    if (fwrite(data, 1, size, fp) != (size_t)size) {
+        fclose(fp);
+        return 0;
+    }
+    return !fclose(fp);
+}
+
+int ht_cmpfile(const char *path, const unsigned char *data, long size, long *pos)
+{
+    FILE *fp = fopen(path, "rb");
+    int c;
+
+    if (!fp) return -1;
+    *pos = 0;
+    while ((c = getc(fp)) != EOF && *pos < size && c == data[*pos])
+        ++*pos;
+    fclose(fp);
+    return c == EOF && *pos == size;
+}
+
+long ht_objlen(const unsigned char *data, long size)
+{
+    long pos = 0, len;
+
+    while (pos + 3 <= size) {
+        len = ht_rd16(data + pos);
+        if (pos + 3 + len > size) break;
+        pos += 3 + len;
+        if (data[pos - len - 1] == HT_END) return pos;
+    }
+    return -1;
+}
+
+/* Collect the global symbols from the SYM records of m->data */
+static int get_syms(ht_module *m)
+{
+    const unsigned char *rec, *p, *end, *psect, *name;
+    long pos = 0;
+
+    m->syms = NULL;
+    m->symlen = m->nsyms = 0;
+    while (pos < m->len) {
+        rec = m->data + pos;
+        end = rec + 3 + ht_rd16(rec);
+        pos += 3 + ht_rd16(rec);
+        if (rec[2] != HT_SYM) continue;
+
+        /* Value, flags, psect name and symbol name */
+        for (p = rec + 3; p < end; ) {
+            if (p + 6 >= end) return -1;
+            psect = p + 6;
+            if (!(name = memchr(psect, 0, end - psect))) return -1;
+            ++name;
+            if (name >= end || !memchr(name, 0, end - name)) return -1;
+            if (ht_rd16(p + 4) & HT_GLOBAL) {
+                size_t nl = strlen((const char *)name) + 1;
+
+                m->syms = ht_realloc(m->syms, m->symlen + 1 + nl);
+                m->syms[m->symlen] = ht_rd16(p + 4) & HT_SYMTYPE;
+                memcpy(m->syms + m->symlen + 1, name, nl);
+                m->symlen += 1 + nl;
+                ++m->nsyms;
+            }
+            p = name + strlen((const char *)name) + 1;
+        }
+    }
+    return 0;
+}
+
+int ht_readobj(const char *path, const char *name, ht_module *m)
+{
+    long size;
+
+    memset(m, 0, sizeof(*m));
+    if (!(m->data = read_file(path, &size))) return 0;
+    if ((m->len = ht_objlen(m->data, size)) < 0 || get_syms(m)) {
+        ht_freemod(m);
+        return -1;
+    }
+    m->name = strdup(name);
+    return 1;
+}
+
+int ht_readlib(const char *path, ht_library *lib)
+{
+    unsigned char *file, *dir, *end;
+    long size, pos;
+    unsigned n, nmods;
+    ht_module m;
+
+    memset(lib, 0, sizeof(*lib));
+    if (!(file = read_file(path, &size))) return 0;
+    if (size < 4 || 4 + ht_rd16(file) > size) {
+        free(file);
+        return -1;
+    }
+    dir = file + 4;
+    end = dir + ht_rd16(file);
+    nmods = ht_rd16(file + 2);
+    pos = end - file;
+    for (n = 0; n < nmods; n++) {
+        memset(&m, 0, sizeof(m));
+        if (dir + 12 >= end || !memchr(dir + 12, 0, end - dir - 12)) break;
+        m.symlen = ht_rd16(dir);
+        m.nsyms = ht_rd16(dir + 2);
+        m.len = ht_rd32(dir + 4);
+        m.name = strdup((char *)dir + 12);
+        dir += 13 + strlen(m.name);
+        if (dir + m.symlen > end || pos + m.len > size) {
+            free(m.name);
+            break;
+        }
+        m.syms = ht_realloc(NULL, m.symlen);
+        memcpy(m.syms, dir, m.symlen);
+        dir += m.symlen;
+        m.data = ht_realloc(NULL, m.len);
+        memcpy(m.data, file + pos, m.len);
+        pos += m.len;
+        ht_addmod(lib, &m);
+    }
+    free(file);
+    if (n < nmods) {
+        ht_freelib(lib);
+        return -1;
+    }
+    return 1;
+}
+
+unsigned char *ht_packlib(const ht_library *lib, long *size)
+{
+    unsigned char *file, *p;
+    long dirsize = 0, len = 0, padded;
+    int n;
+
+    for (n = 0; n < lib->nmods; n++) {
+        dirsize += 13 + strlen(lib->mods[n].name) + lib->mods[n].symlen;
+        len += lib->mods[n].len;
+    }
+
+    /* LIBR writes the directory and modules to a work file and copies it
+     * after the header a record at a time, ^Z padding and all, so the
+     * library ends with up to two records' worth of ^Z */
+    padded = 4 + (dirsize + len + 127) / 128 * 128;
+    padded = (padded + 127) / 128 * 128;
+    file = ht_realloc(NULL, padded);
+    memset(file, 0x1A, padded);
+
+    wr16(file, dirsize);
+    wr16(file + 2, lib->nmods);
+    p = file + 4;
+    for (n = 0; n < lib->nmods; n++) {
+        const ht_module *m = &lib->mods[n];
+
+        wr16(p, m->symlen);
+        wr16(p + 2, m->nsyms);
+        wr32(p + 4, m->len);
+        wr32(p + 8, 0);
+        strcpy((char *)p + 12, m->name);
+        p += 13 + strlen(m->name);
+        memcpy(p, m->syms, m->symlen);
+        p += m->symlen;
+    }
+    for (n = 0; n < lib->nmods; n++) {
+        memcpy(p, lib->mods[n].data, lib->mods[n].len);
+        p += lib->mods[n].len;
+    }
+    *size = padded;
+    return file;
+}
+
+int ht_findmod(const ht_library *lib, const char *name)
+{
+    int n;
+
+    for (n = 0; n < lib->nmods; n++)
+        if (!strcasecmp(lib->mods[n].name, name)) return n;
+    return -1;
+}
+
+void ht_addmod(ht_library *lib, ht_module *m)
+{
+    if (lib->nmods == lib->maxmods) {
+        lib->maxmods = lib->maxmods ? lib->maxmods * 2 : 64;
+        lib->mods = ht_realloc(lib->mods, lib->maxmods * sizeof(ht_module));
+    }
+    lib->mods[lib->nmods++] = *m;
+}
+
+void ht_delmod(ht_library *lib, int n)
+{
+    ht_freemod(&lib->mods[n]);
+    memmove(&lib->mods[n], &lib->mods[n + 1],
+            (lib->nmods - n - 1) * sizeof(ht_module));
+    --lib->nmods;
+}
+
+void ht_freemod(ht_module *m)
+{
+    free(m->name);
+    free(m->data);
+    free(m->syms);
+    memset(m, 0, sizeof(*m));
+}
+
+void ht_freelib(ht_library *lib)
+{
+    int n;
+
+    for (n = 0; n < lib->nmods; n++)
+        ht_freemod(&lib->mods[n]);
+    free(lib->mods);
+    memset(lib, 0, sizeof(*lib));
+}
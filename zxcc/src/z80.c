@@ -20,6 +20,9 @@
 
 #define parity(a) (partable[a])
 
+#ifdef ZXFOOT
+extern unsigned char partable[256];
+#else
 unsigned char partable[256] = {
     4, 0, 0, 4, 0, 4, 4, 0, 0, 4, 4, 0, 4, 0, 0, 4,
     0, 4, 4, 0, 4, 0, 0, 4, 4, 0, 0, 4, 0, 4, 4, 0,
@@ -37,6 +40,37 @@ unsigned char partable[256] = {
     0, 4, 4, 0, 4, 0, 0, 4, 4, 0, 0, 4, 0, 4, 4, 0,
     0, 4, 4, 0, 4, 0, 0, 4, 4, 0, 0, 4, 0, 4, 4, 0,
     4, 0, 0, 4, 0, 4, 4, 0, 0, 4, 4, 0, 4, 0, 0, 4};
+#endif
+
+#ifdef ZXFOOT
+#include "zxfoot.h"
+
+/* This is z80foot.c's build: note each access to memory as it is made.
+ * Reads from just past PC are taken to be of the instruction's own bytes. */
+static inline unsigned short footread(unsigned short ad, unsigned short pc)
+{
+   zxfoot_page[ad >> 8] |= (unsigned short)(ad - pc) < 4 ? FOOT_X : FOOT_R;
+   return ad;
+}
+
+static inline void footstore(unsigned short ad, unsigned char b)
+{
+   zxfoot_written[ad >> 3] |= 1 << (ad & 7);
+   zxfoot_page[ad >> 8] |= FOOT_W;
+   xlat_stored(ad);
+   RAM[ad] = b;
+}
+
+#undef fetch
+#define fetch(x) (RAM[footread((x), pc)])
+#undef store
+#define store(x,y) footstore(x,y)
+#undef store2b
+#define store2b(x,hi,lo) do { unsigned short foot_ad = (x); \
+                              footstore(foot_ad, lo); \
+                              footstore((foot_ad + 1) & 0xFFFF, hi); \
+                         } while(0)
+#endif
 
 #ifdef DEBUG
 static unsigned short breakpoint = 0;
@@ -55,15 +89,25 @@ unsigned short val;
 }
 #endif
 
+#include "z80regs.h"
+
+#ifdef ZXFOOT
+void mainloop_foot(word spc, word ssp)
+#else
+unsigned long z80_insns, z80_tstates;
+
 void mainloop(word spc, word ssp)
+#endif
 {
-   register unsigned char a, f, b, c, d, e, h, l;
-   unsigned char r, a1, f1, b1, c1, d1, e1, h1, l1, i, iff1, iff2, im;
+   register unsigned char a, f;
+   register regpair rbc, rde, rhl;
+   unsigned char r, a1, f1, i, iff1, iff2, im;
    register unsigned short pc;
-   unsigned short ix, iy, sp;
+   regpair rix, riy, rbc1, rde1, rhl1;
+   unsigned short sp;
    register unsigned long tstates;
    register unsigned int radjust;
-   register unsigned char ixoriy, new_ixoriy;
+   unsigned long insns;
    unsigned char intsample;
    register unsigned char op;
 #ifdef DEBUG
@@ -81,23 +125,26 @@ void mainloop(word spc, word ssp)
 
    fputs("Press F11 to log\n", stderr);
 #endif
-   a = f = b = c = d = e = h = l = a1 = f1 = b1 = c1 = d1 = e1 = h1 = l1 = i = r = iff1 = iff2 = im = 0;
-   ixoriy = new_ixoriy = 0;
+   a = f = a1 = f1 = i = r = iff1 = iff2 = im = 0;
+   bc = de = hl = bc1 = de1 = hl1 = 0;
    ix = iy = 0;
    pc = spc;
    sp = ssp;
    tstates = radjust = 0;
+   insns = 0;
+#ifdef ZXFOOT
+   zxfoot_sp = sp;
+   zxfoot_start();
+#endif
    while (1)
    {
-      ixoriy = new_ixoriy;
-      new_ixoriy = 0;
 #ifdef DEBUG
       next = (struct _next *)&fetch(pc);
       BC = bc;
       DE = de;
       HL = hl;
       AF = (a << 8) | f;
-      if (fp && !ixoriy)
+      if (fp)
       {
          log(fp, "pc", pc);
          if (sp != sp2)
@@ -129,12 +176,9 @@ void mainloop(word spc, word ssp)
          breaks++; /* some code at which to set a breakpoint */
       a = AF >> 8;
       f = AF;
-      h = HL >> 8;
-      l = HL;
-      d = DE >> 8;
-      e = DE;
-      b = BC >> 8;
-      c = BC;
+      hl = HL;
+      de = DE;
+      bc = BC;
 #endif
       /*
       {
@@ -149,13 +193,44 @@ void mainloop(word spc, word ssp)
                               id, pc, fetch(pc), a,f, bc, de, hl, ix, iy);
       }
       */
+#ifdef ZXFOOT
+      if (sp < zxfoot_sp)
+         zxfoot_sp = sp;
+#else
+      if (unlikely(xlat_map != NULL) && xlat_map[pc])
+      {
+         /* Run translated code until it comes back to something that
+          * is not translated (see zxxlat.h) */
+         struct xlat_cpu cpu;
+
+         cpu.a = a; cpu.f = f; cpu.a1 = a1; cpu.f1 = f1;
+         cpu.i = i; cpu.r = r; cpu.iff1 = iff1; cpu.iff2 = iff2; cpu.im = im;
+         cpu.BC = bc; cpu.DE = de; cpu.HL = hl; cpu.IX = ix; cpu.IY = iy;
+         cpu.BC1 = bc1; cpu.DE1 = de1; cpu.HL1 = hl1;
+         cpu.sp = sp; cpu.pc = pc;
+         cpu.tstates = tstates; cpu.radjust = radjust;
+         cpu.insns = insns;
+         xlat_run(&cpu);
+         a = cpu.a; f = cpu.f; a1 = cpu.a1; f1 = cpu.f1;
+         i = cpu.i; r = cpu.r; iff1 = cpu.iff1; iff2 = cpu.iff2; im = cpu.im;
+         bc = cpu.BC; de = cpu.DE; hl = cpu.HL; ix = cpu.IX; iy = cpu.IY;
+         bc1 = cpu.BC1; de1 = cpu.DE1; hl1 = cpu.HL1;
+         sp = cpu.sp; pc = cpu.pc;
+         tstates = cpu.tstates; radjust = cpu.radjust;
+         insns = cpu.insns;
+      }
+#endif
       intsample = 1;
       op = fetch(pc);
       pc++;
       radjust++;
+      insns++;
+   dispatch:
       switch (op)
       {
+#define IXORIY 0
 #include "z80ops.h"
+#undef IXORIY
       }
       /***
        * ZXCC doesn't do interrupts at all, so all this is commented out
@@ -291,5 +366,56 @@ void mainloop(word spc, word ssp)
                   }
                }
             }*/
+      continue;
+
+      /* DD and FD prefixes: the next opcode is looked up in the IX or
+       * IY table, and anything not found there runs as unprefixed. */
+   ixprefix:
+      op = fetch(pc);
+      pc++;
+      radjust++;
+      switch (op)
+      {
+#define IXORIY 1
+#include "z80ops.h"
+#undef IXORIY
+      default:
+         goto dispatch;
+      }
+      continue;
+
+   iyprefix:
+      op = fetch(pc);
+      pc++;
+      radjust++;
+      switch (op)
+      {
+#define IXORIY 2
+#include "z80ops.h"
+#undef IXORIY
+      default:
+         goto dispatch;
+      }
    }
 }
+
+/* The register names of z80regs.h are only for mainloop(); z80foot.c
+ * includes this file, and must not be left with them */
+#undef bc
+#undef b
+#undef c
+#undef de
+#undef d
+#undef e
+#undef hl
+#undef h
+#undef l
+#undef ix
+#undef ixh
+#undef ixl
+#undef iy
+#undef iyh
+#undef iyl
+#undef bc1
+#undef de1
+#undef hl1
@@ -0,0 +1,4 @@
+/* The Z80 core built again as mainloop_foot(), which notes the memory the
+ * program uses for ZXCC_FOOTPRINT (see zxfoot.h) */
+#define ZXFOOT
+#include "z80.c"
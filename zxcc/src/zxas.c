@@ -3,13 +3,18 @@
 #include <string.h>
 
 #include "common.h"
+#include "zxcache.h"
 
 int main(int argc, char **argv)
 {
     char cmdbuf[CMD_BUF_SIZE];
 
+    if (argc == 2 && zxcache_option(argv[1]))
+        return EXIT_SUCCESS;
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <file> [options]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <file> [options]\n"
+                        "       %s --cache-stats|--cache-zero|--cache-clear\n",
+                argv[0], argv[0]);
         return EXIT_FAILURE;
     }
 
@@ -31,5 +36,5 @@ int main(int argc, char **argv)
     }
 
     printf("Executing: %s\n", cmdbuf);
-    return system(cmdbuf);
+    return zxcache_run(cmdbuf);
 }
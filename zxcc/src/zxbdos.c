@@ -4,6 +4,8 @@
 #include "zxbdos.h"
 #include "zxcbdos.h"
 #include "zxdbdos.h"
+#include "zxhost.h"
+#include "zxrec.h"
 #include "cpmio.h"
 
 #ifdef __MSDOS__
@@ -136,6 +138,9 @@ void cpmbdos(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
 
 	/* Msg("BDOS with C=%02x DE=%04x\n", c, de);     */
 
+	if (zxrec_active)
+		zxrec_before(*c, *e, de, cpm_dma);
+
 	switch (*c)
 	{
 	case 0:
@@ -255,6 +260,8 @@ void cpmbdos(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
 
 	case 0x14: /* Sequential read using FCB */
 		setw(l, h, fcb_read(pde, pdma));
+		if (!*l)
+			xlat_read(cpm_dma, zxrec_reclen());
 		break;
 
 	case 0x15: /* Sequential write using FCB */
@@ -310,6 +317,8 @@ void cpmbdos(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
 
 	case 0x21: /* Read a record */
 		setw(l, h, fcb_randrd(pde, pdma));
+		if (!*l)
+			xlat_read(cpm_dma, zxrec_reclen());
 		break;
 
 	case 0x22: /* Write a record */
@@ -474,6 +483,15 @@ void cpmbdos(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
 		setw(l, h, fcb_parse((char *)RAM + peekw(de), (byte *)RAM + peekw(de + 2)));
 		break;
 
+	case ZXH_PROBE: /* zxcc host file calls */
+	case ZXH_OPEN:
+	case ZXH_CLOSE:
+	case ZXH_READ:
+	case ZXH_WRITE:
+	case ZXH_SIZE:
+		setw(l, h, zxhost_call(*c, de));
+		break;
+
 	default:
 #ifdef USE_CPMIO
 		cpm_scr_unit();
@@ -489,6 +507,14 @@ void cpmbdos(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
 		break;
 	}
 
+	if (zxrec_active)
+		zxrec_after(((*h) << 8) | *l);
+
+	/* Reads into the DMA area or a buffer at DE may land on translated
+	 * code */
+	xlat_written(cpm_dma, zxrec_reclen());
+	xlat_written(de, 256);
+
 	*a = *l;
 	*b = *h;
 }
@@ -1,40 +1,243 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 #include "common.h"
+#include "zxcache.h"
+
+/* zxc -jN a.c b.c ...: compile each .c file to .obj in its own zxcc, up to
+ * N at a time, then link the objects with one more. Each compile keeps its
+ * temporary files to itself (ZXCC_PRIVATE) and its output is shown in one
+ * piece, each line prefixed with the file it came from. Without -j, or
+ * with only one .c file, the whole command line goes to C.COM as before.
+ *
+ * Every zxcc command goes through the compile cache when ZXCC_CACHE is set
+ * (see zxcache.h). */
+
+typedef struct {
+    char *src;
+    char obj[CMD_BUF_SIZE];
+    pid_t pid;
+    FILE *out;      /* What the compiler printed */
+} job;
+
+static char *progname;
+
+static int is_csrc(const char *name)
+{
+    size_t len = strlen(name);
+
+    return len > 2 && name[len - 2] == '.' && tolower(name[len - 1]) == 'c';
+}
+
+static void append(char *buf, const char *s)
+{
+    strncat(buf, " ", CMD_BUF_SIZE - strlen(buf) - 1);
+    strncat(buf, s, CMD_BUF_SIZE - strlen(buf) - 1);
+}
+
+/* Turn a status from wait() into an exit code */
+static int exit_code(int status)
+{
+    if (status == -1) return EXIT_FAILURE;
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    return EXIT_FAILURE;
+}
+
+/* The file C.COM writes for a source: its base name, in lower case like
+ * every file the redirector creates, with ext (obj, or as for -S) for c */
+static void obj_name(const char *src, const char *ext, char *obj, size_t size)
+{
+    const char *base = strrchr(src, '/');
+    size_t n;
+
+    base = base ? base + 1 : src;
+    snprintf(obj, size, "%.*s%s", (int)(strlen(base) - 1), base, ext);
+    for (n = 0; obj[n]; n++)
+        obj[n] = tolower((unsigned char)obj[n]);
+}
+
+static int start_job(job *j, const char *opts)
+{
+    char cmd[CMD_BUF_SIZE];
+
+    snprintf(cmd, CMD_BUF_SIZE, "zxcc c --c%s %s", opts, j->src);
+    printf("Executing: %s\n", cmd);
+    fflush(stdout);
+
+    /* C.COM does not always set an error code, so a compile only counts
+     * if it leaves its output file behind */
+    remove(j->obj);
+    j->out = tmpfile();
+    if (!j->out) {
+        perror(progname);
+        return 0;
+    }
+    j->pid = fork();
+    if (j->pid < 0) {
+        perror(progname);
+        return 0;
+    }
+    if (!j->pid) {
+        dup2(fileno(j->out), STDOUT_FILENO);
+        dup2(fileno(j->out), STDERR_FILENO);
+        _exit(zxcache_run(cmd));
+    }
+    return 1;
+}
+
+static int finish_job(job *j, int status)
+{
+    char line[512];
+    int bol = 1, rv = exit_code(status);
+
+    if (!rv && access(j->obj, F_OK)) rv = EXIT_FAILURE;
+
+    rewind(j->out);
+    while (fgets(line, sizeof(line), j->out)) {
+        if (bol) printf("%s: ", j->src);
+        fputs(line, stdout);
+        bol = (strchr(line, '\n') != NULL);
+    }
+    if (!bol) putchar('\n');
+    fclose(j->out);
+    if (rv) printf("%s: %s: compile failed (exit code %d)\n", progname, j->src, rv);
+    fflush(stdout);
+    return rv;
+}
+
+/* Compile every job, at most maxjobs at once. Returns the number that
+ * failed. */
+static int run_jobs(job *jobs, int njobs, int maxjobs, const char *opts)
+{
+    int next = 0, running = 0, failed = 0, status, n;
+    pid_t pid;
+
+    while (next < njobs || running) {
+        if (next < njobs && running < maxjobs) {
+            if (!start_job(&jobs[next], opts)) {
+                failed += njobs - next;
+                next = njobs;
+                continue;
+            }
+            ++next;
+            ++running;
+            continue;
+        }
+        pid = wait(&status);
+        if (pid < 0) break;
+        for (n = 0; n < next && jobs[n].pid != pid; n++)
+            ;
+        if (n == next) continue;
+        --running;
+        if (finish_job(&jobs[n], status)) ++failed;
+    }
+    return failed;
+}
 
 int main(int argc, char **argv)
 {
-    char cmdbuf[CMD_BUF_SIZE];
-    
+    char cmdbuf[CMD_BUF_SIZE], opts[CMD_BUF_SIZE], objs[CMD_BUF_SIZE];
+    char *opt;
+    int maxjobs = 1, njobs = 0, link = 1, stop_as = 0, failed;
+    job *jobs;
+
+    progname = argv[0];
+    if (argc == 2 && zxcache_option(argv[1]))
+        return EXIT_SUCCESS;
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <file.c> [options]\n", argv[0]);
+        fprintf(stderr, "Usage: %s [-jN] <file.c> [options]\n"
+                        "       %s --cache-stats|--cache-zero|--cache-clear\n",
+                argv[0], argv[0]);
         return EXIT_FAILURE;
     }
 
-    snprintf(cmdbuf, CMD_BUF_SIZE, "zxcc c %s", argv[1]);
-    
-    for (int n = 2; n < argc; n++) {
+    jobs = calloc(argc, sizeof(job));
+    if (!jobs) {
+        fprintf(stderr, "%s: out of memory\n", progname);
+        return EXIT_FAILURE;
+    }
+
+    strcpy(cmdbuf, "zxcc c");
+    opts[0] = objs[0] = 0;
+    for (int n = 1; n < argc; n++) {
         if (!argv[n]) continue;
 
         if (argv[n][0] == '-') {
-            if (fname_opt(argv[n], 'e', cmdbuf)) continue;
-            if (fname_opt(argv[n], 'f', cmdbuf)) continue;
-            if (fname_opt(argv[n], 'i', cmdbuf)) continue;
-            if (fname_opt(argv[n], 'm', cmdbuf)) continue;
-            if (cref_opt(argv[n], cmdbuf)) continue;
-            
-            strncat(cmdbuf, " ", CMD_BUF_SIZE - strlen(cmdbuf) - 1);
-            strncat(cmdbuf, argv[n], CMD_BUF_SIZE - strlen(cmdbuf) - 1);
+            if (argv[n][1] == 'j' && isdigit((unsigned char)argv[n][2])) {
+                maxjobs = atoi(argv[n] + 2);
+                continue;
+            }
+            /* Compile only, or stop at assembly language: nothing to link.
+             * zxcc passes "--c" to C.COM as "-c". */
+            opt = argv[n] + (argv[n][1] == '-' ? 2 : 1);
+            if (opt[0] && !opt[1] && strchr("cCsS", opt[0])) link = 0;
+            if (opt[0] && !opt[1] && strchr("sS", opt[0])) stop_as = 1;
+
+            if (fname_opt(argv[n], 'e', cmdbuf)) {
+                fname_opt(argv[n], 'e', opts);
+                continue;
+            }
+            if (fname_opt(argv[n], 'f', cmdbuf)) {
+                fname_opt(argv[n], 'f', opts);
+                continue;
+            }
+            if (fname_opt(argv[n], 'i', cmdbuf)) {
+                fname_opt(argv[n], 'i', opts);
+                continue;
+            }
+            if (fname_opt(argv[n], 'm', cmdbuf)) {
+                fname_opt(argv[n], 'm', opts);
+                continue;
+            }
+            if (cref_opt(argv[n], cmdbuf)) {
+                cref_opt(argv[n], opts);
+                continue;
+            }
+
+            append(cmdbuf, argv[n]);
+            append(opts, argv[n]);
         }
         else {
-            strncat(cmdbuf, " ", CMD_BUF_SIZE - strlen(cmdbuf) - 1);
-            strncat(cmdbuf, argv[n], CMD_BUF_SIZE - strlen(cmdbuf) - 1);
+            append(cmdbuf, argv[n]);
+            if (is_csrc(argv[n])) {
+                jobs[njobs].src = argv[n];
+                obj_name(argv[n], "obj", jobs[njobs].obj, CMD_BUF_SIZE);
+                append(objs, jobs[njobs++].obj);
+            }
+            else
+                append(objs, argv[n]);
         }
     }
 
+    /* -S stops at assembly language, so what each compile leaves is a .as */
+    for (int n = 0; stop_as && n < njobs; n++)
+        obj_name(jobs[n].src, "as", jobs[n].obj, CMD_BUF_SIZE);
+
+    if (maxjobs < 2 || njobs < 2) {
+        printf("Executing: %s\n", cmdbuf);
+        return zxcache_run(cmdbuf);
+    }
+
+    /* Each compile runs in the same directory, so keep their $CTMPn.$$$
+     * and the like apart */
+    setenv("ZXCC_PRIVATE", "1", 0);
+
+    failed = run_jobs(jobs, njobs, maxjobs, opts);
+    free(jobs);
+    if (failed) {
+        fprintf(stderr, "%s: %d of %d files failed to compile\n",
+                progname, failed, njobs);
+        return EXIT_FAILURE;
+    }
+    if (!link) return EXIT_SUCCESS;
+
+    snprintf(cmdbuf, CMD_BUF_SIZE, "zxcc c%s%s", opts, objs);
     printf("Executing: %s\n", cmdbuf);
-    return system(cmdbuf);
+    fflush(stdout);
+    return zxcache_run(cmdbuf);
 }
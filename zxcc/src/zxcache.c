@@ -0,0 +1,681 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "zxcache.h"
+
+/* See zxcache.h. The cache directory holds:
+ *
+ *   stats          counters, one "name value" per line
+ *   tmp/           files being written, and ZXCC_TRACE logs
+ *   xx/key.m       manifest: "r name" for each file a command line read,
+ *                  and "n name" for each it looked for and did not find
+ *   xx/result.r    result: "o size name" for each output file and
+ *                  "s size" for what was printed, a "." line, then the
+ *                  data of each in turn
+ *
+ * where key hashes the command line, result hashes the key and the
+ * contents of every file the manifest says was read, and xx is the first
+ * two digits of the hash. A file the manifest says was not found must
+ * still not be there: a header put in an include directory searched
+ * before the one the compiler found it in would change what it read.
+ */
+
+#define CACHE_VERSION "zxcache 2"
+#define DEFAULT_LIMIT (64ULL << 20)
+
+typedef unsigned long long hash_t;
+
+enum { HITS, MISSES, STORES, EVICTIONS, SIZE, NSTATS };
+
+static const char *stat_names[NSTATS] = {
+    "hits", "misses", "stores", "evictions", "size"
+};
+
+/* A file named in a trace */
+typedef struct {
+    char *name;
+    int read;       /* Read before anything wrote it: an input */
+    int written;
+    int absent;     /* Looked for and not found before that */
+} tfile;
+
+/* A cache entry, when evicting */
+typedef struct {
+    char *name;
+    time_t mtime;
+    unsigned long long size;
+} centry;
+
+static char *cache_dir;
+
+/* 64-bit FNV-1a */
+static hash_t fnv(hash_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    while (len--) {
+        h ^= *p++;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static hash_t fnv_str(hash_t h, const char *s)
+{
+    return fnv(h, s, strlen(s) + 1);
+}
+
+/* Hash the contents of a file. Returns 0 if it can't be read. */
+static int hash_file(const char *name, hash_t *h)
+{
+    unsigned char buf[8192];
+    ssize_t n;
+    int fd = open(name, O_RDONLY);
+
+    if (fd < 0) return 0;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+        *h = fnv(*h, buf, n);
+    close(fd);
+    return n == 0;
+}
+
+/* Read a whole file into memory, with a 0 after it */
+static char *read_file(const char *name, size_t *len)
+{
+    struct stat st;
+    char *data;
+    int fd = open(name, O_RDONLY);
+
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) || !(data = malloc(st.st_size + 1))) {
+        close(fd);
+        return NULL;
+    }
+    if (read(fd, data, st.st_size) != st.st_size) {
+        free(data);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    data[st.st_size] = 0;
+    *len = st.st_size;
+    return data;
+}
+
+static int write_all(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+    ssize_t n;
+
+    while (len) {
+        n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        p += n;
+        len -= n;
+    }
+    return 1;
+}
+
+static void entry_name(char *buf, size_t size, hash_t h, const char *ext)
+{
+    snprintf(buf, size, "%s/%02x/%016llx%s", cache_dir,
+             (unsigned)(h >> 56), h, ext);
+}
+
+static unsigned long long cache_limit(void)
+{
+    char *s = getenv("ZXCC_CACHE_SIZE"), *end;
+    unsigned long long n;
+
+    if (!s) return DEFAULT_LIMIT;
+    n = strtoull(s, &end, 10);
+    switch (*end) {
+        case 'g': case 'G': n <<= 10; /* fall through */
+        case 'm': case 'M': n <<= 10; /* fall through */
+        case 'k': case 'K': n <<= 10; break;
+    }
+    return n ? n : DEFAULT_LIMIT;
+}
+
+/* Lock the stats file and read the counters from it. Returns the file
+ * descriptor to pass to stats_unlock(), or -1. */
+static int stats_lock(unsigned long long *st)
+{
+    char name[FILENAME_MAX], buf[512], *line;
+    struct flock fl;
+    ssize_t len;
+    size_t nl;
+    int fd, n;
+
+    memset(st, 0, NSTATS * sizeof(*st));
+    snprintf(name, sizeof(name), "%s/stats", cache_dir);
+    fd = open(name, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) return -1;
+
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &fl) < 0) {
+        if (errno != EINTR) {
+            close(fd);
+            return -1;
+        }
+    }
+    /* Read through fd: closing another descriptor for the file would
+     * release the lock */
+    len = read(fd, buf, sizeof(buf) - 1);
+    buf[len > 0 ? len : 0] = 0;
+    for (line = strtok(buf, "\n"); line; line = strtok(NULL, "\n")) {
+        for (n = 0; n < NSTATS; n++) {
+            nl = strlen(stat_names[n]);
+            if (!strncmp(line, stat_names[n], nl) && line[nl] == ' ')
+                st[n] = strtoull(line + nl + 1, NULL, 10);
+        }
+    }
+    return fd;
+}
+
+/* Write the counters back and release the lock */
+static void stats_unlock(int fd, unsigned long long *st)
+{
+    char buf[512];
+    size_t len = 0;
+    int n;
+
+    if (fd < 0) return;
+    for (n = 0; n < NSTATS; n++)
+        len += snprintf(buf + len, sizeof(buf) - len, "%s %llu\n",
+                        stat_names[n], st[n]);
+    if (lseek(fd, 0, SEEK_SET) == 0 && !ftruncate(fd, 0))
+        write_all(fd, buf, len);
+    close(fd);
+}
+
+static void stats_add(int which, unsigned long long n)
+{
+    unsigned long long st[NSTATS];
+    int fd = stats_lock(st);
+
+    st[which] += n;
+    stats_unlock(fd, st);
+}
+
+/* List the entries in the cache. Returns how many, or -1. */
+static int list_entries(centry **list)
+{
+    char name[FILENAME_MAX];
+    struct dirent *de, *fe;
+    struct stat st;
+    DIR *dir, *sub;
+    size_t len;
+    int n = 0, max = 0;
+    centry *l = NULL, *nl;
+
+    if (!(dir = opendir(cache_dir))) return -1;
+    while ((de = readdir(dir))) {
+        if (strlen(de->d_name) != 2 || de->d_name[0] == '.') continue;
+        snprintf(name, sizeof(name), "%s/%s", cache_dir, de->d_name);
+        if (!(sub = opendir(name))) continue;
+        while ((fe = readdir(sub))) {
+            len = strlen(fe->d_name);
+            if (len < 3 || fe->d_name[len - 2] != '.' ||
+                (fe->d_name[len - 1] != 'm' && fe->d_name[len - 1] != 'r'))
+                continue;
+            snprintf(name, sizeof(name), "%s/%s/%s", cache_dir,
+                     de->d_name, fe->d_name);
+            if (stat(name, &st)) continue;
+            if (n == max) {
+                max = max ? max * 2 : 256;
+                if (!(nl = realloc(l, max * sizeof(centry)))) break;
+                l = nl;
+            }
+            l[n].name = strdup(name);
+            l[n].mtime = st.st_mtime;
+            l[n].size = st.st_size;
+            ++n;
+        }
+        closedir(sub);
+    }
+    closedir(dir);
+    *list = l;
+    return n;
+}
+
+static int cmp_mtime(const void *a, const void *b)
+{
+    time_t ta = ((const centry *)a)->mtime, tb = ((const centry *)b)->mtime;
+
+    return ta < tb ? -1 : ta > tb;
+}
+
+/* With the stats locked: if the cache has grown past its limit, remove the
+ * least recently used entries, other than "keep", until it is back under
+ * 90% of it. The size is recounted from the files, so it can't drift. */
+static void evict(unsigned long long *st, int all, char **keep)
+{
+    unsigned long long limit = cache_limit(), total = 0;
+    centry *list;
+    int n, count = list_entries(&list);
+
+    if (count < 0) return;
+    for (n = 0; n < count; n++)
+        total += list[n].size;
+    if (all || total > limit) {
+        qsort(list, count, sizeof(centry), cmp_mtime);
+        for (n = 0; n < count && (all || total > limit / 10 * 9); n++) {
+            if (keep && (!strcmp(list[n].name, keep[0]) ||
+                         !strcmp(list[n].name, keep[1])))
+                continue;
+            if (unlink(list[n].name)) continue;
+            total -= list[n].size;
+            if (!all && list[n].name[strlen(list[n].name) - 1] == 'r')
+                ++st[EVICTIONS];
+        }
+    }
+    st[SIZE] = total;
+    for (n = 0; n < count; n++)
+        free(list[n].name);
+    free(list);
+}
+
+/* Create a file under tmp/ in the cache. Returns its descriptor. */
+static int temp_file(char *name, size_t size, const char *prefix)
+{
+    snprintf(name, size, "%s/tmp", cache_dir);
+    mkdir(name, 0777);
+    snprintf(name, size, "%s/tmp/%sXXXXXX", cache_dir, prefix);
+    return mkstemp(name);
+}
+
+/* Move a finished file from tmp/ to its place in the cache */
+static int install(char *tmpname, hash_t h, const char *ext)
+{
+    char name[FILENAME_MAX];
+
+    snprintf(name, sizeof(name), "%s/%02x", cache_dir, (unsigned)(h >> 56));
+    mkdir(name, 0777);
+    entry_name(name, sizeof(name), h, ext);
+    if (rename(tmpname, name)) {
+        unlink(tmpname);
+        return 0;
+    }
+    return 1;
+}
+
+/* The key for a command line: the things, besides its input files, that
+ * could change what it does */
+static hash_t command_key(char *cmd)
+{
+    static const char *env[] = {
+        "CPMDIR80", "BINDIR80", "LIBDIR80", "INCDIR80",
+        "ZXCC_IMAGE", "ZXCC_BIOS", NULL
+    };
+    hash_t h = fnv_str(14695981039346656037ULL, CACHE_VERSION);
+    char *s;
+    int n;
+
+    h = fnv_str(h, cmd);
+    for (n = 0; env[n]; n++) {
+        s = getenv(env[n]);
+        h = fnv_str(h, env[n]);
+        h = fnv_str(h, s ? s : "");
+    }
+    return h;
+}
+
+/* The result for a key, given the manifest of files it reads. Returns 0 if
+ * one of them can't be read, or one it did not find is there now, so there
+ * can be no result. */
+static int result_key(hash_t key, char *manifest, hash_t *result)
+{
+    char *name, *end;
+    hash_t h = fnv(14695981039346656037ULL, &key, sizeof(key));
+
+    for (name = manifest; *name; name = end + 1) {
+        end = strchr(name, '\n');
+        if (!end) break;
+        *end = 0;
+        h = fnv_str(h, name);
+        if (strlen(name) < 3 || name[1] != ' ' ||
+            (name[0] == 'n' ? !access(name + 2, F_OK) :
+                              !hash_file(name + 2, &h))) {
+            *end = '\n';
+            return 0;
+        }
+        *end = '\n';
+    }
+    *result = h;
+    return 1;
+}
+
+/* Put back the files of a cached result. Returns 0 if it is damaged. */
+static int restore(char *data, size_t len)
+{
+    char *line, *end, *name, *hdr_end, *body;
+    unsigned long long size, total = 0;
+    int fd, ok;
+
+    line = strchr(data, '\n');
+    if (!line) return 0;
+    /* Find where the data starts, and check it's all there */
+    hdr_end = strstr(line, "\n.\n");
+    if (!hdr_end) return 0;
+    body = hdr_end + 3;
+    for (line++; line <= hdr_end; line = end + 1) {
+        end = strchr(line, '\n');
+        total += strtoull(line + 2, NULL, 10);
+    }
+    if (total != len - (body - data)) return 0;
+
+    for (line = strchr(data, '\n') + 1; line <= hdr_end; line = end + 1) {
+        end = strchr(line, '\n');
+        *end = 0;
+        size = strtoull(line + 2, &name, 10);
+        if (line[0] == 'o') {
+            fd = open(name + 1, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+            ok = fd >= 0 && write_all(fd, body, size);
+            if (fd >= 0) close(fd);
+            if (!ok) {
+                *end = '\n';
+                return 0;
+            }
+        } else if (line[0] == 's') {
+            fwrite(body, 1, size, stdout);
+            fflush(stdout);
+        }
+        *end = '\n';
+        body += size;
+    }
+    return 1;
+}
+
+/* Look a command line up in the cache. Returns 1 if it was there and its
+ * results have been put back. */
+static int lookup(hash_t key)
+{
+    char mname[FILENAME_MAX], rname[FILENAME_MAX], *manifest, *result;
+    size_t mlen, rlen;
+    hash_t rkey;
+    int ok = 0;
+
+    entry_name(mname, sizeof(mname), key, ".m");
+    if (!(manifest = read_file(mname, &mlen))) return 0;
+    if (strncmp(manifest, CACHE_VERSION "\n", sizeof(CACHE_VERSION)) ||
+        !result_key(key, manifest + sizeof(CACHE_VERSION), &rkey)) {
+        free(manifest);
+        return 0;
+    }
+    free(manifest);
+
+    entry_name(rname, sizeof(rname), rkey, ".r");
+    if ((result = read_file(rname, &rlen))) {
+        ok = !strncmp(result, CACHE_VERSION "\n", sizeof(CACHE_VERSION)) &&
+             restore(result, rlen);
+        free(result);
+    }
+    if (ok) {
+        /* Keep it from being evicted for a while */
+        utime(mname, NULL);
+        utime(rname, NULL);
+    }
+    return ok;
+}
+
+static int find_tfile(tfile *files, int nfiles, const char *name)
+{
+    int n;
+
+    for (n = 0; n < nfiles; n++)
+        if (!strcmp(files[n].name, name)) return n;
+    return -1;
+}
+
+/* Store the results of a command line, given the trace of the files it
+ * used and what it printed */
+static void store(hash_t key, const char *trace, const char *out,
+                  size_t outlen)
+{
+    char tmpname[FILENAME_MAX], mname[FILENAME_MAX], rname[FILENAME_MAX];
+    char *data, *line, *end, *buf;
+    unsigned long long st[NSTATS], size = 0;
+    struct stat sb;
+    size_t len;
+    tfile *files;
+    hash_t rkey;
+    int fd, n, nfiles = 0, ok = 1;
+
+    if (!(data = read_file(trace, &len))) return;
+    files = calloc(len / 2 + 1, sizeof(tfile));
+    if (!files) {
+        free(data);
+        return;
+    }
+    for (line = data; *line; line = end + 1) {
+        if (!(end = strchr(line, '\n'))) break;
+        *end = 0;
+        if (strlen(line) < 3 || line[1] != ' ') continue;
+        n = find_tfile(files, nfiles, line + 2);
+        if (n < 0) {
+            n = nfiles++;
+            files[n].name = line + 2;
+        }
+        if (line[0] == 'r' && !files[n].written)
+            files[n].read = 1;
+        else if (line[0] == 'n' && !files[n].written && !files[n].read)
+            files[n].absent = 1;
+        else if (line[0] == 'w') {
+            /* A program that rewrites one of its own inputs (a library
+             * being updated, say) can't be replayed from its inputs */
+            if (files[n].read) ok = 0;
+            files[n].written = 1;
+        }
+    }
+
+    /* The manifest: everything it read, and what it looked for but did
+     * not find and did not go on to write itself */
+    buf = malloc(len + sizeof(CACHE_VERSION) + 1);
+    if (!buf) ok = 0;
+    else {
+        strcpy(buf, CACHE_VERSION "\n");
+        for (n = 0; n < nfiles; n++) {
+            if (files[n].read) {
+                if (stat(files[n].name, &sb)) ok = 0;
+                strcat(buf, "r ");
+            } else if (files[n].absent && !files[n].written)
+                strcat(buf, "n ");
+            else
+                continue;
+            strcat(buf, files[n].name);
+            strcat(buf, "\n");
+        }
+    }
+    if (!ok || !result_key(key, buf + sizeof(CACHE_VERSION), &rkey)) {
+        free(buf);
+        free(files);
+        free(data);
+        return;
+    }
+
+    /* The result: the files it wrote that are still there */
+    fd = temp_file(tmpname, sizeof(tmpname), "r");
+    if (fd >= 0) {
+        char hdr[FILENAME_MAX + 32];
+        char *blk;
+        size_t blen;
+
+        write_all(fd, CACHE_VERSION "\n", sizeof(CACHE_VERSION));
+        for (n = 0; n < nfiles; n++) {
+            if (!files[n].written || stat(files[n].name, &sb) ||
+                !S_ISREG(sb.st_mode) || strstr(files[n].name, "/.zxcc"))
+                files[n].written = 0;
+            else {
+                snprintf(hdr, sizeof(hdr), "o %llu %s\n",
+                         (unsigned long long)sb.st_size, files[n].name);
+                ok = ok && write_all(fd, hdr, strlen(hdr));
+            }
+        }
+        snprintf(hdr, sizeof(hdr), "s %llu\n.\n", (unsigned long long)outlen);
+        ok = ok && write_all(fd, hdr, strlen(hdr));
+        for (n = 0; ok && n < nfiles; n++) {
+            if (!files[n].written) continue;
+            blk = read_file(files[n].name, &blen);
+            ok = blk && write_all(fd, blk, blen);
+            free(blk);
+        }
+        ok = ok && write_all(fd, out, outlen);
+        size = lseek(fd, 0, SEEK_END);
+        close(fd);
+        if (!ok || !install(tmpname, rkey, ".r")) {
+            unlink(tmpname);
+            ok = 0;
+        }
+    }
+    else ok = 0;
+
+    if (ok) {
+        fd = temp_file(tmpname, sizeof(tmpname), "m");
+        if (fd >= 0 && write_all(fd, buf, strlen(buf))) {
+            close(fd);
+            if (install(tmpname, key, ".m")) size += strlen(buf);
+        } else if (fd >= 0) {
+            close(fd);
+            unlink(tmpname);
+        }
+        fd = stats_lock(st);
+        ++st[STORES];
+        st[SIZE] += size;
+        if (st[SIZE] > cache_limit()) {
+            char *keep[2] = { mname, rname };
+
+            entry_name(mname, sizeof(mname), key, ".m");
+            entry_name(rname, sizeof(rname), rkey, ".r");
+            evict(st, 0, keep);
+        }
+        stats_unlock(fd, st);
+    }
+    free(buf);
+    free(files);
+    free(data);
+}
+
+/* Run the command with ZXCC_TRACE set, passing on what it prints and
+ * keeping a copy. Returns its exit code. */
+static int run_traced(char *cmd, const char *trace, char **out, size_t *outlen)
+{
+    char buf[4096], *p;
+    size_t max = 0;
+    ssize_t n;
+    FILE *fp;
+    int status;
+
+    setenv("ZXCC_TRACE", trace, 1);
+    fflush(stdout);
+    fp = popen(cmd, "r");
+    unsetenv("ZXCC_TRACE");
+    if (!fp) return EXIT_FAILURE;
+
+    *out = NULL;
+    *outlen = 0;
+    while ((n = read(fileno(fp), buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        fwrite(buf, 1, n, stdout);
+        fflush(stdout);
+        if (*outlen + n > max) {
+            max = (*outlen + n) * 2;
+            if (!(p = realloc(*out, max))) continue;
+            *out = p;
+        }
+        memcpy(*out + *outlen, buf, n);
+        *outlen += n;
+    }
+    status = pclose(fp);
+    if (status == -1 || !WIFEXITED(status)) return EXIT_FAILURE;
+    return WEXITSTATUS(status);
+}
+
+static int run_plain(char *cmd)
+{
+    int rv = system(cmd);
+
+    if (rv == -1 || !WIFEXITED(rv)) return EXIT_FAILURE;
+    return WEXITSTATUS(rv);
+}
+
+int zxcache_run(char *cmd)
+{
+    char trace[FILENAME_MAX], *out = NULL;
+    size_t outlen;
+    hash_t key;
+    int fd, rv;
+
+    cache_dir = getenv("ZXCC_CACHE");
+    if (!cache_dir || !cache_dir[0] ||
+        (mkdir(cache_dir, 0777) && errno != EEXIST))
+        return run_plain(cmd);
+
+    key = command_key(cmd);
+    if (lookup(key)) {
+        stats_add(HITS, 1);
+        return EXIT_SUCCESS;
+    }
+    stats_add(MISSES, 1);
+
+    fd = temp_file(trace, sizeof(trace), "trace");
+    if (fd < 0) return run_plain(cmd);
+    close(fd);
+    rv = run_traced(cmd, trace, &out, &outlen);
+    /* Only a clean run is worth keeping */
+    if (!rv) store(key, trace, out ? out : "", outlen);
+    unlink(trace);
+    free(out);
+    return rv;
+}
+
+int zxcache_option(char *arg)
+{
+    unsigned long long st[NSTATS];
+    int fd, n;
+
+    if (strcmp(arg, "--cache-stats") && strcmp(arg, "--cache-zero") &&
+        strcmp(arg, "--cache-clear"))
+        return 0;
+
+    cache_dir = getenv("ZXCC_CACHE");
+    if (!cache_dir || !cache_dir[0]) {
+        fprintf(stderr, "ZXCC_CACHE is not set\n");
+        return 1;
+    }
+    fd = stats_lock(st);
+    if (!strcmp(arg, "--cache-clear"))
+        evict(st, 1, NULL);
+    else if (!strcmp(arg, "--cache-zero")) {
+        for (n = 0; n < SIZE; n++)
+            st[n] = 0;
+    } else {
+        printf("cache directory  %s\n", cache_dir);
+        for (n = 0; n < SIZE; n++)
+            printf("%-16s %llu\n", stat_names[n], st[n]);
+        if (st[HITS] + st[MISSES])
+            printf("%-16s %.1f%%\n", "hit rate",
+                   100.0 * st[HITS] / (st[HITS] + st[MISSES]));
+        printf("%-16s %llu kB of %llu kB\n", "size",
+               st[SIZE] >> 10, cache_limit() >> 10);
+    }
+    stats_unlock(fd, st);
+    return 1;
+}
@@ -1,4 +1,9 @@
 #include "zxcc.h"
+#include "zxbdos.h"
+#include "zxrec.h"
+#include "zxstats.h"
+#include "zxmem.h"
+#include "zxfoot.h"
 
 /* Global variables */
 
@@ -19,6 +24,7 @@ byte RAM[65536]; /* The Z80's address space */
 void load_comfile(void); /* Forward declaration */
 
 static int deinit_term, deinit_gsx;
+static cpm_word image_drives; /* Drives served from ZXCC_IMAGE */
 static void mkpath(char *fullpath, char *path, char *subdir);
 
 void dump_regs(FILE *fp, byte a, byte b, byte c, byte d, byte e, byte f,
@@ -92,6 +98,7 @@ void ed_fe(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
     switch (*a)
     {
     case 0xC0:
+        zxstats_bdos[*c]++;
         cpmbdos(a, b, c, d, e, f, h, l, pc, ix, iy);
         break;
 
@@ -105,6 +112,7 @@ void ed_fe(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
         zxcc_exit(1);
 
     case 0xC3:
+        zxstats_bios++;
         cpmbios(a, b, c, d, e, f, h, l, pc, ix, iy);
         break;
 
@@ -117,43 +125,27 @@ void ed_fe(byte *a, byte *b, byte *c, byte *d, byte *e, byte *f,
 }
 
 /*
- * load_bios() loads the minimal CP/M BIOS and BDOS.
+ * load_bios() loads the minimal CP/M BIOS and BDOS. The bios.bin built into
+ * zxcc is used unless ZXCC_BIOS names another one.
  *
  */
 
 void load_bios(void)
 {
-    char dir[CPM_MAXPATH + 1], fname[CPM_MAXPATH + 1];
-    char *q;
+    char *fname = getenv("ZXCC_BIOS");
     size_t bios_len;
+    FILE *fp;
 
-    FILE *fp = fopen("bios.bin", "rb");
-    if (!fp)
+    if (!fname)
     {
-        strcpy(fname, bindir80);
-        strcat(fname, "bios.bin");
-        fp = fopen(fname, "rb");
+        memcpy(RAM + 0xFE00, zxcc_bios, zxcc_bios_len < 512 ? zxcc_bios_len : 512);
+        Msg("Loaded %d bytes of built-in BIOS\n", zxcc_bios_len);
+        return;
     }
+    fp = fopen(fname, "rb");
     if (!fp)
     {
-#ifdef _MSC_VER
-        dir[0] = 0;                             /* use strncat in case the path is very long */
-        strncat(dir, _pgmptr, CPM_MAXPATH - 8); /* copy the executable path */
-#elif defined(__APPLE__)
-        uint32_t size = CPM_MAXPATH - 8;
-        _NSGetExecutablePath(dir, &size);
-#else
-        readlink("/proc/self/exe", dir, CPM_MAXPATH - 8); /* allow room for bios.bin */
-#endif
-        q = strrchr(dir, DIRSEPCH);
-        *++q = 0;
-        strcpy(fname, dir);
-        strcat(fname, "bios.bin");
-        fp = fopen(fname, "rb");
-    }
-    if (!fp)
-    {
-        fprintf(stderr, "%s: Cannot locate bios.bin\n", progname);
+        fprintf(stderr, "%s: Cannot locate %s\n", progname, fname);
         zxcc_term();
         zxcc_exit(1);
     }
@@ -161,7 +153,7 @@ void load_bios(void)
     if (bios_len < 1 || ferror(fp))
     {
         fclose(fp);
-        fprintf(stderr, "%s: Cannot load bios.bin\n", progname);
+        fprintf(stderr, "%s: Cannot load %s\n", progname, fname);
         zxcc_term();
         zxcc_exit(1);
     }
@@ -204,6 +196,28 @@ FILE *try_com(char *s)
     return NULL;
 }
 
+/*
+ * try_image() looks for file, file.com and file.cpm on drive A: of a packed
+ * image. Names in the image are not case sensitive.
+ *
+ */
+
+const byte *try_image(char *s, long *len)
+{
+    char fname[CPM_MAXPATH + 1];
+    const byte *p;
+
+    if (strlen(s) > 8 + 1 + 3)
+        return NULL;
+    if ((p = xlt_image_file(0, s, len)))
+        return p;
+    sprintf(fname, "%s.com", s);
+    if ((p = xlt_image_file(0, fname, len)))
+        return p;
+    sprintf(fname, "%s.cpm", s);
+    return xlt_image_file(0, fname, len);
+}
+
 /*
  * load_comfile() loads the COM file whose name was passed as a parameter.
  *
@@ -213,12 +227,28 @@ void load_comfile(void)
 {
     size_t com_len;
     char fname[CPM_MAXPATH + 1];
+    const byte *img;
+    long img_len;
     FILE *fp;
 
     /* Look in current directory first */
     strcpy(fname, argv[1]);
     fp = try_com(fname);
-    if (!fp)
+    if (!fp && (image_drives & 1))
+    {
+        /* A: is served from an image, so look there, not in bindir80 */
+        img = try_image(argv[1], &img_len);
+        if (img && img_len > 0)
+        {
+            if (img_len > 0xFD00)
+                img_len = 0xFD00;
+            memcpy(RAM + 0x0100, img, img_len);
+            Msg("Loaded %ld bytes of %s from image\n", img_len, argv[1]);
+            xlat_load(img_len);
+            return;
+        }
+    }
+    else if (!fp)
     {
         strcpy(fname, bindir80);
         strcat(fname, argv[1]);
@@ -240,24 +270,33 @@ void load_comfile(void)
         zxcc_exit(1);
     }
     fclose(fp);
+    xlt_trace_name('r', fname);
 
     Msg("Loaded %d bytes from %s\n", com_len, fname);
+    xlat_load(com_len);
 }
 
+/* The only ports are those of the expanded memory (see zxmem.h) and the
+ * T-state count (see zxstats.h) */
 unsigned int in(unsigned int tstates, unsigned char b, unsigned char c)
 {
-    (void)tstates;
+    static unsigned long latch;
+
     (void)b;
-    (void)c;
-    return 0;
+    if (c >= ZS_TSTATES && c < ZS_TSTATES + 4)
+    {
+        if (c == ZS_TSTATES)
+            latch = tstates;
+        return (latch >> 8 * (c - ZS_TSTATES)) & 0xFF;
+    }
+    return zxmem_in(c);
 }
 
 unsigned int out(unsigned int tstates, unsigned char b, unsigned char c, unsigned char value)
 {
     (void)tstates;
     (void)b;
-    (void)c;
-    (void)value;
+    zxmem_out(c, value);
     return 0;
 }
 
@@ -362,6 +401,93 @@ int main(int ac, char **av)
     xlt_map(1, libdir80);
     xlt_map(2, incdir80);
 
+    /* ZXCC_PRIVATE keeps temporary files on P: private to this process,
+     * so that several programs can run at once in one directory. It holds
+     * the patterns to treat as temporary, or 1 for the names Hi-Tech C
+     * and its tools use.
+     */
+    if ((tmpenv = getenv("ZXCC_PRIVATE")))
+    {
+        if (!strcmp(tmpenv, "1"))
+            tmpenv = PRIVATE_DEFAULT;
+        if (!xlt_private(tmpenv))
+        {
+            fprintf(stderr, "%s: Bad ZXCC_PRIVATE pattern in %s\n",
+                    progname, tmpenv);
+            zxcc_exit(1);
+        }
+        atexit(fcb_deinit);
+    }
+
+    /* ZXCC_TRACE=file lists the files the program reads and writes, for
+     * the zxc and zxas compile cache.
+     */
+    if ((tmpenv = getenv("ZXCC_TRACE")) && !xlt_trace(tmpenv))
+    {
+        fprintf(stderr, "%s: Cannot open %s\n", progname, tmpenv);
+        zxcc_exit(1);
+    }
+
+    /* ZXCC_STATS=file has a line appended to it at exit, giving the
+     * instructions run, the BDOS calls made and the time and memory
+     * taken (see zxstats.h).
+     */
+    if ((tmpenv = getenv("ZXCC_STATS")) && !zxstats_init(tmpenv))
+    {
+        fprintf(stderr, "%s: Cannot open %s\n", progname, tmpenv);
+        zxcc_exit(1);
+    }
+
+    /* ZXCC_XMEM sets the size of the expanded memory pool in kilobytes, or
+     * turns it off with 0 (see zxmem.h).
+     */
+    if ((tmpenv = getenv("ZXCC_XMEM")))
+    {
+        char *end;
+        unsigned long kbytes = strtoul(tmpenv, &end, 10);
+
+        if (end == tmpenv || *end)
+        {
+            fprintf(stderr, "%s: Bad ZXCC_XMEM size %s\n", progname, tmpenv);
+            zxcc_exit(1);
+        }
+        zxmem_init(kbytes);
+    }
+
+    /* ZXCC_FOOTPRINT=file has a report of the memory the program used
+     * appended to it when the program stops (see zxfoot.h).
+     */
+    if ((tmpenv = getenv("ZXCC_FOOTPRINT")) && !zxfoot_init(tmpenv))
+    {
+        fprintf(stderr, "%s: Cannot open %s\n", progname, tmpenv);
+        zxcc_exit(1);
+    }
+
+    /* ZXCC_XLAT names a directory to keep native translations of the COM
+     * files run in (see zxxlat.h). ZXCC_XLAT_CHECK runs the translations
+     * beside the interpreter instead, and stops at the first difference.
+     * Translations aren't used while the footprint is being taken.
+     */
+    if (!zxfoot_fp && (tmpenv = getenv("ZXCC_XLAT")) && *tmpenv &&
+        !xlat_init(tmpenv, getenv("ZXCC_XLAT_CHECK") != NULL))
+    {
+        fprintf(stderr, "%s: Cannot use %s for translations\n", progname,
+                tmpenv);
+        zxcc_exit(1);
+    }
+
+    /* ZXCC_IMAGE names a packed image (made by zxpack) to serve the fixed
+     * drives from, in place of the directories above. Its drives are
+     * read-only.
+     */
+    if ((tmpenv = getenv("ZXCC_IMAGE")) && !(image_drives = xlt_image(tmpenv)))
+    {
+        fprintf(stderr, "%s: Cannot load image %s\n", progname, tmpenv);
+        zxcc_exit(1);
+    }
+    if (image_drives)
+        xlt_trace_name('r', tmpenv);
+
     pCmd = (char *)RAM + 0x81;
 
     for (n = 2; n < argc; n++)
@@ -393,6 +519,12 @@ int main(int ac, char **av)
     str = parse_to_fcb(pCmd, 0x5C);
     parse_to_fcb(str, 0x6C);
 
+    /* ZXCC_RECORD=file logs the disc BDOS calls for zxreplay. This is
+     * done after the arguments have been parsed, so the log captures any
+     * drive mappings they created. */
+    if ((tmpenv = getenv("ZXCC_RECORD")))
+        zxrec_init(tmpenv);
+
     /* This statement is very useful when creating a client like zxc or zxas
 
         printf("Command tail is %s\n", pCmd);
@@ -438,7 +570,10 @@ int main(int ac, char **av)
 #endif
 
     /* Start the Z80 at 0xFF00, with stack at 0xFE00 */
-    mainloop(0xFF00, 0xFE00);
+    if (zxfoot_fp)
+        mainloop_foot(0xFF00, 0xFE00);
+    else
+        mainloop(0xFF00, 0xFE00);
 
     return zxcc_term();
 }
@@ -460,6 +595,8 @@ int zxcc_term(void)
 {
     word n;
 
+    zxfoot_report();
+
     n = RAM[0x81];            /* Get the return code. This is Hi-Tech C */
     n = (n << 8) | RAM[0x80]; /* specific and fails with other COM files */
 
@@ -0,0 +1,133 @@
+#include "zxcc.h"
+#include "zxfoot.h"
+
+/* Memory footprint of the program run. See zxfoot.h. */
+
+FILE *zxfoot_fp;
+unsigned char zxfoot_page[256];
+unsigned char zxfoot_written[8192];
+unsigned short zxfoot_sp;
+
+/* The memory as the program started, to find what the BDOS wrote */
+static byte *foot_start;
+
+#define TPA_TOP 0xFE00
+
+int zxfoot_init(char *fname)
+{
+	zxfoot_fp = fopen(fname, "a");
+	return zxfoot_fp != NULL;
+}
+
+void zxfoot_start(void)
+{
+	foot_start = malloc(sizeof(RAM));
+	if (foot_start)
+		memcpy(foot_start, RAM, sizeof(RAM));
+}
+
+static int written(unsigned ad)
+{
+	return zxfoot_written[ad >> 3] & (1 << (ad & 7));
+}
+
+/* Find the Hi-Tech C sbrk() in the program:
+ *
+ *	_sbrk:	pop bc / pop de / push de / push bc
+ *		ld hl,(memtop) / ld a,l / or h / jr nz,1f
+ *		ld hl,__Hbss / ld (memtop),hl
+ *
+ * and return the address of memtop, setting *base to __Hbss. Returns 0 if
+ * it isn't there. */
+static unsigned find_sbrk(unsigned *base)
+{
+	static const byte code[] = {0xC1, 0xD1, 0xD5, 0xC5, 0x2A, 0, 0, 0x7D,
+	                            0xB4, 0x20, 0, 0x21, 0, 0, 0x22};
+	unsigned ad, n, memtop;
+
+	for (ad = 0x100; ad + sizeof(code) + 2 <= TPA_TOP; ad++)
+	{
+		for (n = 0; n < sizeof(code); n++)
+			if (code[n] != RAM[ad + n] && code[n])
+				break;
+		if (n < sizeof(code))
+			continue;
+		memtop = RAM[ad + 5] | (RAM[ad + 6] << 8);
+		if ((unsigned)(RAM[ad + 15] | (RAM[ad + 16] << 8)) != memtop)
+			continue;
+		*base = RAM[ad + 12] | (RAM[ad + 13] << 8);
+		return memtop;
+	}
+	return 0;
+}
+
+static void put_bitmap(const char *name, byte bit)
+{
+	int page, n, digit;
+
+	fprintf(zxfoot_fp, "%-9s", name);
+	for (page = 0; page < 256; page += 4)
+	{
+		for (digit = n = 0; n < 4; n++)
+			digit = (digit << 1) | !!(zxfoot_page[page + n] & bit);
+		putc("0123456789abcdef"[digit], zxfoot_fp);
+	}
+	putc('\n', zxfoot_fp);
+}
+
+void zxfoot_report(void)
+{
+	unsigned ad, top, memtop, base, sp;
+	int page;
+
+	if (!zxfoot_fp)
+		return;
+
+	/* Take in what was written without being stored by the Z80 */
+	for (ad = 0; foot_start && ad < sizeof(RAM); ad++)
+		if (RAM[ad] != foot_start[ad])
+		{
+			zxfoot_written[ad >> 3] |= 1 << (ad & 7);
+			zxfoot_page[ad >> 8] |= FOOT_W;
+		}
+
+	sp = zxfoot_sp ? zxfoot_sp : 0x10000;
+	for (top = (sp < TPA_TOP ? sp : TPA_TOP) - 1; top >= 0x100; top--)
+		if (written(top))
+			break;
+
+	fprintf(zxfoot_fp, "program  %s\n", argc > 1 ? argv[1] : "");
+	fprintf(zxfoot_fp, "written  %04Xh\n", top);
+	memtop = find_sbrk(&base);
+	if (!memtop)
+		fprintf(zxfoot_fp, "heap     no sbrk() found\n");
+	else if (!(RAM[memtop] | RAM[memtop + 1]))
+		fprintf(zxfoot_fp, "heap     %04Xh, not used\n", base);
+	else
+		fprintf(zxfoot_fp, "heap     %04Xh-%04Xh\n", base,
+				((RAM[memtop] | (RAM[memtop + 1] << 8)) - 1) & 0xFFFF);
+	if (sp < TPA_TOP)
+		fprintf(zxfoot_fp, "stack    %04Xh, %u bytes below %04Xh\n", sp,
+				TPA_TOP - sp, TPA_TOP);
+	else
+		fprintf(zxfoot_fp, "stack    %04Xh, above %04Xh\n", sp, TPA_TOP);
+	ad = (sp < TPA_TOP ? sp : TPA_TOP) - top - 1;
+	fprintf(zxfoot_fp, "free     %u bytes, %u%% of the TPA\n", ad,
+			ad * 100 / (TPA_TOP - 0x100));
+	for (page = 0; page < 256; page++)
+	{
+		if (!(page % 64))
+			fprintf(zxfoot_fp, "%-9s%04X ", page ? "" : "pages", page << 8);
+		putc((zxfoot_page[page] & FOOT_X) ? 'x' :
+			 (zxfoot_page[page] & FOOT_W) ? 'w' :
+			 (zxfoot_page[page] & FOOT_R) ? 'r' : '.', zxfoot_fp);
+		if (page % 64 == 63)
+			putc('\n', zxfoot_fp);
+	}
+	put_bitmap("read", FOOT_R);
+	put_bitmap("write", FOOT_W);
+	put_bitmap("exec", FOOT_X);
+	putc('\n', zxfoot_fp);
+	fclose(zxfoot_fp);
+	zxfoot_fp = NULL;
+}
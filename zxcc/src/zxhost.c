@@ -0,0 +1,189 @@
+#include "zxcc.h"
+#include "zxbdos.h"
+#include "zxdbdos.h"
+#include "zxhost.h"
+
+/* Host file calls: BDOS functions D0h-D5h. See zxhost.h. */
+
+/* Host file handles plus one; 0 for a free slot */
+static int host_fd[ZXHOST_FILES];
+
+#define pbword(pb, off) (RAM[(pb) + (off)] | (RAM[(pb) + (off) + 1] << 8))
+
+/* Turn a name into an FCB the way the Hi-Tech C library's setfcb() does,
+ * so that both ways of opening a file find the same one. The user number
+ * is skipped. Returns 0 if there is no name. */
+static int host_fcb(char *name, byte *fcb)
+{
+	byte *cp;
+	byte c;
+
+	memset(fcb, 0, 36);
+	while (isspace((byte)*name))
+		++name;
+	if (name[0] && (name[1] == ':' || name[2] == ':' || name[3] == ':'))
+	{
+		for (; *name != ':'; ++name)
+			if (!isdigit((byte)*name) && !fcb[0])
+				fcb[0] = toupper((byte)*name) - 'A' + 1;
+		++name;
+	}
+	if (name[0] && name[1] == ':' && !fcb[0] && !isdigit((byte)name[0]))
+	{
+		fcb[0] = toupper((byte)name[0]) - 'A' + 1;
+		name += 2;
+	}
+	if (fcb[0] > 16)
+		return 0;
+
+	cp = fcb + 1;
+	while (*name != '.' && *name != '*' && (byte)*name > ' ' && cp < fcb + 9)
+		*cp++ = toupper((byte)*name++);
+	if (cp == fcb + 1)
+		return 0;
+	c = (*name == '*') ? '?' : ' ';
+	while (cp < fcb + 9)
+		*cp++ = c;
+	while (*name && *name++ != '.')
+		continue;
+	while ((byte)*name > ' ' && *name != '*' && cp < fcb + 12)
+		*cp++ = toupper((byte)*name++);
+	c = (*name == '*') ? '?' : ' ';
+	while (cp < fcb + 12)
+		*cp++ = c;
+	return 1;
+}
+
+static word host_open(word pb)
+{
+	static const int modes[] = {O_RDONLY, O_WRONLY, O_RDWR};
+	char name[CPM_MAXPATH];
+	word addr = pbword(pb, ZXH_PB_ADDR);
+	byte mode = RAM[pb + ZXH_PB_MODE];
+	byte fcb[36], odrv;
+	size_t len;
+	int n, fd, flags;
+
+	if ((mode & ~ZXH_CREAT) > ZXH_RDWR)
+		return 0xFFFF;
+	flags = modes[mode & ~ZXH_CREAT];
+	if (mode & ZXH_CREAT)
+		flags |= O_CREAT;
+
+	for (n = 0; n < ZXHOST_FILES && host_fd[n]; n++)
+		;
+	if (n == ZXHOST_FILES)
+		return 0xFFFF;
+
+	/* The name must not run past the top of memory */
+	len = 0x10000 - addr;
+	if (len > sizeof(name) - 1)
+		len = sizeof(name) - 1;
+	memcpy(name, RAM + addr, len);
+	name[len] = 0;
+	if (!host_fcb(name, fcb))
+		return 0xFFFF;
+
+	fd = fcb_host_open(fcb, flags);
+	/* Try the search drives, as an FCB open would */
+	if (fd < 0 && !(flags & O_CREAT) && fcbforce(fcb, &odrv))
+		fd = fcb_host_open(fcb, flags);
+	if (fd < 0)
+		return 0xFFFF;
+
+	host_fd[n] = fd + 1;
+	RAM[pb + ZXH_PB_HANDLE] = n;
+	wr32(pb + ZXH_PB_POS, (dword)lseek(fd, 0, SEEK_END));
+	return 0;
+}
+
+/* The host handle for the one in the parameter block, or -1 */
+static int host_handle(word pb)
+{
+	byte n = RAM[pb + ZXH_PB_HANDLE];
+
+	return (n < ZXHOST_FILES) ? host_fd[n] - 1 : -1;
+}
+
+static word host_close(word pb)
+{
+	int fd = host_handle(pb);
+
+	if (fd < 0)
+		return 0xFFFF;
+	host_fd[RAM[pb + ZXH_PB_HANDLE]] = 0;
+	return close(fd) ? 0xFFFF : 0;
+}
+
+static word host_transfer(byte func, word pb)
+{
+	int fd = host_handle(pb);
+	word addr = pbword(pb, ZXH_PB_ADDR);
+	unsigned count = pbword(pb, ZXH_PB_COUNT);
+	dword pos = rd32(pb + ZXH_PB_POS);
+	unsigned done = 0;
+	long n = 0;
+
+	if (fd < 0 || lseek(fd, (off_t)pos, SEEK_SET) < 0)
+		return 0xFFFF;
+	/* Transfers don't wrap round the top of memory */
+	if (count > 0x10000u - addr)
+		count = 0x10000 - addr;
+	while (done < count)
+	{
+		if (func == ZXH_READ)
+			n = read(fd, RAM + addr + done, count - done);
+		else
+			n = write(fd, RAM + addr + done, count - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		done += n;
+	}
+	if (func == ZXH_READ)
+	{
+		xlat_read(addr, done);
+		xlat_written(addr, done);
+	}
+	if (n < 0 && !done)
+		return 0xFFFF;
+
+	RAM[pb + ZXH_PB_COUNT] = done & 0xFF;
+	RAM[pb + ZXH_PB_COUNT + 1] = done >> 8;
+	wr32(pb + ZXH_PB_POS, pos + done);
+	return 0;
+}
+
+static word host_size(word pb)
+{
+	struct stat st;
+	int fd = host_handle(pb);
+
+	if (fd < 0 || fstat(fd, &st))
+		return 0xFFFF;
+	wr32(pb + ZXH_PB_POS, (dword)st.st_size);
+	return 0;
+}
+
+word zxhost_call(byte func, word de)
+{
+	if (func == ZXH_PROBE)
+		return ZXHOST_MAGIC;
+	if (de > 0x10000 - ZXH_PB_LEN)
+		return 0xFFFF;
+
+	switch (func)
+	{
+	case ZXH_OPEN:
+		return host_open(de);
+	case ZXH_CLOSE:
+		return host_close(de);
+	case ZXH_READ:
+	case ZXH_WRITE:
+		return host_transfer(func, de);
+	case ZXH_SIZE:
+		return host_size(de);
+	}
+	return 0xFFFF;
+}
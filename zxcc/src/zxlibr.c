@@ -1,39 +1,363 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <errno.h>
 
 #include "common.h"
+#include "htobj.h"
 
-int main(int argc, char **argv)
+/* zxlibr key library [module ...]: maintain a Hi-Tech library.
+ *
+ * The keys are LIBR's: r (replace or add modules), d (delete), x
+ * (extract), m (list modules) and s (list modules and their symbols).
+ * zxlibr reads and writes the library itself, so adding a hundred modules
+ * is one pass over the library rather than a hundred runs of LIBR.COM,
+ * and the library it writes is byte for byte the one LIBR.COM would.
+ *
+ * With --emulate the command is run by LIBR.COM under zxcc instead. With
+ * --verify it is done both ways and zxlibr reports any difference in the
+ * library, the extracted files or the listing.
+ *
+ * Modules are named after the file they came from, less any directory,
+ * as LIBR.COM names a module given to it as "-name.obj".
+ */
+
+static char *progname;
+static int verify;
+
+/* What the native run produced, for --verify to compare */
+static unsigned char *lib_image;
+static long lib_size;
+static FILE *listing;
+
+static int usage(void)
 {
-    char cmdbuf[CMD_BUF_SIZE];
+    fprintf(stderr, "Usage: %s [--emulate|--verify] r|d|x|m|s <library> [module ...]\n",
+            progname);
+    return EXIT_FAILURE;
+}
+
+static const char *base_name(const char *path)
+{
+    const char *p = strrchr(path, '/');
+
+    return p ? p + 1 : path;
+}
+
+static int bad_file(const char *name, int rv)
+{
+    if (rv)
+        fprintf(stderr, "%s: %s: not a Hi-Tech %s\n", progname, name,
+                strstr(name, ".lib") || strstr(name, ".LIB") ? "library" : "object file");
+    else
+        fprintf(stderr, "%s: %s: %s\n", progname, name, strerror(errno));
+    return EXIT_FAILURE;
+}
+
+static int no_module(const char *name)
+{
+    fprintf(stderr, "%s: no such module: %s\n", progname, name);
+    return EXIT_FAILURE;
+}
+
+/* A module as an object file: ^Z padded to a whole number of records */
+static unsigned char *obj_image(const ht_module *m, long *size)
+{
+    unsigned char *data;
+
+    *size = (m->len + 127) / 128 * 128;
+    data = ht_realloc(NULL, *size);
+    memset(data, 0x1A, *size);
+    memcpy(data, m->data, m->len);
+    return data;
+}
+
+static int write_file(const char *name, const unsigned char *data, long size)
+{
+    if (!ht_writefile(name, data, size)) {
+        fprintf(stderr, "%s: %s: %s\n", progname, name, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int defines_syms(const ht_module *m)
+{
+    const unsigned char *p = m->syms;
+    int n;
+
+    for (n = 0; n < m->nsyms; n++, p += strlen((const char *)p + 1) + 2)
+        if (p[0] != HT_EXTERN) return 1;
+    return 0;
+}
+
+static int replace(ht_library *lib, int nnames, char **names)
+{
+    ht_module m;
+    int n, i, rv;
+
+    if (!nnames) {
+        fprintf(stderr, "%s: replace what ?\n", progname);
+        return EXIT_FAILURE;
+    }
+    for (n = 0; n < nnames; n++) {
+        rv = ht_readobj(names[n], base_name(names[n]), &m);
+        if (rv <= 0) return bad_file(names[n], rv);
+        if (!defines_syms(&m))
+            fprintf(stderr, "module %s defines no symbols (warning)\n", m.name);
+
+        if ((i = ht_findmod(lib, m.name)) < 0) {
+            ht_addmod(lib, &m);
+            continue;
+        }
+        /* LIBR keeps the name the module was first added under */
+        free(m.name);
+        m.name = lib->mods[i].name;
+        lib->mods[i].name = NULL;
+        ht_freemod(&lib->mods[i]);
+        lib->mods[i] = m;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int delete(ht_library *lib, int nnames, char **names)
+{
+    int n, i;
+
+    if (!nnames) {
+        fprintf(stderr, "%s: delete what ?\n", progname);
+        return EXIT_FAILURE;
+    }
+    for (n = 0; n < nnames; n++) {
+        if ((i = ht_findmod(lib, base_name(names[n]))) < 0)
+            return no_module(names[n]);
+        ht_delmod(lib, i);
+    }
+    return EXIT_SUCCESS;
+}
+
+static int extract(const ht_module *m)
+{
+    unsigned char *data;
+    long size;
+    int rv;
+
+    if (verify) return EXIT_SUCCESS;
+    data = obj_image(m, &size);
+    rv = write_file(m->name, data, size);
+    free(data);
+    return rv;
+}
 
-    snprintf(cmdbuf, CMD_BUF_SIZE, "zxcc libr.com ");
+/* One module of a listing, laid out as LIBR.COM does it: four symbols to
+ * a line. A module with no symbols leaves the line unfinished, which
+ * LIBR.COM does too. */
+static void list(FILE *fp, const ht_module *m, int syms)
+{
+    const unsigned char *p = m->syms;
+    int n;
 
-    for (int n = 1; n < argc; n++) {
-        if (!argv[n]) continue;
+    if (!syms) {
+        fprintf(fp, "%-15s\n", m->name);
+        return;
+    }
+    fprintf(fp, "%-16s", m->name);
+    for (n = 0; n < m->nsyms; n++) {
+        if (n && !(n % 4)) fputs("\t\t", fp);
+        fprintf(fp, n % 4 == 3 ? "%c %-12s\n" : "%c %-14s",
+                p[0] == HT_EXTERN ? 'U' : 'D', p + 1);
+        p += strlen((const char *)p + 1) + 2;
+    }
+    if (n % 4) putc('\n', fp);
+}
+
+static int selected(const ht_module *m, int nnames, char **names)
+{
+    int n;
+
+    for (n = 0; n < nnames; n++)
+        if (!strcasecmp(m->name, base_name(names[n]))) return 1;
+    return !nnames;
+}
 
-        size_t len = strlen(cmdbuf);
-        size_t remaining = CMD_BUF_SIZE - len - 1;
+/* Do the key's work on the library without LIBR.COM */
+static int native(int key, char *libname, int nnames, char **names)
+{
+    ht_library lib;
+    int rv, n, i;
 
-        char segment[256];
+    rv = ht_readlib(libname, &lib);
+    if (rv <= 0 && !(key == 'r' && !rv && errno == ENOENT))
+        return bad_file(libname, rv);
 
-        if (n == 1) {
-            snprintf(segment, sizeof(segment), "-%s", argv[n]);
-        } else {
-            snprintf(segment, sizeof(segment), "%s", argv[n]);
+    switch (key) {
+    case 'r':
+    case 'd':
+        rv = (key == 'r' ? replace : delete)(&lib, nnames, names);
+        if (rv == EXIT_SUCCESS) {
+            lib_image = ht_packlib(&lib, &lib_size);
+            if (!verify) rv = write_file(libname, lib_image, lib_size);
         }
+        break;
 
-        size_t seg_len = strlen(segment);
-        if (seg_len + 1 > remaining) {
-            fprintf(stderr, "Warning: Command buffer full, truncating arguments\n");
-            break;
+    case 'x':
+    case 'm':
+    case 's':
+        /* Named modules are taken in library order, as LIBR.COM does */
+        if (!listing) listing = stdout;
+        rv = EXIT_SUCCESS;
+        for (i = 0; i < lib.nmods && rv == EXIT_SUCCESS; i++) {
+            if (!selected(&lib.mods[i], nnames, names))
+                continue;
+            if (key == 'x')
+                rv = extract(&lib.mods[i]);
+            else
+                list(listing, &lib.mods[i], key == 's');
         }
+        for (n = 0; n < nnames && rv == EXIT_SUCCESS; n++)
+            if (ht_findmod(&lib, base_name(names[n])) < 0)
+                rv = no_module(names[n]);
+        break;
 
-        strncat(cmdbuf, segment, remaining);
-        strncat(cmdbuf, " ", CMD_BUF_SIZE - strlen(cmdbuf) - 1);
+    default:
+        rv = usage();
+    }
+    ht_freelib(&lib);
+    return rv;
+}
+
+/* The zxcc command line to run the key with LIBR.COM. Modules in the
+ * current directory are passed as "-name.obj" so that LIBR names them as
+ * zxlibr does, rather than after their CP/M file names ("p:name.obj"). */
+static void emulate_cmd(char *cmdbuf, int key, char *libname, int nnames, char **names)
+{
+    char keyarg[3] = { '-', key, 0 };
+    int n;
+
+    snprintf(cmdbuf, CMD_BUF_SIZE, "zxcc libr.com");
+    add_arg(cmdbuf, "", keyarg);
+    add_arg(cmdbuf, "", libname);
+    for (n = 0; n < nnames; n++)
+        add_arg(cmdbuf, strchr(names[n], '/') ? "" : "-", names[n]);
+}
+
+/* Compare what LIBR.COM left in a file with what zxlibr would have written */
+static int compare(const char *name, const unsigned char *data, long size)
+{
+    long pos;
+    int same = ht_cmpfile(name, data, size, &pos);
+
+    if (same < 0)
+        fprintf(stderr, "%s: %s: %s\n", progname, name, strerror(errno));
+    else if (!same)
+        fprintf(stderr, "%s: %s: LIBR.COM's differs from zxlibr's at offset %ld\n",
+                progname, name, pos);
+    return same > 0;
+}
+
+/* Run the key both ways and compare the results */
+static int verify_key(int key, char *libname, int nnames, char **names)
+{
+    char cmdbuf[CMD_BUF_SIZE];
+    ht_library lib;
+    unsigned char *data;
+    FILE *emu;
+    long size;
+    int rv, same = 1, i, c, d;
+
+    emulate_cmd(cmdbuf, key, libname, nnames, names);
+    verify = 1;
+    if (key == 'm' || key == 's') listing = tmpfile();
+    if ((rv = native(key, libname, nnames, names)) != EXIT_SUCCESS) {
+        fprintf(stderr, "%s: not verified, zxlibr failed\n", progname);
+        return rv;
     }
 
     printf("Executing: %s\n", cmdbuf);
-    return system(cmdbuf);
+    fflush(stdout);
+    if (!listing) {
+        if ((rv = system(cmdbuf)) != 0) {
+            fprintf(stderr, "%s: LIBR.COM failed\n", progname);
+            return EXIT_FAILURE;
+        }
+    } else {
+        /* LIBR.COM's listing has CR LF line ends, and zxcc ends with a
+         * newline of its own */
+        if (!(emu = popen(cmdbuf, "r"))) {
+            perror(progname);
+            return EXIT_FAILURE;
+        }
+        rewind(listing);
+        c = getc(emu);
+        while ((d = getc(listing)) != EOF) {
+            while (c == '\r') c = getc(emu);
+            if (c != d) break;
+            c = getc(emu);
+        }
+        if (c == '\n') c = getc(emu);
+        same = (d == EOF && c == EOF);
+        while (c != EOF) c = getc(emu);
+        pclose(emu);
+        fclose(listing);
+        if (!same)
+            fprintf(stderr, "%s: LIBR.COM's listing differs from zxlibr's\n", progname);
+    }
+
+    switch (key) {
+    case 'r':
+    case 'd':
+        same = compare(libname, lib_image, lib_size);
+        break;
+    case 'x':
+        if (ht_readlib(libname, &lib) <= 0) return bad_file(libname, 0);
+        for (i = 0; i < lib.nmods; i++) {
+            if (!selected(&lib.mods[i], nnames, names))
+                continue;
+            data = obj_image(&lib.mods[i], &size);
+            same &= compare(lib.mods[i].name, data, size);
+            free(data);
+        }
+        ht_freelib(&lib);
+        break;
+    }
+    free(lib_image);
+    if (!same) return EXIT_FAILURE;
+    fprintf(stderr, "%s: %s %s: same as LIBR.COM\n", progname,
+            key == 'r' ? "replace in" : key == 'd' ? "delete from" :
+            key == 'x' ? "extract from" : "list", libname);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    char cmdbuf[CMD_BUF_SIZE];
+    int emulate = 0, key, n = 1;
+
+    progname = argv[0];
+    for (; n < argc && !strncmp(argv[n], "--", 2); n++) {
+        if (!strcmp(argv[n], "--emulate"))
+            emulate = 1;
+        else if (!strcmp(argv[n], "--verify"))
+            verify = 1;
+        else
+            return usage();
+    }
+    if (argc - n < 2) return usage();
+
+    /* The key as LIBR takes it: "r", "-r" or "R" */
+    key = argv[n][argv[n][0] == '-'];
+    if (key >= 'A' && key <= 'Z') key += 'a' - 'A';
+    if (!key || !strchr("rdxms", key) || argv[n][1 + (argv[n][0] == '-')])
+        return usage();
+
+    if (verify)
+        return verify_key(key, argv[n + 1], argc - n - 2, argv + n + 2);
+    if (emulate) {
+        emulate_cmd(cmdbuf, key, argv[n + 1], argc - n - 2, argv + n + 2);
+        printf("Executing: %s\n", cmdbuf);
+        fflush(stdout);
+        return system(cmdbuf) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    return native(key, argv[n + 1], argc - n - 2, argv + n + 2);
 }
@@ -1,36 +1,832 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
 
+#include <cpmredir.h>
+
+#include "cpmdirs.h"
 #include "common.h"
+#include "htobj.h"
 
-int main(int argc, char **argv)
+/* zxlink [--emulate|--verify] [option ...] file ...: link Hi-Tech object
+ * files and libraries.
+ *
+ * The options are LINK's, written "-x" or, as zxcc wants them, "--x". A
+ * link that makes a CP/M program at a fixed address (-C and -O, with the
+ * psects placed by -P) is done by zxlink itself: the objects are read once
+ * rather than through LINK.COM's FCB reads, and the program, the map (-M)
+ * and the symbol file (-D) come out byte for byte as LINK.COM writes them.
+ * That covers the links C.COM makes, those of its -Y overlays included.
+ *
+ * Anything else is handed to LINK.COM under zxcc: object file output (-R,
+ * -L, or no -C), the options zxlink does not know (-I, -N, -S, -U, -W),
+ * load addresses in -P, undefined or multiply defined symbols, local or
+ * overlaid psects, and programs with holes in them, whose filling depends
+ * on how LINK.COM's output happened to be buffered. With --emulate every
+ * link goes to LINK.COM; with --verify it is done both ways and zxlink
+ * reports any difference in the files written.
+ */
+
+#define MAX_PSECTS  32
+#define HASH_SIZE   997     /* LINK.COM's symbol table */
+
+typedef struct {
+    char *name;
+    long addr, size;
+    int placed;
+} psect;
+
+typedef struct {
+    char *name;
+    int defined;
+    int psect;      /* -1 if absolute */
+    int mod;        /* Defined by this module, or -1 by the linker */
+    unsigned long value;    /* Offset into the module's part of the psect, then address */
+    int is_psect;   /* A psect's name, which LINK.COM keeps in the table too */
+} symbol;
+
+typedef struct {
+    const char *name;   /* As LINK.COM shows it in the map */
+    ht_module *m;
+    int lib;            /* Library it came from, or -1 */
+    long base[MAX_PSECTS], size[MAX_PSECTS];
+} module;
+
+typedef struct {
+    char *path;         /* Host file name */
+    char cpmname[CPM_MAXPATH + 1];
+    int lib;
+} input;
+
+typedef struct {
+    unsigned char *data;
+    long len, max;
+} buffer;
+
+static char *progname;
+static int verify;
+static const char *unsupported; /* Why the link is left to LINK.COM */
+
+static char *outname, *mapname, *symname, *pspec;
+static long cbase;
+static int cset;            /* -C was given: the output is a COM file */
+static int nolocals, nocompiler;
+
+static input *inputs;
+static int ninputs;
+static ht_library *libs;
+
+static psect psects[MAX_PSECTS];
+static int npsects;
+static symbol table[HASH_SIZE];
+static symbol *locals;
+static int nlocals, maxlocals;
+static module *mods;
+static int nmods, maxmods;
+static const char *machine;
+
+/* What the native link produced */
+static buffer out_file, map_file, sym_file;
+
+static int usage(void)
 {
-    char cmdbuf[CMD_BUF_SIZE];
-    
-    snprintf(cmdbuf, CMD_BUF_SIZE, "zxcc linq.com ");
+    fprintf(stderr, "Usage: %s [--emulate|--verify] [option ...] file ...\n",
+            progname);
+    return EXIT_FAILURE;
+}
+
+/* Note that the link can't be done natively. Returns 0 for the caller to
+ * pass on. */
+static int fail(const char *why)
+{
+    if (!unsupported) unsupported = why;
+    return 0;
+}
+
+static void bput(buffer *b, const void *data, long len)
+{
+    if (b->len + len > b->max) {
+        b->max = (b->len + len) * 2;
+        b->data = ht_realloc(b->data, b->max);
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+}
+
+static void bprintf(buffer *b, const char *fmt, ...)
+{
+    char line[1024];
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    bput(b, line, n < (int)sizeof(line) ? n : (int)sizeof(line) - 1);
+}
+
+/* CP/M files end on a record boundary, padded with ^Z */
+static void bpad(buffer *b)
+{
+    unsigned char eof[128];
+
+    memset(eof, 0x1A, sizeof(eof));
+    if (b->len % 128) bput(b, eof, 128 - b->len % 128);
+}
+
+/*
+ * The drives zxcc sets up, so that files are named in the map as LINK.COM
+ * sees them
+ */
+
+static char cpmdirs[3][CPM_MAXPATH + 1] = { BINDIR80, LIBDIR80, INCDIR80 };
+
+static void mkpath(char *fullpath, const char *path, const char *subdir)
+{
+    char *s;
+
+    snprintf(fullpath, CPM_MAXPATH - strlen(subdir), "%s", path);
+    s = strchr(fullpath, '\0');
+    if (*fullpath && !ISDIRSEP(s[-1]))
+        *s++ = '/';
+    strcpy(s, subdir);
+}
+
+static void map_drives(void)
+{
+    static const char *vars[3] = { "BINDIR80", "LIBDIR80", "INCDIR80" };
+    static const char *subdirs[3] = { BIN80, LIB80, INC80 };
+    char *env;
+    int n;
+
+    fcb_init();
+    for (n = 0; n < 3; n++) {
+        if ((env = getenv("CPMDIR80"))) mkpath(cpmdirs[n], env, subdirs[n]);
+        if ((env = getenv(vars[n]))) mkpath(cpmdirs[n], env, "");
+        xlt_map(n, cpmdirs[n]);
+    }
+}
+
+/* The host file for a name given on the command line. "b:libc.lib" is
+ * where zxcc would find it. */
+static char *host_path(const char *name)
+{
+    char *path, *p;
+    int drive = -1;
+
+    if (name[0] && name[1] == ':' && (p = strchr("aAbBcCpP", name[0])))
+        drive = (p - "aAbBcCpP") / 2;
+    if (drive < 0 || drive == 3)
+        return strdup(drive < 0 ? name : name + 2);
+    path = ht_realloc(NULL, strlen(cpmdirs[drive]) + strlen(name));
+    sprintf(path, "%s%s", cpmdirs[drive], name + 2);
+    return path;
+}
 
-    for (int n = 1; n < argc; n++) {
-        if (!argv[n]) continue;
+/* Output files are created in lower case, as the redirector names them */
+static char *out_path(const char *name)
+{
+    char *path = host_path(name), *p = strrchr(path, '/');
+
+    for (p = p ? p + 1 : path; *p; p++)
+        *p = tolower((unsigned char)*p);
+    return path;
+}
+
+/* A name LINK.COM could open as given: 8.3, and no upper case for the
+ * redirector to fold */
+static int plain_name(const char *path)
+{
+    const char *base = strrchr(path, '/'), *dot;
+
+    base = base ? base + 1 : path;
+    if (base[0] && base[1] == ':') base += 2;
+    dot = strchr(base, '.');
+    if (!*base || (dot ? dot - base : (long)strlen(base)) > 8) return 0;
+    if (dot && (strlen(dot + 1) > 3 || strchr(dot + 1, '.'))) return 0;
+    for (; *base; base++)
+        if (isupper((unsigned char)*base) || strchr(" *?<>=,;:[]|", *base)) return 0;
+    return 1;
+}
+
+/* Numbers as LINK takes them: decimal, or hex with an H after it */
+static int parse_num(const char *s, const char *end, long *value)
+{
+    int base = (end > s && toupper((unsigned char)end[-1]) == 'H') ? 16 : 10;
+    char *stop;
+
+    if (base == 16) --end;
+    if (end == s || !isdigit((unsigned char)*s)) return 0;
+    *value = strtol(s, &stop, base);
+    return stop == end && *value <= 0xFFFF;
+}
+
+/*
+ * Psects and symbols
+ */
+
+/* LINK.COM hashes names by adding up their characters, and looks for a
+ * free slot from there on */
+static symbol *slot(const char *name, int create)
+{
+    unsigned h = 0, n;
+    const char *p;
+
+    for (p = name; *p; p++)
+        h += (unsigned char)*p;
+    for (h %= HASH_SIZE, n = 0; n < HASH_SIZE; n++, h = (h + 1) % HASH_SIZE) {
+        if (!table[h].name) break;
+        if (!strcmp(table[h].name, name)) return &table[h];
+    }
+    if (!create) return NULL;
+    if (n == HASH_SIZE) return fail("too many symbols"), NULL;
+    table[h].name = strdup(name);
+    table[h].psect = -1;
+    table[h].mod = -1;
+    return &table[h];
+}
+
+static symbol *lookup(const char *name, int create)
+{
+    symbol *s = slot(name, create);
+
+    if (s && s->is_psect) return fail("symbol named like a psect"), NULL;
+    return s;
+}
+
+static int find_psect(const char *name, int create)
+{
+    symbol *s;
+    int n;
 
-        if (argv[n][0] == '-') {
-            if (fname_opt(argv[n], 'o', cmdbuf)) continue;
-            if (fname_opt(argv[n], 'm', cmdbuf)) continue;
-            if (fname_opt(argv[n], 'd', cmdbuf)) continue;
+    for (n = 0; n < npsects; n++)
+        if (!strcmp(psects[n].name, name)) return n;
+    if (!create) return -1;
+    if (npsects == MAX_PSECTS) return fail("too many psects") - 1;
+    if (slot(name, 0)) return fail("psect named like a symbol") - 1;
+    if (!(s = slot(name, 1))) return -1;
+    s->is_psect = 1;
+    memset(&psects[n], 0, sizeof(psect));
+    psects[n].name = strdup(name);
+    return npsects++;
+}
+
+static int add_local(const char *name, int p, int mod, unsigned long value)
+{
+    if (nlocals == maxlocals) {
+        maxlocals = maxlocals ? maxlocals * 2 : 1024;
+        locals = ht_realloc(locals, maxlocals * sizeof(symbol));
+    }
+    locals[nlocals].name = strdup(name);
+    locals[nlocals].defined = 1;
+    locals[nlocals].psect = p;
+    locals[nlocals].mod = mod;
+    locals[nlocals++].value = value;
+    return 1;
+}
+
+/* Take in a module's psects and symbols */
+static int add_module(ht_module *m, const char *name, int lib)
+{
+    const unsigned char *rec, *p, *end, *ps, *sname;
+    unsigned len, flags;
+    module *mod;
+    symbol *s;
+    long pos, top;
+    int ps_n;
+
+    if (nmods == maxmods) {
+        maxmods = maxmods ? maxmods * 2 : 64;
+        mods = ht_realloc(mods, maxmods * sizeof(module));
+    }
+    mod = &mods[nmods];
+    memset(mod, 0, sizeof(module));
+    mod->name = name;
+    mod->m = m;
+    mod->lib = lib;
+
+    for (pos = 0; pos < m->len; pos += 3 + len) {
+        rec = m->data + pos;
+        len = ht_rd16(rec);
+        end = rec + 3 + len;
+        p = rec + 3;
+        switch (rec[2]) {
+        case HT_IDENT:
+            if (len < 7 || end[-1]) return fail("bad ident record");
+            if (!machine)
+                machine = (const char *)p + 6;
+            else if (strcmp(machine, (const char *)p + 6))
+                return fail("ident records do not match");
+            break;
+        case HT_TEXT:
+            if (len < 5 || !(sname = memchr(p + 4, 0, len - 4)))
+                return fail("bad text record");
+            ps = p + 4;
+            top = ht_rd32(p) + (end - sname - 1);
+            if (!*ps) {
+                if (end - sname > 1) return fail("absolute code");
+                break;
+            }
+            if ((ps_n = find_psect((const char *)ps, 1)) < 0) return 0;
+            if (top > mod->size[ps_n]) mod->size[ps_n] = top;
+            break;
+        case HT_PSECT:
+            if (len < 3 || end[-1]) return fail("bad psect record");
+            flags = ht_rd16(p);
+            if (!p[2]) break;
+            if (flags & ~0x30 || !(flags & HT_GLOBAL))
+                return fail("psect that is not global");
+            if (find_psect((const char *)p + 2, 1) < 0) return 0;
+            break;
+        case HT_RELOC:
+            for (; p + 4 <= end; p = sname + 1) {
+                if (p[2] != 0x12 && p[2] != 0x22) return fail("relocation type");
+                if (!(sname = memchr(p + 3, 0, end - p - 3))) break;
+                if (p[2] == 0x22 && !lookup((const char *)p + 3, 1)) return 0;
+            }
+            if (p != end) return fail("bad relocation record");
+            break;
+        case HT_SYM:
+            while (p < end) {
+                ps = p + 6;
+                if (end - p < 8 || !(sname = memchr(ps, 0, end - ps)) ||
+                    !memchr(sname + 1, 0, end - sname - 1))
+                    return fail("bad symbol record");
+                ++sname;
+                flags = ht_rd16(p + 4);
+                ps_n = *ps ? find_psect((const char *)ps, 1) : -1;
+                if (*ps && ps_n < 0) return 0;
+                if (flags == 0) {
+                    add_local((const char *)sname, ps_n, nmods, ht_rd32(p));
+                } else if (flags == (HT_GLOBAL | HT_EXTERN) || flags == HT_GLOBAL) {
+                    if (!(s = lookup((const char *)sname, 1))) return 0;
+                    if (flags == HT_GLOBAL) {
+                        if (s->defined) return fail("multiply defined symbol");
+                        s->defined = 1;
+                        s->psect = ps_n;
+                        s->mod = nmods;
+                        s->value = ht_rd32(p);
+                    }
+                } else
+                    return fail("symbol type");
+                p = sname + strlen((const char *)sname) + 1;
+            }
+            break;
+        case HT_START:
+        case HT_END:
+            break;
+        default:
+            return fail("record type");
         }
+    }
+    ++nmods;
+    return 1;
+}
 
-        size_t len = strlen(cmdbuf);
-        size_t remaining = CMD_BUF_SIZE - len - 1;
+/* Whether a library module defines a symbol that is wanted so far */
+static int wanted(const ht_module *m)
+{
+    const unsigned char *p = m->syms;
+    symbol *s;
+    int n;
+
+    for (n = 0; n < m->nsyms; n++, p += strlen((const char *)p + 1) + 2)
+        if (p[0] != HT_EXTERN && (s = slot((const char *)p + 1, 0)) &&
+            (s->is_psect || !s->defined))
+            return 1;
+    return 0;
+}
+
+/* Read the inputs in order, searching each library once through for
+ * modules that define symbols still undefined */
+static int load(void)
+{
+    ht_module *m;
+    unsigned char head[3];
+    FILE *fp;
+    int n, i, rv, searched = 0;
 
-        if (remaining <= strlen(argv[n]) + 1) {
-            fprintf(stderr, "Warning: Command buffer full, truncating\n");
+    /* The absolute psect, whose empty name is in the table from the start */
+    slot("", 1)->is_psect = 1;
+
+    libs = ht_realloc(NULL, ninputs * sizeof(ht_library));
+    memset(libs, 0, ninputs * sizeof(ht_library));
+    for (n = 0; n < ninputs; n++) {
+        if (!(fp = fopen(inputs[n].path, "rb"))) return fail("can't open an input");
+        rv = fread(head, 1, 3, fp);
+        fclose(fp);
+
+        if (rv == 3 && ht_rd16(head) == 10 && head[2] == HT_IDENT) {
+            if (searched) return fail("object file after a library");
+            m = ht_realloc(NULL, sizeof(ht_module));
+            if (ht_readobj(inputs[n].path, inputs[n].cpmname, m) <= 0)
+                return fail("bad object file");
+            if (!add_module(m, inputs[n].cpmname, -1)) return 0;
+            continue;
+        }
+        if (ht_readlib(inputs[n].path, &libs[n]) <= 0) return fail("bad library");
+        inputs[n].lib = 1;
+        searched = 1;
+        for (i = 0; i < libs[n].nmods; i++)
+            if (wanted(&libs[n].mods[i]) &&
+                !add_module(&libs[n].mods[i], libs[n].mods[i].name, n))
+                return 0;
+    }
+    return 1;
+}
+
+/* Place the psects as -P says, the rest after them in the order they
+ * were met, and each module's part of a psect after the last */
+static int layout(void)
+{
+    char *spec = pspec, *end, *eq;
+    long addr = 0, at[MAX_PSECTS];
+    int n, p;
+
+    for (n = 0; n < nmods; n++)
+        for (p = 0; p < npsects; p++)
+            psects[p].size += mods[n].size[p];
+
+    while (*spec) {
+        end = spec + strcspn(spec, ",");
+        if (memchr(spec, '/', end - spec)) return fail("load address in -P");
+        eq = memchr(spec, '=', end - spec);
+        for (p = 0; p < npsects; p++)
+            if (strlen(psects[p].name) == (size_t)((eq ? eq : end) - spec) &&
+                !strncmp(psects[p].name, spec, (eq ? eq : end) - spec))
+                break;
+        if (p == npsects || psects[p].placed) return fail("-P names an unknown psect");
+        if (eq && !parse_num(eq + 1, end, &addr)) return fail("bad address in -P");
+        psects[p].addr = addr;
+        psects[p].placed = 1;
+        addr += psects[p].size;
+        spec = *end ? end + 1 : end;
+    }
+    for (p = 0; p < npsects; p++) {
+        if (!psects[p].placed) {
+            psects[p].addr = addr;
+            addr += psects[p].size;
+        }
+        if (psects[p].addr + psects[p].size > 0x10000) return fail("psect beyond 64K");
+        at[p] = psects[p].addr;
+    }
+    for (n = 0; n < nmods; n++)
+        for (p = 0; p < npsects; p++) {
+            mods[n].base[p] = at[p];
+            at[p] += mods[n].size[p];
+        }
+    return 1;
+}
+
+/* Define __Lpsect and __Hpsect, unless a module already has, and work out
+ * where every symbol is. LINK.COM enters them in the table only now, after
+ * all the modules, which decides where they land in the -D file. */
+static int resolve(void)
+{
+    char name[64];
+    symbol *s;
+    int p, n, h;
+
+    for (p = 0; p < npsects; p++)
+        for (h = 0; h < 2; h++) {
+            snprintf(name, sizeof(name), "__%c%s", h ? 'H' : 'L', psects[p].name);
+            if (!(s = lookup(name, 1))) return 0;
+            if (s->defined) continue;
+            s->defined = 1;
+            s->psect = p;
+            s->value = psects[p].addr + (h ? psects[p].size : 0);
+        }
+
+    for (n = 0; n < HASH_SIZE; n++) {
+        s = &table[n];
+        if (!s->name || s->is_psect) continue;
+        if (!s->defined) return fail("undefined symbols");
+        if (s->mod >= 0 && s->psect >= 0)
+            s->value = (s->value + mods[s->mod].base[s->psect]) & 0xFFFFFFFF;
+    }
+    for (n = 0; n < nlocals; n++) {
+        s = &locals[n];
+        if (s->psect >= 0)
+            s->value = (s->value + mods[s->mod].base[s->psect]) & 0xFFFFFFFF;
+    }
+    return 1;
+}
+
+/* Lay the code out in memory, relocated, and cut the program from it */
+static int build(void)
+{
+    static unsigned char image[0x10000], used[0x10000];
+    const unsigned char *rec, *p, *end, *name;
+    unsigned len, word;
+    long pos, addr = 0, size = 0, lo = 0x10000, hi = 0, a, add;
+    module *mod;
+    symbol *s;
+    int n, ps;
+
+    for (n = 0; n < nmods; n++) {
+        mod = &mods[n];
+        for (pos = 0; pos < mod->m->len; pos += 3 + len) {
+            rec = mod->m->data + pos;
+            len = ht_rd16(rec);
+            end = rec + 3 + len;
+            p = rec + 3;
+            if (rec[2] == HT_TEXT) {
+                name = p + 4;
+                if (!*name) {
+                    size = 0;
+                    continue;
+                }
+                ps = find_psect((const char *)name, 0);
+                p = (const unsigned char *)strchr((const char *)name, 0) + 1;
+                addr = mod->base[ps] + ht_rd32(rec + 3);
+                size = end - p;
+                if (addr + size > 0x10000) return fail("code beyond 64K");
+                for (a = addr; a < addr + size; a++)
+                    if (used[a]++) return fail("overlapping code");
+                memcpy(image + addr, p, size);
+                if (size && addr < lo) lo = addr;
+                if (size && addr + size > hi) hi = addr + size;
+            } else if (rec[2] == HT_RELOC) {
+                for (; p < end; p = name + strlen((const char *)name) + 1) {
+                    name = p + 3;
+                    if (ht_rd16(p) + 2 > size) return fail("relocation out of range");
+                    if (p[2] == 0x12) {
+                        if (!*name || (ps = find_psect((const char *)name, 0)) < 0)
+                            return fail("relocation to an unknown psect");
+                        add = mod->base[ps];
+                    } else {
+                        if (!(s = lookup((const char *)name, 0))) return fail("relocation to a local symbol");
+                        add = s->value;
+                    }
+                    a = addr + ht_rd16(p);
+                    word = image[a] | (image[a + 1] << 8);
+                    word += add;
+                    image[a] = word & 0xFF;
+                    image[a + 1] = (word >> 8) & 0xFF;
+                }
+            }
+        }
+    }
+    if (hi <= lo) return fail("no code");
+    if (lo < cbase) return fail("code below the file base");
+    for (a = cbase; a < hi; a++)
+        if (!used[a]) return fail("holes in the program");
+    bput(&out_file, image + cbase, hi - cbase);
+    bpad(&out_file);
+    return 1;
+}
+
+/*
+ * The map and symbol files
+ */
+
+static const char *psect_name(int p)
+{
+    return p < 0 ? "(abs)" : psects[p].name;
+}
+
+static int by_name(const void *a, const void *b)
+{
+    return strcmp((*(const symbol **)a)->name, (*(const symbol **)b)->name);
+}
+
+/* A module's line in the map: where each of its psects went */
+static void map_module(buffer *b, const module *mod)
+{
+    int n, k;
+
+    bprintf(b, "%-16s", mod->name);
+    for (n = k = 0; n < npsects; n++) {
+        if (!mod->size[n]) continue;
+        if (k) bprintf(b, k % 2 ? "\t" : "\r\n\t\t");
+        bprintf(b, "%-8.8s%9lX%9lX", psects[n].name, mod->base[n], mod->size[n]);
+        ++k;
+    }
+    bprintf(b, "\r\n");
+}
+
+static void write_map(buffer *b)
+{
+    symbol **sorted;
+    int n, i, nsorted = 0, width = 0, pwidth = 5, cols;
+
+    /* The object files, then each library and what came from it */
+    bprintf(b, "Machine type is %s\r\n\r\n", machine);
+    for (n = 0; n < nmods && mods[n].lib < 0; n++)
+        map_module(b, &mods[n]);
+    for (i = 0; i < ninputs; i++) {
+        if (!inputs[i].lib) continue;
+        bprintf(b, "\r\n%s\r\n", inputs[i].cpmname);
+        for (; n < nmods && mods[n].lib == i; n++)
+            map_module(b, &mods[n]);
+    }
+
+    bprintf(b, "\r\nTOTAL\t\tName         Link     Load   Length\r\n");
+    bprintf(b, "\t\t%-8s%9X%9X%9X\r\n", "(abs)", 0, 0, 0);
+    for (n = 0; n < npsects; n++)
+        bprintf(b, "\t\t%-8.8s%9lX%9lX%9lX\r\n", psects[n].name,
+                psects[n].addr, psects[n].addr, psects[n].size);
+
+    /* The symbols in as many columns as fit in 80, each as wide as the
+     * longest name and psect name */
+    bprintf(b, "\r\n%34sSymbol Table\r\n\r\n", "");
+    sorted = ht_realloc(NULL, HASH_SIZE * sizeof(symbol *));
+    for (n = 0; n < HASH_SIZE; n++) {
+        if (!table[n].name || table[n].is_psect) continue;
+        sorted[nsorted++] = &table[n];
+        if ((int)strlen(table[n].name) > width) width = strlen(table[n].name);
+    }
+    for (n = 0; n < npsects; n++)
+        if ((int)strlen(psects[n].name) > pwidth) pwidth = strlen(psects[n].name);
+    if ((cols = 80 / (width + pwidth + 8)) < 1) cols = 1;
+    qsort(sorted, nsorted, sizeof(symbol *), by_name);
+    for (n = 0; n < nsorted; n++)
+        bprintf(b, "%-*s %-*s %04lX%s", width, sorted[n]->name, pwidth,
+                psect_name(sorted[n]->psect), sorted[n]->value,
+                n % cols == cols - 1 ? "\r\n" : "  ");
+    if (nsorted % cols) bprintf(b, "\r\n");
+    free(sorted);
+    bpad(b);
+}
+
+/* The local labels the compiler makes up, dropped by -Z */
+static int compiler_local(const char *name)
+{
+    if (!strchr("FLSfkl", name[0]) || !name[0]) return 0;
+    while (isdigit((unsigned char)*++name))
+        ;
+    return !*name;
+}
+
+static void write_syms(buffer *b)
+{
+    int n;
+
+    for (n = 0; n < HASH_SIZE; n++)
+        if (table[n].name && !table[n].is_psect)
+            bprintf(b, "%04lX %s\r\n", table[n].value, table[n].name);
+    for (n = 0; n < nlocals && !nolocals; n++)
+        if (!nocompiler || !compiler_local(locals[n].name))
+            bprintf(b, "%04lX %s\r\n", locals[n].value, locals[n].name);
+    bpad(b);
+}
+
+static int write_file(const char *name, const buffer *b)
+{
+    char *path = out_path(name);
+    int ok = ht_writefile(path, b->data, b->len);
+
+    if (!ok) fprintf(stderr, "%s: %s: %s\n", progname, path, strerror(errno));
+    free(path);
+    return ok;
+}
+
+/* Link in memory. Returns 0, with the reason in unsupported, if it is a
+ * link for LINK.COM. */
+static int native(void)
+{
+    if (unsupported) return 0;
+    if (!outname) return fail("no -O");
+    if (!pspec) return fail("no -P");
+    if (!cset) return fail("no -C");
+    if (!ninputs) return fail("no input files");
+    if (getenv("ZXCC_IMAGE")) return fail("ZXCC_IMAGE is set");
+    if (!load() || !layout() || !resolve() || !build()) return 0;
+    if (mapname) write_map(&map_file);
+    if (symname) write_syms(&sym_file);
+    return 1;
+}
+
+static int write_outputs(void)
+{
+    return write_file(outname, &out_file) &&
+           (!mapname || write_file(mapname, &map_file)) &&
+           (!symname || write_file(symname, &sym_file));
+}
+
+/*
+ * The command line
+ */
+
+/* Take in the options and file names, building the command line that runs
+ * the link with LINK.COM. Names are translated for the map in the same
+ * order as zxcc will, so that they get the same drives. */
+static void parse_args(int argc, char **argv, char *cmdbuf)
+{
+    char name[CPM_MAXPATH + 1], drive[CPM_MAXPATH + 1], **target, *arg;
+    int n;
+
+    inputs = ht_realloc(NULL, argc * sizeof(input));
+    snprintf(cmdbuf, CMD_BUF_SIZE, "zxcc link.com");
+    for (n = 0; n < argc; n++) {
+        arg = argv[n];
+        if (arg[0] != '-') {
+            add_arg(cmdbuf, "", arg);
+            xlt_name(arg, inputs[ninputs].cpmname);
+            inputs[ninputs].path = host_path(arg);
+            inputs[ninputs].lib = 0;
+            if (!plain_name(arg)) fail("file name LINK.COM would fold");
+            ++ninputs;
+            continue;
+        }
+        arg += (arg[1] == '-') + 1;
+        target = NULL;
+        switch (tolower((unsigned char)arg[0])) {
+        case 'o': target = &outname; break;
+        case 'm': target = &mapname; break;
+        case 'd': target = &symname; break;
+        case 'p':
+            if (pspec) fail("more than one -P");
+            pspec = arg + 1;
+            break;
+        case 'c':
+            if (!parse_num(arg + 1, strchr(arg, 0), &cbase)) fail("bad -C");
+            cset = 1;
             break;
+        case 'x': nolocals = 1; break;
+        case 'z': nocompiler = 1; break;
+        default:
+            fail("option");
         }
+        if ((target && !arg[1]) || (strchr("xXzZ", arg[0]) && arg[1])) fail("option");
+        if (target && arg[1]) {
+            if (*target) fail("option given twice");
+            *target = arg + 1;
+            if (!plain_name(arg + 1)) fail("file name LINK.COM would fold");
+            /* Only to map its directory to a drive where zxcc will */
+            xlt_name(arg + 1, drive);
+            snprintf(name, sizeof(name), "%c", arg[0]);
+            add_arg(cmdbuf, "--", name);
+            add_arg(cmdbuf, "+", arg + 1);
+        } else
+            add_arg(cmdbuf, "--", arg);
+    }
+}
+
+/* Compare what LINK.COM left in a file with what zxlink would have written */
+static int compare(const char *name, const buffer *b)
+{
+    char *path = out_path(name);
+    long pos;
+    int same = ht_cmpfile(path, b->data, b->len, &pos);
+
+    if (same < 0)
+        fprintf(stderr, "%s: %s: %s\n", progname, path, strerror(errno));
+    else if (!same)
+        fprintf(stderr, "%s: %s: LINK.COM's differs from zxlink's at offset %ld\n",
+                progname, path, pos);
+    free(path);
+    return same > 0;
+}
+
+static int verify_link(char *cmdbuf)
+{
+    int same;
+
+    if (!native()) {
+        fprintf(stderr, "%s: not verified, left to LINK.COM: %s\n", progname, unsupported);
+        return EXIT_FAILURE;
+    }
+    printf("Executing: %s\n", cmdbuf);
+    fflush(stdout);
+    if (system(cmdbuf) != 0) {
+        fprintf(stderr, "%s: LINK.COM failed\n", progname);
+        return EXIT_FAILURE;
+    }
+    same = compare(outname, &out_file);
+    if (mapname) same &= compare(mapname, &map_file);
+    if (symname) same &= compare(symname, &sym_file);
+    if (!same) return EXIT_FAILURE;
+    fprintf(stderr, "%s: %s: same as LINK.COM\n", progname, outname);
+    return EXIT_SUCCESS;
+}
 
-        strncat(cmdbuf, argv[n], remaining);
-        strncat(cmdbuf, " ", CMD_BUF_SIZE - strlen(cmdbuf) - 1);
+int main(int argc, char **argv)
+{
+    char cmdbuf[CMD_BUF_SIZE];
+    int emulate = 0, n = 1;
+
+    progname = argv[0];
+    for (; n < argc && argv[n][0] == '-' && argv[n][1] == '-' && strlen(argv[n]) > 3; n++) {
+        if (!strcmp(argv[n], "--emulate"))
+            emulate = 1;
+        else if (!strcmp(argv[n], "--verify"))
+            verify = 1;
+        else
+            break;
     }
+    if (n == argc) return usage();
+
+    map_drives();
+    parse_args(argc - n, argv + n, cmdbuf);
+
+    if (verify) return verify_link(cmdbuf);
+    if (!emulate && native()) return write_outputs() ? EXIT_SUCCESS : EXIT_FAILURE;
 
     printf("Executing: %s\n", cmdbuf);
-    return system(cmdbuf);
+    fflush(stdout);
+    return system(cmdbuf) ? EXIT_FAILURE : EXIT_SUCCESS;
 }
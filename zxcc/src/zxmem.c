@@ -0,0 +1,116 @@
+#include "zxcc.h"
+#include "zxmem.h"
+
+/* Expanded memory: a pool of host memory reached through I/O ports. See
+ * zxmem.h. */
+
+/* The pool's pages, each allocated when it is first written to */
+static byte **xm_page;
+static unsigned long xm_pages = 16384 / (XM_PAGE / 1024);
+
+static word xm_pb;       /* The parameter block's address */
+static byte xm_status;   /* Result of the last command */
+
+/* Offsets in the parameter block */
+#define PB_ADDR   0
+#define PB_LEN    2
+#define PB_OFFSET 4
+
+#define pbword(off) (RAM[(word)(xm_pb + (off))] | \
+		    (RAM[(word)(xm_pb + (off) + 1)] << 8))
+
+void zxmem_init(unsigned long kbytes)
+{
+	xm_pages = (kbytes + XM_PAGE / 1024 - 1) / (XM_PAGE / 1024);
+	if (xm_pages > 0xFFFF) /* As many as XM_INFO can give */
+		xm_pages = 0xFFFF;
+}
+
+/* Copy len bytes between Z80 address addr and pool offset off */
+static int xm_copy(int put, word addr, word len, unsigned long off)
+{
+	unsigned long page, n;
+
+	if ((unsigned long)addr + len > 0x10000 ||
+	    off > xm_pages * XM_PAGE || len > xm_pages * XM_PAGE - off)
+		return 0;
+	if (!xm_page && len)
+	{
+		xm_page = calloc(xm_pages, sizeof(byte *));
+		if (!xm_page)
+			return 0;
+	}
+	while (len)
+	{
+		page = off / XM_PAGE;
+		n = XM_PAGE - off % XM_PAGE;
+		if (n > len)
+			n = len;
+		if (put)
+		{
+			if (!xm_page[page] && !(xm_page[page] = calloc(1, XM_PAGE)))
+				return 0;
+			memcpy(xm_page[page] + off % XM_PAGE, RAM + addr, n);
+		}
+		else
+		{
+			/* A page never written to reads as zeroes */
+			if (xm_page[page])
+				memcpy(RAM + addr, xm_page[page] + off % XM_PAGE, n);
+			else
+				memset(RAM + addr, 0, n);
+			xlat_written(addr, n);
+		}
+		addr += n;
+		len -= n;
+		off += n;
+	}
+	return 1;
+}
+
+static int xm_command(byte cmd)
+{
+	unsigned long off;
+
+	switch (cmd)
+	{
+	case XM_INFO:
+		RAM[(word)(xm_pb + PB_LEN)] = xm_pages & 0xFF;
+		RAM[(word)(xm_pb + PB_LEN + 1)] = (xm_pages >> 8) & 0xFF;
+		xlat_written(xm_pb + PB_LEN, 2);
+		return 1;
+	case XM_PUT:
+	case XM_GET:
+		off = pbword(PB_OFFSET) | ((unsigned long)pbword(PB_OFFSET + 2) << 16);
+		return xm_copy(cmd == XM_PUT, pbword(PB_ADDR), pbword(PB_LEN), off);
+	}
+	return 0;
+}
+
+byte zxmem_in(byte c)
+{
+	switch (c)
+	{
+	case XM_CMD:
+		return xm_status;
+	case XM_ID:
+		return xm_pages ? XM_IDBYTE : 0;
+	}
+	return 0;
+}
+
+void zxmem_out(byte c, byte value)
+{
+	switch (c)
+	{
+	case XM_PBLO:
+		xm_pb = (xm_pb & 0xFF00) | value;
+		break;
+	case XM_PBHI:
+		xm_pb = (xm_pb & 0x00FF) | (value << 8);
+		break;
+	case XM_CMD:
+		xm_status = xm_command(value) ? 0 : 0xFF;
+		break;
+	}
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include <cpmredir.h>
+#include <cpmimage.h>
+
+/* zxpack: build a packed drive image for ZXCC_IMAGE.
+ *
+ *   zxpack image.img [A:] file... [B:] file... [C:] file...
+ *
+ * A drive letter followed by a colon selects the drive for the files after
+ * it (A: to start with). Each file is stored under its own name, which must
+ * be a valid CP/M 8.3 name, unless it is given as host=NAME.TYP. A directory
+ * adds every file in it that has a lower case 8.3 name, as cpmredir would
+ * show it.
+ */
+
+typedef struct {
+    cpm_byte key[IMG_KEYLEN]; /* Drive and CP/M name */
+    char *path;
+    unsigned long len;
+    unsigned long mtime;
+    unsigned long offset;
+    unsigned long next;
+} entry;
+
+static entry *entries;
+static int nentries, maxentries;
+static char *progname;
+
+/* Convert a host name to an 11-byte CP/M name. Returns 0 if it isn't 8.3;
+ * with "lower" set, names with upper case letters are also refused. */
+static int cpm_name(const char *name, cpm_byte *cname, int lower)
+{
+    const char *dot = strchr(name, '.');
+    size_t nl = dot ? (size_t)(dot - name) : strlen(name);
+    size_t tl = dot ? strlen(dot + 1) : 0;
+    size_t n;
+
+    if (!nl || nl > 8 || tl > 3 || (dot && strchr(dot + 1, '.')))
+        return 0;
+    memset(cname, ' ', 11);
+    for (n = 0; n < nl + (dot ? tl + 1 : 0); n++) {
+        if (isupper((unsigned char)name[n]) && lower)
+            return 0;
+        if (name[n] == ' ' || name[n] == '*' || name[n] == '?')
+            return 0;
+    }
+    for (n = 0; n < nl; n++)
+        cname[n] = toupper((unsigned char)name[n]);
+    for (n = 0; n < tl; n++)
+        cname[8 + n] = toupper((unsigned char)dot[1 + n]);
+    return 1;
+}
+
+static void add_file(int drive, char *path, const char *name, int lower)
+{
+    struct stat st;
+    entry *e;
+
+    if (stat(path, &st)) {
+        perror(path);
+        exit(1);
+    }
+    if (nentries == maxentries) {
+        maxentries = maxentries ? maxentries * 2 : 256;
+        entries = realloc(entries, maxentries * sizeof(entry));
+        if (!entries) {
+            fprintf(stderr, "%s: out of memory\n", progname);
+            exit(1);
+        }
+    }
+    e = &entries[nentries];
+    e->key[0] = drive;
+    if (!cpm_name(name, e->key + 1, lower)) {
+        if (lower)
+            return; /* Directory entry cpmredir wouldn't show */
+        fprintf(stderr, "%s: %s is not a CP/M 8.3 name\n", progname, name);
+        exit(1);
+    }
+    e->path = strdup(path);
+    e->len = st.st_size;
+    e->mtime = (unsigned long)st.st_mtime;
+    ++nentries;
+}
+
+static void add_dir(int drive, char *path)
+{
+    char fname[CPM_MAXPATH + 1];
+    struct dirent *de;
+    struct stat st;
+    DIR *dir = opendir(path);
+
+    if (!dir) {
+        perror(path);
+        exit(1);
+    }
+    while ((de = readdir(dir))) {
+        snprintf(fname, sizeof(fname), "%s/%s", path, de->d_name);
+        if (stat(fname, &st) || !S_ISREG(st.st_mode))
+            continue;
+        add_file(drive, fname, de->d_name, 1);
+    }
+    closedir(dir);
+}
+
+static int cmp_key(const void *a, const void *b)
+{
+    return memcmp(((const entry *)a)->key, ((const entry *)b)->key, IMG_KEYLEN);
+}
+
+static void put32(FILE *fp, unsigned long v)
+{
+    putc(v & 0xFF, fp);
+    putc((v >> 8) & 0xFF, fp);
+    putc((v >> 16) & 0xFF, fp);
+    putc((v >> 24) & 0xFF, fp);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long *buckets, nbuckets, offs, h;
+    char buf[65536];
+    struct stat st;
+    char *arg, *eq;
+    FILE *fp, *in;
+    size_t n;
+    int i, drive = 0;
+
+    progname = argv[0];
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s image [A:] file|dir|file=NAME.TYP ... "
+                        "[B:] ...\n", progname);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 2; i < argc; i++) {
+        arg = argv[i];
+        if (isalpha((unsigned char)arg[0]) && arg[1] == ':' && !arg[2]) {
+            drive = toupper((unsigned char)arg[0]) - 'A';
+            if (drive > 14) {
+                fprintf(stderr, "%s: %s: drive must be A: to O:\n",
+                        progname, arg);
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+        eq = strrchr(arg, '=');
+        if (eq) {
+            *eq = 0;
+            add_file(drive, arg, eq + 1, 0);
+        } else if (!stat(arg, &st) && S_ISDIR(st.st_mode)) {
+            add_dir(drive, arg);
+        } else {
+            eq = strrchr(arg, '/');
+            add_file(drive, arg, eq ? eq + 1 : arg, 0);
+        }
+    }
+
+    qsort(entries, nentries, sizeof(entry), cmp_key);
+    for (i = 1; i < nentries; i++) {
+        if (!cmp_key(&entries[i - 1], &entries[i])) {
+            fprintf(stderr, "%s: %s and %s have the same CP/M name\n",
+                    progname, entries[i - 1].path, entries[i].path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Keep the load factor at 1/2 or less */
+    for (nbuckets = 16; nbuckets < 2UL * nentries; nbuckets *= 2)
+        ;
+    buckets = calloc(nbuckets, sizeof(unsigned long));
+    if (!buckets) {
+        fprintf(stderr, "%s: out of memory\n", progname);
+        return EXIT_FAILURE;
+    }
+    for (i = nentries - 1; i >= 0; i--) {
+        h = img_hash(entries[i].key) & (nbuckets - 1);
+        entries[i].next = buckets[h];
+        buckets[h] = i + 1;
+    }
+
+    /* File data follows the directory, each file starting on a 128-byte
+     * boundary like a CP/M record */
+    offs = IMG_HDRLEN + nbuckets * 4 + (unsigned long)nentries * IMG_ENTLEN;
+    for (i = 0; i < nentries; i++) {
+        offs = (offs + 127) & ~127UL;
+        entries[i].offset = offs;
+        offs += entries[i].len;
+    }
+    if (offs > 0xFFFFFFFFUL) {
+        fprintf(stderr, "%s: image would be larger than 4Gb\n", progname);
+        return EXIT_FAILURE;
+    }
+
+    fp = fopen(argv[1], "wb");
+    if (!fp) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    fwrite(IMG_MAGIC, 1, 4, fp);
+    put32(fp, IMG_VERSION);
+    put32(fp, nentries);
+    put32(fp, nbuckets);
+    put32(fp, IMG_HDRLEN);
+    put32(fp, IMG_HDRLEN + nbuckets * 4);
+    put32(fp, 0);
+    put32(fp, 0);
+    for (h = 0; h < nbuckets; h++)
+        put32(fp, buckets[h]);
+    for (i = 0; i < nentries; i++) {
+        fwrite(entries[i].key, 1, IMG_KEYLEN, fp);
+        put32(fp, entries[i].offset);
+        put32(fp, entries[i].len);
+        put32(fp, entries[i].mtime);
+        put32(fp, entries[i].next);
+        put32(fp, 0);
+    }
+    for (i = 0; i < nentries; i++) {
+        while ((unsigned long)ftell(fp) < entries[i].offset)
+            putc(0, fp);
+        in = fopen(entries[i].path, "rb");
+        if (!in) {
+            perror(entries[i].path);
+            return EXIT_FAILURE;
+        }
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+            fwrite(buf, 1, n, fp);
+        fclose(in);
+        if ((unsigned long)ftell(fp) != entries[i].offset + entries[i].len) {
+            fprintf(stderr, "%s: %s changed while packing\n",
+                    progname, entries[i].path);
+            return EXIT_FAILURE;
+        }
+    }
+    if (fclose(fp)) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    printf("%s: %d files, %lu bytes\n", argv[1], nentries, offs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include "zxcc.h"
+#include "zxbdos.h"
+#include "zxrec.h"
+#include "zxhost.h"
+
+/* BDOS call recorder. The log format is described in zxrec.h; zxreplay.c
+ * is the matching reader. */
+
+int zxrec_active = 0;
+
+static FILE *rec_fp;
+static int zxrec_multi = 1; /* Records per transfer, as set by BDOS 0x2C */
+static byte rec_func, rec_e;
+
+int zxrec_flags(byte func)
+{
+	switch (func)
+	{
+	case 0x0D: /* Reset discs */
+		return ZXREC_NORET;
+	case 0x0E: /* Select drive */
+	case 0x1C: /* Make disc R/O */
+	case 0x20: /* Get/set user */
+	case 0x25: /* Reset drives */
+	case 0x2C: /* Set multi-sector count */
+		return 0;
+	case 0x0F: /* Open */
+	case 0x13: /* Delete */
+	case 0x16: /* Create */
+	case 0x17: /* Rename */
+	case 0x1E: /* Set attributes */
+	case 0x23: /* File size */
+	case 0x63: /* Truncate */
+	case 0x66: /* Get file date */
+		return ZXREC_FCB;
+	case 0x11: /* Search first */
+	case 0x12: /* Search next */
+		return ZXREC_FCB | ZXREC_DIRENT;
+	case 0x10: /* Close */
+	case 0x24: /* Get file pointer */
+		return ZXREC_FCB | ZXREC_HANDLE;
+	case 0x14: /* Sequential read */
+	case 0x21: /* Random read */
+		return ZXREC_FCB | ZXREC_HANDLE | ZXREC_DMAOUT;
+	case 0x15: /* Sequential write */
+	case 0x22: /* Random write */
+	case 0x28: /* Random write with zero fill */
+		return ZXREC_FCB | ZXREC_HANDLE | ZXREC_DMAIN_REC;
+	case 0x74: /* Set file date */
+		return ZXREC_FCB | ZXREC_DMAIN_8;
+	case ZXH_OPEN:
+	case ZXH_CLOSE:
+	case ZXH_READ:
+	case ZXH_WRITE:
+	case ZXH_SIZE:
+		return ZXREC_HOST;
+	default:
+		return -1; /* Not a disc call; not recorded */
+	}
+}
+
+/* Length of one read/write transfer, following any BDOS 0x2C calls seen */
+
+int zxrec_reclen(void)
+{
+	return 128 * zxrec_multi;
+}
+
+int zxrec_hostin(byte func, word pb, word *addr)
+{
+	unsigned count = RAM[(word)(pb + ZXH_PB_COUNT)] |
+	                 (RAM[(word)(pb + ZXH_PB_COUNT + 1)] << 8);
+
+	*addr = RAM[(word)(pb + ZXH_PB_ADDR)] |
+	        (RAM[(word)(pb + ZXH_PB_ADDR + 1)] << 8);
+	if (func == ZXH_OPEN)
+		return ZXREC_NAMELEN;
+	if (func != ZXH_READ && func != ZXH_WRITE)
+		return 0;
+	/* As much as zxhost.c will move */
+	return (count > 0x10000u - *addr) ? 0x10000u - *addr : count;
+}
+
+void zxrec_track(byte func, byte e, word ret)
+{
+	if (func == 0x2C && ret == 0)
+		zxrec_multi = e;
+}
+
+/* FNV-1a over the parts of the result that do not depend on host state
+ * (file handles, time stamps), so a replay on a copy of the same files
+ * gives the same digest. */
+
+static dword fnv(dword h, byte *p, int len)
+{
+	while (len-- > 0)
+	{
+		h ^= *p++;
+		h = (h * 16777619UL) & 0xFFFFFFFFUL;
+	}
+	return h;
+}
+
+dword zxrec_digest(byte func, word ret, byte *fcb, byte *dma, int dmalen)
+{
+	int flags = zxrec_flags(func);
+	byte r[2];
+	dword h = 2166136261UL;
+
+	r[0] = ret & 0xFF;
+	r[1] = ret >> 8;
+	if (!(flags & ZXREC_NORET))
+		h = fnv(h, r, 2);
+	if (flags & ZXREC_FCB)
+	{
+		h = fnv(h, fcb, 0x10);
+		h = fnv(h, fcb + 0x20, 4);
+	}
+	/* A failed read leaves the DMA buffer as it was, which the log does
+	 * not hold, so only hash data from a successful transfer */
+	if ((flags & ZXREC_DMAOUT) && ret == 0)
+		h = fnv(h, dma, dmalen);
+	if (flags & ZXREC_DIRENT)
+	{
+		h = fnv(h, dma, 0x16);
+		h = fnv(h, dma + 0x1C, 4);
+	}
+	/* For a host file call, fcb is the parameter block and dma what a
+	 * read brought in */
+	if (flags & ZXREC_HOST)
+	{
+		h = fnv(h, fcb, ZXH_PB_LEN);
+		if (func == ZXH_READ && ret == 0)
+			h = fnv(h, dma, dmalen);
+	}
+	return h;
+}
+
+void zxrec_get(byte *buf, word addr, int len)
+{
+	while (len-- > 0)
+		*buf++ = RAM[addr++];
+}
+
+void zxrec_put(word addr, byte *buf, int len)
+{
+	while (len-- > 0)
+		RAM[addr++] = *buf++;
+}
+
+/* Write len bytes of the Z80's memory at addr to the log */
+static void put_mem(word addr, int len)
+{
+	while (len-- > 0)
+		putc(RAM[addr++], rec_fp);
+}
+
+static void put_word(word w)
+{
+	putc(w & 0xFF, rec_fp);
+	putc(w >> 8, rec_fp);
+}
+
+static void put_dword(dword d)
+{
+	put_word(d & 0xFFFF);
+	put_word((d >> 16) & 0xFFFF);
+}
+
+void zxrec_init(char *fname)
+{
+	int n;
+	char *dir;
+
+	rec_fp = fopen(fname, "wb");
+	if (!rec_fp)
+	{
+		fprintf(stderr, "%s: Cannot create %s\n", progname, fname);
+		return;
+	}
+	setvbuf(rec_fp, NULL, _IOFBF, 65536);
+
+	fputs(ZXREC_MAGIC, rec_fp);
+	putc(ZXREC_VERSION, rec_fp);
+	putc(fcb_getdrv(), rec_fp);
+	putc(fcb_user(0xFF), rec_fp);
+	putc(0, rec_fp);
+	for (n = 0; n < 16; n++)
+	{
+		dir = xlt_getcwd(n);
+		put_word((word)strlen(dir));
+		fputs(dir, rec_fp);
+	}
+	zxrec_active = 1;
+}
+
+static word rec_fcb, rec_dma;
+
+void zxrec_before(byte func, byte e, word fcb, word dma)
+{
+	int flags = zxrec_flags(func);
+
+	rec_func = func;
+	if (flags < 0)
+	{
+		rec_func = 0xFF;
+		return;
+	}
+	rec_e = e;
+	rec_fcb = fcb;
+	rec_dma = dma;
+
+	putc(func, rec_fp);
+	putc(e, rec_fp);
+	put_word(fcb);
+	put_word(dma);
+	if (flags & ZXREC_FCB)
+		put_mem(fcb, ZXREC_FCBLEN);
+	if (flags & ZXREC_DMAIN_REC)
+		put_mem(dma, zxrec_reclen());
+	if (flags & ZXREC_DMAIN_8)
+		put_mem(dma, 8);
+	if (flags & ZXREC_HOST)
+	{
+		word addr;
+		int len = zxrec_hostin(func, fcb, &addr);
+
+		put_mem(fcb, ZXH_PB_LEN);
+		if (func != ZXH_READ)
+			put_mem(addr, len);
+	}
+}
+
+void zxrec_after(word ret)
+{
+	static byte dma[0x10000];
+	byte fcb[ZXREC_FCBLEN];
+	word addr = rec_dma;
+	int len = zxrec_reclen();
+
+	if (rec_func == 0xFF)
+		return;
+
+	/* A host file read leaves in its parameter block how much it read */
+	if (zxrec_flags(rec_func) & ZXREC_HOST)
+		len = zxrec_hostin(rec_func, rec_fcb, &addr);
+	zxrec_get(fcb, rec_fcb, ZXREC_FCBLEN);
+	zxrec_get(dma, addr, len);
+	put_word(ret);
+	put_dword(zxrec_digest(rec_func, ret, fcb, dma, len));
+	zxrec_track(rec_func, rec_e, ret);
+}
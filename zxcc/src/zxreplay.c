@@ -0,0 +1,351 @@
+#include "zxcc.h"
+#include "zxbdos.h"
+#include "zxdbdos.h"
+#include "zxrec.h"
+#include "zxhost.h"
+
+#include <time.h>
+
+/* zxreplay: play back a log made with ZXCC_RECORD=file.
+ *
+ * Every recorded disc BDOS call is made again, directly on cpmredir, with
+ * the FCB and DMA contents it had when it was recorded. The return value
+ * and a digest of the results are checked against the log, and the time
+ * spent in each function is reported. Run it on a copy of the directory
+ * the recording started in, since the calls will modify the files.
+ */
+
+char *progname;
+byte RAM[65536];
+
+#define MAX_OPEN 256
+#define MAX_REPORT 20
+
+/* Handle fields of the FCBs opened during the replay. The log holds the
+ * handles zxcc got when recording, which need not match ours. */
+static struct
+{
+	word fcbaddr;
+	byte area[16];
+} open_fcb[MAX_OPEN];
+static int n_open;
+
+static struct
+{
+	unsigned long calls;
+	double secs;
+} stats[256];
+
+static int verbose;
+
+/* What zxhost.c uses from zxbdos.c and zxxlat.c. There is no translator
+ * here to tell about the memory it reads into. */
+void wr32(word addr, dword v)
+{
+	RAM[addr] = v & 0xFF;
+	RAM[addr + 1] = (v >> 8) & 0xFF;
+	RAM[addr + 2] = (v >> 16) & 0xFF;
+	RAM[addr + 3] = (v >> 24) & 0xFF;
+}
+
+dword rd32(word addr)
+{
+	return RAM[addr] | (RAM[addr + 1] << 8) | ((dword)RAM[addr + 2] << 16) |
+		   ((dword)RAM[addr + 3] << 24);
+}
+
+void xlat_read(unsigned short addr, unsigned len)
+{
+	(void)addr;
+	(void)len;
+}
+
+void xlat_written(unsigned short addr, unsigned len)
+{
+	(void)addr;
+	(void)len;
+}
+
+static int get_word(FILE *fp, word *w)
+{
+	int lo = getc(fp);
+	int hi = getc(fp);
+
+	if (lo == EOF || hi == EOF)
+		return 0;
+	*w = (word)(lo | (hi << 8));
+	return 1;
+}
+
+static int get_dword(FILE *fp, dword *d)
+{
+	word lo, hi;
+
+	if (!get_word(fp, &lo) || !get_word(fp, &hi))
+		return 0;
+	*d = lo | ((dword)hi << 16);
+	return 1;
+}
+
+static int find_open(word fcbaddr)
+{
+	int n;
+
+	for (n = 0; n < n_open; n++)
+		if (open_fcb[n].fcbaddr == fcbaddr)
+			return n;
+	return -1;
+}
+
+static void save_open(word fcbaddr)
+{
+	int n = find_open(fcbaddr);
+
+	if (n < 0)
+	{
+		if (n_open == MAX_OPEN)
+			return;
+		n = n_open++;
+		open_fcb[n].fcbaddr = fcbaddr;
+	}
+	memcpy(open_fcb[n].area, RAM + fcbaddr + 0x10, 16);
+}
+
+static word call(byte func, byte e, word fcbaddr, word dma)
+{
+	byte *fcb = RAM + fcbaddr;
+	byte *pdma = RAM + dma;
+
+	switch (func)
+	{
+	case 0x0D: return fcb_reset();
+	case 0x0E: return fcb_drive(e);
+	case 0x0F: return x_fcb_open(fcb, pdma);
+	case 0x10: return fcb_close(fcb);
+	case 0x11: return fcb_find1(fcb, pdma);
+	case 0x12: return fcb_find2(fcb, pdma);
+	case 0x13: return fcb_unlink(fcb, pdma);
+	case 0x14: return fcb_read(fcb, pdma);
+	case 0x15: return fcb_write(fcb, pdma);
+	case 0x16: return fcb_creat(fcb, pdma);
+	case 0x17: return fcb_rename(fcb, pdma);
+	case 0x1C: return fcb_rodisk();
+	case 0x1E: return fcb_chmod(fcb, pdma);
+	case 0x20: return fcb_user(e);
+	case 0x21: return fcb_randrd(fcb, pdma);
+	case 0x22: return fcb_randwr(fcb, pdma);
+	case 0x23: return x_fcb_stat(fcb);
+	case 0x24: return fcb_tell(fcb);
+	case 0x25: return fcb_resro(fcbaddr);
+	case 0x28: return fcb_randwz(fcb, pdma);
+	case 0x2C: return fcb_multirec(e);
+	case 0x63: return fcb_trunc(fcb, pdma);
+	case 0x66: return fcb_date(fcb);
+	case 0x74: return fcb_sdate(fcb, pdma);
+	case ZXH_OPEN:
+	case ZXH_CLOSE:
+	case ZXH_READ:
+	case ZXH_WRITE:
+	case ZXH_SIZE:
+		return zxhost_call(func, fcbaddr);
+	}
+	return 0xFFFF;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int read_header(FILE *fp, char *fname)
+{
+	char magic[4];
+	int version, drive, user, n;
+	word len;
+	char dir[CPM_MAXPATH + 1];
+
+	if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, ZXREC_MAGIC, 4))
+	{
+		fprintf(stderr, "%s: %s is not a BDOS log\n", progname, fname);
+		return 0;
+	}
+	version = getc(fp);
+	drive = getc(fp);
+	user = getc(fp);
+	getc(fp);
+	if (version != ZXREC_VERSION)
+	{
+		fprintf(stderr, "%s: %s has unsupported version %d\n",
+				progname, fname, version);
+		return 0;
+	}
+	for (n = 0; n < 16; n++)
+	{
+		if (!get_word(fp, &len) || len > CPM_MAXPATH ||
+			fread(dir, 1, len, fp) != len)
+		{
+			fprintf(stderr, "%s: %s: truncated header\n", progname, fname);
+			return 0;
+		}
+		dir[len] = 0;
+		/* P: is always the current directory */
+		if (n < 15 && len)
+			xlt_map(n, dir);
+	}
+	fcb_drive(drive);
+	fcb_user(user);
+	return 1;
+}
+
+static void report(unsigned long callno, byte func, word fcbaddr,
+				   word ret, word rret, dword dig, dword rdig)
+{
+	printf("call %lu: BDOS %02Xh %-11.11s returned %04X (log %04X), "
+		   "digest %08lX (log %08lX)\n",
+		   callno, func, (zxrec_flags(func) & ZXREC_FCB) ? (char *)RAM + fcbaddr + 1 : "",
+		   ret, rret, dig, rdig);
+}
+
+int main(int ac, char **av)
+{
+	FILE *fp;
+	int n, c, flags;
+	byte func, e;
+	word fcbaddr, dma, rret, ret;
+	dword rdig, dig;
+	static byte buf[0x10000];
+	byte fcb[ZXREC_FCBLEN];
+	word addr;
+	int len;
+	unsigned long callno = 0, bad = 0;
+	double t0, t, total = 0;
+
+	progname = av[0];
+	for (n = 1; n < ac && av[n][0] == '-'; n++)
+	{
+		if (!strcmp(av[n], "-v"))
+			verbose = 1;
+		else
+			break;
+	}
+	if (n != ac - 1)
+	{
+		fprintf(stderr, "Usage: %s [-v] logfile\n", progname);
+		return 2;
+	}
+	fp = fopen(av[n], "rb");
+	if (!fp)
+	{
+		perror(av[n]);
+		return 2;
+	}
+	setvbuf(fp, NULL, _IOFBF, 65536);
+
+	if (!fcb_init())
+	{
+		fprintf(stderr, "Could not initialise CPMREDIR library\n");
+		return 2;
+	}
+	if (!read_header(fp, av[n]))
+		return 2;
+
+	while ((c = getc(fp)) != EOF)
+	{
+		func = c;
+		e = getc(fp);
+		if (!get_word(fp, &fcbaddr) || !get_word(fp, &dma))
+			break;
+		flags = zxrec_flags(func);
+		if (flags < 0)
+		{
+			fprintf(stderr, "%s: unexpected BDOS %02Xh in log\n",
+					progname, func);
+			return 2;
+		}
+		if (flags & ZXREC_FCB)
+		{
+			if (fread(buf, 1, ZXREC_FCBLEN, fp) != ZXREC_FCBLEN)
+				break;
+			zxrec_put(fcbaddr, buf, ZXREC_FCBLEN);
+		}
+		if (flags & ZXREC_DMAIN_REC)
+		{
+			if (fread(buf, 1, zxrec_reclen(), fp) != (size_t)zxrec_reclen())
+				break;
+			zxrec_put(dma, buf, zxrec_reclen());
+		}
+		if (flags & ZXREC_DMAIN_8)
+		{
+			if (fread(buf, 1, 8, fp) != 8)
+				break;
+			zxrec_put(dma, buf, 8);
+		}
+		if (flags & ZXREC_HOST)
+		{
+			if (fread(buf, 1, ZXH_PB_LEN, fp) != ZXH_PB_LEN)
+				break;
+			zxrec_put(fcbaddr, buf, ZXH_PB_LEN);
+			len = zxrec_hostin(func, fcbaddr, &addr);
+			if (func != ZXH_READ)
+			{
+				if (fread(buf, 1, len, fp) != (size_t)len)
+					break;
+				zxrec_put(addr, buf, len);
+			}
+		}
+		if (!get_word(fp, &rret) || !get_dword(fp, &rdig))
+			break;
+		++callno;
+
+		if ((flags & ZXREC_HANDLE) && (n = find_open(fcbaddr)) >= 0)
+			memcpy(RAM + fcbaddr + 0x10, open_fcb[n].area, 16);
+
+		t0 = now();
+		ret = call(func, e, fcbaddr, dma);
+		t = now() - t0;
+		stats[func].calls++;
+		stats[func].secs += t;
+		total += t;
+
+		if ((func == 0x0F || func == 0x16) && ret == 0)
+			save_open(fcbaddr);
+		else if ((flags & ZXREC_HANDLE) && find_open(fcbaddr) >= 0)
+			save_open(fcbaddr);
+
+		addr = dma;
+		len = zxrec_reclen();
+		if (flags & ZXREC_HOST)
+			len = zxrec_hostin(func, fcbaddr, &addr);
+		zxrec_get(fcb, fcbaddr, ZXREC_FCBLEN);
+		zxrec_get(buf, addr, len);
+		dig = zxrec_digest(func, ret, fcb, buf, len);
+		if (dig != rdig || ((flags & ZXREC_NORET) == 0 && ret != rret))
+		{
+			if (bad++ < MAX_REPORT)
+				report(callno, func, fcbaddr, ret, rret, dig, rdig);
+		}
+		else if (verbose)
+			report(callno, func, fcbaddr, ret, rret, dig, rdig);
+		zxrec_track(func, e, ret);
+	}
+	if (c != EOF)
+		fprintf(stderr, "%s: log truncated after %lu calls\n", progname, callno);
+	fclose(fp);
+
+	printf("BDOS  calls       total us    ns/call\n");
+	for (n = 0; n < 256; n++)
+	{
+		if (!stats[n].calls)
+			continue;
+		printf("%02Xh %7lu %14.0f %10.0f\n", n, stats[n].calls,
+			   stats[n].secs * 1e6, stats[n].secs * 1e9 / stats[n].calls);
+	}
+	printf("all %7lu %14.0f %10.0f\n", callno, total * 1e6,
+		   callno ? total * 1e9 / callno : 0.0);
+	printf("%lu mismatch%s\n", bad, bad == 1 ? "" : "es");
+
+	return bad ? 1 : 0;
+}
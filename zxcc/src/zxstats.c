@@ -0,0 +1,91 @@
+#include "zxcc.h"
+#include "zxstats.h"
+#include <sys/time.h>
+#include <sys/resource.h>
+
+/* Run statistics, written as zxcc exits. See zxstats.h. */
+
+unsigned long zxstats_bdos[256];
+unsigned long zxstats_bios;
+
+static FILE *stats_fp;
+static struct timespec stats_start;
+
+static double seconds(struct timeval tv)
+{
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* Write s as the inside of a JSON string */
+static void put_chars(const char *s)
+{
+	for (; *s; s++)
+	{
+		if (*s == '"' || *s == '\\')
+			putc('\\', stats_fp);
+		if ((unsigned char)*s >= ' ')
+			putc(*s, stats_fp);
+	}
+}
+
+static void put_string(const char *s)
+{
+	putc('"', stats_fp);
+	put_chars(s);
+	putc('"', stats_fp);
+}
+
+static void zxstats_write(void)
+{
+	struct timespec now;
+	struct rusage ru;
+	double wall;
+	unsigned long total = 0;
+	long maxrss;
+	int n, sep;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	getrusage(RUSAGE_SELF, &ru);
+	wall = (now.tv_sec - stats_start.tv_sec) +
+		   (now.tv_nsec - stats_start.tv_nsec) / 1e9;
+	maxrss = ru.ru_maxrss;
+#ifdef __APPLE__
+	maxrss /= 1024; /* Bytes there, not kilobytes */
+#endif
+
+	fputs("{\"program\":", stats_fp);
+	put_string(argc > 1 ? argv[1] : "");
+	fputs(",\"args\":\"", stats_fp);
+	for (n = 2; n < argc; n++)
+	{
+		if (n > 2)
+			putc(' ', stats_fp);
+		put_chars(argv[n]);
+	}
+	fprintf(stats_fp, "\",\"insns\":%lu,\"tstates\":%lu", z80_insns,
+			z80_tstates);
+	for (n = 0; n < 256; n++)
+		total += zxstats_bdos[n];
+	fprintf(stats_fp, ",\"bdos\":%lu,\"bdos_calls\":{", total);
+	for (n = sep = 0; n < 256; n++)
+		if (zxstats_bdos[n])
+			fprintf(stats_fp, "%s\"%d\":%lu", sep++ ? "," : "", n,
+					zxstats_bdos[n]);
+	fprintf(stats_fp, "},\"bios\":%lu", zxstats_bios);
+	fprintf(stats_fp, ",\"wall\":%.6f,\"user\":%.6f,\"sys\":%.6f",
+			wall, seconds(ru.ru_utime), seconds(ru.ru_stime));
+	fprintf(stats_fp, ",\"maxrss\":%ld}\n", maxrss);
+	fclose(stats_fp);
+}
+
+int zxstats_init(char *fname)
+{
+	clock_gettime(CLOCK_MONOTONIC, &stats_start);
+	stats_fp = fopen(fname, "a");
+	if (!stats_fp)
+		return 0;
+	/* One write at exit, so that runs in parallel don't mix their lines */
+	setvbuf(stats_fp, NULL, _IOFBF, 16384);
+	atexit(zxstats_write);
+	return 1;
+}
@@ -0,0 +1,1312 @@
+#include "zxcc.h"
+
+#include <stddef.h>
+#include <dlfcn.h>
+#include <sys/wait.h>
+
+/* See zxxlat.h. A translation is a C file with one function ("chunk") for
+ * each CHUNK_SIZE instructions of the image, in address order. Each
+ * instruction becomes the text of its case in z80ops.h, cbops.h or
+ * edops.h, with pc set beforehand to where the interpreter would have it,
+ * so that the compiler can fold the operand fetches into plain loads and
+ * keep the registers in locals from one instruction to the next. An
+ * instruction that may jump goes through a switch on pc over the chunk's
+ * entry points; leaving the chunk, or reaching an address with no entry,
+ * returns to xlat_run().
+ *
+ * Besides the chunks, a translation defines:
+ *
+ *   xlat_abi        XLAT_ABI, as it was when the translation was made
+ *   xlat_chunks     the chunk functions
+ *   xlat_entries    xlat_nentries pairs of entry address and chunk number
+ *   xlat_runs       xlat_nruns pairs of start and length of the bytes
+ *                   that were translated
+ *
+ * The ".tgt" file kept with it has a line "t addr" for each address
+ * translated code was seen to leave for, and "d addr" for each byte that
+ * was taken for code but then written to; such bytes are not translated
+ * again.
+ */
+
+#define CHUNK_SIZE  256     /* Instructions in a chunk */
+
+#define NOTE_TARGET 1
+#define NOTE_DATA   2
+
+#define F_ENTRY     1       /* Translated code can be entered here */
+#define F_STOP      2       /* Left for the interpreter to run */
+
+typedef unsigned long long hash_t;
+
+/* The source of one instruction */
+typedef struct {
+    char *text;             /* From instr(...) to endinstr;, or NULL */
+    int hl;                 /* Uses (HL), (IX+d) or (IY+d) */
+    int ix;                 /* Also in the IX and IY tables */
+    int stop;               /* Does I/O or traps: leave to the interpreter */
+    int branch;             /* May change pc other than by stepping over
+                             * its operands */
+    int stores;             /* May write to memory */
+} opsrc;
+
+/* An instruction as decoded from the image */
+typedef struct {
+    int len;                /* 0 if it can't be decoded */
+    int xy;                 /* 0, or 1 or 2 after a DD or FD prefix */
+    int ed, cb;             /* ED or CB prefixed */
+    int op;                 /* The opcode after the prefixes, or -1 for a
+                             * DD or FD that does not apply to it */
+    int target;             /* Where a jump, call or restart goes, or -1 */
+    int next;               /* Execution may go on to the next instruction */
+} insn;
+
+unsigned short *xlat_map;
+unsigned char *xlat_code;
+static unsigned short *map;         /* What xlat_map is, unless checking */
+static unsigned short *step_map;    /* All STEP_MARK, for checking */
+
+extern unsigned char partable[256];
+
+/* The instruction sources, copied in by the Makefile (obj/xlatsrc.c) */
+extern const char xlat_src_zxxlat[], xlat_src_z80regs[], xlat_src_z80ops[],
+                  xlat_src_cbops[], xlat_src_edops[];
+
+static char *xlat_dir;              /* ZXCC_XLAT */
+static hash_t image_key;
+static unsigned char *image;        /* The COM file as loaded at 0100h */
+static unsigned image_len;
+static unsigned char *notes;        /* NOTE_TARGET and NOTE_DATA by address */
+static int new_notes;               /* This run noted something new */
+static void *handle;                /* The translation in use */
+static int loaded;                  /* There was one, if since dropped */
+static const xlat_chunk *chunks;
+static unsigned load_top;           /* End of a file being read to 0100h */
+
+static opsrc mainops[256], edops[256];
+static char *cbops[256];            /* Statements for CB 00-3F, and for
+                                     * CB 40-FF by op & C7 */
+static char *cbreg[8];              /* Copying an (IX+d) result to a register */
+static char *ops_common, *cb_common, *ed_common;
+
+/* 64-bit FNV-1a */
+static hash_t fnv(hash_t h, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    while (len--) {
+        h ^= *p++;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void file_name(char *buf, size_t size, const char *ext)
+{
+    snprintf(buf, size, "%s/%016llx%s", xlat_dir, image_key, ext);
+}
+
+/* Translations for checking are kept apart (see check_run()) */
+static const char *so_ext(void)
+{
+    return step_map ? ".chk.so" : ".so";
+}
+
+static void note(unsigned addr, int what)
+{
+    if (addr < 0x100 || addr >= 0x100 + image_len)
+        return;
+    if (!(notes[addr] & what)) {
+        notes[addr] |= what;
+        new_notes = 1;
+    }
+}
+
+static void read_notes(void)
+{
+    char name[CPM_MAXPATH + 32];
+    unsigned addr;
+    char c;
+    FILE *fp;
+
+    file_name(name, sizeof(name), ".tgt");
+    if (!(fp = fopen(name, "r")))
+        return;
+    while (fscanf(fp, " %c %x", &c, &addr) == 2)
+        if (addr < 0x10000)
+            notes[addr] |= (c == 'd') ? NOTE_DATA : NOTE_TARGET;
+    fclose(fp);
+}
+
+/* Add this run's notes to the .tgt file. Another run may have added some
+ * of its own since we read it, so it is read again first. */
+static int save_notes(void)
+{
+    char name[CPM_MAXPATH + 32], tmpname[CPM_MAXPATH + 48];
+    unsigned addr;
+    FILE *fp;
+
+    read_notes();
+    file_name(name, sizeof(name), ".tgt");
+    snprintf(tmpname, sizeof(tmpname), "%s.%ld", name, (long)getpid());
+    if (!(fp = fopen(tmpname, "w")))
+        return 0;
+    for (addr = 0; addr < 0x10000; addr++) {
+        if (notes[addr] & NOTE_TARGET)
+            fprintf(fp, "t %04x\n", addr);
+        if (notes[addr] & NOTE_DATA)
+            fprintf(fp, "d %04x\n", addr);
+    }
+    if (fclose(fp) || rename(tmpname, name)) {
+        remove(tmpname);
+        return 0;
+    }
+    return 1;
+}
+
+/* Stop using the translation. If a program is being read in, the map
+ * keeps the mark at 0100h that says so. */
+static void xlat_off(void)
+{
+    if (!handle)
+        return;
+    Msg("Translated code dropped\n");
+    memset(map, 0, 0x10000 * sizeof(*map));
+    memset(xlat_code, 0, 0x10000);
+    if (load_top)
+        map[0x100] = XLAT_NEW;
+    dlclose(handle);
+    handle = NULL;
+}
+
+static void load_translation(void)
+{
+    char name[CPM_MAXPATH + 32];
+    const unsigned short *entries, *runs;
+    const unsigned *nentries, *nruns;
+    const int *abi;
+    unsigned n, a;
+
+    file_name(name, sizeof(name), so_ext());
+    if (!(handle = dlopen(name, RTLD_NOW | RTLD_LOCAL)))
+        return;
+    abi = dlsym(handle, "xlat_abi");
+    chunks = dlsym(handle, "xlat_chunks");
+    entries = dlsym(handle, "xlat_entries");
+    nentries = dlsym(handle, "xlat_nentries");
+    runs = dlsym(handle, "xlat_runs");
+    nruns = dlsym(handle, "xlat_nruns");
+    if (!abi || *abi != XLAT_ABI || !chunks || !entries || !nentries ||
+        !runs || !nruns) {
+        dlclose(handle);
+        handle = NULL;
+        return;
+    }
+    for (n = 0; n < *nentries; n++)
+        map[entries[2 * n]] = entries[2 * n + 1] + 1;
+    for (n = 0; n < *nruns; n++)
+        for (a = runs[2 * n]; a < (unsigned)runs[2 * n] + runs[2 * n + 1]; a++)
+            xlat_code[a] = 1;
+    loaded = 1;
+    Msg("Loaded translation %s\n", name);
+}
+
+static void start_image(unsigned len);
+static void check_run(struct xlat_cpu *cpu);
+
+void xlat_run(struct xlat_cpu *cpu)
+{
+    unsigned k;
+
+    if (step_map) {
+        check_run(cpu);
+        return;
+    }
+    cpu->mem = RAM;
+    cpu->smc = 0;
+    cpu->miss = 0;
+    while ((k = map[cpu->pc]) != 0) {
+        if (k == XLAT_NEW) {
+            /* A program read in by a CP/M program has been started */
+            start_image(load_top - 0x100);
+            continue;
+        }
+        cpu->code = xlat_code;
+        cpu->miss = 0;
+        chunks[k - 1](cpu);
+        if (cpu->smc) {
+            note(cpu->smc & 0xFFFF, NOTE_DATA);
+            xlat_off();
+            return;
+        }
+    }
+    if (cpu->miss)
+        note(cpu->pc, NOTE_TARGET);
+}
+
+void xlat_smc(unsigned short addr)
+{
+    note(addr, NOTE_DATA);
+    xlat_off();
+}
+
+void xlat_written(unsigned short addr, unsigned len)
+{
+    if (!handle)
+        return;
+    for (; len; len--, addr++)
+        if (xlat_code[addr] && RAM[addr] != image[addr - 0x100]) {
+            xlat_off();
+            return;
+        }
+}
+
+void xlat_read(unsigned short addr, unsigned len)
+{
+    if (!map)
+        return;
+    if (addr == 0x100) {
+        load_top = addr + len;
+        map[0x100] = XLAT_NEW;
+    }
+    else if (load_top && addr == load_top && load_top + len <= 0x10000)
+        load_top += len;
+}
+
+/*** Checking translations against the interpreter ***/
+
+/* With ZXCC_XLAT_CHECK, the program is run by the interpreter alone, and
+ * each time it comes to an entry of the translation, the chunk is also run
+ * on a copy of the registers and memory. Translations for checking are
+ * compiled with XLAT_CHECK, which has them count the instructions they
+ * run. xlat_map is step_map throughout, so the interpreter comes here
+ * before each instruction; once it has run as many as the chunk did, both
+ * must have the same registers and memory, or zxcc stops and shows what
+ * differs. To find the instruction at fault, the chunk is run again for
+ * one instruction, then two, and so on, against the registers the
+ * interpreter had after each.
+ *
+ * Only the interpreter's run is kept, so the BDOS sees each call once.
+ * Translating is not left to the background, so that each run checks
+ * what the one before it found. */
+
+#define STEP_MARK 0xFFFE
+#define ALL_STEPS 0xFFFFFFFFUL
+#define TRAIL     4096              /* Instructions that can be looked back on */
+
+static struct xlat_cpu check_before, check_after;
+static struct xlat_cpu *trail;      /* The interpreter after each instruction */
+static unsigned check_chunk;
+static unsigned long check_steps, check_done;
+static unsigned char *start;        /* The memory when the chunk was entered */
+static unsigned char *shadow;       /* The memory as the translation left it */
+static unsigned long check_blocks;
+
+static void check_report(void)
+{
+    fprintf(stderr, "%s: %lu blocks of translated code checked\n",
+            progname, check_blocks);
+}
+
+static int check_init(void)
+{
+    unsigned n;
+
+    if (!(step_map = malloc(0x10000 * sizeof(*step_map))) ||
+        !(trail = malloc(TRAIL * sizeof(*trail))) ||
+        !(start = malloc(0x10000)) || !(shadow = malloc(0x10000)))
+        return 0;
+    for (n = 0; n < 0x10000; n++)
+        step_map[n] = STEP_MARK;
+    atexit(check_report);
+    return 1;
+}
+
+static const struct {
+    const char *name;
+    size_t offset;
+    int size;
+} check_regs[] = {
+#define REG(r, n) { n, offsetof(struct xlat_cpu, r), \
+                    sizeof(((struct xlat_cpu *)0)->r) }
+    REG(a, "a"), REG(f, "f"), REG(a1, "a'"), REG(f1, "f'"),
+    REG(BC, "bc"), REG(DE, "de"), REG(HL, "hl"), REG(IX, "ix"),
+    REG(IY, "iy"), REG(BC1, "bc'"), REG(DE1, "de'"), REG(HL1, "hl'"),
+    REG(sp, "sp"), REG(pc, "pc"), REG(i, "i"), REG(r, "r"),
+    REG(iff1, "iff1"), REG(iff2, "iff2"), REG(im, "im"),
+    REG(radjust, "radjust"), REG(tstates, "tstates")
+#undef REG
+};
+
+static unsigned long reg_value(const struct xlat_cpu *cpu, int n)
+{
+    const char *p = (const char *)cpu + check_regs[n].offset;
+
+    switch (check_regs[n].size) {
+    case 1:
+        return *(const unsigned char *)p;
+    case 2:
+        return *(const unsigned short *)p;
+    case sizeof(unsigned):
+        return *(const unsigned *)p;
+    default:
+        return *(const unsigned long *)p;
+    }
+}
+
+static int same_regs(const struct xlat_cpu *x, const struct xlat_cpu *y)
+{
+    int n;
+
+    for (n = 0; n < (int)(sizeof(check_regs) / sizeof(check_regs[0])); n++)
+        if (reg_value(x, n) != reg_value(y, n))
+            return 0;
+    return 1;
+}
+
+/* Run the chunk from where it was entered, for at most steps instructions */
+static void run_chunk(struct xlat_cpu *cpu, unsigned long steps)
+{
+    *cpu = check_before;
+    memcpy(shadow, start, 0x10000);
+    cpu->mem = shadow;
+    cpu->code = xlat_code;
+    cpu->smc = 0;
+    cpu->miss = 0;
+    cpu->steps = steps;
+    chunks[check_chunk](cpu);
+}
+
+static void show_flags(char *buf, unsigned f)
+{
+    const char *names = "SZ5H3VNC";
+    int n;
+
+    for (n = 0; n < 8; n++)
+        buf[n] = (f & (0x80 >> n)) ? names[n] : '-';
+    buf[8] = 0;
+}
+
+static void check_fail(const struct xlat_cpu *cpu)
+{
+    const struct xlat_cpu *before = &check_before, *interp = cpu;
+    struct xlat_cpu trans = check_after;
+    unsigned long k = check_done, n;
+    char flags[3][9];
+    unsigned addr, shown = 0;
+
+    fprintf(stderr, "%s: translated code differs from the interpreter\n",
+            progname);
+    fprintf(stderr, "Block %lu, entered at %04Xh, ran %lu instructions\n",
+            check_blocks, check_before.pc, check_done);
+    for (addr = 0; addr < 0x10000 && shown < 16; addr++)
+        if (RAM[addr] != shadow[addr]) {
+            fprintf(stderr, "  (%04X) interpreter %02X, translation %02X\n",
+                    addr, RAM[addr], shadow[addr]);
+            shown++;
+        }
+
+    /* Find the first instruction after which the registers differ */
+    for (n = 1; n <= check_done && n <= TRAIL; n++) {
+        run_chunk(&trans, n);
+        if (!same_regs(&trans, &trail[n - 1])) {
+            k = n;
+            interp = &trail[n - 1];
+            if (n > 1)
+                before = &trail[n - 2];
+            break;
+        }
+    }
+    if (n > check_done || n > TRAIL)
+        trans = check_after;
+    else
+        fprintf(stderr, "Registers first differ after instruction %lu, at "
+                "%04Xh: %02X %02X %02X %02X\n", k, before->pc,
+                RAM[before->pc], RAM[(before->pc + 1) & 0xFFFF],
+                RAM[(before->pc + 2) & 0xFFFF], RAM[(before->pc + 3) & 0xFFFF]);
+
+    fprintf(stderr, "            before  interpreter  translation\n");
+    for (n = 0; n < sizeof(check_regs) / sizeof(check_regs[0]); n++) {
+        int digits = check_regs[n].size < 4 ? 2 * check_regs[n].size : 8;
+
+        fprintf(stderr, "%c %-8s %8.*lX %12.*lX %12.*lX\n",
+                reg_value(interp, n) != reg_value(&trans, n) ? '*' : ' ',
+                check_regs[n].name, digits, reg_value(before, n),
+                digits, reg_value(interp, n), digits, reg_value(&trans, n));
+    }
+    show_flags(flags[0], before->f);
+    show_flags(flags[1], interp->f);
+    show_flags(flags[2], trans.f);
+    fprintf(stderr, "%c flags    %8s %12s %12s\n",
+            interp->f != trans.f ? '*' : ' ', flags[0], flags[1], flags[2]);
+    zxcc_term();
+    zxcc_exit(3);
+}
+
+/* Does the instruction at addr go somewhere taken from a register or the
+ * stack? */
+static int computed_jump(unsigned addr)
+{
+    unsigned op = RAM[addr], next = RAM[(addr + 1) & 0xFFFF];
+
+    return op == 0xE9 || op == 0xC9 || (op & 0xC7) == 0xC0 ||
+           ((op == 0xDD || op == 0xFD) && next == 0xE9) ||
+           (op == 0xED && (next & 0xC7) == 0x45);
+}
+
+static void check_run(struct xlat_cpu *cpu)
+{
+    static long last = -1;          /* Interpreted, if not checking a chunk */
+    unsigned k;
+
+    if (check_steps) {
+        /* The interpreter is catching up with the translated code */
+        if (check_done < TRAIL)
+            trail[check_done] = *cpu;
+        if (++check_done < check_steps)
+            return;
+        if (!same_regs(cpu, &check_after) || memcmp(RAM, shadow, 0x10000))
+            check_fail(cpu);
+        check_steps = 0;
+    }
+    else if (last >= 0 && computed_jump(last) && !map[cpu->pc]) {
+        /* Where the translated code would have left off if it had run the
+         * jump (see xlat_run()), so that the next check covers what
+         * follows */
+        note(cpu->pc, NOTE_TARGET);
+    }
+    last = cpu->pc;
+    if ((k = map[cpu->pc]) == XLAT_NEW) {
+        start_image(load_top - 0x100);
+        k = map[cpu->pc];
+    }
+    if (!k)
+        return;
+
+    check_before = *cpu;
+    check_chunk = k - 1;
+    memcpy(start, RAM, 0x10000);
+    run_chunk(&check_after, ALL_STEPS);
+    if (check_after.miss && !map[check_after.pc])
+        note(check_after.pc, NOTE_TARGET);
+    check_steps = ALL_STEPS - check_after.steps;
+    check_done = 0;
+    if (check_steps) {
+        check_blocks++;
+        last = -1;
+    }
+}
+
+/*** Reading the instruction sources ***/
+
+/* Is word at p, and not part of a longer name? */
+static int is_word(const char *start, const char *p, const char *word)
+{
+    size_t n = strlen(word);
+
+    return !strncmp(p, word, n) && !isalnum((unsigned char)p[n]) &&
+           p[n] != '_' &&
+           (p == start || (!isalnum((unsigned char)p[-1]) && p[-1] != '_'));
+}
+
+static int has_word(const char *text, const char *word)
+{
+    const char *p;
+
+    for (p = text; (p = strstr(p, word)) != NULL; p++)
+        if (is_word(text, p, word))
+            return 1;
+    return 0;
+}
+
+/* Does text assign to pc other than by ++ or += ? */
+static int sets_pc(const char *text)
+{
+    const char *p, *q;
+
+    for (p = text; (p = strstr(p, "pc")) != NULL; p++) {
+        if (!is_word(text, p, "pc"))
+            continue;
+        for (q = p + 2; *q == ' '; q++)
+            ;
+        if ((q[0] == '=' && q[1] != '=') || (q[0] == '-' && q[1] == '='))
+            return 1;
+    }
+    return 0;
+}
+
+static void classify(opsrc *o)
+{
+    const char *t = o->text;
+
+    o->stop = strstr(t, "#include") || strstr(t, "goto") ||
+              has_word(t, "in") || has_word(t, "out") ||
+              has_word(t, "input") || has_word(t, "ed_fe");
+    o->branch = has_word(t, "jp") || has_word(t, "jr") ||
+                has_word(t, "call") || has_word(t, "ret") || sets_pc(t);
+    o->stores = strstr(t, "store") || strstr(t, "push") ||
+                has_word(t, "call");
+}
+
+/* A copy of a source without its carriage returns */
+static char *source(const char *src)
+{
+    char *s = malloc(strlen(src) + 1), *d = s;
+
+    if (!s)
+        return NULL;
+    for (; *src; src++)
+        if (*src != '\r')
+            *d++ = *src;
+    *d = 0;
+    return s;
+}
+
+/* Split a file of instr(...); ... endinstr; blocks into ops[]. Blocks in
+ * an "#if IXORIY==0" section are only in the unprefixed table. Returns the
+ * text before the first block. */
+static char *parse_ops(const char *src, opsrc *ops)
+{
+    char *s = source(src), *p, *line, *head = NULL;
+    int region0 = 0, comment = 0, nl, op;
+    opsrc *o = NULL;
+
+    if (!s)
+        return NULL;
+    for (p = s; *p; ) {
+        /* Each line is looked at on its own, and put back afterwards
+         * unless it ends a block */
+        line = p;
+        p += strcspn(p, "\n");
+        if ((nl = (*p != 0)))
+            *p++ = 0;
+        if (o) {
+            if (!strncmp(line, "endinstr", 8)) {
+                o = NULL;
+                continue;
+            }
+        }
+        else if (comment) {
+            if (strstr(line, "*/"))
+                comment = 0;
+        }
+        else if (!strncmp(line, "instr(", 6) || !strncmp(line, "HLinstr(", 8)) {
+            if (!head && !(head = strndup(s, line - s)))
+                return NULL;
+            op = strtol(strchr(line, '(') + 1, NULL, 0);
+            if (op >= 0 && op <= 255) {
+                o = &ops[op];
+                o->text = line;
+                o->hl = (line[0] == 'H');
+                o->ix = !region0;
+            }
+        }
+        else if (!strncmp(line, "#if IXORIY==0", 13))
+            region0 = 1;
+        else if (!strncmp(line, "#endif", 6))
+            region0 = 0;
+        else if (strstr(line, "/*") && !strstr(strstr(line, "/*"), "*/"))
+            comment = 1;
+        if (nl)
+            p[-1] = '\n';
+    }
+    for (op = 0; op < 256; op++)
+        if (ops[op].text) {
+            if (!(ops[op].text = strdup(ops[op].text)))
+                return NULL;
+            classify(&ops[op]);
+        }
+    free(s);
+    return head;
+}
+
+/* The macros of z80ops.h, from its Z80OPS_COMMON section */
+static char *ops_macros(char *head)
+{
+    char *start = strstr(head, "#define Z80OPS_COMMON"), *p;
+    int depth = 1;
+
+    if (!start)
+        return NULL;
+    start += strlen("#define Z80OPS_COMMON");
+    for (p = start; (p = strchr(p, '#')) != NULL; p++) {
+        if (!strncmp(p, "#if", 3))
+            depth++;
+        else if (!strncmp(p, "#endif", 6) && !--depth) {
+            *p = 0;
+            return start;
+        }
+    }
+    return NULL;
+}
+
+/* The statement of each case of a switch in cbops.h */
+static void parse_cases(const char *sw, char **table)
+{
+    const char *p = sw, *end = strstr(sw, "\n   }");
+    char *stmt;
+    int n, len;
+
+    while ((p = strstr(p, "case")) && (!end || p < end)) {
+        n = strtol(p + 4, (char **)&p, 0);
+        while (*p == ' ' || *p == ':')
+            p++;
+        len = strstr(p, "break;") - p;
+        if (n >= 0 && n < 256 && (stmt = malloc(len + 1))) {
+            memcpy(stmt, p, len);
+            stmt[len] = 0;
+            table[n] = stmt;
+        }
+    }
+}
+
+static int parse_sources(void)
+{
+    char *head, *cb, *p;
+
+    if (ops_common)
+        return 1;
+    if (!(head = parse_ops(xlat_src_z80ops, mainops)) ||
+        !(ops_common = ops_macros(head)) ||
+        !(ed_common = parse_ops(xlat_src_edops, edops)) ||
+        !(cb = source(xlat_src_cbops)))
+        return 0;
+    /* Both headers open their instructions with a line "{" */
+    if ((p = strstr(ed_common, "\n{\n")))
+        p[1] = 0;
+    if (!(p = strstr(cb, "\n{\n")))
+        return 0;
+    p[1] = 0;
+    cb_common = cb;
+    p += 2;
+    if (!(p = strstr(p, "switch(op)")))
+        return 0;
+    parse_cases(p, cbops);
+    if (!(p = strstr(p, "switch(op&0xc7)")))
+        return 0;
+    parse_cases(p, cbops);
+    if (!(p = strstr(p, "switch(reg)")))
+        return 0;
+    parse_cases(p, cbreg);
+    return 1;
+}
+
+/*** Finding the code ***/
+
+static int in_image(unsigned addr)
+{
+    return addr >= 0x100 && addr < 0x100 + image_len;
+}
+
+/* Length of an unprefixed instruction */
+static int op_len(int op)
+{
+    switch (op) {
+    case 0x01: case 0x11: case 0x21: case 0x31:
+    case 0x22: case 0x2a: case 0x32: case 0x3a:
+    case 0xc3: case 0xcd:
+        return 3;
+    case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+    case 0xcb: case 0xd3: case 0xdb:
+        return 2;
+    }
+    if ((op & 0xc7) == 0xc2 || (op & 0xc7) == 0xc4)
+        return 3;
+    if ((op & 0xc7) == 0x06 || (op & 0xc7) == 0xc6)
+        return 2;
+    return 1;
+}
+
+static int byte_at(unsigned addr)
+{
+    return in_image(addr) ? image[addr - 0x100] : -1;
+}
+
+static void decode(unsigned addr, insn *in)
+{
+    int op = byte_at(addr), n;
+    unsigned char *p;
+
+    memset(in, 0, sizeof(*in));
+    in->target = -1;
+    in->next = 1;
+    if (op == 0xdd || op == 0xfd) {
+        in->xy = (op == 0xdd) ? 1 : 2;
+        n = byte_at(addr + 1);
+        if (n < 0 || !mainops[n].ix) {
+            /* The prefix on its own, and then whatever follows */
+            in->op = -1;
+            in->len = 1;
+            return;
+        }
+        op = n;
+        if (op == 0xcb) {
+            in->cb = 1;
+            in->len = 4;
+        }
+        else
+            in->len = 1 + op_len(op) + mainops[op].hl;
+    }
+    else if (op == 0xed) {
+        in->ed = 1;
+        op = byte_at(addr + 1);
+        in->len = ((op & 0xc7) == 0x43) ? 4 : 2;
+        if ((op & 0xc7) == 0x45)            /* RETN, RETI */
+            in->next = 0;
+        else if ((op & 0xf4) == 0xb0)       /* LDIR and the like */
+            in->target = addr;
+    }
+    else if (op == 0xcb) {
+        in->cb = 1;
+        in->len = 2;
+        op = byte_at(addr + 1);
+    }
+    else
+        in->len = op_len(op);
+    in->op = op;
+    for (n = 0; n < in->len; n++)
+        if (byte_at(addr + n) < 0 || (notes[addr + n] & NOTE_DATA)) {
+            in->len = 0;
+            return;
+        }
+    if (in->ed || in->cb)
+        return;
+
+    p = image + (addr - 0x100) + (in->xy != 0);
+    if (op == 0xc3 || op == 0xcd || (op & 0xc7) == 0xc2 || (op & 0xc7) == 0xc4)
+        in->target = p[1] | (p[2] << 8);
+    else if (op == 0x10 || op == 0x18 || (op & 0xe7) == 0x20)
+        in->target = (addr + 2 + (signed char)p[1]) & 0xFFFF;
+    else if ((op & 0xc7) == 0xc7)
+        in->target = op & 0x38;
+    if (op == 0xc3 || op == 0x18 || op == 0xc9 || op == 0xe9)
+        in->next = 0;
+}
+
+static int is_stop(const insn *in)
+{
+    if (in->op < 0 || in->cb)
+        return 0;
+    if (in->ed)
+        return edops[in->op].text && edops[in->op].stop;
+    return mainops[in->op].stop;
+}
+
+static int is_branch(const insn *in)
+{
+    if (in->op < 0 || in->cb)
+        return 0;
+    if (in->ed)
+        return edops[in->op].text && edops[in->op].branch;
+    return mainops[in->op].branch;
+}
+
+static int is_store(const insn *in)
+{
+    if (in->op < 0)
+        return 0;
+    if (in->cb)
+        return 1;
+    if (in->ed)
+        return edops[in->op].text && edops[in->op].stores;
+    return mainops[in->op].stores;
+}
+
+/* Decode everything that can be reached from 0100h and from the noted
+ * targets, setting len[] for each instruction found. Then mark the
+ * entries: where jumps, calls and restarts go, and where execution comes
+ * back to after them and after anything left to the interpreter. */
+static void discover(unsigned char *len, unsigned char *flags)
+{
+    unsigned short *stack = malloc(0x10000 * sizeof(*stack));
+    unsigned char *seen = calloc(0x10000, 1);
+    unsigned addr, sp = 0;
+    insn in;
+
+    if (!stack || !seen) {
+        free(stack);
+        free(seen);
+        return;
+    }
+#define PUSH(a) do { if (in_image(a) && !seen[a]) { \
+                         seen[a] = 1; stack[sp++] = (a); } } while (0)
+    PUSH(0x100);
+    for (addr = 0x100; addr < 0x100 + image_len; addr++)
+        if (notes[addr] & NOTE_TARGET)
+            PUSH(addr);
+    while (sp) {
+        addr = stack[--sp];
+        decode(addr, &in);
+        if (!in.len)
+            continue;
+        len[addr] = in.len;
+        if (is_stop(&in))
+            flags[addr] |= F_STOP;
+        if (in.target >= 0)
+            PUSH((unsigned)in.target);
+        if (in.next)
+            PUSH(addr + in.len);
+    }
+#undef PUSH
+
+    flags[0x100] |= F_ENTRY;
+    for (addr = 0x100; addr < 0x100 + image_len; addr++) {
+        if (notes[addr] & NOTE_TARGET)
+            flags[addr] |= F_ENTRY;
+        if (!len[addr])
+            continue;
+        decode(addr, &in);
+        if (in.target >= 0 && in_image(in.target))
+            flags[in.target] |= F_ENTRY;
+        if ((flags[addr] & F_STOP) || is_branch(&in) || in.target >= 0)
+            if (addr + in.len < 0x10000)
+                flags[addr + in.len] |= F_ENTRY;
+    }
+    free(stack);
+    free(seen);
+}
+
+/* Can translated code be entered at addr? */
+static int entry(const unsigned char *len, const unsigned char *flags,
+                 unsigned addr)
+{
+    return addr < 0x10000 && len[addr] &&
+           (flags[addr] & (F_ENTRY | F_STOP)) == F_ENTRY;
+}
+
+static void emit_prologue(FILE *fp)
+{
+    int n;
+
+    fputs("/* A COM image translated by zxcc. Do not edit. */\n", fp);
+    fputs(source(xlat_src_zxxlat), fp);
+    fputs(source(xlat_src_z80regs), fp);
+    fputs("\n#define parity(a) (partable[a])\n"
+          "static const unsigned char partable[256] = {", fp);
+    for (n = 0; n < 256; n++)
+        fprintf(fp, "%s%d,", (n % 16) ? "" : "\n", partable[n]);
+    fputs("\n};\n\n"
+          "#define fetch(x) (mem[x])\n"
+          "#define fetch2(x) ((fetch((x)+1)<<8)|fetch(x))\n"
+          "#define stored(x) if(code[x])smc=0x10000|(x)\n"
+          "#define store(x,y) do{unsigned short s_=(x);mem[s_]=(y);"
+          "stored(s_);}while(0)\n"
+          "#define store2b(x,hi,lo) do{unsigned short s_=(x);mem[s_]=(lo);"
+          "stored(s_);\\\n"
+          "   s_++;mem[s_]=(hi);stored(s_);}while(0)\n"
+          "#define store2(x,y) store2b(x,(y)>>8,y)\n", fp);
+    fputs(ops_common, fp);
+    fputs(cb_common, fp);
+    fputs(ed_common, fp);
+    fputs("\n#undef instr\n#undef endinstr\n"
+          "#define instr(opcode,cycles) {tstates+=cycles\n"
+          "#define endinstr }\n"
+          "#define HLinstr(opcode,cycles,morecycles) "
+          "XLAT_CAT(XLAT_HLINSTR,IXORIY)(cycles,morecycles)\n"
+          "#define XLAT_HLINSTR0(cycles,morecycles) "
+          "{unsigned short addr=hl;tstates+=cycles\n"
+          "#define XLAT_HLINSTR1(cycles,morecycles) "
+          "{unsigned short addr=ix+(signed char)fetch(pc);pc++;"
+          "tstates+=cycles+morecycles\n"
+          "#define XLAT_HLINSTR2(cycles,morecycles) "
+          "{unsigned short addr=iy+(signed char)fetch(pc);pc++;"
+          "tstates+=cycles+morecycles\n"
+          "#define XLAT_CAT(a,b) XLAT_CAT_(a,b)\n"
+          "#define XLAT_CAT_(a,b) a##b\n"
+          "#define xhl XLAT_CAT(XLAT_HL,IXORIY)\n"
+          "#define xh XLAT_CAT(XLAT_H,IXORIY)\n"
+          "#define xl XLAT_CAT(XLAT_L,IXORIY)\n"
+          "#define XLAT_HL0 hl\n#define XLAT_H0 h\n#define XLAT_L0 l\n"
+          "#define XLAT_HL1 ix\n#define XLAT_H1 ixh\n#define XLAT_L1 ixl\n"
+          "#define XLAT_HL2 iy\n#define XLAT_H2 iyh\n#define XLAT_L2 iyl\n"
+          "#define IXORIY 0\n\n"
+          "#ifdef XLAT_CHECK\n"
+          "#define XLAT_STEP insns++;if(!--steps)goto out\n"
+          "#else\n"
+          "#define XLAT_STEP insns++\n"
+          "#endif\n"
+          "#define XLAT_ENTER \\\n"
+          "   unsigned char a=cpu->a,f=cpu->f,a1=cpu->a1,f1=cpu->f1;\\\n"
+          "   unsigned char i=cpu->i,r=cpu->r,iff1=cpu->iff1,"
+          "iff2=cpu->iff2,im=cpu->im;\\\n"
+          "   unsigned char intsample;\\\n"
+          "   regpair rbc,rde,rhl,rix,riy,rbc1,rde1,rhl1;\\\n"
+          "   unsigned short sp=cpu->sp,pc=cpu->pc;\\\n"
+          "   unsigned long tstates=cpu->tstates;\\\n"
+          "   unsigned int radjust=cpu->radjust;\\\n"
+          "   unsigned long steps=cpu->steps,insns=cpu->insns;\\\n"
+          "   unsigned char *const mem=cpu->mem;\\\n"
+          "   const unsigned char *const code=cpu->code;\\\n"
+          "   int smc=0;\\\n"
+          "   bc=cpu->BC;de=cpu->DE;hl=cpu->HL;ix=cpu->IX;iy=cpu->IY;\\\n"
+          "   bc1=cpu->BC1;de1=cpu->DE1;hl1=cpu->HL1\n"
+          "#define XLAT_LEAVE \\\n"
+          "   cpu->a=a;cpu->f=f;cpu->a1=a1;cpu->f1=f1;\\\n"
+          "   cpu->i=i;cpu->r=r;cpu->iff1=iff1;cpu->iff2=iff2;cpu->im=im;\\\n"
+          "   cpu->BC=bc;cpu->DE=de;cpu->HL=hl;cpu->IX=ix;cpu->IY=iy;\\\n"
+          "   cpu->BC1=bc1;cpu->DE1=de1;cpu->HL1=hl1;\\\n"
+          "   cpu->sp=sp;cpu->pc=pc;\\\n"
+          "   cpu->tstates=tstates;cpu->radjust=radjust;cpu->smc=smc;\\\n"
+          "   cpu->steps=steps;cpu->insns=insns\n\n",
+          fp);
+}
+
+/* Write out the instruction at addr, and what follows it to get to the
+ * next one: nothing if that comes next in the chunk, else a jump */
+static void emit_insn(FILE *fp, const unsigned char *len,
+                      const unsigned char *flags, const int *chunk,
+                      unsigned addr, unsigned follow, int *ixoriy)
+{
+    static const char *xy_reg[3] = { "hl", "ix", "iy" };
+    unsigned next, op;
+    insn in;
+
+    decode(addr, &in);
+    next = addr + in.len;
+    fprintf(fp, "L%04x:\n", addr);
+    if (flags[addr] & F_STOP) {
+        fprintf(fp, "pc=0x%04x;goto out;\n", addr);
+        return;
+    }
+    op = in.op;
+    if (in.op < 0)
+        fprintf(fp, "pc=0x%04x;radjust++;tstates+=4;\n", next);
+    else if (in.ed) {
+        fprintf(fp, "pc=0x%04x;radjust+=2;tstates+=4;\n", addr + 2);
+        fprintf(fp, "%s\n", edops[op].text ? edops[op].text : "tstates+=4;");
+    }
+    else if (in.cb && !in.xy) {
+        fprintf(fp, "pc=0x%04x;radjust++;\n"
+                "{unsigned short addr=hl;unsigned char val;"
+                "tstates+=8;radjust++;pc++;\n", addr + 1);
+        if (op >= 64)
+            fprintf(fp, "unsigned char n=%u;\n", (op >> 3) & 7);
+        fprintf(fp, "%s}\n", cbops[op < 64 ? op : (op & 0xc7)]);
+    }
+    else if (in.cb) {
+        op = image[addr + 3 - 0x100];
+        fprintf(fp, "pc=0x%04x;radjust+=2;tstates+=4;\n"
+                "{unsigned short addr=%s+(signed char)fetch(pc);"
+                "unsigned char val;tstates+=12;pc+=2;\n",
+                addr + 2, xy_reg[in.xy]);
+        op = (op & 0xf8) | 6;
+        if (op >= 64)
+            fprintf(fp, "unsigned char n=%u;\n", (op >> 3) & 7);
+        fprintf(fp, "%s", cbops[op < 64 ? op : (op & 0xc7)]);
+        op = image[addr + 3 - 0x100] & 7;
+        fprintf(fp, "%s}\n", cbreg[op] ? cbreg[op] : "");
+    }
+    else {
+        if (in.xy != *ixoriy) {
+            fprintf(fp, "#undef IXORIY\n#define IXORIY %d\n", in.xy);
+            *ixoriy = in.xy;
+        }
+        if (in.xy)
+            fprintf(fp, "pc=0x%04x;radjust+=2;tstates+=4;\n", addr + 2);
+        else
+            fprintf(fp, "pc=0x%04x;radjust++;\n", addr + 1);
+        fprintf(fp, "%s\n", mainops[op].text);
+    }
+    /* The interpreter runs a prefix that does nothing together with the
+     * instruction after it */
+    if (in.op >= 0)
+        fputs("XLAT_STEP;\n", fp);
+    if (is_store(&in))
+        fputs("if(smc)goto out;\n", fp);
+    if (is_branch(&in)) {
+        if (in.target >= 0 && (unsigned)in.target != follow &&
+            entry(len, flags, in.target) && chunk[in.target] == chunk[addr])
+            fprintf(fp, "if(pc==0x%04x)goto L%04x;\n", in.target, in.target);
+        if (next == follow)
+            fprintf(fp, "if(pc!=0x%04x)goto dispatch;\n", next);
+        else
+            fputs("goto dispatch;\n", fp);
+    }
+    else if (next != follow)
+        fputs("goto dispatch;\n", fp);
+}
+
+/* Write the translation as C */
+static int emit(FILE *fp, unsigned char *len, unsigned char *flags)
+{
+    int *chunk = malloc(0x10000 * sizeof(*chunk));
+    unsigned addr, a, n, k, nchunks, nentries = 0, nruns = 0;
+    unsigned first, next;
+    int ixoriy = 0;
+
+    if (!chunk)
+        return 0;
+
+    /* Split the code into chunks, and give an entry to each instruction
+     * that is not reached by falling into it from the one before */
+    for (addr = 0x100, n = 0; addr < 0x100 + image_len; addr++)
+        if (len[addr])
+            chunk[addr] = n++ / CHUNK_SIZE;
+    nchunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    for (addr = 0x100; addr < 0x100 + image_len; addr = next) {
+        for (next = addr + 1; next < 0x100 + image_len && !len[next]; next++)
+            ;
+        if (len[addr] && !(flags[addr] & F_STOP) &&
+            addr + len[addr] < 0x100 + image_len &&
+            (addr + len[addr] != next || chunk[next] != chunk[addr]))
+            flags[addr + len[addr]] |= F_ENTRY;
+    }
+
+    emit_prologue(fp);
+    for (k = 0, addr = 0x100; k < nchunks; k++) {
+        while (!len[addr])
+            addr++;
+        first = addr;
+        fprintf(fp, "static void x%u(struct xlat_cpu *cpu)\n{\n"
+                "XLAT_ENTER;\ngoto dispatch;\n", k);
+        for (; addr < 0x100 + image_len && (!len[addr] || chunk[addr] == (int)k);
+             addr = next) {
+            for (next = addr + 1; next < 0x100 + image_len && !len[next]; next++)
+                ;
+            if (len[addr])
+                emit_insn(fp, len, flags, chunk, addr,
+                          (next < 0x100 + image_len && chunk[next] == (int)k)
+                              ? next : 0x10000,
+                          &ixoriy);
+        }
+        fputs("dispatch:\nswitch(pc){\n", fp);
+        for (a = first; a < addr; a++)
+            if (entry(len, flags, a)) {
+                fprintf(fp, "case 0x%04x:goto L%04x;\n", a, a);
+                nentries++;
+            }
+        fputs("}\ncpu->miss=1;\nout:\nXLAT_LEAVE;\n}\n\n", fp);
+    }
+
+    fprintf(fp, "const int xlat_abi = %d;\n", XLAT_ABI);
+    fputs("const xlat_chunk xlat_chunks[] = {", fp);
+    for (k = 0; k < nchunks; k++)
+        fprintf(fp, "%sx%u,", (k % 8) ? "" : "\n", k);
+    fprintf(fp, "\n};\nconst unsigned xlat_nentries = %u;\n"
+            "const unsigned short xlat_entries[] = {", nentries);
+    for (addr = 0x100, n = 0; addr < 0x100 + image_len; addr++)
+        if (entry(len, flags, addr))
+            fprintf(fp, "%s0x%04x,%d,", (n++ % 8) ? "" : "\n", addr, chunk[addr]);
+
+    /* The bytes translated, as runs of consecutive instructions */
+    fputs("\n};\nconst unsigned short xlat_runs[] = {", fp);
+    for (addr = 0x100; addr < 0x100 + image_len; ) {
+        if (!len[addr] || (flags[addr] & F_STOP)) {
+            addr++;
+            continue;
+        }
+        for (first = addr; addr < 0x100 + image_len && len[addr] &&
+                           !(flags[addr] & F_STOP); addr += len[addr])
+            ;
+        fprintf(fp, "%s0x%04x,%u,", (nruns++ % 8) ? "" : "\n",
+                first, addr - first);
+    }
+    fprintf(fp, "\n};\nconst unsigned xlat_nruns = %u;\n", nruns);
+    free(chunk);
+    return !ferror(fp);
+}
+
+/*** Making and loading translations ***/
+
+/* Compile src to the shared object obj with cc, which may be a command
+ * with options of its own, as $CC often is. The file names are passed to
+ * it as they are, without a shell to take them apart. */
+static int compile(const char *cc, const char *src, const char *obj)
+{
+    char *words, *w, *argv[40];
+    int argc = 0, status;
+    pid_t pid;
+
+    if (!(words = strdup(cc)))
+        return 0;
+    for (w = words; argc < 30; ) {
+        while (*w == ' ' || *w == '\t')
+            *w++ = 0;
+        if (!*w)
+            break;
+        argv[argc++] = w;
+        while (*w && *w != ' ' && *w != '\t')
+            w++;
+    }
+    if (!argc)
+        argv[argc++] = (char *)"cc";
+    /* Checking is slow anyway, so its translations are not worth the time
+     * it takes to optimise them */
+    if (step_map) {
+        argv[argc++] = (char *)"-O0";
+        argv[argc++] = (char *)"-DXLAT_CHECK";
+    } else
+        argv[argc++] = (char *)"-O1";
+    argv[argc++] = (char *)"-fPIC";
+    argv[argc++] = (char *)"-shared";
+    argv[argc++] = (char *)"-w";
+    argv[argc++] = (char *)"-o";
+    argv[argc++] = (char *)obj;
+    argv[argc++] = (char *)src;
+    argv[argc] = NULL;
+
+    if ((pid = fork()) == 0) {
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    free(words);
+    return pid > 0 && waitpid(pid, &status, 0) == pid &&
+           WIFEXITED(status) && !WEXITSTATUS(status);
+}
+
+/* Translate the image, unless another zxcc is doing so already or an
+ * earlier attempt failed. Nobody waits for this (see translate_later()),
+ * so a failure only leaves a ".bad" file behind. */
+static void translate(void)
+{
+    char lock[CPM_MAXPATH + 32], bad[CPM_MAXPATH + 32], src[CPM_MAXPATH + 32];
+    char obj[CPM_MAXPATH + 48], so[CPM_MAXPATH + 32];
+    char *cc = getenv("CC");
+    unsigned char *len = NULL, *flags = NULL;
+    struct stat st;
+    int fd, ok = 0;
+    FILE *fp;
+
+    file_name(bad, sizeof(bad), ".bad");
+    if (!stat(bad, &st))
+        return;
+    if (!parse_sources()) {
+        if ((fp = fopen(bad, "w")))
+            fclose(fp);
+        return;
+    }
+    /* A lock left by a zxcc that was killed is taken over after a while */
+    file_name(lock, sizeof(lock), ".lock");
+    if ((fd = open(lock, O_WRONLY | O_CREAT | O_EXCL, 0644)) < 0) {
+        if (stat(lock, &st) || time(NULL) - st.st_mtime < 600)
+            return;
+        remove(lock);
+        if ((fd = open(lock, O_WRONLY | O_CREAT | O_EXCL, 0644)) < 0)
+            return;
+    }
+    close(fd);
+
+    file_name(src, sizeof(src), "");
+    snprintf(obj, sizeof(obj), "%s.%ld.so", src, (long)getpid());
+    snprintf(src + strlen(src), sizeof(src) - strlen(src), ".%ld.c",
+             (long)getpid());
+    file_name(so, sizeof(so), so_ext());
+    len = calloc(0x10000, 1);
+    flags = calloc(0x10000, 1);
+    if (len && flags && (fp = fopen(src, "w"))) {
+        discover(len, flags);
+        ok = emit(fp, len, flags);
+        if (fclose(fp))
+            ok = 0;
+        if (ok) {
+            Msg("Translating %s\n", src);
+            ok = compile(cc ? cc : "cc", src, obj) && !rename(obj, so);
+        }
+        remove(src);
+        remove(obj);
+        if (!ok && (fp = fopen(bad, "w")))
+            fclose(fp);
+    }
+    free(len);
+    free(flags);
+    remove(lock);
+}
+
+/* Compiling a translation takes longer than most runs of the program, so
+ * it is left to a process of its own that nobody waits for */
+static void translate_later(void)
+{
+    pid_t pid;
+    int fd;
+
+    if ((pid = fork()) == 0) {
+        if (fork() == 0) {
+            /* Let go of the terminal, and of pipes whose readers would
+             * otherwise wait for us */
+            if ((fd = open("/dev/null", O_RDWR)) >= 0) {
+                dup2(fd, 0);
+                dup2(fd, 1);
+                dup2(fd, 2);
+                if (fd > 2)
+                    close(fd);
+            }
+            translate();
+        }
+        _exit(0);
+    }
+    if (pid > 0)
+        waitpid(pid, NULL, 0);
+}
+
+/* Done with the image: keep what was learnt about it, and translate it
+ * if need be */
+static void finish_image(void)
+{
+    if (image_len && (!loaded || new_notes) && save_notes()) {
+        /* See check_run() */
+        if (step_map)
+            translate();
+        else
+            translate_later();
+    }
+    xlat_off();
+    image_len = 0;
+    loaded = 0;
+}
+
+static void start_image(unsigned len)
+{
+    hash_t key;
+
+    finish_image();
+    load_top = 0;
+    map[0x100] = 0;
+    if (!len || len > 0xFD00)
+        return;
+    memcpy(image, RAM + 0x100, len);
+    memset(notes, 0, 0x10000);
+    image_len = len;
+    new_notes = 0;
+
+    key = fnv(14695981039346656037ULL, "XLAT", 4);
+    key = fnv(key, xlat_src_zxxlat, strlen(xlat_src_zxxlat));
+    key = fnv(key, xlat_src_z80regs, strlen(xlat_src_z80regs));
+    key = fnv(key, xlat_src_z80ops, strlen(xlat_src_z80ops));
+    key = fnv(key, xlat_src_cbops, strlen(xlat_src_cbops));
+    key = fnv(key, xlat_src_edops, strlen(xlat_src_edops));
+    image_key = fnv(key, image, len);
+
+    read_notes();
+    load_translation();
+}
+
+static void xlat_exit(void)
+{
+    finish_image();
+}
+
+int xlat_init(const char *dir, int check)
+{
+    struct stat st;
+
+    if (stat(dir, &st) ? mkdir(dir, 0777) != 0 : !S_ISDIR(st.st_mode))
+        return 0;
+    if (!(xlat_dir = strdup(dir)) ||
+        !(image = malloc(0xFD00)) || !(notes = malloc(0x10000)) ||
+        !(map = calloc(0x10000, sizeof(*map))) ||
+        !(xlat_code = calloc(0x10000, 1))) {
+        free(map);
+        map = NULL;
+        return 0;
+    }
+    if (check && !check_init())
+        return 0;
+    xlat_map = step_map ? step_map : map;
+    atexit(xlat_exit);
+    return 1;
+}
+
+void xlat_load(unsigned len)
+{
+    if (map)
+        start_image(len);
+}